@@ -1,5 +1,6 @@
 #include "benchmark.h"
 
+#include <bozo/awaitable.h>
 #include <bozo/connection_info.h>
 #include <bozo/connection_pool.h>
 #include <bozo/request.h>
@@ -10,14 +11,81 @@
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/spawn.hpp>
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/co_spawn.hpp>
+#endif
 #include <boost/program_options.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <cstdlib>
+#include <new>
+#include <numeric>
 #include <thread>
 
 namespace {
 
+// Counts heap allocations made by the benchmark to report them per request
+std::atomic_size_t allocations_count {0};
+
+} // namespace
+
+// The array forms call these ones by default, all the replaced forms
+// allocate via std::malloc or std::aligned_alloc so std::free fits them all.
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = operator new(size, std::nothrow)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    // std::aligned_alloc requires the size to be a multiple of the alignment
+    return std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = operator new(size, alignment, std::nothrow)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+namespace {
+
 namespace asio = boost::asio;
 
 using benchmark_t = bozo::benchmark::time_limit_benchmark;
@@ -79,6 +147,7 @@ struct benchmark_params {
     std::size_t threads_number = 0;
     std::size_t queue_capacity = 0;
     std::size_t connections = 0;
+    std::size_t shards = 1;
     bool parse_result = false;
     bool verbose = false;
     bozo::time_traits::duration connect_timeout = std::chrono::seconds(1);
@@ -96,7 +165,9 @@ struct benchmark_report {
     BOZO_STD_OPTIONAL<std::size_t> threads_number;
     BOZO_STD_OPTIONAL<std::size_t> queue_capacity;
     BOZO_STD_OPTIONAL<std::size_t> connections;
+    BOZO_STD_OPTIONAL<std::size_t> shards;
     BOZO_STD_OPTIONAL<bool> parse_result;
+    double allocations_per_request = 0;
 };
 
 std::ostream& operator <<(std::ostream& stream, const benchmark_report& value) {
@@ -114,10 +185,14 @@ std::ostream& operator <<(std::ostream& stream, const benchmark_report& value) {
     if (value.connections) {
         stream << "connections: " << *value.connections << '\n';
     }
+    if (value.shards) {
+        stream << "shards: " << *value.shards << '\n';
+    }
     if (value.parse_result) {
         stream << "parse_result: " << *value.parse_result << '\n';
     }
     stream << value.stats << '\n';
+    stream << "allocations_per_request: " << value.allocations_per_request << '\n';
     return stream;
 }
 
@@ -262,6 +337,68 @@ benchmark_report use_connection_pool(const benchmark_params& params, Query query
     return report;
 }
 
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+template <typename Row, typename Query>
+benchmark_report use_connection_pool_awaitable(const benchmark_params& params, Query query) {
+    constexpr bool parse_result = !std::is_same_v<Row, void>;
+
+    assert(parse_result == params.parse_result);
+
+    benchmark_report report;
+    report.name = __func__;
+    report.query = bozo::to_const_char(bozo::get_text(query));
+    report.coroutines = params.coroutines;
+    report.queue_capacity = params.queue_capacity;
+    report.parse_result = parse_result;
+
+    benchmark_t benchmark(params.coroutines, params.duration);
+    benchmark.set_print_progress(params.verbose);
+
+    asio::io_context io(1);
+    const bozo::connection_info connection_info(params.conn_string);
+    bozo::connection_pool_config config;
+    config.capacity = params.coroutines + 1;
+    config.queue_capacity = params.queue_capacity;
+    bozo::connection_pool pool(connection_info, config, !bozo::thread_safe);
+
+    for (std::size_t token = 0; token < params.coroutines; ++token) {
+        asio::co_spawn(io, [&, token] () -> asio::awaitable<void> {
+            while (true) {
+                std::conditional_t<parse_result, std::vector<Row>, bozo::result> result;
+                const auto [ec, connection] = co_await bozo::request(pool[io], query, params.request_timeout,
+                    bozo::into(result), bozo::use_awaitable);
+                if (ec) {
+                    std::cerr << ec.message() << '\n';
+                    if (connection) {
+                        std::cerr << bozo::get_error_context(connection) << '\n';
+                        std::cerr << bozo::error_message(connection) << '\n';
+                    }
+                    std::abort();
+                }
+                if (!benchmark.step(result.size(), token)) {
+                    break;
+                }
+            }
+        }, [token] (std::exception_ptr e) {
+            if (e) {
+                const std::lock_guard lock(cerr_mutex);
+                std::cerr << "coroutine " << token << " failed" << std::endl;
+                std::abort();
+            }
+        });
+    }
+
+    io.run();
+
+    report.output = benchmark.get_output();
+    report.stats = benchmark.get_stats();
+
+    return report;
+}
+
+#endif
+
 struct context {
     asio::io_context io;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> guard = boost::asio::make_work_guard(io);
@@ -283,6 +420,7 @@ benchmark_report use_connection_pool_mult_threads(const benchmark_params& params
     report.queue_capacity = params.queue_capacity;
     report.threads_number = params.threads_number;
     report.connections = params.connections;
+    report.shards = params.shards;
     report.parse_result = parse_result;
 
     benchmark_t benchmark(params.coroutines * params.threads_number, params.duration);
@@ -292,6 +430,7 @@ benchmark_report use_connection_pool_mult_threads(const benchmark_params& params
     bozo::connection_pool_config config;
     config.capacity = params.connections;
     config.queue_capacity = params.queue_capacity;
+    config.shards = params.shards;
     std::vector<std::unique_ptr<context>> contexts;
     bozo::connection_pool pool(connection_info, config);
     std::atomic_size_t finished_coroutines {0};
@@ -378,6 +517,18 @@ benchmark_report run_benchmark(const std::string& name, const benchmark_params&
                 }
             }
         },
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+        {
+            "use_connection_pool_awaitable",
+            [&] {
+                if (params.parse_result) {
+                    return use_connection_pool_awaitable<Row>(params, query);
+                } else {
+                    return use_connection_pool_awaitable<void>(params, query);
+                }
+            }
+        },
+#endif
         {
             "use_connection_pool_mult_threads",
             [&] {
@@ -396,7 +547,15 @@ benchmark_report run_benchmark(const std::string& name, const benchmark_params&
         throw std::invalid_argument("Invalid benchmark name: \"" + name + "\"");
     }
 
-    return scenario->second();
+    const auto allocations_before = allocations_count.load(std::memory_order_relaxed);
+    auto report = scenario->second();
+    const auto allocations = allocations_count.load(std::memory_order_relaxed) - allocations_before;
+    const auto requests = std::accumulate(report.output.steps.begin(), report.output.steps.end(), std::size_t(0),
+        [] (std::size_t sum, const bozo::benchmark::step& v) { return sum + v.requests_count; });
+    if (requests) {
+        report.allocations_per_request = static_cast<double>(allocations) / static_cast<double>(requests);
+    }
+    return report;
 }
 
 benchmark_report run_benchmark(const std::string& name, const benchmark_params& params) {
@@ -543,6 +702,9 @@ struct adl_serializer<benchmark_report> {
         if (value.connections) {
             j["connections"] = *value.connections;
         }
+        if (value.shards) {
+            j["shards"] = *value.shards;
+        }
         if (value.queue_capacity) {
             j["queue_capacity"] = *value.queue_capacity;
         }
@@ -554,6 +716,7 @@ struct adl_serializer<benchmark_report> {
         }
         j["output"] = value.output;
         j["stats"] = value.stats;
+        j["allocations_per_request"] = value.allocations_per_request;
     }
 
     static void from_json(const json&, benchmark_report&) {
@@ -589,6 +752,7 @@ int main(int argc, char **argv) {
             ("queue", po::value<std::size_t>()->default_value(0), "connection pool queue capacity")
             ("threads", po::value<std::size_t>()->default_value(1), "number of threads")
             ("connections", po::value<std::size_t>(), "number of parallel coroutines (default: equal to coroutines + 1)")
+            ("shards", po::value<std::size_t>()->default_value(1), "number of connection pool shards for multithreaded benchmark")
             ("parse,p", "parse query result")
             ("verbose,v", "use verbose output")
             ("duration,d", po::value<double>()->default_value(31), "benchmark duration in seconds")
@@ -626,6 +790,7 @@ int main(int argc, char **argv) {
         } else {
             params.connections = params.coroutines;
         }
+        params.shards = variables.at("shards").as<std::size_t>();
         params.parse_result = variables.count("parse") > 0;
         params.verbose = variables.count("verbose") > 0;
         params.duration = to_duration(variables.at("duration"));
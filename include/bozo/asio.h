@@ -1,6 +1,7 @@
 #pragma once
 
 #include <bozo/detail/asio_compat.hpp>
+#include <bozo/deadline_wheel.h>
 
 #include <boost/asio/strand.hpp>
 #include <boost/asio/steady_timer.hpp>
@@ -35,9 +36,11 @@ auto make_strand_executor(const Executor& ex) {
     return strand_executor<Executor>::get(ex);
 }
 
+// Operations deadlines are served by the deadline wheel of the io_context if it is
+// enabled via bozo::enable_deadline_wheel() and by the asio::steady_timer otherwise
 template <typename ExecutionContext>
 struct operation_timer {
-    using type = asio::steady_timer;
+    using type = operation_deadline_timer<ExecutionContext>;
 
     template <typename TimeConstraint>
     static type get(const ExecutionContext& ex, TimeConstraint t) {
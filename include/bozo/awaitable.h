@@ -0,0 +1,102 @@
+#pragma once
+
+#include <bozo/asio.h>
+#include <bozo/error.h>
+
+#include <boost/asio/use_awaitable.hpp>
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT) || defined(BOZO_DOCUMENTATION)
+
+#include <boost/asio/redirect_error.hpp>
+
+#include <tuple>
+
+namespace bozo {
+
+/**
+ * @brief Completion token for C++20 coroutines
+ *
+ * Makes an operation return `asio::awaitable` which is completed with a tuple
+ * of the error code and the connection instead of throwing an exception.
+ * So the connection is still available on error, e.g. to get the error context,
+ * as it is with the callback and `yield_context` completion tokens.
+ * Operations with a single error code argument in the signature are completed with
+ * the error code only.
+ *
+ * The operation is awaited via `asio::use_awaitable`, so the coroutine does not need
+ * a stack of its own as `yield_context` does. Only the frame of the adapter coroutine
+ * comes from the per-thread cache of asio coroutine frames, the operation state is
+ * allocated the same way as with the other completion tokens.
+ *
+ * Available only if the compiler supports coroutines, i.e. with C++20 enabled.
+ *
+ * ### Example
+ *
+ * @code
+asio::awaitable<void> get_users(bozo::connection_pool<bozo::connection_info<>>& pool) {
+    auto& io = static_cast<asio::io_context&>((co_await asio::this_coro::executor).context());
+    bozo::rows_of<std::int64_t, std::string> rows;
+    auto [ec, conn] = co_await bozo::request(pool[io], "SELECT id, name FROM users"_SQL,
+            1s, bozo::into(rows), bozo::use_awaitable);
+    if (ec) {
+        std::cerr << ec.message() << " | " << bozo::error_message(conn);
+        if (!bozo::is_null_recursive(conn)) {
+            std::cerr << " | " << bozo::get_error_context(conn);
+        }
+        co_return;
+    }
+    ...
+}
+ * @endcode
+ *
+ * @tparam Executor --- executor type of the coroutine.
+ * @ingroup group-core-types
+ */
+template <typename Executor = asio::any_io_executor>
+struct use_awaitable_t {
+    constexpr use_awaitable_t() = default;
+};
+
+/**
+ * Default instance of `bozo::use_awaitable_t`.
+ * @ingroup group-core-types
+ */
+constexpr use_awaitable_t<> use_awaitable;
+
+} // namespace bozo
+
+namespace boost::asio {
+
+template <typename Executor, typename R, typename T>
+class async_result<bozo::use_awaitable_t<Executor>, R(bozo::error_code, T)> {
+public:
+    using value_type = std::decay_t<T>;
+    using return_type = awaitable<std::tuple<bozo::error_code, value_type>, Executor>;
+
+    template <typename Initiation, typename ...Args>
+    static return_type initiate(Initiation initiation, bozo::use_awaitable_t<Executor>, Args ...args) {
+        bozo::error_code ec;
+        auto token = redirect_error(use_awaitable_t<Executor>{}, ec);
+        auto value = co_await async_initiate<decltype(token), void(bozo::error_code, value_type)>(
+            std::move(initiation), token, std::move(args)...);
+        co_return std::make_tuple(std::move(ec), std::move(value));
+    }
+};
+
+template <typename Executor, typename R>
+class async_result<bozo::use_awaitable_t<Executor>, R(bozo::error_code)> {
+public:
+    using return_type = awaitable<bozo::error_code, Executor>;
+
+    template <typename Initiation, typename ...Args>
+    static return_type initiate(Initiation initiation, bozo::use_awaitable_t<Executor>, Args ...args) {
+        bozo::error_code ec;
+        auto token = redirect_error(use_awaitable_t<Executor>{}, ec);
+        co_await async_initiate<decltype(token), void(bozo::error_code)>(std::move(initiation), token, std::move(args)...);
+        co_return ec;
+    }
+};
+
+} // namespace boost::asio
+
+#endif
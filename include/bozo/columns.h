@@ -0,0 +1,487 @@
+#pragma once
+
+#include <bozo/detail/bulk_endian.h>
+#include <bozo/io/recv.h>
+#include <bozo/pg/types/bytea.h>
+#include <bozo/pg/types/name.h>
+#include <bozo/result.h>
+
+#include <boost/hana/accessors.hpp>
+#include <boost/hana/at_key.hpp>
+#include <boost/hana/keys.hpp>
+#include <boost/hana/second.hpp>
+#include <boost/hana/tuple.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bozo {
+
+/**
+ * @brief Validity bitmap of a column
+ *
+ * Contains one bit per value of a column, the bit is set for a not `NULL` value.
+ * Bits are packed into bytes starting from the least significant bit, so the
+ * bitmap may be passed as is into vectorized code.
+ *
+ * @ingroup group-requests-types
+ */
+class validity_bitmap {
+public:
+    std::size_t size() const noexcept { return size_;}
+
+    bool empty() const noexcept { return size_ == 0;}
+
+    bool operator[] (std::size_t i) const noexcept {
+        return (bits_[i / 8] >> (i % 8)) & 1;
+    }
+
+    /**
+     * Count of unset bits, i.e. count of `NULL` values.
+     */
+    std::size_t null_count() const noexcept { return null_count_;}
+
+    /**
+     * Raw bitmap bytes, `(size() + 7) / 8` bytes long.
+     */
+    const std::uint8_t* data() const noexcept { return bits_.data();}
+
+    void push_back(bool valid) {
+        if (size_ % 8 == 0) {
+            bits_.push_back(0);
+        }
+        if (valid) {
+            bits_.back() |= std::uint8_t(1u << (size_ % 8));
+        } else {
+            ++null_count_;
+        }
+        ++size_;
+    }
+
+    void reserve(std::size_t n) { bits_.reserve((n + 7) / 8);}
+
+    /**
+     * Drops the bits starting from `n`, does nothing if the bitmap is not longer than `n`.
+     */
+    void truncate(std::size_t n) noexcept {
+        for (; size_ > n; --size_) {
+            null_count_ -= !(*this)[size_ - 1];
+        }
+        bits_.resize((size_ + 7) / 8);
+        if (size_ % 8) {
+            bits_.back() &= std::uint8_t((1u << (size_ % 8)) - 1);
+        }
+    }
+
+    void clear() noexcept {
+        bits_.clear();
+        size_ = 0;
+        null_count_ = 0;
+    }
+
+private:
+    std::vector<std::uint8_t> bits_;
+    std::size_t size_ = 0;
+    std::size_t null_count_ = 0;
+};
+
+namespace detail {
+
+/**
+ * Types which are received as is and can be stored within a single
+ * contiguous buffer of a column.
+ */
+template <typename T>
+struct is_blob_column_type : std::false_type {};
+
+template <>
+struct is_blob_column_type<std::string> : std::true_type {};
+
+template <>
+struct is_blob_column_type<pg::bytea> : std::true_type {};
+
+template <>
+struct is_blob_column_type<pg::name> : std::true_type {};
+
+template <typename T>
+constexpr auto BlobColumnType = is_blob_column_type<std::decay_t<T>>::value;
+
+} // namespace detail
+
+#ifdef BOZO_DOCUMENTATION
+/**
+ * @brief Column of a request result in a contiguous memory
+ *
+ * Stores all the values of a result column. `NULL` values are marked via the
+ * `bozo::validity_bitmap`, so the column type itself should not be #Nullable.
+ *
+ * Values of types with fixed size like integers or floating point numbers are
+ * stored in a contiguous array of the type values, `NULL` values are
+ * default constructed. Values of `std::string`, `bozo::pg::bytea` and `bozo::pg::name` are
+ * stored in one contiguous buffer of bytes with offsets of the values, like
+ * Apache Arrow does. They are accessed via `std::string_view`, `NULL` values are empty.
+ * The bytes are copied into the buffer once rather than referenced within the result,
+ * since the result is released as soon as it has been received.
+ * Values of other types are stored in a contiguous array of the type values.
+ *
+ * Values of a result are appended to the column, so a column may accumulate
+ * several results. If a value could not be received the column is left as it was
+ * before the result was appended, as well as the other columns of the output.
+ *
+ * @tparam T --- type of the column values.
+ * @ingroup group-requests-types
+ */
+template <typename T>
+class column;
+#else
+template <typename T, typename = std::void_t<>>
+class column {
+    static_assert(!Nullable<T>, "column type should not be Nullable, NULL values are marked with validity bitmap");
+
+public:
+    using value_type = T;
+
+    std::size_t size() const noexcept { return values_.size();}
+
+    bool empty() const noexcept { return values_.empty();}
+
+    const T& operator[] (std::size_t i) const noexcept { return values_[i];}
+
+    bool is_null(std::size_t i) const noexcept { return !validity_[i];}
+
+    const T* data() const noexcept { return values_.data();}
+
+    const std::vector<T>& values() const noexcept { return values_;}
+
+    const validity_bitmap& validity() const noexcept { return validity_;}
+
+    void reserve(std::size_t n) {
+        values_.reserve(n);
+        validity_.reserve(n);
+    }
+
+    void clear() noexcept {
+        values_.clear();
+        validity_.clear();
+    }
+
+    /**
+     * Drops the values starting from the n-th one.
+     */
+    void truncate(std::size_t n) {
+        if (n < size()) {
+            values_.resize(n);
+            validity_.truncate(n);
+        }
+    }
+
+    /**
+     * Appends the values of the result column.
+     */
+    template <typename Result, typename OidMap>
+    void append(const basic_result<Result>& in, int column, const OidMap& oids) {
+        const std::size_t offset = values_.size();
+        try {
+            append(in, column, oids, offset);
+        } catch (...) {
+            values_.resize(offset);
+            validity_.truncate(offset);
+            throw;
+        }
+    }
+
+private:
+    template <typename Result, typename OidMap>
+    void append(const basic_result<Result>& in, int column, [[maybe_unused]] const OidMap& oids, std::size_t offset) {
+        values_.resize(offset + in.size());
+        validity_.reserve(values_.size());
+        if constexpr (detail::BulkByteOrderConvertible<T>) {
+            // Copy raw values and convert them from the big endian byte order at once
+            auto out = reinterpret_cast<char*>(values_.data() + offset);
+            for (auto row : in) {
+                const auto v = row[column];
+                const bool is_null = v.is_null();
+                validity_.push_back(!is_null);
+                if (!is_null) {
+                    if (v.size() != sizeof(T)) {
+                        throw system_error(error::bad_object_size,
+                            "data size " + std::to_string(v.size())
+                            + " does not match type size " + std::to_string(sizeof(T)));
+                    }
+                    std::memcpy(out, v.data(), sizeof(T));
+                }
+                out += sizeof(T);
+            }
+            detail::convert_from_big_endian(values_.data() + offset, in.size());
+        } else {
+            auto out = values_.begin() + offset;
+            for (auto row : in) {
+                const auto v = row[column];
+                const bool is_null = v.is_null();
+                validity_.push_back(!is_null);
+                if (!is_null) {
+                    istream s(v.data(), v.size());
+                    T value{};
+                    detail::recv(s, null_oid, v.size(), oids, value);
+                    *out = std::move(value);
+                }
+                ++out;
+            }
+        }
+    }
+
+    std::vector<T> values_;
+    validity_bitmap validity_;
+};
+
+template <typename T>
+class column<T, std::enable_if_t<detail::BlobColumnType<T>>> {
+public:
+    using value_type = T;
+
+    std::size_t size() const noexcept { return offsets_.size() - 1;}
+
+    bool empty() const noexcept { return size() == 0;}
+
+    std::string_view operator[] (std::size_t i) const noexcept {
+        return {data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+    }
+
+    bool is_null(std::size_t i) const noexcept { return !validity_[i];}
+
+    /**
+     * All the values bytes in a row.
+     */
+    const char* data() const noexcept { return data_.data();}
+
+    /**
+     * Offsets of the values within the data buffer, `size() + 1` items long;
+     * value `i` occupies `[offsets()[i], offsets()[i + 1])` range.
+     */
+    const std::vector<std::size_t>& offsets() const noexcept { return offsets_;}
+
+    const validity_bitmap& validity() const noexcept { return validity_;}
+
+    void reserve(std::size_t n) {
+        offsets_.reserve(n + 1);
+        validity_.reserve(n);
+    }
+
+    void clear() noexcept {
+        data_.clear();
+        offsets_.assign(1, 0);
+        validity_.clear();
+    }
+
+    /**
+     * Drops the values starting from the n-th one.
+     */
+    void truncate(std::size_t n) {
+        if (n < size()) {
+            data_.resize(offsets_[n]);
+            offsets_.resize(n + 1);
+            validity_.truncate(n);
+        }
+    }
+
+    /**
+     * Appends the values of the result column.
+     */
+    template <typename Result, typename OidMap>
+    void append(const basic_result<Result>& in, int column, const OidMap&) {
+        const std::size_t count = size();
+        const std::size_t bytes = data_.size();
+        try {
+            std::size_t total = bytes;
+            for (auto row : in) {
+                total += row[column].size();
+            }
+            data_.reserve(total);
+            reserve(count + in.size());
+            for (auto row : in) {
+                const auto v = row[column];
+                const bool is_null = v.is_null();
+                validity_.push_back(!is_null);
+                if (!is_null) {
+                    data_.insert(data_.end(), v.data(), v.data() + v.size());
+                }
+                offsets_.push_back(data_.size());
+            }
+        } catch (...) {
+            data_.resize(bytes);
+            offsets_.resize(count + 1);
+            validity_.truncate(count);
+            throw;
+        }
+    }
+
+private:
+    std::vector<char> data_;
+    std::vector<std::size_t> offsets_ = {0};
+    validity_bitmap validity_;
+};
+#endif
+
+/**
+ * @brief Columns of a request result
+ *
+ * Output object which receives a request result column by column into
+ * `bozo::column` objects. Columns are typed in compile time and
+ * matched with the result columns by position.
+ *
+ * ### Example
+ *
+@code{cpp}
+bozo::columns_of<std::int64_t, std::string> columns;
+
+bozo::request(conn_info[io], "SELECT id, name FROM users_info"_SQL, bozo::into(columns), yield);
+
+const auto& [ids, names] = boost::hana::unpack(columns, [](auto&... c) { return std::tie(c...); });
+@endcode
+ *
+ * In addition to positional columns a #HanaStruct with only `bozo::column` members may be
+ * used as an output object. In this case the columns are matched by the members names.
+ *
+ * @tparam Ts --- types of the columns values
+ * @ingroup group-requests-types
+ */
+template <typename ...Ts>
+using columns_of = hana::tuple<column<Ts>...>;
+
+template <typename T>
+struct is_column : std::false_type {};
+
+template <typename ...Ts>
+struct is_column<column<Ts...>> : std::true_type {};
+
+namespace detail {
+
+template <typename T>
+struct all_members_are_columns {
+    template <typename ...Accessors>
+    constexpr auto operator() (Accessors...) const {
+        return std::bool_constant<(is_column<std::decay_t<
+            decltype(hana::second(std::declval<Accessors>())(std::declval<T&>()))
+        >>::value && ...)>{};
+    }
+};
+
+template <typename T, typename = std::void_t<>>
+struct is_columns_struct : std::false_type {};
+
+template <typename T>
+struct is_columns_struct<T, std::enable_if_t<HanaStruct<T>>>
+: decltype(hana::unpack(hana::accessors<T>(), all_members_are_columns<T>{})) {};
+
+template <typename T, typename Out>
+inline void check_columns_count(const basic_result<T>& in, std::size_t count, const Out& out) {
+    if (in.empty()) {
+        return;
+    }
+    const auto size = std::size(*in.begin());
+    if (size != count) {
+        throw std::range_error("row size " + std::to_string(size)
+            + " does not match columns " + boost::core::demangle(typeid(out).name())
+            + " size " + std::to_string(count));
+    }
+}
+
+template <typename T, typename OidMap, typename Column>
+inline void check_column_oid(const basic_result<T>& in, int column, const OidMap& oids, const Column&) {
+    using value_type = typename Column::value_type;
+    if (in.empty()) {
+        return;
+    }
+    // All the values of a column have the same oid, so it is checked once.
+    const auto oid = (*in.begin())[column].oid();
+    if (!accepts_oid<value_type>(oids, oid)) {
+        throw system_error(error::oid_type_mismatch, "unexpected oid "
+            + std::to_string(oid) + " for column of type "
+            + boost::core::demangle(typeid(value_type).name()));
+    }
+}
+
+/**
+ * Appends the result columns to all the output columns or to none of them. Each output
+ * column is visited via `for_each_column(f)` which calls `f(index, column)` with the
+ * index of the result column. The OIDs are checked before anything is appended and
+ * if a value could not be received the columns are truncated to their previous sizes.
+ */
+template <std::size_t N, typename T, typename OidMap, typename ForEachColumn>
+inline void append_columns(const basic_result<T>& in, const OidMap& oids, ForEachColumn&& for_each_column) {
+    for_each_column([&](int column, const auto& out) { check_column_oid(in, column, oids, out);});
+
+    std::array<std::size_t, N> sizes;
+    std::size_t n = 0;
+    for_each_column([&](int, const auto& out) { sizes[n++] = out.size();});
+    try {
+        for_each_column([&](int column, auto& out) { out.append(in, column, oids);});
+    } catch (...) {
+        n = 0;
+        for_each_column([&](int, auto& out) { out.truncate(sizes[n++]);});
+        throw;
+    }
+}
+
+} // namespace detail
+
+/**
+ * Indicates if the type is a #HanaStruct with only `bozo::column` members.
+ */
+template <typename T>
+constexpr auto ColumnsStruct = detail::is_columns_struct<std::decay_t<T>>::value;
+
+template <typename T, typename OidMap, typename ...Ts>
+columns_of<Ts...>& recv_result(const basic_result<T>& in, const OidMap& oid_map, columns_of<Ts...>& out) {
+    detail::check_columns_count(in, sizeof...(Ts), out);
+    detail::append_columns<sizeof...(Ts)>(in, oid_map, [&](auto&& f) {
+        int column = 0;
+        hana::for_each(out, [&](auto& c) { f(column++, c);});
+    });
+    return out;
+}
+
+template <typename T, typename OidMap, typename Out>
+Require<ColumnsStruct<Out>, Out&>
+recv_result(const basic_result<T>& in, const OidMap& oid_map, Out& out) {
+    const auto keys = hana::keys(out);
+    constexpr std::size_t size = decltype(hana::size(keys))::value;
+    detail::check_columns_count(in, size, out);
+    if (in.empty()) {
+        return out;
+    }
+    // All the columns are resolved before anything is appended
+    const auto first = *in.begin();
+    std::array<int, size> columns;
+    std::size_t n = 0;
+    hana::for_each(keys, [&](auto key) {
+        auto i = first.find(hana::to<const char*>(key));
+        if (i == first.end()) {
+            throw std::range_error(std::string("row does not contain \"")
+                + hana::to<const char*>(key) + "\" column for "
+                + boost::core::demangle(typeid(out).name()));
+        }
+        columns[n++] = static_cast<int>(i - first.begin());
+    });
+    detail::append_columns<size>(in, oid_map, [&](auto&& f) {
+        std::size_t i = 0;
+        hana::for_each(keys, [&](auto key) { f(columns[i++], hana::at_key(out, key));});
+    });
+    return out;
+}
+
+/**
+ * @ingroup group-requests-functions
+ * @brief Shortcut for create reference wrapper for `bozo::columns_of`.
+ *
+ * @param v --- `bozo::columns_of` object for columns.
+ */
+template <typename ...Ts>
+constexpr auto into(columns_of<Ts...>& v) noexcept { return std::ref(v);}
+
+} // namespace bozo
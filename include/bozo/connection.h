@@ -8,9 +8,12 @@
 #include <bozo/core/none.h>
 #include <bozo/deadline.h>
 #include <bozo/pg/handle.h>
+#include <bozo/statistics.h>
 
 #include <bozo/detail/bind.h>
 #include <bozo/detail/functional.h>
+#include <bozo/detail/query_arena.h>
+#include <bozo/detail/statement_cache.h>
 
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/posix/stream_descriptor.hpp>
@@ -83,7 +86,7 @@ inline constexpr decltype(auto) unwrap_connection(T&& conn) noexcept {
  * The class object is non-copyable.
  *
  * @tparam OidMap --- oid map of types are used with connection
- * @tparam Statistics --- statistics of the connection (not supported yet)
+ * @tparam Statistics --- statistics of the connection, e.g. `bozo::query_statistics`
  *
  * @thread_safety{Safe,Unsafe}
  * @ingroup group-connection-types
@@ -101,7 +104,7 @@ public:
      * Construct a new connection object.
      *
      * @param io --- execution context for IO operations associated with the object.
-     * @param statistics --- initial statistics (not supported yet)
+     * @param statistics --- initial statistics
      */
     connection(io_context& io, Statistics statistics);
 
@@ -132,12 +135,36 @@ public:
      */
     const oid_map_type& oid_map() const noexcept { return oid_map_;}
 
+    /**
+     * Update the statistics of the connection. The function is used by the library operations
+     * if the statistics type models `bozo::QueryStatistics`.
+     *
+     * @param key --- query text or `bozo::checkout_key`.
+     * @param v --- `bozo::query_sample` or `bozo::checkout_sample` respectively.
+     */
     template <typename Key, typename Value>
-    void update_statistics(const Key&, const Value&) noexcept {
-        static_assert(std::is_void_v<Key>, "update_statistics is not supperted");
+    void update_statistics(const Key& key, Value&& v) noexcept {
+        static_assert(QueryStatistics<Statistics>, "update_statistics is not supported by the statistics type");
+        statistics_.update(key, std::forward<Value>(v));
     }
     const Statistics& statistics() const noexcept { return statistics_;}
 
+    /**
+     * Get a reference to the cache of statements prepared on the server for the connection.
+     * The cache is disabled by default and may be enabled by setting non-zero capacity.
+     *
+     * @return detail::statement_cache& --- reference on the prepared statements cache.
+     */
+    detail::statement_cache& statement_cache() noexcept { return statement_cache_;}
+
+    /**
+     * Get the memory arena which is used for binary queries sent via the connection
+     * unless an operation handler has its own associated allocator.
+     *
+     * @return const std::shared_ptr<detail::query_arena>& --- the query memory arena.
+     */
+    const std::shared_ptr<detail::query_arena>& query_arena() noexcept { return query_arena_;}
+
     /**
      * Get the additional context object for an error that occurred during the last operation on the connection.
      *
@@ -270,6 +297,8 @@ private:
     oid_map_type oid_map_;
     Statistics statistics_;
     error_context_type error_context_;
+    detail::statement_cache statement_cache_;
+    std::shared_ptr<detail::query_arena> query_arena_ = std::make_shared<detail::query_arena>();
 };
 
 /**
@@ -2,7 +2,10 @@
 
 #include <bozo/connector.h>
 #include <bozo/connection.h>
+#include <bozo/dns_cache.h>
 #include <bozo/impl/async_connect.h>
+#include <bozo/impl/async_resolve.h>
+#include <bozo/detail/request_statistics.h>
 #include <bozo/ext/std/shared_ptr.h>
 
 #include <chrono>
@@ -15,10 +18,14 @@ namespace bozo {
  * This connection source establishes a connection to a single host using (or via) the specified
  * [connection string](https://www.postgresql.org/docs/9.4/static/libpq-connect.html#LIBPQ-CONNSTRING).
  *
+ * If `bozo::dns_cache` is enabled the host name is resolved asynchronously and
+ * connections to several resolved addresses are raced, see `bozo::dns_cache` for details.
+ *
  * @warning Multi-host connection is not supported.
  *
  * @tparam OidMap --- oid map type with custom types that should be used within a connection.
- * @tparam Statistics --- statistics type which defines statistics is collected for this connection.
+ * @tparam Statistics --- statistics type which defines statistics is collected for this connection,
+ *                        e.g. `bozo::query_statistics`.
  * @ingroup group-connection-types
  * @models{ConnectionSource}
  */
@@ -59,9 +66,11 @@ public:
     template <typename TimeConstraint, typename Handler>
     void operator ()(io_context& io, TimeConstraint t, Handler&& handler) const {
         static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
-        auto allocator = asio::get_associated_allocator(handler);
-        impl::async_connect(conn_str, t, std::allocate_shared<bozo::connection<OidMap, Statistics>>(allocator, io, statistics),
-            std::forward<Handler>(handler));
+        if constexpr (QueryStatistics<Statistics>) {
+            connect(io, t, detail::connect_statistics_handler<std::decay_t<Handler>>{std::forward<Handler>(handler)});
+        } else {
+            connect(io, t, std::forward<Handler>(handler));
+        }
     }
 
     auto operator [](io_context& io) const & {
@@ -71,6 +80,21 @@ public:
     auto operator [](io_context& io) && {
         return connection_provider(std::move(*this), io);
     }
+
+private:
+    template <typename TimeConstraint, typename Handler>
+    void connect(io_context& io, const TimeConstraint& t, Handler&& handler) const {
+        auto make_connection = [&io, allocator = asio::get_associated_allocator(handler), statistics = statistics] {
+            return std::allocate_shared<bozo::connection<OidMap, Statistics>>(allocator, io, statistics);
+        };
+        if (dns_cache::global().enabled()) {
+            if (auto host = detail::resolvable_host(conn_str)) {
+                return impl::async_resolve_connect(io, conn_str, std::move(*host), t,
+                    std::move(make_connection), std::forward<Handler>(handler));
+            }
+        }
+        impl::async_connect(conn_str, t, make_connection(), std::forward<Handler>(handler));
+    }
 };
 
 template<typename OidMap, typename Statistics>
@@ -6,6 +6,10 @@
 #include <bozo/connector.h>
 #include <bozo/core/thread_safety.h>
 #include <bozo/detail/connection_pool.h>
+#include <bozo/detail/connection_socket.h>
+#include <bozo/detail/query_arena.h>
+#include <bozo/detail/request_statistics.h>
+#include <bozo/detail/statement_cache.h>
 
 namespace bozo {
 
@@ -22,6 +26,14 @@ struct connection_pool_config {
     std::size_t queue_capacity = 128; //!< maximum number of queued requests to get available connection
     time_traits::duration idle_timeout = std::chrono::seconds(60); //!< time interval to close connection after last usage
     time_traits::duration lifespan = std::chrono::hours(24); //!< time interval to keep connection open
+    std::size_t statement_cache_capacity = 0; //!< maximum number of prepared statements cached per connection, 0 disables the cache
+    std::size_t shards = 1; //!< number of independent pool shards, each `io_context` is served by its own shard, see `bozo::connection_pool`
+    time_traits::duration cancel_timeout = time_traits::duration::zero(); //!< time interval to cancel a query left in progress by a failed operation and to drain its results to reuse the connection, 0 disables it and such connection is closed, see `bozo::pooled_connection`
+    std::size_t min_idle = 0; //!< number of connections to open by `connection_pool::warm_up()` and to keep open in background, 0 disables it
+    time_traits::duration min_idle_check_interval = std::chrono::seconds(1); //!< time interval to check and to top up the number of open connections to `min_idle`
+    time_traits::duration min_idle_connect_timeout = std::chrono::seconds(10); //!< time constraint to open a connection to keep `min_idle`
+    double lifespan_jitter = 0; //!< part of `lifespan` to shorten it at random per connection, e.g. 0.1 for up to 10%, so connections do not expire at the same time
+    double idle_timeout_jitter = 0; //!< part of `idle_timeout` to shorten it at random per connection, e.g. 0.1 for up to 10%, so connections released at the same time are not closed at the same time
 };
 
 /**
@@ -66,9 +78,22 @@ public:
 
     const auto& statistics() const & {return statistics_;}
 
+    detail::statement_cache& statement_cache() & {return statement_cache_;}
+
+    const std::shared_ptr<detail::query_arena>& query_arena() & {return query_arena_;}
+
+    detail::connection_socket& socket() & {return socket_;}
+
+    time_traits::time_point expires_at() const noexcept {return expires_at_;}
+    void set_expires_at(time_traits::time_point v) noexcept {expires_at_ = v;}
+
+    time_traits::time_point idle_expires_at() const noexcept {return idle_expires_at_;}
+    void set_idle_expires_at(time_traits::time_point v) noexcept {idle_expires_at_ = v;}
+
     template <typename Key, typename Value>
-    void update_statistics(const Key&, Value&&) noexcept {
-        static_assert(std::is_void_v<Key>, "update_statistics is not supperted");
+    void update_statistics(const Key& key, Value&& v) noexcept {
+        static_assert(QueryStatistics<Statistics>, "update_statistics is not supported by the statistics type");
+        statistics_.update(key, std::forward<Value>(v));
     }
 
     const error_context_type& get_error_context() const noexcept {
@@ -92,6 +117,28 @@ private:
     oid_map_type oid_map_;
     error_context_type error_context_;
     statistics_type statistics_;
+    detail::statement_cache statement_cache_;
+    std::shared_ptr<detail::query_arena> query_arena_ = std::make_shared<detail::query_arena>();
+    time_traits::time_point expires_at_ = time_traits::time_point::max();
+    time_traits::time_point idle_expires_at_ = time_traits::time_point::max();
+    // Declared after the handle to be released before the connection is closed
+    detail::connection_socket socket_;
+};
+
+template <typename V>
+struct unwrap_impl<yamail::resource_pool::handle<V>> {
+    template <typename T>
+    static constexpr decltype(auto) apply(T&& handle) {
+        return *handle;
+    }
+};
+
+template <typename Handle>
+struct unwrap_impl<detail::shard_handle<Handle>> {
+    template <typename T>
+    static constexpr decltype(auto) apply(T&& handle) {
+        return *handle;
+    }
 };
 
 /**
@@ -104,6 +151,24 @@ private:
  * status is different than `bozo::transaction_status::idle` then it will not return to
  * the pool and be closed. The class object is non-copyable.
  *
+ * If the underlying representation provides a socket which lives as long as the
+ * connection (like `bozo::connection_rep` does), the socket stays registered in the
+ * `io_context` reactor between checkouts, so getting a connection from the pool does
+ * not cost system calls unless the connection is used with another `io_context`.
+ *
+ * If an operation has failed, e.g. by a time-out, the connection is left with a query
+ * in progress. If the cancel timeout is set via `connection_pool_config::cancel_timeout`,
+ * the query is cancelled on the server and its results are drained in background on
+ * the connection destruction, so the connection returns to the pool instead of being
+ * closed and reestablished. The blocking `PQcancel()` call is made out of the `io_context`
+ * via the system executor. If the query could not be cancelled within the timeout the
+ * connection is closed.
+ *
+ * If the connection has outlived its lifespan shortened by `connection_pool_config::lifespan_jitter`
+ * it is closed on the destruction or replaced with a new one on the checkout from the pool.
+ * The same is for the connection which has been idle in the pool longer than its idle timeout
+ * shortened by `connection_pool_config::idle_timeout_jitter`.
+ *
  * @tparam Rep      --- underlying connection pool representation for the real connection.
  * @tparam Executor --- the type of the executor is used to perform IO; currently only
  *                      `boost::asio::io_context::executor_type` is supported.
@@ -122,7 +187,9 @@ public:
     using statistics_type = typename connection_traits<rep_type>::statistics_type; //!< Connection statistics to be collected
     using executor_type = Executor; //!< The type of the executor associated with the object.
 
-    pooled_connection(const Executor& ex, Rep&& rep);
+    pooled_connection(const Executor& ex, Rep&& rep,
+        time_traits::duration cancel_timeout = time_traits::duration::zero(),
+        time_traits::duration idle_timeout = time_traits::duration::max());
 
     /**
      * Get native connection handle object.
@@ -143,10 +210,32 @@ public:
 
     template <typename Key, typename Value>
     void update_statistics(const Key& key, Value&& v) noexcept {
-        bozo::unwrap(rep_).update_statistics(key, std::forward<Value(v)>);
+        bozo::unwrap(rep_).update_statistics(key, std::forward<Value>(v));
     }
     const statistics_type& statistics() const noexcept { return bozo::unwrap(rep_).statistics();}
 
+    /**
+     * Get a reference to the cache of statements prepared on the server for the connection.
+     * The cache lives as long as the underlying connection and is dropped with it then
+     * the connection is wasted by the pool.
+     *
+     * @return detail::statement_cache& --- reference on the prepared statements cache.
+     */
+    template <typename T = rep_type>
+    auto statement_cache() noexcept -> decltype(bozo::unwrap(std::declval<T&>()).statement_cache()) {
+        return bozo::unwrap(rep_).statement_cache();
+    }
+
+    /**
+     * Get the memory arena for binary queries of the underlying connection.
+     *
+     * @return const std::shared_ptr<detail::query_arena>& --- the query memory arena.
+     */
+    template <typename T = rep_type>
+    auto query_arena() noexcept -> decltype(bozo::unwrap(std::declval<T&>()).query_arena()) {
+        return bozo::unwrap(rep_).query_arena();
+    }
+
     /**
      * Get the additional context object for an error that occurred during the last operation on the connection.
      *
@@ -251,9 +340,30 @@ public:
 private:
     using stream_type = typename detail::connection_stream<executor_type>::type;
 
+    template <typename T, typename = std::void_t<>>
+    struct has_socket : std::false_type {};
+
+    template <typename T>
+    struct has_socket<T, std::void_t<decltype(bozo::unwrap(std::declval<T&>()).socket())>>
+        : std::is_same<typename std::decay_t<decltype(bozo::unwrap(std::declval<T&>()).socket())>::stream_type, stream_type> {};
+
+    static constexpr bool uses_rep_socket = has_socket<rep_type>::value;
+
+    struct no_stream {};
+    using own_stream_type = std::conditional_t<uses_rep_socket, no_stream, stream_type>;
+
+    own_stream_type make_own_stream();
+
+    bool cancel_and_reuse() noexcept;
+
+    stream_type& stream() noexcept { return *stream_;}
+
     rep_type rep_;
     executor_type ex_;
-    stream_type stream_;
+    own_stream_type own_stream_;
+    stream_type* stream_;
+    time_traits::duration cancel_timeout_;
+    time_traits::duration idle_timeout_;
 };
 
 template <typename ...Ts>
@@ -263,6 +373,10 @@ template <typename T>
 struct connection_traits<yamail::resource_pool::handle<T>> :
     connection_traits<typename yamail::resource_pool::handle<T>::value_type> {};
 
+template <typename Handle>
+struct connection_traits<detail::shard_handle<Handle>> :
+    connection_traits<typename detail::shard_handle<Handle>::value_type> {};
+
 /**
  * @brief Connection pool implementation
  *
@@ -279,6 +393,22 @@ struct connection_traits<yamail::resource_pool::handle<T>> :
  *
  * The request may be limited by time via optional `connection_pool_timeouts` argument of the `connection_pool::operator()`.
  *
+ * If `connection_pool_config::shards` is greater than 1, the pool is split into independent shards
+ * and the capacity is split between them. Each `io_context` is bound to its own shard, so threads
+ * running different `io_context` objects do not contend on the same pool lock. If the shard has no
+ * idle connection, an idle connection of another shard is used if any, then a shard with room for a new
+ * connection, so the whole capacity is available even with fewer `io_context` objects than shards.
+ * It is useful for the multithreaded applications with an `io_context` per thread. The shard is selected
+ * without locks, but the connection is still got from the shard under its lock, so there is no lock free
+ * path for a single shard.
+ *
+ * Connections are opened on demand, so the first requests after the start wait for the connect.
+ * If `connection_pool_config::min_idle` is set, `connection_pool::warm_up()` opens the connections
+ * in parallel in advance and keeps that number of connections open in background. To make connections
+ * established at the same time not to be closed at the same time by the lifespan,
+ * set `connection_pool_config::lifespan_jitter`, and by the idle timeout ---
+ * `connection_pool_config::idle_timeout_jitter`.
+ *
  * `connection_pool` models `ConnectionSource` concept itself using underlying `ConnectionSource`.
  *
  * @tparam Source --- underlying `ConnectionSource` which is being used to create connection to a database.
@@ -303,9 +433,14 @@ class connection_pool {
     static_assert(ConnectionSource<Source>, "should model ConnectionSource concept");
 
 public:
-    using connection_rep_type = bozo::connection_rep<typename bozo::unwrap_type<bozo::connection_type<Source>>::oid_map_type>;
+    using connection_rep_type = bozo::connection_rep<
+        typename bozo::unwrap_type<bozo::connection_type<Source>>::oid_map_type,
+        detail::connection_statistics_t<bozo::unwrap_type<bozo::connection_type<Source>>>>;
 
     using impl_type = detail::get_connection_pool_impl_t<connection_rep_type, ThreadSafety>;
+
+    using shards_type = detail::sharded_connection_pool<impl_type>;
+
     /**
      * Construct a new connection pool object
      *
@@ -315,13 +450,16 @@ public:
      * Thread safe by default (`bozo::thread_safety<true>`).
      */
     connection_pool(Source source, const connection_pool_config& config, const ThreadSafety& /*thread_safety*/ = ThreadSafety{})
-    : impl_(config.capacity, config.queue_capacity, config.idle_timeout, config.lifespan),
-      source_(std::move(source)) {}
+    : ctx_(std::make_shared<context>(std::move(source), config)) {}
 
     /**
      * Type of connection depends on connection type of Source. The definition is used to model `ConnectionSource`
+     *
+     * @note The pooled connection holds `detail::shard_handle` of the pool handle, so code which names
+     * `pooled_connection<yamail::resource_pool::handle<...>>` explicitly should use this type instead.
      */
-    using connection_type = std::shared_ptr<pooled_connection<yamail::resource_pool::handle<connection_rep_type>>>;
+    using connection_type = std::shared_ptr<pooled_connection<
+        detail::shard_handle<yamail::resource_pool::handle<connection_rep_type>>>>;
 
     /**
      * Get connection is bound to the given `io_context` object.
@@ -336,8 +474,29 @@ public:
     template <typename TimeConstraint, typename Handler>
     void operator ()(io_context& io, TimeConstraint t, Handler&& handler);
 
+    /**
+     * Open connections of the pool in advance for the given `io_context` object.
+     *
+     * The part of `connection_pool_config::min_idle` which belongs to the pool shard of the
+     * `io_context` is opened in parallel, each connection within `connection_pool_config::min_idle_connect_timeout`.
+     * Then the number of open connections is checked each `connection_pool_config::min_idle_check_interval`
+     * and topped up in background via the `io_context` while the pool exists and its shard is used. The
+     * check stops if there was no request to the shard since the previous one, so the maintenance
+     * does not keep `io_context::run()` running, and starts again with the next request. The pool opens
+     * a new connection only if there is no idle one, so the idle connections are held by the top up
+     * until the room for the new ones is got from the pool.
+     *
+     * With the sharded pool the operation should be called for each `io_context` which uses the pool.
+     *
+     * @param io --- `io_context` for the connections IO and the background maintenance.
+     * @param token --- completion token with `void(bozo::error_code)` signature, the first error
+     *                  of the opened connections is passed if any.
+     */
+    template <typename CompletionToken>
+    auto warm_up(io_context& io, CompletionToken&& token);
+
     auto stats() const {
-        return impl_.stats();
+        return ctx_->impl.stats();
     }
 
     auto operator [](io_context& io) {
@@ -358,8 +517,59 @@ private:
         return time_traits::duration(0);
     }
 
-    impl_type impl_;
-    Source source_;
+    // State of the pool shard to keep min_idle connections
+    struct min_idle_shard_state {
+        std::atomic<bool> topping_up{false};
+        std::atomic<bool> enabled{false};
+        std::atomic<bool> maintained{false};
+        std::atomic<bool> used{false};
+        std::shared_ptr<asio::steady_timer> timer;
+    };
+
+    // Pool state is shared with the background maintenance which stops when the pool is gone
+    struct context {
+        using connection_type = typename connection_pool::connection_type;
+        using mutex_type = detail::get_connection_pool_mutex_t<ThreadSafety>;
+
+        shards_type impl;
+        Source source;
+        detail::pooled_connection_options options;
+        std::size_t min_idle;
+        time_traits::duration min_idle_check_interval;
+        time_traits::duration min_idle_connect_timeout;
+        std::vector<std::shared_ptr<min_idle_shard_state>> min_idle_shards;
+
+        context(Source source, const connection_pool_config& config)
+        : impl(config.shards, config.capacity, config.queue_capacity, config.idle_timeout, config.lifespan),
+          source(std::move(source)),
+          options{config.statement_cache_capacity, config.cancel_timeout, config.lifespan, config.lifespan_jitter,
+              config.idle_timeout, config.idle_timeout_jitter},
+          min_idle(config.min_idle),
+          min_idle_check_interval(config.min_idle_check_interval),
+          min_idle_connect_timeout(config.min_idle_connect_timeout) {
+            min_idle_shards.reserve(impl.shards_count());
+            for (std::size_t i = 0; i < impl.shards_count(); ++i) {
+                min_idle_shards.push_back(std::make_shared<min_idle_shard_state>());
+            }
+        }
+
+        ~context() {
+            // The keepers are stopped via their io_context, the timers cannot be touched from here
+            for (const auto& state : min_idle_shards) {
+                if (auto timer = state->timer) {
+                    asio::post(timer->get_executor(), [timer] { timer->cancel();});
+                }
+            }
+        }
+
+        std::size_t shard_min_idle(std::size_t shard) const noexcept {
+            return std::min(detail::split_evenly(min_idle, impl.shards_count(), shard), impl.shard_capacity(shard));
+        }
+    };
+
+    static void maintain(const std::shared_ptr<context>& ctx, io_context& io, std::size_t shard);
+
+    std::shared_ptr<context> ctx_;
 };
 
 //[[DEPRECATED]] for backward compatibility only
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <bozo/impl/async_copy_in.h>
+
+namespace bozo {
+#ifdef BOZO_DOCUMENTATION
+/**
+ * @brief Copies rows into a database table with time constraint
+ *
+ * The function performs the `COPY ... FROM STDIN` query given and streams the rows into
+ * a database in the PostgreSQL binary `COPY` format. It is much faster than inserting
+ * the rows via parameterized `INSERT` queries, so it suits well for bulk loads.
+ * The rows are serialized via the same rules as query parameters, so a row field may be of
+ * any type which can be passed as a query parameter, `NULL` values are supported via
+ * #Nullable types. The rows are sent by batches, so memory consumption does not depend on
+ * the number of rows. The function can be called as any of Boost.Asio asynchronous
+ * function with #CompletionToken. The operation would be cancelled if time constrain is
+ * reached while performing.
+ *
+ * @note The query should copy data in the binary format, i.e. contain
+ * `FORMAT binary` option, and the order and types of the row fields should match the
+ * columns of the query.
+ * @note The rows range passed as an lvalue is not copied, so it should outlive the operation.
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider object to get connection from.
+ * @param query --- `COPY ... FROM STDIN (FORMAT binary)` query.
+ * @param rows --- range of rows to copy; a row may be a #HanaStruct, a #FusionSequence
+ *                 or a #HanaSequence like `std::tuple`.
+ * @param time_constraint --- operation #TimeConstraint; this time constrain <b>includes</b> time for getting connection from provider.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ *
+ * ###Example
+ *
+ * @code
+struct user {
+    std::int64_t id;
+    std::string name;
+};
+BOOST_HANA_ADAPT_STRUCT(user, id, name);
+
+std::vector<user> users = ...;
+
+bozo::copy_in(conn_info[io], "COPY users (id, name) FROM STDIN (FORMAT binary)"_SQL,
+    users, 10min, yield);
+ * @endcode
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename BinaryQueryConvertible, typename Rows, typename TimeConstraint, typename CompletionToken>
+decltype(auto) copy_in(ConnectionProvider&& provider, BinaryQueryConvertible&& query, Rows&& rows, TimeConstraint time_constraint, CompletionToken&& token);
+
+/**
+ * @brief Copies rows into a database table
+ *
+ * This function is time constrain free shortcut to `bozo::copy_in()` function.
+ * Its call is equal to `bozo::copy_in(provider, query, rows, bozo::none, token)` call.
+ *
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider object to get connection from.
+ * @param query --- `COPY ... FROM STDIN (FORMAT binary)` query.
+ * @param rows --- range of rows to copy.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename BinaryQueryConvertible, typename Rows, typename CompletionToken>
+decltype(auto) copy_in(ConnectionProvider&& provider, BinaryQueryConvertible&& query, Rows&& rows, CompletionToken&& token);
+#else
+
+template <typename Initiator>
+struct copy_in_op : base_async_operation <copy_in_op<Initiator>, Initiator> {
+    using base = typename copy_in_op::base;
+    using base::base;
+
+    template <typename P, typename Q, typename Rows, typename TimeConstraint, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, Rows&& rows, TimeConstraint t, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<P>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, handler_signature<P>>(
+            get_operation_initiator(*this), token, std::forward<P>(provider), t,
+            std::forward<Q>(query), std::forward<Rows>(rows));
+    }
+
+    template <typename P, typename Q, typename Rows, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, Rows&& rows, CompletionToken&& token) const {
+        return (*this)(std::forward<P>(provider), std::forward<Q>(query), std::forward<Rows>(rows), none,
+            std::forward<CompletionToken>(token));
+    }
+
+    template <typename OtherInitiator>
+    constexpr static auto rebind_initiator(const OtherInitiator& other) {
+        return copy_in_op<OtherInitiator>{other};
+    }
+};
+
+namespace detail {
+struct initiate_async_copy_in {
+    template <typename Handler, typename P, typename Q, typename Rows, typename TimeConstraint>
+    constexpr void operator()(Handler&& h, P&& provider, TimeConstraint t, Q&& query, Rows&& rows) const {
+        impl::async_copy_in(std::forward<P>(provider), std::forward<Q>(query), std::forward<Rows>(rows),
+            t, std::forward<Handler>(h));
+    }
+};
+} // namespace detail
+
+constexpr copy_in_op<detail::initiate_async_copy_in> copy_in;
+#endif
+} // namespace bozo
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <bozo/impl/async_copy_out.h>
+
+namespace bozo {
+#ifdef BOZO_DOCUMENTATION
+/**
+ * @brief Copies rows out of a database with time constraint
+ *
+ * The function performs the `COPY ... TO STDOUT` query given and receives the rows
+ * in the PostgreSQL binary `COPY` format. Each row is decoded as soon as it has been
+ * received and passed to the output, so the whole result is never held in memory.
+ * It is the fastest way to export big amounts of data, e.g. whole tables.
+ * The row fields are received via the same rules as `bozo::recv()` uses, `NULL` values are
+ * supported via #Nullable types. The function can be called as any of Boost.Asio asynchronous
+ * function with #CompletionToken. The operation would be cancelled if time constrain is
+ * reached while performing.
+ *
+ * Output may be:
+ * * #InsertIterator --- rows of the container value type are inserted via the iterator;
+ * * `bozo::row_stream` made via `bozo::for_each_row()` --- the callback is called for each row.
+ *
+ * @note The query should copy data in the binary format, i.e. contain
+ * `FORMAT binary` option, and the order and types of the row fields should match the
+ * columns of the query. The columns oids are not transferred within binary `COPY` data,
+ * so they are not checked.
+ * @note Since the rows are passed to the output while the query is in progress,
+ * some rows could be received by a request which completes with an error.
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider object to get connection from.
+ * @param query --- `COPY ... TO STDOUT (FORMAT binary)` query.
+ * @param out --- output for rows; a row may be a #HanaStruct, a #FusionSequence
+ *                or a #HanaSequence like `std::tuple`.
+ * @param time_constraint --- operation #TimeConstraint; this time constrain <b>includes</b> time for getting connection from provider.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ *
+ * ###Example
+ *
+ * @code
+struct user {
+    std::int64_t id;
+    std::string name;
+};
+BOOST_HANA_ADAPT_STRUCT(user, id, name);
+
+bozo::copy_out(conn_info[io], "COPY users (id, name) TO STDOUT (FORMAT binary)"_SQL,
+    bozo::for_each_row<user>([&](user&& u) { write(u); }), 10min, yield);
+ * @endcode
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename BinaryQueryConvertible, typename Out, typename TimeConstraint, typename CompletionToken>
+decltype(auto) copy_out(ConnectionProvider&& provider, BinaryQueryConvertible&& query, Out&& out, TimeConstraint time_constraint, CompletionToken&& token);
+
+/**
+ * @brief Copies rows out of a database
+ *
+ * This function is time constrain free shortcut to `bozo::copy_out()` function.
+ * Its call is equal to `bozo::copy_out(provider, query, out, bozo::none, token)` call.
+ *
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider object to get connection from.
+ * @param query --- `COPY ... TO STDOUT (FORMAT binary)` query.
+ * @param out --- output for rows.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename BinaryQueryConvertible, typename Out, typename CompletionToken>
+decltype(auto) copy_out(ConnectionProvider&& provider, BinaryQueryConvertible&& query, Out&& out, CompletionToken&& token);
+#else
+
+template <typename Initiator>
+struct copy_out_op : base_async_operation <copy_out_op<Initiator>, Initiator> {
+    using base = typename copy_out_op::base;
+    using base::base;
+
+    template <typename P, typename Q, typename Out, typename TimeConstraint, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, Out&& out, TimeConstraint t, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<P>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, handler_signature<P>>(
+            get_operation_initiator(*this), token, std::forward<P>(provider), t,
+            std::forward<Q>(query), std::forward<Out>(out));
+    }
+
+    template <typename P, typename Q, typename Out, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, Out&& out, CompletionToken&& token) const {
+        return (*this)(std::forward<P>(provider), std::forward<Q>(query), std::forward<Out>(out), none,
+            std::forward<CompletionToken>(token));
+    }
+
+    template <typename OtherInitiator>
+    constexpr static auto rebind_initiator(const OtherInitiator& other) {
+        return copy_out_op<OtherInitiator>{other};
+    }
+};
+
+namespace detail {
+struct initiate_async_copy_out {
+    template <typename Handler, typename P, typename Q, typename Out, typename TimeConstraint>
+    constexpr void operator()(Handler&& h, P&& provider, TimeConstraint t, Q&& query, Out&& out) const {
+        impl::async_copy_out(std::forward<P>(provider), std::forward<Q>(query), std::forward<Out>(out),
+            t, std::forward<Handler>(h));
+    }
+};
+} // namespace detail
+
+constexpr copy_out_op<detail::initiate_async_copy_out> copy_out;
+#endif
+} // namespace bozo
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <bozo/impl/async_cursor.h>
+#include <bozo/transaction.h>
+
+namespace bozo {
+#ifdef BOZO_DOCUMENTATION
+/**
+ * @brief Fetches rows of a query via a server-side cursor with time constraint
+ *
+ * The function declares a cursor for the query within the transaction given and fetches
+ * its rows by `FETCH` batches until the cursor is exhausted, then the cursor is closed.
+ * The next `FETCH` is sent as soon as the previous batch has been received, so the database
+ * prepares the next batch while the previous one is being decoded into the output and the
+ * connection is never idle. Only a single batch is held in memory at a time, so the function
+ * is suitable for huge results where the single-row mode of `bozo::for_each_row()` is
+ * impractical, e.g. via poolers which buffer the whole result. The function can be called
+ * as any of Boost.Asio asynchronous function with #CompletionToken. The operation would be
+ * cancelled if time constrain is reached while performing.
+ *
+ * The number of rows of a batch is adapted to the `cursor_config::batch_bytes` target
+ * by the data size of the previous batch. Use `bozo::cursor.with_config()` to specify
+ * the configuration.
+ *
+ * Output may be:
+ * * `bozo::row_stream` made via `bozo::for_each_row()` --- the callback is called for each row,
+ *   the chunk size of the stream is ignored;
+ * * #InsertIterator --- rows of all the batches are inserted via the iterator.
+ *
+ * @note The query should model `bozo::Query` concept, e.g. be made via `bozo::query_builder`
+ * or `bozo::query_repository`, since its text is prefixed with the `DECLARE` statement.
+ * @note Since the rows are passed to the output while the cursor is being fetched,
+ * some rows could be received by a request which completes with an error. If the output
+ * throws an exception the operation completes with `bozo::error::bad_result_process`
+ * and the query in flight is abandoned, so the connection is not suitable for new requests anymore.
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param transaction --- `bozo::transaction` to declare the cursor within.
+ * @param query --- query to fetch rows of.
+ * @param out --- output for rows.
+ * @param time_constraint --- operation #TimeConstraint.
+ * @param token --- operation #CompletionToken with the transaction as the connection.
+ * @return deduced from #CompletionToken.
+ *
+ * ###Example
+ *
+ * @code
+auto transaction = bozo::begin(conn_pool[io], yield);
+
+bozo::cursor.with_config({1000, 50000, 4 * 1024 * 1024})(std::move(transaction),
+    "SELECT id, name FROM users"_SQL,
+    bozo::for_each_row<bozo::typed_row<std::int64_t, std::string>>([&](auto&& row) { write(row); }),
+    1h, yield);
+ * @endcode
+ * @ingroup group-requests-functions
+ */
+template <typename Transaction, typename Query, typename Out, typename TimeConstraint, typename CompletionToken>
+decltype(auto) cursor(Transaction&& transaction, Query&& query, Out&& out, TimeConstraint time_constraint, CompletionToken&& token);
+
+/**
+ * @brief Fetches rows of a query via a server-side cursor
+ *
+ * This function is time constrain free shortcut to `bozo::cursor()` function.
+ * Its call is equal to `bozo::cursor(transaction, query, out, bozo::none, token)` call.
+ *
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param transaction --- `bozo::transaction` to declare the cursor within.
+ * @param query --- query to fetch rows of.
+ * @param out --- output for rows.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ * @ingroup group-requests-functions
+ */
+template <typename Transaction, typename Query, typename Out, typename CompletionToken>
+decltype(auto) cursor(Transaction&& transaction, Query&& query, Out&& out, CompletionToken&& token);
+#else
+
+namespace detail {
+
+template <typename T>
+struct is_transaction : std::false_type {};
+
+template <typename ...Ts>
+struct is_transaction<transaction<Ts...>> : std::true_type {};
+
+} // namespace detail
+
+template <typename Initiator>
+struct cursor_op : base_async_operation <cursor_op<Initiator>, Initiator> {
+    using base = typename cursor_op::base;
+    cursor_config config_;
+
+    constexpr explicit cursor_op(Initiator initiator = {}, cursor_config config = {}) : base(initiator), config_(config) {}
+
+    template <typename T, typename Q, typename Out, typename TimeConstraint, typename CompletionToken>
+    decltype(auto) operator() (T&& transaction, Q&& query, Out&& out, TimeConstraint t, CompletionToken&& token) const {
+        static_assert(detail::is_transaction<std::decay_t<T>>::value, "cursor should be declared within a transaction");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, handler_signature<T>>(
+            get_operation_initiator(*this), token, std::forward<T>(transaction), t,
+            std::forward<Q>(query), std::forward<Out>(out), config_);
+    }
+
+    template <typename T, typename Q, typename Out, typename CompletionToken>
+    decltype(auto) operator() (T&& transaction, Q&& query, Out&& out, CompletionToken&& token) const {
+        return (*this)(std::forward<T>(transaction), std::forward<Q>(query), std::forward<Out>(out), none,
+            std::forward<CompletionToken>(token));
+    }
+
+    constexpr auto with_config(const cursor_config& config) const {
+        return cursor_op{get_operation_initiator(*this), config};
+    }
+
+    template <typename OtherInitiator>
+    constexpr auto rebind_initiator(const OtherInitiator& other) const {
+        return cursor_op<OtherInitiator>{other, config_};
+    }
+};
+
+namespace detail {
+struct initiate_async_cursor {
+    template <typename Handler, typename T, typename Q, typename Out, typename TimeConstraint>
+    constexpr void operator()(Handler&& h, T&& transaction, TimeConstraint t, Q&& query, Out&& out,
+            const cursor_config& config) const {
+        impl::async_cursor(std::forward<T>(transaction), std::forward<Q>(query), std::forward<Out>(out),
+            config, t, std::forward<Handler>(h));
+    }
+};
+} // namespace detail
+
+constexpr cursor_op<detail::initiate_async_cursor> cursor;
+#endif
+} // namespace bozo
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <bozo/time_traits.h>
+#include <bozo/detail/recycling_allocator.h>
+#include <bozo/detail/timer_wheel.h>
+
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/execution/context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace bozo {
+
+namespace asio = boost::asio;
+
+class deadline_wheel_service;
+
+namespace detail {
+
+struct deadline_wheel_registry {
+    std::mutex mutex;
+    // Serializes enabling of the wheels, taken before the mutex above
+    std::mutex enable_mutex;
+    std::vector<std::pair<const asio::execution_context*, deadline_wheel_service*>> items;
+    std::atomic<std::uint64_t> generation{0};
+
+    // The registry is never destroyed since services may outlive static objects
+    static deadline_wheel_registry& instance() {
+        static auto retval = new deadline_wheel_registry;
+        return *retval;
+    }
+
+    void add(const asio::execution_context& ctx, deadline_wheel_service& wheel) {
+        const std::lock_guard lock(mutex);
+        items.emplace_back(&ctx, &wheel);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void remove(const deadline_wheel_service& wheel) {
+        const std::lock_guard lock(mutex);
+        items.erase(std::remove_if(items.begin(), items.end(),
+            [&](const auto& v) { return v.second == &wheel;}), items.end());
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
+    deadline_wheel_service* find(const asio::execution_context& ctx) {
+        const std::lock_guard lock(mutex);
+        const auto i = std::find_if(items.begin(), items.end(),
+            [&](const auto& v) { return v.first == &ctx;});
+        return i == items.end() ? nullptr : i->second;
+    }
+};
+
+template <typename Executor>
+decltype(auto) get_execution_context(const Executor& ex) {
+    if constexpr (asio::can_query<const Executor&, asio::execution::context_t>::value) {
+        return asio::query(ex, asio::execution::context);
+    } else {
+        return ex.context();
+    }
+}
+
+struct deadline_wheel_wait_base : timer_wheel_entry {
+    using executor_type = asio::io_context::executor_type;
+    // Calls the handler via the executor or just destroys it if there is no executor
+    using complete_type = void (*)(deadline_wheel_wait_base*, const boost::system::error_code&, const executor_type*);
+    using destroy_type = void (*)(deadline_wheel_wait_base*);
+
+    complete_type complete_;
+    destroy_type destroy_;
+    // Owned by the wheel until completion and by the timer until its destruction
+    int refs_ = 2;
+
+    deadline_wheel_wait_base(complete_type complete, destroy_type destroy) noexcept
+    : complete_(complete), destroy_(destroy) {}
+};
+
+template <typename Handler>
+struct deadline_wheel_wait_op : deadline_wheel_wait_base {
+    using allocator_type = recycling_allocator<deadline_wheel_wait_op>;
+
+    std::optional<Handler> handler_;
+
+    template <typename T>
+    explicit deadline_wheel_wait_op(T&& handler)
+    : deadline_wheel_wait_base(&do_complete, &do_destroy), handler_(std::forward<T>(handler)) {}
+
+    struct bound_handler {
+        using executor_type = asio::associated_executor_t<Handler, deadline_wheel_wait_base::executor_type>;
+        using allocator_type = asio::associated_allocator_t<Handler>;
+
+        Handler handler_;
+        boost::system::error_code ec_;
+        deadline_wheel_wait_base::executor_type ex_;
+
+        void operator() () { handler_(ec_);}
+
+        executor_type get_executor() const noexcept {
+            return asio::get_associated_executor(handler_, ex_);
+        }
+
+        allocator_type get_allocator() const noexcept {
+            return asio::get_associated_allocator(handler_);
+        }
+    };
+
+    static void do_complete(deadline_wheel_wait_base* base, const boost::system::error_code& ec, const executor_type* ex) {
+        auto& self = *static_cast<deadline_wheel_wait_op*>(base);
+        auto handler = std::move(*self.handler_);
+        self.handler_.reset();
+        if (ex) {
+            asio::post(*ex, bound_handler{std::move(handler), ec, *ex});
+        }
+    }
+
+    static void do_destroy(deadline_wheel_wait_base* base) {
+        auto self = static_cast<deadline_wheel_wait_op*>(base);
+        allocator_type alloc;
+        std::allocator_traits<allocator_type>::destroy(alloc, self);
+        std::allocator_traits<allocator_type>::deallocate(alloc, self, 1);
+    }
+
+    template <typename T>
+    static deadline_wheel_wait_op* create(T&& handler) {
+        allocator_type alloc;
+        const auto p = std::allocator_traits<allocator_type>::allocate(alloc, 1);
+        try {
+            std::allocator_traits<allocator_type>::construct(alloc, p, std::forward<T>(handler));
+        } catch (...) {
+            std::allocator_traits<allocator_type>::deallocate(alloc, p, 1);
+            throw;
+        }
+        return p;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Deadline timers of the operations which share a timer wheel
+ *
+ * By default each operation with a time constraint arms its own `asio::steady_timer`,
+ * which costs the insertion into and the removal from the timer heap of the `io_context`.
+ * With a lot of concurrent operations the heap maintenance becomes noticeable. The service
+ * keeps the deadlines of all the operations on the `io_context` in the hierarchical timer
+ * wheel with constant time insertion and removal, and only one `asio::steady_timer`
+ * is used to wake the wheel up when the nearest slot is due.
+ *
+ * Deadlines are rounded up to the wheel granularity, so an operation may be
+ * cancelled up to the granularity later than its time constraint says.
+ *
+ * The service is enabled for an `io_context` via `bozo::enable_deadline_wheel()`.
+ * @ingroup group-core-types
+ */
+class deadline_wheel_service : public asio::execution_context::service {
+public:
+    using duration = time_traits::duration;
+    using time_point = time_traits::time_point;
+    using wait_base = detail::deadline_wheel_wait_base;
+
+    inline static asio::execution_context::id id;
+
+    deadline_wheel_service(asio::execution_context& ctx, asio::io_context::executor_type ex, duration granularity)
+    : asio::execution_context::service(ctx),
+      ex_(ex),
+      wheel_(granularity, time_traits::now()),
+      timer_(ex) {
+        detail::deadline_wheel_registry::instance().add(ctx, *this);
+    }
+
+    ~deadline_wheel_service() override {
+        detail::deadline_wheel_registry::instance().remove(*this);
+    }
+
+    /**
+     * Granularity of the wheel.
+     */
+    duration granularity() const noexcept { return wheel_.granularity();}
+
+    /**
+     * Number of the deadlines which are waited for.
+     */
+    std::size_t size() const {
+        const std::lock_guard lock(mutex_);
+        return wheel_.size();
+    }
+
+    /**
+     * Starts waiting for the deadline. The handler is called via `asio::post()` with
+     * no error when the deadline expires or with `asio::error::operation_aborted`
+     * when the wait is cancelled. The returned wait must be released via `release()`.
+     */
+    template <typename Handler>
+    wait_base* async_wait(time_point expiry, Handler&& handler) {
+        using op_type = detail::deadline_wheel_wait_op<std::decay_t<Handler>>;
+        const auto op = op_type::create(std::forward<Handler>(handler));
+        const std::lock_guard lock(mutex_);
+        if (shutdown_) {
+            op->complete_(op, {}, nullptr);
+            --op->refs_;
+        } else if (!wheel_.insert(*op, expiry)) {
+            op->complete_(op, {}, &ex_);
+            --op->refs_;
+        } else {
+            arm();
+        }
+        return op;
+    }
+
+    /**
+     * Cancels the wait if it is not completed yet.
+     */
+    void cancel(wait_base* op) {
+        const std::lock_guard lock(mutex_);
+        cancel_locked(op);
+    }
+
+    /**
+     * Cancels the wait if it is not completed yet and releases the wait object.
+     */
+    void release(wait_base* op) {
+        {
+            const std::lock_guard lock(mutex_);
+            cancel_locked(op);
+            if (--op->refs_) {
+                return;
+            }
+        }
+        op->destroy_(op);
+    }
+
+    void shutdown() override {
+        std::vector<wait_base*> ops;
+        {
+            const std::lock_guard lock(mutex_);
+            shutdown_ = true;
+            wheel_.clear([&] (auto& e) { ops.push_back(static_cast<wait_base*>(&e));});
+            timer_.cancel();
+        }
+        for (auto op : ops) {
+            op->complete_(op, {}, nullptr);
+            bool destroy = false;
+            {
+                const std::lock_guard lock(mutex_);
+                destroy = --op->refs_ == 0;
+            }
+            if (destroy) {
+                op->destroy_(op);
+            }
+        }
+    }
+
+private:
+    void cancel_locked(wait_base* op) {
+        if (!op->linked()) {
+            return;
+        }
+        wheel_.remove(*op);
+        op->complete_(op, asio::error::operation_aborted, shutdown_ ? nullptr : &ex_);
+        --op->refs_;
+        if (wheel_.size() == 0 && armed_) {
+            // Do not keep the io_context busy without pending deadlines
+            armed_.reset();
+            timer_.cancel();
+        }
+    }
+
+    void arm() {
+        const auto expiry = wheel_.next_expiry();
+        if (!expiry || (armed_ && *armed_ <= *expiry)) {
+            return;
+        }
+        armed_ = expiry;
+        timer_.expires_at(*expiry);
+        timer_.async_wait([this] (const boost::system::error_code& ec) {
+            if (ec != asio::error::operation_aborted) {
+                expire();
+            }
+        });
+    }
+
+    void expire() {
+        const std::lock_guard lock(mutex_);
+        if (shutdown_) {
+            return;
+        }
+        armed_.reset();
+        wheel_.advance(time_traits::now(), [&] (auto& e) {
+            auto op = static_cast<wait_base*>(&e);
+            op->complete_(op, {}, &ex_);
+            --op->refs_;
+        });
+        arm();
+    }
+
+    asio::io_context::executor_type ex_;
+    mutable std::mutex mutex_;
+    detail::timer_wheel wheel_;
+    asio::steady_timer timer_;
+    std::optional<time_point> armed_;
+    bool shutdown_ = false;
+};
+
+/**
+ * @brief Enables the deadline wheel for the `io_context`
+ *
+ * After the call the time constraints of all the operations which are executed
+ * on the `io_context` are served by the `bozo::deadline_wheel_service` instead
+ * of a timer per operation. Should be called before the operations are started.
+ * If the wheel is enabled already the existing one is returned and the granularity
+ * is not changed. It is safe to call the function concurrently.
+ *
+ * @param io --- `io_context` to enable the wheel for
+ * @param granularity --- wheel granularity, 1 millisecond by default
+ * @return the deadline wheel service of the `io_context`
+ * @ingroup group-core-functions
+ */
+inline deadline_wheel_service& enable_deadline_wheel(asio::io_context& io,
+        time_traits::duration granularity = std::chrono::milliseconds(1)) {
+    auto& registry = detail::deadline_wheel_registry::instance();
+    // asio::make_service() throws if the service exists, so the check and the creation
+    // are made under the lock for the concurrent calls to get the same wheel
+    const std::lock_guard lock(registry.enable_mutex);
+    if (const auto wheel = registry.find(io)) {
+        return *wheel;
+    }
+    return asio::make_service<deadline_wheel_service>(io, io.get_executor(), granularity);
+}
+
+/**
+ * Returns the deadline wheel enabled for the execution context of the executor
+ * or `nullptr` if it is not enabled.
+ * @ingroup group-core-functions
+ */
+template <typename Executor>
+deadline_wheel_service* find_deadline_wheel(const Executor& ex) {
+    auto& registry = detail::deadline_wheel_registry::instance();
+    const auto generation = registry.generation.load(std::memory_order_acquire);
+    if (generation == 0) {
+        return nullptr;
+    }
+    struct cache {
+        const asio::execution_context* ctx = nullptr;
+        deadline_wheel_service* wheel = nullptr;
+        std::uint64_t generation = 0;
+    };
+    thread_local cache cached;
+    const asio::execution_context& ctx = detail::get_execution_context(ex);
+    if (cached.ctx != &ctx || cached.generation != generation) {
+        cached = cache{&ctx, registry.find(ctx), generation};
+    }
+    return cached.wheel;
+}
+
+namespace detail {
+
+/**
+ * Operation timer which is served by the deadline wheel if it is enabled
+ * for the executor and by the `asio::steady_timer` otherwise.
+ */
+template <typename Executor>
+class operation_deadline_timer {
+public:
+    using time_point = time_traits::time_point;
+    using duration = time_traits::duration;
+
+    operation_deadline_timer(const Executor& ex, time_point expiry)
+    : wheel_(find_deadline_wheel(ex)) {
+        if (wheel_) {
+            expiry_ = expiry;
+        } else {
+            timer_.emplace(ex, expiry);
+        }
+    }
+
+    operation_deadline_timer(const Executor& ex, duration after)
+    : wheel_(find_deadline_wheel(ex)) {
+        if (wheel_) {
+            const auto now = time_traits::now();
+            expiry_ = after < time_point::max() - now ? now + after : time_point::max();
+        } else {
+            timer_.emplace(ex, after);
+        }
+    }
+
+    explicit operation_deadline_timer(const Executor& ex) {
+        timer_.emplace(ex);
+    }
+
+    operation_deadline_timer(operation_deadline_timer&& other) noexcept
+    : wheel_(other.wheel_), expiry_(other.expiry_), timer_(std::move(other.timer_)),
+      wait_(std::exchange(other.wait_, nullptr)) {}
+
+    operation_deadline_timer& operator = (operation_deadline_timer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            wheel_ = other.wheel_;
+            expiry_ = other.expiry_;
+            timer_ = std::move(other.timer_);
+            wait_ = std::exchange(other.wait_, nullptr);
+        }
+        return *this;
+    }
+
+    ~operation_deadline_timer() {
+        reset();
+    }
+
+    template <typename Handler>
+    void async_wait(Handler&& handler) {
+        if (timer_) {
+            timer_->async_wait(std::forward<Handler>(handler));
+        } else {
+            reset();
+            wait_ = wheel_->async_wait(expiry_, std::forward<Handler>(handler));
+        }
+    }
+
+    void cancel() {
+        if (timer_) {
+            timer_->cancel();
+        } else if (wait_) {
+            wheel_->cancel(wait_);
+        }
+    }
+
+    bool uses_deadline_wheel() const noexcept { return !timer_;}
+
+private:
+    void reset() noexcept {
+        if (wait_) {
+            wheel_->release(std::exchange(wait_, nullptr));
+        }
+    }
+
+    deadline_wheel_service* wheel_ = nullptr;
+    time_point expiry_;
+    std::optional<asio::steady_timer> timer_;
+    deadline_wheel_service::wait_base* wait_ = nullptr;
+};
+
+} // namespace detail
+} // namespace bozo
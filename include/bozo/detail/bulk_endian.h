@@ -0,0 +1,146 @@
+#pragma once
+
+#include <bozo/detail/endian.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#if !defined(BOZO_DISABLE_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define BOZO_DETAIL_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace bozo::detail {
+
+/**
+ * Types which values can be converted from big endian byte order in bulk,
+ * i.e. fixed size arithmetic types with the wire representation equal to the
+ * memory one up to the byte order.
+ */
+template <typename T, typename = std::void_t<>>
+struct is_bulk_byte_order_convertible : std::false_type {};
+
+template <typename T>
+struct is_bulk_byte_order_convertible<T, std::enable_if_t<
+    std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+>> : std::bool_constant<sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8> {};
+
+template <typename T>
+constexpr auto BulkByteOrderConvertible = is_bulk_byte_order_convertible<T>::value;
+
+/**
+ * Type of items of a contiguous container or void if the container
+ * does not provide contiguous storage access.
+ */
+template <typename T, typename = std::void_t<>>
+struct contiguous_item { using type = void; };
+
+template <typename T>
+struct contiguous_item<T, std::void_t<decltype(std::data(std::declval<T&>()))>> {
+    using type = std::remove_pointer_t<decltype(std::data(std::declval<T&>()))>;
+};
+
+template <typename T>
+using contiguous_item_t = typename contiguous_item<T>::type;
+
+template <std::size_t Size>
+using unsigned_of_size = std::conditional_t<Size == 2, std::uint16_t,
+    std::conditional_t<Size == 4, std::uint32_t, std::uint64_t>>;
+
+template <std::size_t Size>
+inline void byte_order_swap_scalar(char* data, std::size_t count) noexcept {
+    using type = unsigned_of_size<Size>;
+    for (std::size_t i = 0; i != count; ++i, data += Size) {
+        type v;
+        std::memcpy(&v, data, Size);
+        v = byte_order_swap<type>(v, std::make_index_sequence<Size>{});
+        std::memcpy(data, &v, Size);
+    }
+}
+
+#ifdef BOZO_DETAIL_X86_SIMD
+
+// Shuffle mask which reverses bytes of each Size bytes long item
+// within 16 bytes lanes.
+template <std::size_t Size>
+constexpr std::array<char, 32> byte_order_swap_mask() noexcept {
+    std::array<char, 32> retval{};
+    for (std::size_t i = 0; i != retval.size(); ++i) {
+        const auto lane_i = i % 16;
+        retval[i] = static_cast<char>(lane_i / Size * Size + Size - 1 - lane_i % Size);
+    }
+    return retval;
+}
+
+template <std::size_t Size>
+struct byte_order_swap_mask_constant {
+    alignas(32) static constexpr std::array<char, 32> value = byte_order_swap_mask<Size>();
+};
+
+template <std::size_t Size>
+__attribute__((target("ssse3")))
+inline void byte_order_swap_ssse3(char* data, std::size_t count) noexcept {
+    const auto mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(byte_order_swap_mask_constant<Size>::value.data()));
+    const std::size_t bytes = count * Size;
+    std::size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const auto p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+    }
+    byte_order_swap_scalar<Size>(data + i, (bytes - i) / Size);
+}
+
+template <std::size_t Size>
+__attribute__((target("avx2")))
+inline void byte_order_swap_avx2(char* data, std::size_t count) noexcept {
+    const auto mask = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(byte_order_swap_mask_constant<Size>::value.data()));
+    const std::size_t bytes = count * Size;
+    std::size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const auto p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+    }
+    byte_order_swap_scalar<Size>(data + i, (bytes - i) / Size);
+}
+
+#endif // BOZO_DETAIL_X86_SIMD
+
+using byte_order_swap_function = void (*)(char*, std::size_t) noexcept;
+
+/**
+ * Selects the fastest byte order swap implementation supported by the CPU
+ * the program is running on.
+ */
+template <std::size_t Size>
+inline byte_order_swap_function select_byte_order_swap() noexcept {
+#ifdef BOZO_DETAIL_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return byte_order_swap_avx2<Size>;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return byte_order_swap_ssse3<Size>;
+    }
+#endif
+    return byte_order_swap_scalar<Size>;
+}
+
+/**
+ * Converts values of a contiguous array from big endian byte order in place.
+ */
+template <typename T>
+inline void convert_from_big_endian([[maybe_unused]] T* values, [[maybe_unused]] std::size_t count) noexcept {
+    static_assert(BulkByteOrderConvertible<T>, "T should be a fixed size arithmetic type");
+    if constexpr (endian::native == endian::little) {
+        static const auto impl = select_byte_order_swap<sizeof(T)>();
+        impl(reinterpret_cast<char*>(values), count);
+    }
+}
+
+} // namespace bozo::detail
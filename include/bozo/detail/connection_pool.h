@@ -2,10 +2,20 @@
 
 #include <bozo/core/thread_safety.h>
 #include <bozo/detail/stub_mutex.h>
+#include <bozo/time_traits.h>
+#include <bozo/asio.h>
+#include <bozo/error.h>
 
 #include <yamail/resource_pool/async/pool.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <random>
+#include <vector>
 
 namespace bozo::detail {
 
@@ -25,4 +35,410 @@ struct get_connection_pool_impl<ConnectionRepType, thread_safety<false>> {
 template <typename ConnectionRepType, typename ThreadSafety>
 using get_connection_pool_impl_t = typename get_connection_pool_impl<ConnectionRepType, std::decay_t<ThreadSafety>>::type;
 
+/**
+ * Mutex type of the pool internals which follows the pool thread safety.
+ */
+template <typename ThreadSafety>
+using get_connection_pool_mutex_t = std::conditional_t<std::decay_t<ThreadSafety>::value, std::mutex, stub_mutex>;
+
+/**
+ * Options of the connections made by the pool.
+ */
+struct pooled_connection_options {
+    std::size_t statement_cache_capacity = 0;
+    time_traits::duration cancel_timeout = time_traits::duration::zero();
+    time_traits::duration lifespan = time_traits::duration::max();
+    double lifespan_jitter = 0;
+    time_traits::duration idle_timeout = time_traits::duration::max();
+    double idle_timeout_jitter = 0;
+};
+
+/**
+ * Expiry time of a new connection. The lifespan is shortened at random by
+ * up to the `lifespan_jitter` part of it, so the connections made at the same
+ * time do not expire at the same time.
+ */
+inline time_traits::time_point get_connection_expiry(const pooled_connection_options& options,
+        time_traits::time_point now = time_traits::now()) {
+    if (options.lifespan_jitter <= 0 || options.lifespan == time_traits::duration::max()) {
+        return time_traits::time_point::max();
+    }
+    thread_local std::minstd_rand generator{std::random_device{}()};
+    std::uniform_real_distribution<double> distribution(0, std::min(options.lifespan_jitter, 1.0));
+    const auto jitter = std::chrono::duration_cast<time_traits::duration>(
+        options.lifespan * distribution(generator));
+    return now + options.lifespan - jitter;
+}
+
+/**
+ * Idle timeout of a connection returned to the pool. The idle timeout is shortened
+ * at random by up to the `idle_timeout_jitter` part of it, so the connections released
+ * at the same time are not closed at the same time. Without the jitter the idle timeout
+ * is left to the underlying pool and the maximum duration is returned.
+ */
+inline time_traits::duration get_connection_idle_timeout(const pooled_connection_options& options) {
+    if (options.idle_timeout_jitter <= 0 || options.idle_timeout == time_traits::duration::max()) {
+        return time_traits::duration::max();
+    }
+    thread_local std::minstd_rand generator{std::random_device{}()};
+    std::uniform_real_distribution<double> distribution(0, std::min(options.idle_timeout_jitter, 1.0));
+    const auto jitter = std::chrono::duration_cast<time_traits::duration>(
+        options.idle_timeout * distribution(generator));
+    return options.idle_timeout - jitter;
+}
+
+template <typename T, typename = std::void_t<>>
+struct has_expiry : std::false_type {};
+
+template <typename T>
+struct has_expiry<T, std::void_t<
+    decltype(std::declval<T&>().expires_at())
+>> : std::true_type {};
+
+/**
+ * Indicates if the connection representation type has an expiry time.
+ */
+template <typename T>
+constexpr auto HasExpiry = has_expiry<std::decay_t<T>>::value;
+
+template <typename Rep>
+inline void set_connection_expiry([[maybe_unused]] Rep& rep, [[maybe_unused]] time_traits::time_point at) {
+    if constexpr (HasExpiry<Rep>) {
+        rep.set_expires_at(at);
+    }
+}
+
+template <typename Rep>
+inline bool connection_expired([[maybe_unused]] const Rep& rep) {
+    if constexpr (HasExpiry<Rep>) {
+        return rep.expires_at() != time_traits::time_point::max() && rep.expires_at() <= time_traits::now();
+    } else {
+        return false;
+    }
+}
+
+template <typename T, typename = std::void_t<>>
+struct has_idle_expiry : std::false_type {};
+
+template <typename T>
+struct has_idle_expiry<T, std::void_t<
+    decltype(std::declval<T&>().idle_expires_at())
+>> : std::true_type {};
+
+/**
+ * Indicates if the connection representation type has an idle expiry time.
+ */
+template <typename T>
+constexpr auto HasIdleExpiry = has_idle_expiry<std::decay_t<T>>::value;
+
+/**
+ * Sets the time the idle connection expires at, the maximum idle timeout leaves
+ * it to the underlying pool.
+ */
+template <typename Rep>
+inline void set_connection_idle_expiry([[maybe_unused]] Rep& rep, [[maybe_unused]] time_traits::duration idle_timeout,
+        [[maybe_unused]] time_traits::time_point now = time_traits::now()) {
+    if constexpr (HasIdleExpiry<Rep>) {
+        rep.set_idle_expires_at(idle_timeout == time_traits::duration::max()
+            ? time_traits::time_point::max() : now + idle_timeout);
+    }
+}
+
+template <typename Rep>
+inline bool connection_idle_expired([[maybe_unused]] const Rep& rep) {
+    if constexpr (HasIdleExpiry<Rep>) {
+        return rep.idle_expires_at() != time_traits::time_point::max() && rep.idle_expires_at() <= time_traits::now();
+    } else {
+        return false;
+    }
+}
+
+/**
+ * Part of the total amount which belongs to the i-th of count parts, the remainder
+ * goes to the first parts.
+ */
+constexpr std::size_t split_evenly(std::size_t total, std::size_t count, std::size_t i) noexcept {
+    return total / count + (i < total % count);
+}
+
+/**
+ * Load of a pool shard which is tracked without locks to select the shard
+ * for a request. The counters are approximate since the underlying pool
+ * may close idle connections by itself, e.g. on the idle timeout or the lifespan.
+ * The idle counter is reconciled once the shard provides a handle without
+ * a connection, which means it has no idle connections.
+ */
+class shard_load {
+public:
+    std::size_t idle() const noexcept { return idle_.load(std::memory_order_relaxed);}
+
+    std::size_t used() const noexcept { return used_.load(std::memory_order_relaxed);}
+
+    /**
+     * Connection is got from the shard.
+     *
+     * @param reused --- an idle connection is taken, otherwise a new one is to be opened.
+     */
+    void acquire(bool reused) noexcept {
+        used_.fetch_add(1, std::memory_order_relaxed);
+        if (!reused) {
+            // Idle connections counted before have been closed by the pool
+            idle_.store(0, std::memory_order_relaxed);
+            return;
+        }
+        auto idle = idle_.load(std::memory_order_relaxed);
+        while (idle && !idle_.compare_exchange_weak(idle, idle - 1, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * Connection returns to the shard, it stays open there if it is reusable.
+     */
+    void release(bool reusable) noexcept {
+        if (reusable) {
+            idle_.fetch_add(1, std::memory_order_relaxed);
+        }
+        used_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::size_t> idle_{0};
+    std::atomic<std::size_t> used_{0};
+};
+
+/**
+ * Handle of a connection got from a pool shard which releases the connection
+ * to the shard load on destruction. It provides the same interface as the handle
+ * of the underlying pool.
+ */
+template <typename Handle>
+class shard_handle {
+public:
+    using value_type = typename Handle::value_type;
+
+    shard_handle() = default;
+
+    shard_handle(Handle handle, std::shared_ptr<shard_load> load) noexcept
+    : handle_(std::move(handle)), load_(std::move(load)) {}
+
+    shard_handle(const shard_handle&) = delete;
+    shard_handle(shard_handle&&) = default;
+    shard_handle& operator = (const shard_handle&) = delete;
+
+    shard_handle& operator = (shard_handle&& other) noexcept {
+        release(!handle_.empty());
+        handle_ = std::move(other.handle_);
+        load_ = std::move(other.load_);
+        return *this;
+    }
+
+    ~shard_handle() { release(!handle_.empty());}
+
+    bool empty() const { return handle_.empty();}
+
+    value_type& operator * () { return *handle_;}
+    const value_type& operator * () const { return *handle_;}
+    value_type* operator -> () { return std::addressof(*handle_);}
+    const value_type* operator -> () const { return std::addressof(*handle_);}
+
+    void reset(value_type&& v) { handle_.reset(std::move(v));}
+
+    void waste() {
+        release(false);
+        handle_.waste();
+    }
+
+    void recycle() {
+        release(!handle_.empty());
+        handle_.recycle();
+    }
+
+private:
+    void release(bool reusable) noexcept {
+        if (load_) {
+            load_->release(reusable);
+            load_.reset();
+        }
+    }
+
+    Handle handle_;
+    std::shared_ptr<shard_load> load_;
+};
+
+/**
+ * @brief Connection pool split into independent shards
+ *
+ * Each `io_context` is bound to its own shard on the first request, so threads
+ * running different `io_context` objects acquire and release connections via
+ * different pools and do not contend on a single pool lock. The shard for a request
+ * is selected without locks by the shards load:
+ * * the own shard if it has an idle connection;
+ * * otherwise the idle connection is stolen from the next shard which has one;
+ * * otherwise a new connection is opened in the own shard if it has room for it,
+ *   or in the next shard which has room, so shards which are not bound to any
+ *   `io_context` are used too;
+ * * otherwise the request waits in the queue of the own shard.
+ *
+ * The connection returns to the shard it belongs to after usage. If there are more
+ * `io_context` objects than shards the rest of them are spread over the shards by hash.
+ *
+ * Pool capacity and queue capacity are split between the shards exactly, so the total
+ * numbers do not exceed them. With a single shard the pool works as the underlying one.
+ *
+ * Only the shard selection is lock free, getting and returning a connection still takes
+ * the lock of the selected shard, so the threads contend only if they use the same shard.
+ *
+ * @tparam Impl --- underlying pool type of a shard.
+ */
+template <typename Impl>
+class sharded_connection_pool {
+public:
+    template <typename Duration>
+    sharded_connection_pool(std::size_t shards, std::size_t capacity, std::size_t queue_capacity,
+            Duration idle_timeout, Duration lifespan) {
+        // Each shard should be able to hold at least one connection
+        const auto count = std::clamp<std::size_t>(shards, 1, std::max<std::size_t>(capacity, 1));
+        shards_.reserve(count);
+        capacities_.reserve(count);
+        loads_.reserve(count);
+        owners_ = std::make_unique<std::atomic<const void*>[]>(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto shard_capacity = split_evenly(capacity, count, i);
+            const auto shard_queue_capacity = split_evenly(queue_capacity, count, i);
+            shards_.emplace_back(std::make_unique<Impl>(shard_capacity, shard_queue_capacity, idle_timeout, lifespan));
+            capacities_.push_back(shard_capacity);
+            loads_.push_back(std::make_shared<shard_load>());
+            owners_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Gets connection handle for the `io_context` from its shard or from another one.
+     * The handler is called with `shard_handle` of the underlying pool handle.
+     */
+    template <typename IoContext, typename Handler, typename Duration>
+    void get_auto_recycle(IoContext& io, Handler&& handler, Duration wait_duration) {
+        get_shard_auto_recycle(select_shard(shard_index(io)), io, std::forward<Handler>(handler), wait_duration);
+    }
+
+    /**
+     * Gets connection handle from the given shard.
+     */
+    template <typename IoContext, typename Handler, typename Duration>
+    void get_shard_auto_recycle(std::size_t i, IoContext& io, Handler&& handler, Duration wait_duration) {
+        shards_[i]->get_auto_recycle(io,
+            handler_wrapper<std::decay_t<Handler>>{loads_[i], std::forward<Handler>(handler)},
+            wait_duration);
+    }
+
+    /**
+     * Statistics of the pool summed over all the shards.
+     */
+    auto stats() const {
+        auto retval = shards_.front()->stats();
+        std::for_each(std::next(shards_.begin()), shards_.end(), [&](const auto& shard) {
+            const auto v = shard->stats();
+            retval.size += v.size;
+            retval.available += v.available;
+            retval.used += v.used;
+            retval.queue_size += v.queue_size;
+        });
+        return retval;
+    }
+
+    std::size_t shards_count() const noexcept { return shards_.size();}
+
+    const Impl& shard(std::size_t i) const noexcept { return *shards_[i];}
+
+    Impl& shard(std::size_t i) noexcept { return *shards_[i];}
+
+    std::size_t shard_capacity(std::size_t i) const noexcept { return capacities_[i];}
+
+    const shard_load& load(std::size_t i) const noexcept { return *loads_[i];}
+
+    shard_load& load(std::size_t i) noexcept { return *loads_[i];}
+
+    /**
+     * Index of the shard the `io_context` is bound to. The first shard which
+     * is not bound yet is claimed for an unknown `io_context`.
+     */
+    template <typename IoContext>
+    std::size_t shard_index(const IoContext& io) noexcept {
+        const auto count = shards_.size();
+        if (count == 1) {
+            return 0;
+        }
+        const void* key = std::addressof(io);
+        for (std::size_t i = 0; i < count; ++i) {
+            const void* owner = owners_[i].load(std::memory_order_acquire);
+            if (owner == nullptr && owners_[i].compare_exchange_strong(owner, key, std::memory_order_acq_rel)) {
+                return i;
+            }
+            if (owner == key) {
+                return i;
+            }
+        }
+        return std::hash<const void*>{}(key) % count;
+    }
+
+    /**
+     * Index of the shard to get a connection from for a request of the given shard.
+     */
+    std::size_t select_shard(std::size_t local) const noexcept {
+        const auto count = shards_.size();
+        if (count == 1) {
+            return 0;
+        }
+        if (auto i = find_shard(local, [&](std::size_t i) { return loads_[i]->idle() != 0;})) {
+            return *i;
+        }
+        if (auto i = find_shard(local, [&](std::size_t i) { return loads_[i]->used() < capacities_[i];})) {
+            return *i;
+        }
+        return local;
+    }
+
+private:
+    template <typename Handler>
+    struct handler_wrapper {
+        std::shared_ptr<shard_load> load_;
+        Handler handler_;
+
+        template <typename Handle>
+        void operator() (error_code ec, Handle&& handle) {
+            auto load = std::move(load_);
+            if (!ec) {
+                load->acquire(!handle.empty());
+            } else {
+                load.reset();
+            }
+            handler_(std::move(ec), shard_handle<std::decay_t<Handle>>{std::forward<Handle>(handle), std::move(load)});
+        }
+
+        using executor_type = asio::associated_executor_t<Handler>;
+
+        executor_type get_executor() const noexcept { return asio::get_associated_executor(handler_);}
+
+        using allocator_type = asio::associated_allocator_t<Handler>;
+
+        allocator_type get_allocator() const noexcept { return asio::get_associated_allocator(handler_);}
+    };
+
+    // The first shard starting from the local one which matches the predicate
+    template <typename Predicate>
+    std::optional<std::size_t> find_shard(std::size_t local, Predicate&& predicate) const {
+        const auto count = shards_.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (const auto shard = (local + i) % count; predicate(shard)) {
+                return shard;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::unique_ptr<Impl>> shards_;
+    std::vector<std::size_t> capacities_;
+    std::vector<std::shared_ptr<shard_load>> loads_;
+    std::unique_ptr<std::atomic<const void*>[]> owners_;
+};
+
 } // namespace bozo::detail
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <bozo/asio.h>
+
+#include <memory>
+
+namespace bozo::detail {
+
+/**
+ * Tracks the lifetime of an `io_context`, so objects registered in its
+ * reactor know whether the reactor still exists.
+ */
+class io_context_liveness_service : public asio::io_context::service {
+public:
+    static inline asio::io_context::id id;
+
+    explicit io_context_liveness_service(asio::io_context& io) : asio::io_context::service(io) {}
+
+    std::weak_ptr<void> token() const noexcept { return token_;}
+
+private:
+    void shutdown() override { token_.reset();}
+
+    std::shared_ptr<void> token_ = std::make_shared<char>();
+};
+
+/**
+ * @brief Socket of a connection registered in the reactor of an `io_context`
+ *
+ * The socket lives as long as the underlying connection, so a pooled connection
+ * is registered in the reactor once instead of on each checkout from the pool.
+ * The registration is changed only if the connection is used with another
+ * `io_context` or its file descriptor has been changed.
+ *
+ * The file descriptor is owned by `libpq`, so it is released rather than closed.
+ * If the `io_context` has been destroyed before the socket, the stale registration
+ * is dropped without touching the reactor.
+ */
+class connection_socket {
+public:
+    using stream_type = asio::posix::stream_descriptor;
+
+    connection_socket() = default;
+    connection_socket(const connection_socket&) = delete;
+    connection_socket& operator= (const connection_socket&) = delete;
+
+    connection_socket(connection_socket&& other) noexcept
+    : stream_(std::move(other.stream_)), io_(other.io_), io_alive_(std::move(other.io_alive_)) {
+        other.io_ = nullptr;
+    }
+
+    connection_socket& operator= (connection_socket&& other) noexcept {
+        if (this != &other) {
+            release();
+            stream_ = std::move(other.stream_);
+            io_ = other.io_;
+            io_alive_ = std::move(other.io_alive_);
+            other.io_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~connection_socket() { release();}
+
+    /**
+     * Gets the socket for the file descriptor registered in the `io_context` reactor.
+     * The registration is reused if it has been made for the same `io_context` and
+     * file descriptor.
+     */
+    stream_type& bind(asio::io_context& io, int fd) {
+        if (!stream_ || io_ != &io || stream_->native_handle() != fd) {
+            release();
+            stream_ = std::make_unique<stream_type>(io);
+            if (fd != -1) {
+                stream_->assign(fd);
+            }
+            io_ = &io;
+            io_alive_ = asio::use_service<io_context_liveness_service>(io).token();
+        }
+        return *stream_;
+    }
+
+    /**
+     * Removes the file descriptor from the reactor without closing it.
+     */
+    void release() noexcept {
+        if (!stream_) {
+            return;
+        }
+        if (io_alive_.expired()) {
+            // The reactor is gone along with the registration data, so the stream
+            // object must not be touched anymore.
+            static_cast<void>(stream_.release());
+        } else {
+            stream_->release();
+            stream_.reset();
+        }
+        io_ = nullptr;
+    }
+
+    bool is_bound() const noexcept { return stream_ != nullptr;}
+
+    const asio::io_context* context() const noexcept { return io_;}
+
+private:
+    std::unique_ptr<stream_type> stream_;
+    asio::io_context* io_ = nullptr;
+    std::weak_ptr<void> io_alive_;
+};
+
+} // namespace bozo::detail
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <boost/asio/ip/address.hpp>
+
+#include <libpq-fe.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace bozo::detail {
+
+struct conninfo_options_deleter {
+    void operator() (PQconninfoOption* options) const noexcept { PQconninfoFree(options);}
+};
+
+using conninfo_options = std::unique_ptr<PQconninfoOption, conninfo_options_deleter>;
+
+/**
+ * Parses key-value or URI connection string, returns null for invalid one.
+ */
+inline conninfo_options parse_conninfo(const std::string& conninfo) {
+    char* error = nullptr;
+    conninfo_options retval(PQconninfoParse(conninfo.c_str(), &error));
+    if (error) {
+        PQfreemem(error);
+    }
+    return retval;
+}
+
+inline const char* get_conninfo_option(const conninfo_options& options, std::string_view keyword) noexcept {
+    for (auto option = options.get(); option->keyword; ++option) {
+        if (keyword == option->keyword) {
+            return option->val;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Host name of the connection string which libpq would resolve via `getaddrinfo()`,
+ * i.e. a single host without `hostaddr` which is neither a numeric address nor a
+ * Unix-domain socket directory.
+ */
+inline std::optional<std::string> resolvable_host(const std::string& conninfo) {
+    const auto options = parse_conninfo(conninfo);
+    if (!options) {
+        return std::nullopt;
+    }
+    const auto hostaddr = get_conninfo_option(options, "hostaddr");
+    if (hostaddr && *hostaddr) {
+        return std::nullopt;
+    }
+    const auto host = get_conninfo_option(options, "host");
+    if (!host || !*host || *host == '/' || *host == '@' || std::string_view(host).find(',') != std::string_view::npos) {
+        return std::nullopt;
+    }
+    boost::system::error_code ec;
+    boost::asio::ip::make_address(host, ec);
+    if (!ec) {
+        return std::nullopt;
+    }
+    return std::string(host);
+}
+
+inline void append_conninfo_option(std::string& out, std::string_view keyword, std::string_view value) {
+    if (!out.empty()) {
+        out += ' ';
+    }
+    out.append(keyword);
+    out += "='";
+    for (const char c : value) {
+        if (c == '\'' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '\'';
+}
+
+/**
+ * Key-value connection string with the same parameters as the given one
+ * and with the `hostaddr` parameter set to the address.
+ */
+inline std::string with_hostaddr(const std::string& conninfo, std::string_view hostaddr) {
+    const auto options = parse_conninfo(conninfo);
+    if (!options) {
+        return conninfo;
+    }
+    std::string retval;
+    for (auto option = options.get(); option->keyword; ++option) {
+        if (option->val && *option->val && std::string_view(option->keyword) != "hostaddr") {
+            append_conninfo_option(retval, option->keyword, option->val);
+        }
+    }
+    append_conninfo_option(retval, "hostaddr", hostaddr);
+    return retval;
+}
+
+} // namespace bozo::detail
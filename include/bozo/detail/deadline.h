@@ -4,6 +4,7 @@
 #include <bozo/error.h>
 #include <bozo/deadline.h>
 #include <bozo/detail/bind.h>
+#include <bozo/detail/recycling_allocator.h>
 
 #include <boost/asio/dispatch.hpp>
 
@@ -15,7 +16,7 @@ public:
     template <typename TimeConstraint>
     io_deadline_handler (Stream& stream, const TimeConstraint& t, Handler handler)
     : timer_(bozo::detail::get_operation_timer(stream.get_executor(), t)) {
-        auto allocator = asio::get_associated_allocator(handler);
+        auto allocator = get_recycling_allocator(asio::get_associated_allocator(handler));
         ctx_ = std::allocate_shared<context>(allocator, stream, std::move(handler));
         timer_.async_wait(timer_handler{ctx_});
     }
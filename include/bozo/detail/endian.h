@@ -3,6 +3,7 @@
 #include <bozo/core/concept.h>
 
 #include <limits.h>
+#include <limits>
 
 namespace bozo::detail {
 
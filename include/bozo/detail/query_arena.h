@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace bozo::detail {
+
+/**
+ * @brief Monotonic memory arena for binary queries of a connection
+ *
+ * Allocates memory by bumping an offset within a single block. Deallocation
+ * only decrements the count of the live allocations, the block is rewound
+ * once all of them are released, i.e. when the queries made via the arena have been
+ * sent and destroyed. Allocations which do not fit the block are served from the
+ * heap and make the block grow up to `max_block_size` on the next rewind,
+ * so a connection with a steady load works without heap allocations for queries.
+ *
+ * Allocations should be made by one thread at a time (the one which performs an
+ * operation on the connection), while deallocations may be made by any thread.
+ */
+class query_arena {
+public:
+    static constexpr std::size_t max_block_size = 64 * 1024;
+
+    query_arena() = default;
+    query_arena(const query_arena&) = delete;
+    query_arena& operator= (const query_arena&) = delete;
+
+    ~query_arena() { ::operator delete(block_);}
+
+    void* allocate(std::size_t size, std::size_t align) {
+        if (align > alignof(std::max_align_t)) {
+            return ::operator new(size, std::align_val_t(align));
+        }
+        if (live_.load(std::memory_order_acquire) == 0) {
+            rewind();
+        }
+        const auto offset = (offset_ + align - 1) / align * align;
+        void* retval = nullptr;
+        if (offset + size > capacity_) {
+            required_ = std::max(required_, offset + size);
+            retval = ::operator new(size);
+        } else {
+            offset_ = offset + size;
+            retval = block_ + offset;
+        }
+        // Heap allocations are counted too, so the block is never
+        // reallocated while some deallocation may inspect it.
+        live_.fetch_add(1, std::memory_order_relaxed);
+        return retval;
+    }
+
+    void deallocate(void* p, std::size_t, std::size_t align) noexcept {
+        if (align > alignof(std::max_align_t)) {
+            return ::operator delete(p, std::align_val_t(align));
+        }
+        if (!owns(p)) {
+            ::operator delete(p);
+        }
+        live_.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::size_t capacity() const noexcept { return capacity_;}
+
+    bool owns(const void* p) const noexcept {
+        const auto c = static_cast<const char*>(p);
+        return c >= block_ && c < block_ + capacity_;
+    }
+
+private:
+    void rewind() {
+        offset_ = 0;
+        if (required_ > capacity_ && capacity_ < max_block_size) {
+            const auto capacity = std::min(max_block_size, std::max(required_, 2 * capacity_));
+            auto block = static_cast<char*>(::operator new(capacity));
+            ::operator delete(block_);
+            block_ = block;
+            capacity_ = capacity;
+        }
+        required_ = 0;
+    }
+
+    char* block_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t required_ = 0;
+    std::atomic<std::size_t> live_{0};
+};
+
+/**
+ * @brief Allocator which draws memory from the `query_arena`
+ *
+ * The allocator shares the ownership of the arena, so memory allocated via it
+ * may outlive the connection the arena belongs to.
+ */
+template <typename T>
+class query_arena_allocator {
+public:
+    using value_type = T;
+
+    query_arena_allocator(std::shared_ptr<query_arena> arena) noexcept
+    : arena_(std::move(arena)) {}
+
+    template <typename U>
+    query_arena_allocator(const query_arena_allocator<U>& other) noexcept
+    : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        arena_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    const std::shared_ptr<query_arena>& arena() const noexcept { return arena_;}
+
+    template <typename U>
+    friend bool operator== (const query_arena_allocator& lhs, const query_arena_allocator<U>& rhs) noexcept {
+        return lhs.arena() == rhs.arena();
+    }
+
+    template <typename U>
+    friend bool operator!= (const query_arena_allocator& lhs, const query_arena_allocator<U>& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+private:
+    std::shared_ptr<query_arena> arena_;
+};
+
+template <typename T, typename = std::void_t<>>
+struct has_query_arena : std::false_type {};
+
+template <typename T>
+struct has_query_arena<T, std::void_t<
+    decltype(std::declval<T&>().query_arena())
+>> : std::true_type {};
+
+/**
+ * Indicates if the connection type provides a memory arena for queries.
+ */
+template <typename T>
+constexpr auto HasQueryArena = has_query_arena<std::decay_t<T>>::value;
+
+template <typename T>
+struct is_std_allocator : std::false_type {};
+
+template <typename T>
+struct is_std_allocator<std::allocator<T>> : std::true_type {};
+
+/**
+ * Returns allocator for a binary query to be sent via the connection. The connection
+ * arena is used unless the operation handler has its own associated allocator.
+ */
+template <typename Connection, typename Allocator>
+inline auto get_query_allocator([[maybe_unused]] Connection& conn, const Allocator& alloc) {
+    if constexpr (HasQueryArena<Connection> && is_std_allocator<Allocator>::value) {
+        return query_arena_allocator<char>{conn.query_arena()};
+    } else {
+        return alloc;
+    }
+}
+
+} // namespace bozo::detail
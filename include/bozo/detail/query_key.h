@@ -0,0 +1,51 @@
+#pragma once
+
+#include <bozo/io/binary_query.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace bozo::detail {
+
+inline void append_query_key_int(std::string& key, std::int64_t v) {
+    key.append(reinterpret_cast<const char*>(std::addressof(v)), sizeof(v));
+}
+
+/**
+ * Byte string which identifies the query: the text, the types and the binary
+ * representations of the parameters. Queries with equal keys are the same
+ * for a database.
+ */
+inline std::string make_query_key(const binary_query& query) {
+    const auto count = query.params_count();
+    std::string key;
+    std::size_t size = std::strlen(query.text()) + 1 + sizeof(std::int64_t);
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+        size += 2 * sizeof(std::int64_t) + std::size_t(std::max(0, query.lengths()[i]));
+    }
+    key.reserve(size);
+    key.append(query.text());
+    key.push_back('\0');
+    append_query_key_int(key, count);
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+        append_query_key_int(key, query.types()[i]);
+        if (query.values()[i] == nullptr) {
+            append_query_key_int(key, -1);
+            continue;
+        }
+        append_query_key_int(key, query.lengths()[i]);
+        key.append(query.values()[i], std::size_t(query.lengths()[i]));
+    }
+    return key;
+}
+
+/**
+ * Key of the query serialized with the given `OidMap`.
+ */
+template <typename BinaryQueryConvertible, typename OidMap>
+inline std::string make_query_key(const BinaryQueryConvertible& query, const OidMap& oid_map) {
+    return make_query_key(to_binary_query(query, oid_map));
+}
+
+} // namespace bozo::detail
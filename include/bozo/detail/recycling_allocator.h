@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace bozo::detail {
+
+/**
+ * @brief Allocator which reuses memory of the deallocated objects
+ *
+ * Single object blocks are kept in a small per-thread cache after deallocation
+ * and are handed out again on the next allocation of the same type, so objects
+ * which are created and destroyed at high rate, like pooled connection wrappers,
+ * do not hit the heap in a steady state. A block may be deallocated by a thread
+ * other than the one which has allocated it. Blocks deallocated by a thread after
+ * its cache has been destroyed, e.g. by destructors of other thread local objects,
+ * are returned to the heap directly.
+ */
+template <typename T>
+class recycling_allocator {
+public:
+    using value_type = T;
+
+    static constexpr std::size_t cache_capacity = 16;
+
+    recycling_allocator() = default;
+
+    template <typename U>
+    recycling_allocator(const recycling_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        const auto c = cache();
+        if (n == 1 && c && c->size) {
+            return static_cast<T*>(c->blocks[--c->size]);
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        const auto c = cache();
+        if (n == 1 && c && c->size < cache_capacity) {
+            c->blocks[c->size++] = p;
+            return;
+        }
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    /**
+     * Number of the blocks cached by the current thread.
+     */
+    static std::size_t cached() noexcept {
+        const auto c = cache();
+        return c ? c->size : 0;
+    }
+
+    template <typename U>
+    friend constexpr bool operator == (const recycling_allocator&, const recycling_allocator<U>&) noexcept {
+        return true;
+    }
+
+    template <typename U>
+    friend constexpr bool operator != (const recycling_allocator&, const recycling_allocator<U>&) noexcept {
+        return false;
+    }
+
+private:
+    struct blocks_cache {
+        std::array<void*, cache_capacity> blocks;
+        std::size_t size = 0;
+
+        ~blocks_cache() {
+            cache_destroyed() = true;
+            for (std::size_t i = 0; i < size; ++i) {
+                std::allocator<T>{}.deallocate(static_cast<T*>(blocks[i]), 1);
+            }
+        }
+    };
+
+    // The flag is trivially destructible, so it is still valid when the cache
+    // of the thread has been destroyed already
+    static bool& cache_destroyed() noexcept {
+        thread_local bool instance = false;
+        return instance;
+    }
+
+    static blocks_cache* cache() noexcept {
+        if (cache_destroyed()) {
+            return nullptr;
+        }
+        thread_local blocks_cache instance;
+        return std::addressof(instance);
+    }
+};
+
+/**
+ * Allocator for the objects created per operation. The default allocator
+ * is replaced with the recycling one, a custom allocator is used as is.
+ */
+template <typename Allocator>
+constexpr auto get_recycling_allocator(const Allocator& alloc) noexcept {
+    return alloc;
+}
+
+template <typename T>
+constexpr auto get_recycling_allocator(const std::allocator<T>&) noexcept {
+    return recycling_allocator<T>{};
+}
+
+} // namespace bozo::detail
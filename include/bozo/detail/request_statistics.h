@@ -0,0 +1,222 @@
+#pragma once
+
+#include <bozo/connection.h>
+#include <bozo/statistics.h>
+#include <bozo/impl/result.h>
+#include <bozo/io/binary_query.h>
+
+#include <optional>
+#include <string>
+
+namespace bozo::detail {
+
+template <typename T, typename = std::void_t<>>
+struct collects_statistics : std::false_type {};
+
+template <typename T>
+struct collects_statistics<T, std::void_t<
+    decltype(std::declval<T&>().statistics())
+>> : std::bool_constant<QueryStatistics<decltype(std::declval<T&>().statistics())>> {};
+
+/**
+ * Indicates if the connection collects the query statistics.
+ */
+template <typename Connection>
+constexpr auto CollectsStatistics = collects_statistics<std::decay_t<Connection>>::value;
+
+template <typename T, typename = std::void_t<>>
+struct connection_statistics {
+    using type = none_t;
+};
+
+template <typename T>
+struct connection_statistics<T, std::void_t<decltype(std::declval<T&>().statistics())>> {
+    using type = std::decay_t<decltype(std::declval<T&>().statistics())>;
+};
+
+/**
+ * Statistics type of the connection or `bozo::none_t` if it has none.
+ */
+template <typename Connection>
+using connection_statistics_t = typename connection_statistics<std::decay_t<Connection>>::type;
+
+/**
+ * Measurements of a request which are made only if the connection collects statistics,
+ * otherwise the object is empty and does nothing.
+ */
+template <bool Enabled>
+struct request_statistics {
+    void set_query(const binary_query&) noexcept {}
+    void mark_sent() noexcept {}
+    void mark_first_byte() noexcept {}
+    void mark_received() noexcept {}
+    template <typename Result>
+    void add_result(const Result&) noexcept {}
+    void add_rows(std::size_t, std::size_t) noexcept {}
+    void add_sent(std::size_t) noexcept {}
+    void mark_sent(const request_statistics&) noexcept {}
+    template <typename F>
+    decltype(auto) decode(F&& f) { return f();}
+    template <typename Connection>
+    void update(Connection&, bool) noexcept {}
+};
+
+template <>
+struct request_statistics<true> {
+    using time_point = time_traits::time_point;
+
+    std::optional<binary_query> query_;
+    time_point started_ = time_traits::now();
+    time_point sent_;
+    time_point first_byte_;
+    time_point received_;
+    time_traits::duration decode_{};
+    time_traits::duration decode_before_received_{};
+    std::size_t rows_ = 0;
+    std::size_t bytes_received_ = 0;
+    std::size_t data_sent_ = 0;
+
+    // Queries without statistics, e.g. statements preparation, do not set the query
+    void set_query(const binary_query& query) noexcept {
+        query_ = query;
+    }
+
+    void mark_sent() noexcept {
+        if (sent_ == time_point{}) {
+            sent_ = time_traits::now();
+        }
+    }
+
+    // The query is sent by another request, e.g. by the one of a pipeline
+    void mark_sent(const request_statistics& other) noexcept {
+        if (sent_ == time_point{}) {
+            sent_ = other.sent_ == time_point{} ? time_traits::now() : other.sent_;
+        }
+    }
+
+    void mark_first_byte() noexcept {
+        if (first_byte_ == time_point{}) {
+            first_byte_ = time_traits::now();
+        }
+    }
+
+    void mark_received() noexcept {
+        mark_first_byte();
+        if (received_ == time_point{}) {
+            received_ = time_traits::now();
+        }
+    }
+
+    template <typename Result>
+    void add_result(const Result& res) noexcept {
+        const int rows = impl::ntuples(res);
+        const int columns = impl::nfields(res);
+        rows_ += static_cast<std::size_t>(rows);
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                bytes_received_ += impl::get_length(res, row, column);
+            }
+        }
+    }
+
+    // Rows received without a result object or sent, e.g. via COPY, and their payload size
+    void add_rows(std::size_t rows, std::size_t bytes) noexcept {
+        rows_ += rows;
+        bytes_received_ += bytes;
+    }
+
+    // Payload sent after the query, e.g. COPY data
+    void add_sent(std::size_t bytes) noexcept {
+        data_sent_ += bytes;
+    }
+
+    template <typename F>
+    decltype(auto) decode(F&& f) {
+        struct guard {
+            request_statistics& self;
+            time_point start = time_traits::now();
+            ~guard() {
+                const auto elapsed = time_traits::now() - start;
+                self.decode_ += elapsed;
+                if (self.received_ == time_point{}) {
+                    self.decode_before_received_ += elapsed;
+                }
+            }
+        } g{*this};
+        return f();
+    }
+
+    query_sample make_sample(bool failed) const noexcept {
+        const auto now = time_traits::now();
+        const auto sent = sent_ == time_point{} ? now : sent_;
+        const auto first_byte = first_byte_ == time_point{} ? now : std::max(first_byte_, sent);
+        const auto received = received_ == time_point{} ? now : std::max(received_, first_byte);
+
+        query_sample retval;
+        retval[query_phase::send] = sent - started_;
+        retval[query_phase::server] = first_byte - sent;
+        retval[query_phase::receive] = std::max(received - first_byte - decode_before_received_, time_traits::duration{});
+        retval[query_phase::decode] = decode_;
+        retval.rows = rows_;
+        retval.bytes_sent = bytes_sent();
+        retval.bytes_received = bytes_received_;
+        retval.failed = failed;
+        return retval;
+    }
+
+    std::size_t bytes_sent() const noexcept {
+        if (!query_) {
+            return 0;
+        }
+        std::size_t retval = std::char_traits<char>::length(query_->text()) + data_sent_;
+        const auto lengths = query_->lengths();
+        for (std::ptrdiff_t i = 0; i < query_->params_count(); ++i) {
+            retval += static_cast<std::size_t>(lengths[i]);
+        }
+        return retval;
+    }
+
+    template <typename Connection>
+    void update(Connection& conn, bool failed) noexcept {
+        if (query_) {
+            conn.update_statistics(std::string_view(query_->text()), make_sample(failed));
+        }
+    }
+};
+
+template <typename Connection>
+using request_statistics_t = request_statistics<CollectsStatistics<Connection>>;
+
+/**
+ * Completion handler of a connect operation which records the connect time
+ * into the connection statistics.
+ */
+template <typename Handler>
+struct connect_statistics_handler {
+    Handler handler_;
+    time_traits::time_point started_ = time_traits::now();
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection&& conn) {
+        if (!is_null_recursive(conn)) {
+            checkout_sample sample;
+            sample.connect = time_traits::now() - started_;
+            unwrap_connection(conn).update_statistics(checkout_key{}, sample);
+        }
+        handler_(std::move(ec), std::forward<Connection>(conn));
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+} // namespace bozo::detail
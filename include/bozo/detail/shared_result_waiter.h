@@ -0,0 +1,53 @@
+#pragma once
+
+#include <bozo/asio.h>
+#include <bozo/error.h>
+#include <bozo/result.h>
+#include <bozo/io/recv.h>
+#include <bozo/detail/bind.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+
+namespace bozo::detail {
+
+/**
+ * Waiter of a result shared between several operations. Receives the result
+ * into its own output and completes its handler with the signature `void(error_code)`.
+ */
+template <typename OidMap>
+struct shared_result_waiter {
+    virtual ~shared_result_waiter() = default;
+
+    virtual void complete(error_code ec, const shared_result& res, const OidMap& oid_map) = 0;
+};
+
+template <typename OidMap, typename Out, typename Handler>
+class shared_result_waiter_impl final : public shared_result_waiter<OidMap> {
+public:
+    shared_result_waiter_impl(Out out, Handler handler, io_context& io)
+    : out_(std::move(out)), handler_(std::move(handler)),
+      work_(asio::get_associated_executor(handler_, io.get_executor())) {}
+
+    void complete(error_code ec, const shared_result& res, const OidMap& oid_map) override {
+        if (!ec && res.valid()) {
+            try {
+                auto in = res;
+                bozo::recv_result(in, oid_map, out_);
+            } catch (const std::exception&) {
+                ec = error::bad_result_process;
+            }
+        }
+        asio::post(work_.get_executor(), detail::bind(std::move(handler_), std::move(ec)));
+        work_.reset();
+    }
+
+private:
+    using executor_type = asio::associated_executor_t<Handler, io_context::executor_type>;
+
+    Out out_;
+    Handler handler_;
+    asio::executor_work_guard<executor_type> work_;
+};
+
+} // namespace bozo::detail
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <bozo/detail/base36.h>
+#include <bozo/io/binary_query.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bozo::detail {
+
+/**
+ * @brief LRU cache of server-side prepared statements of a connection
+ *
+ * Maps a query text and its parameters types to the name of the statement
+ * which has been prepared on the server for this text. Cache with zero
+ * capacity is disabled and contains nothing. Statements evicted from the cache
+ * are kept in a list of names which should be deallocated on the server.
+ */
+class statement_cache {
+public:
+    explicit statement_cache(std::size_t capacity = 0) noexcept : capacity_(capacity) {}
+
+    std::size_t capacity() const noexcept { return capacity_;}
+
+    bool enabled() const noexcept { return capacity_ != 0;}
+
+    std::size_t size() const noexcept { return entries_.size();}
+
+    bool empty() const noexcept { return entries_.empty();}
+
+    /**
+     * Set the maximum number of statements to be cached. Extra least
+     * recently used statements are evicted.
+     */
+    void set_capacity(std::size_t capacity) {
+        capacity_ = capacity;
+        while (entries_.size() > capacity_) {
+            evict();
+        }
+    }
+
+    /**
+     * Find the name of the statement prepared for the query and mark it
+     * as the most recently used one.
+     *
+     * @return pointer to the statement name or nullptr if not found.
+     */
+    const std::string* find(const binary_query& query) noexcept {
+        const auto hash = hash_of(query);
+        const auto range = index_.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (equal(*i->second, query)) {
+                entries_.splice(entries_.begin(), entries_, i->second);
+                return std::addressof(i->second->name);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Generate a name for a new statement which is unique within the cache.
+     */
+    std::string make_name() {
+        return "bozo_" + ltob36(static_cast<long>(++counter_));
+    }
+
+    /**
+     * Remember the statement prepared for the query as the most recently
+     * used one. Evicts the least recently used statement if the cache is full.
+     */
+    void insert(const binary_query& query, std::string name) {
+        if (!enabled()) {
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            evict();
+        }
+        const auto hash = hash_of(query);
+        entries_.push_front(entry{
+            hash,
+            query.text(),
+            std::vector<Oid>(query.types(), query.types() + query.params_count()),
+            std::move(name)
+        });
+        index_.emplace(hash, entries_.begin());
+    }
+
+    /**
+     * Forget all the statements. Should be used when statements are not
+     * known by the server anymore, e.g. after the connection reset.
+     */
+    void clear() noexcept {
+        index_.clear();
+        entries_.clear();
+        evicted_.clear();
+    }
+
+    /**
+     * Names of evicted statements which should be deallocated on the server.
+     */
+    const std::vector<std::string>& evicted() const noexcept { return evicted_;}
+
+    /**
+     * Take the name of the last evicted statement to deallocate it on the server.
+     */
+    std::string pop_evicted() {
+        std::string retval = std::move(evicted_.back());
+        evicted_.pop_back();
+        return retval;
+    }
+
+private:
+    struct entry {
+        std::size_t hash;
+        std::string text;
+        std::vector<Oid> types;
+        std::string name;
+    };
+
+    using entries_type = std::list<entry>;
+
+    static std::size_t hash_of(const binary_query& query) noexcept {
+        std::size_t seed = std::hash<std::string_view>{}(query.text());
+        boost::hash_range(seed, query.types(), query.types() + query.params_count());
+        return seed;
+    }
+
+    static bool equal(const entry& e, const binary_query& query) noexcept {
+        return e.text == query.text()
+            && std::equal(e.types.begin(), e.types.end(),
+                query.types(), query.types() + query.params_count());
+    }
+
+    void evict() {
+        auto& victim = entries_.back();
+        const auto range = index_.equal_range(victim.hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (std::addressof(*i->second) == std::addressof(victim)) {
+                index_.erase(i);
+                break;
+            }
+        }
+        evicted_.push_back(std::move(victim.name));
+        entries_.pop_back();
+    }
+
+    std::size_t capacity_ = 0;
+    std::size_t counter_ = 0;
+    entries_type entries_;
+    std::unordered_multimap<std::size_t, entries_type::iterator> index_;
+    std::vector<std::string> evicted_;
+};
+
+template <typename T, typename = std::void_t<>>
+struct has_statement_cache : std::false_type {};
+
+template <typename T>
+struct has_statement_cache<T, std::void_t<
+    decltype(std::declval<T&>().statement_cache())
+>> : std::true_type {};
+
+/**
+ * Indicates if the connection type provides a prepared statements cache.
+ */
+template <typename T>
+constexpr auto HasStatementCache = has_statement_cache<std::decay_t<T>>::value;
+
+template <typename Connection>
+inline void set_statement_cache_capacity([[maybe_unused]] Connection& conn,
+        [[maybe_unused]] std::size_t capacity) {
+    if constexpr (HasStatementCache<Connection>) {
+        conn.statement_cache().set_capacity(capacity);
+    }
+}
+
+} // namespace bozo::detail
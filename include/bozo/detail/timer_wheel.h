@@ -0,0 +1,222 @@
+#pragma once
+
+#include <bozo/time_traits.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace bozo::detail {
+
+/**
+ * Intrusive node of the `bozo::detail::timer_wheel`.
+ */
+struct timer_wheel_entry {
+    timer_wheel_entry* prev = nullptr;
+    timer_wheel_entry* next = nullptr;
+    std::uint64_t tick = 0;
+
+    bool linked() const noexcept { return next != nullptr;}
+};
+
+/**
+ * @brief Hierarchical timer wheel
+ *
+ * Deadlines are rounded up to the wheel granularity, so a timer never expires
+ * earlier than it is asked to. The timers due within 256 ticks are kept in the
+ * slots of the first level, those due within 256 * 256 ticks are kept in the slots
+ * of the second level and are moved to the first level when their slot comes,
+ * the rest are kept in the overflow list which is redistributed once per full turn
+ * of the second level. So insertion and removal of a timer take constant time.
+ *
+ * The wheel is not thread safe and does not own the entries.
+ */
+class timer_wheel {
+public:
+    using duration = time_traits::duration;
+    using time_point = time_traits::time_point;
+    using entry = timer_wheel_entry;
+
+    static constexpr std::size_t slots_count = 256;
+    static constexpr unsigned slot_bits = 8;
+
+    timer_wheel(duration granularity, time_point start)
+    : granularity_(granularity.count() > 0 ? granularity : duration(1)), start_(start) {
+        for (auto& v : level0_) init(v);
+        for (auto& v : level1_) init(v);
+        init(overflow_);
+    }
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator = (const timer_wheel&) = delete;
+
+    duration granularity() const noexcept { return granularity_;}
+
+    /**
+     * Number of the timers in the wheel.
+     */
+    std::size_t size() const noexcept { return size_;}
+
+    /**
+     * Tick which the wheel has processed up to.
+     */
+    std::uint64_t current() const noexcept { return current_;}
+
+    /**
+     * Inserts the entry to be expired at the given time. Returns false if the
+     * entry is expired already, then it is not inserted.
+     */
+    bool insert(entry& e, time_point expiry) noexcept {
+        e.tick = expiry_tick(expiry);
+        if (e.tick <= current_) {
+            return false;
+        }
+        place(e);
+        ++size_;
+        return true;
+    }
+
+    /**
+     * Removes the entry which has been inserted and is not expired yet.
+     */
+    void remove(entry& e) noexcept {
+        unlink(e);
+        --size_;
+    }
+
+    /**
+     * Moves the wheel to the given time and passes each expired entry to the
+     * handler. The entry is removed from the wheel before the call.
+     */
+    template <typename Handler>
+    void advance(time_point now, Handler&& expired) {
+        const auto target = tick(now);
+        while (current_ < target) {
+            if (size_ == 0) {
+                current_ = target;
+                break;
+            }
+            ++current_;
+            if ((current_ & mask(2 * slot_bits)) == 0) {
+                cascade(overflow_);
+            }
+            if ((current_ & mask(slot_bits)) == 0) {
+                cascade(level1_[(current_ >> slot_bits) & mask(slot_bits)]);
+            }
+            auto& slot = level0_[current_ & mask(slot_bits)];
+            while (slot.next != &slot) {
+                auto& e = *slot.next;
+                remove(e);
+                expired(e);
+            }
+        }
+    }
+
+    /**
+     * Time when the wheel should be advanced next or nothing if it is empty.
+     */
+    std::optional<time_point> next_expiry() const noexcept {
+        if (size_ == 0) {
+            return std::nullopt;
+        }
+        const auto boundary = ((current_ >> slot_bits) + 1) << slot_bits;
+        for (auto t = current_ + 1; t < boundary; ++t) {
+            const auto& slot = level0_[t & mask(slot_bits)];
+            if (slot.next != &slot) {
+                return time_at(t);
+            }
+        }
+        return time_at(boundary);
+    }
+
+    /**
+     * Removes all the entries from the wheel and passes each of them to the handler.
+     */
+    template <typename Handler>
+    void clear(Handler&& handler) {
+        const auto drain = [&] (entry& head) {
+            while (head.next != &head) {
+                auto& e = *head.next;
+                remove(e);
+                handler(e);
+            }
+        };
+        for (auto& v : level0_) drain(v);
+        for (auto& v : level1_) drain(v);
+        drain(overflow_);
+    }
+
+    time_point time_at(std::uint64_t t) const noexcept {
+        return start_ + granularity_ * static_cast<duration::rep>(t);
+    }
+
+    std::uint64_t tick(time_point t) const noexcept {
+        return t <= start_ ? 0 : static_cast<std::uint64_t>((t - start_) / granularity_);
+    }
+
+    std::uint64_t expiry_tick(time_point t) const noexcept {
+        if (t <= start_) {
+            return 0;
+        }
+        const auto elapsed = t - start_;
+        const auto retval = static_cast<std::uint64_t>(elapsed / granularity_);
+        return elapsed % granularity_ == duration::zero() ? retval : retval + 1;
+    }
+
+private:
+    static constexpr std::uint64_t mask(unsigned bits) noexcept {
+        return (std::uint64_t(1) << bits) - 1;
+    }
+
+    static void init(entry& head) noexcept {
+        head.prev = head.next = &head;
+    }
+
+    static void link(entry& head, entry& e) noexcept {
+        e.prev = head.prev;
+        e.next = &head;
+        head.prev->next = &e;
+        head.prev = &e;
+    }
+
+    static void unlink(entry& e) noexcept {
+        e.prev->next = e.next;
+        e.next->prev = e.prev;
+        e.prev = e.next = nullptr;
+    }
+
+    void place(entry& e) noexcept {
+        if (e.tick - current_ < slots_count) {
+            link(level0_[e.tick & mask(slot_bits)], e);
+        } else if ((e.tick >> slot_bits) - (current_ >> slot_bits) < slots_count) {
+            link(level1_[(e.tick >> slot_bits) & mask(slot_bits)], e);
+        } else {
+            link(overflow_, e);
+        }
+    }
+
+    void cascade(entry& head) noexcept {
+        entry pending;
+        init(pending);
+        while (head.next != &head) {
+            auto& e = *head.next;
+            unlink(e);
+            link(pending, e);
+        }
+        while (pending.next != &pending) {
+            auto& e = *pending.next;
+            unlink(e);
+            place(e);
+        }
+    }
+
+    duration granularity_;
+    time_point start_;
+    std::uint64_t current_ = 0;
+    std::size_t size_ = 0;
+    std::array<entry, slots_count> level0_;
+    std::array<entry, slots_count> level1_;
+    entry overflow_;
+};
+
+} // namespace bozo::detail
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <bozo/asio.h>
+#include <bozo/detail/bind.h>
 
 #include <boost/asio/dispatch.hpp>
 
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <bozo/time_traits.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bozo {
+
+/**
+ * @brief Process-wide cache of the database host addresses
+ *
+ * libpq resolves the `host` of a connection string via blocking `getaddrinfo()` inside
+ * `PQconnectStart()`, so a slow DNS answer stalls the thread which runs the `io_context`
+ * and every operation on it. With the cache enabled `bozo::connection_info` resolves
+ * the host name asynchronously via `asio::ip::tcp::resolver` and connects to the resolved
+ * address via the `hostaddr` connection parameter, so libpq does not resolve it again. The
+ * `host` parameter is kept as is for the server certificate verification and the password file.
+ *
+ * Resolved addresses are cached for the time to live since `getaddrinfo()` does not
+ * provide TTL of the DNS records. If the name is resolved to several addresses connection
+ * attempts are raced in the happy eyeballs manner: the next address is tried if the
+ * previous attempt has failed or has not completed within the attempt delay, the first
+ * established connection is used and the other attempts are cancelled.
+ *
+ * Connection strings with `hostaddr`, with several hosts, with a Unix-domain socket
+ * directory or with a numeric address as the `host` are used as is.
+ *
+ * The cache is disabled by default.
+ *
+ * ### Example
+ *
+@code{cpp}
+bozo::dns_cache::global().enable(std::chrono::seconds(30));
+@endcode
+ *
+ * @thread_safety{Safe,Safe}
+ * @ingroup group-connection-types
+ */
+class dns_cache {
+public:
+    using addresses_type = std::vector<std::string>;
+
+    /**
+     * Cache shared by all the connection sources of the process.
+     */
+    static dns_cache& global() {
+        static dns_cache instance;
+        return instance;
+    }
+
+    /**
+     * Enables the cache.
+     *
+     * @param ttl --- time to live of the resolved addresses.
+     * @param attempt_delay --- time to wait for a connection attempt to an address
+     * before the next address is tried.
+     */
+    void enable(time_traits::duration ttl = std::chrono::seconds(30),
+            time_traits::duration attempt_delay = std::chrono::milliseconds(250)) {
+        const std::lock_guard lock(mutex_);
+        ttl_ = ttl;
+        attempt_delay_ = attempt_delay;
+        enabled_ = true;
+    }
+
+    /**
+     * Disables the cache and drops all the cached addresses.
+     */
+    void disable() {
+        const std::lock_guard lock(mutex_);
+        enabled_ = false;
+        entries_.clear();
+    }
+
+    bool enabled() const {
+        const std::lock_guard lock(mutex_);
+        return enabled_;
+    }
+
+    time_traits::duration attempt_delay() const {
+        const std::lock_guard lock(mutex_);
+        return attempt_delay_;
+    }
+
+    /**
+     * Drops all the cached addresses.
+     */
+    void invalidate() {
+        const std::lock_guard lock(mutex_);
+        entries_.clear();
+    }
+
+    /**
+     * Drops cached addresses of the host.
+     */
+    void invalidate(std::string_view host) {
+        const std::lock_guard lock(mutex_);
+        if (const auto i = entries_.find(host); i != entries_.end()) {
+            entries_.erase(i);
+        }
+    }
+
+    /**
+     * Looks up addresses of the host which are not expired yet.
+     */
+    std::optional<addresses_type> lookup(std::string_view host, time_traits::time_point now = time_traits::now()) const {
+        const std::lock_guard lock(mutex_);
+        if (!enabled_) {
+            return std::nullopt;
+        }
+        const auto i = entries_.find(host);
+        if (i == entries_.end() || now - i->second.updated >= ttl_) {
+            return std::nullopt;
+        }
+        return i->second.addresses;
+    }
+
+    /**
+     * Stores resolved addresses of the host.
+     */
+    void update(std::string_view host, addresses_type addresses, time_traits::time_point now = time_traits::now()) {
+        const std::lock_guard lock(mutex_);
+        if (enabled_ && !addresses.empty()) {
+            entries_.insert_or_assign(std::string(host), entry{std::move(addresses), now});
+        }
+    }
+
+private:
+    struct entry {
+        addresses_type addresses;
+        time_traits::time_point updated;
+    };
+
+    mutable std::mutex mutex_;
+    bool enabled_ = false;
+    time_traits::duration ttl_ = std::chrono::seconds(30);
+    time_traits::duration attempt_delay_ = std::chrono::milliseconds(250);
+    std::map<std::string, entry, std::less<>> entries_;
+};
+
+} // namespace bozo
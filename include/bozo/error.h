@@ -96,6 +96,17 @@ enum code {
     bad_composite_size, //!< a composite's fields number received does not equal to the expected or not supported by the type
     pq_cancel_failed, //!< libpq PQcancel function call failed, see `get_error_context()` for more information
     pq_get_cancel_failed, //!< libpq PQgetCancel function call failed, see `get_error_context()` for more information
+    pg_enter_pipeline_mode_failed, //!< libpq PQenterPipelineMode function failed
+    pg_exit_pipeline_mode_failed, //!< libpq PQexitPipelineMode function failed
+    pg_set_single_row_mode_failed, //!< libpq PQsetSingleRowMode function failed
+    pg_set_chunked_rows_mode_failed, //!< libpq PQsetChunkedRowsMode function failed
+    pg_put_copy_data_failed, //!< libpq PQputCopyData function failed
+    pg_put_copy_end_failed, //!< libpq PQputCopyEnd function failed
+    bad_copy_data, //!< error while serializing rows into the COPY data
+    pg_get_copy_data_failed, //!< libpq PQgetCopyData function failed
+    bad_batch_query, //!< error while making or sending a batch query of `bozo::lookup_batcher`
+    bad_flight_query, //!< error while sending a query of `bozo::single_flight`
+    bad_cache_query, //!< error while sending a query of `bozo::result_cache`
 };
 
 /**
@@ -493,6 +504,28 @@ public:
                 return "libpq PQcancel function call failed";
             case pq_get_cancel_failed:
                 return "libpq PQgetCancel function call failed";
+            case pg_enter_pipeline_mode_failed:
+                return "pg_enter_pipeline_mode_failed - PQenterPipelineMode function failed";
+            case pg_exit_pipeline_mode_failed:
+                return "pg_exit_pipeline_mode_failed - PQexitPipelineMode function failed";
+            case pg_set_single_row_mode_failed:
+                return "pg_set_single_row_mode_failed - PQsetSingleRowMode function failed";
+            case pg_set_chunked_rows_mode_failed:
+                return "pg_set_chunked_rows_mode_failed - PQsetChunkedRowsMode function failed";
+            case pg_put_copy_data_failed:
+                return "pg_put_copy_data_failed - PQputCopyData function failed";
+            case pg_put_copy_end_failed:
+                return "pg_put_copy_end_failed - PQputCopyEnd function failed";
+            case bad_copy_data:
+                return "error while serializing rows into the COPY data";
+            case pg_get_copy_data_failed:
+                return "pg_get_copy_data_failed - PQgetCopyData function failed";
+            case bad_batch_query:
+                return "error while making or sending a batch query";
+            case bad_flight_query:
+                return "error while sending a query of a single flight";
+            case bad_cache_query:
+                return "error while sending a query of a result cache";
         }
         return "no message for value: " + std::to_string(value);
     }
@@ -5,6 +5,8 @@
 #include <bozo/core/options.h>
 #include <bozo/ext/std/optional.h>
 #include <bozo/ext/std/nullopt_t.h>
+#include <bozo/detail/recycling_allocator.h>
+#include <bozo/row_stream.h>
 
 #include <boost/hana/tuple.hpp>
 #include <boost/hana/empty.hpp>
@@ -13,6 +15,13 @@
 #include <boost/hana/not_equal.hpp>
 #include <boost/hana/greater.hpp>
 
+#include <array>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <vector>
+
 /**
  * @defgroup group-failover-role_based Role-Based Execution & Fallback
  * @ingroup group-failover
@@ -59,10 +68,12 @@ struct role_based_options {
     class on_fallback_tag;
     class close_connection_tag;
     class roles_tag;
+    class hedge_delay_tag;
 
     constexpr static option<on_fallback_tag> on_fallback{}; //!< Handler for fallback event with signature `void(error_code, Connection, Fallback)`, may be useful for logging.
     constexpr static option<close_connection_tag> close_connection{}; //!< Close connection policy on retry, possible values `true`(default), `false`.
     constexpr static option<roles_tag> roles{}; //!< Strategy roles sequence.
+    constexpr static option<hedge_delay_tag> hedge_delay{}; //!< Delay of type `bozo::time_traits::duration` after which an idempotent operation is issued once more via another connection, see `bozo::failover::role_based()`.
 };
 
 template <typename Tag>
@@ -300,6 +311,16 @@ public:
         return rebind_type{bozo::unwrap(std::forward<Source>(source_)).rebind_role(r), io_};
     }
 
+    /**
+     * Underlying `ConnectionSource`.
+     */
+    const Source& source() const noexcept { return source_;}
+
+    /**
+     * `io_context` the provider is bound to.
+     */
+    io_context& get_io_context() const noexcept { return io_;}
+
     template <typename TimeConstraint, typename Handler>
     void async_get_connection(TimeConstraint t, Handler&& h) const & {
         static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
@@ -643,6 +664,27 @@ auto conn_info = bozo::failover::make_role_based_connection_source(
 
 auto fallback = failover::role_based(failover::master, failover::replica, failover::replica);
 bozo::request[fallback](conn_info[io], query, .5s, out, yield);
+ * @endcode
+ *
+ * ### Hedging
+ *
+ * Tail latency of reads is often dominated by a single host stalling for a while, e.g. on
+ * a checkpoint. With the `bozo::failover::role_based_options::hedge_delay` option the operation
+ * which has not completed within the delay is issued once more via another connection obtained
+ * from the same roles sequence, the first completed one is passed to the handler and the other
+ * is cancelled. The results of each issue are collected separately, so #InsertIterator, #ForwardIterator,
+ * `std::reference_wrapper` and `bozo::row_stream` outputs receive the rows of the completed issue only;
+ * a row stream gets its rows after the operation has been completed. An error completes the operation if the other
+ * issue has not been started or has failed too. The delay is usually set around the 95th
+ * percentile of the operation latency.
+ *
+ * @warning Hedging is for idempotent read-only operations only since the operation may be
+ * executed twice.
+ *
+ * @code
+auto hedged = failover::role_based(failover::replica, failover::master)
+    .set(failover::role_based_options::hedge_delay=bozo::time_traits::duration(20ms));
+bozo::request[hedged](conn_info[io], query, .5s, bozo::into(rows), yield);
  * @endcode
  *
  * @sa `bozo::failover::role_based_strategy`, `bozo::failover::role_based_connection_provider`
@@ -657,12 +699,355 @@ constexpr auto role_based(Roles ...roles) {
     }
 }
 
+namespace detail {
+
+/**
+ * Argument of a hedged operation which is passed to each issue as is.
+ */
+template <typename T>
+struct hedge_argument {
+    const T& get(const T& v) const noexcept { return v;}
+    void commit(T&) noexcept {}
+};
+
+/**
+ * Per issue storage of a hedged operation output. The outputs are collected
+ * separately for each issue and are moved to the original output for the
+ * completed issue only, outputs of unknown types are passed as is.
+ */
+template <typename T, typename = hana::when<true>>
+struct hedge_buffer : hedge_argument<T> {};
+
+template <typename T>
+struct hedge_buffer<T, hana::when<InsertIterator<T>>> {
+    typename T::container_type value;
+
+    auto get(const T&) { return std::inserter(value, value.end());}
+
+    void commit(T& out) { std::move(value.begin(), value.end(), out);}
+};
+
+template <typename T>
+struct hedge_buffer<T, hana::when<ForwardIterator<T>
+        && !std::is_const_v<std::remove_reference_t<typename std::iterator_traits<T>::reference>>>> {
+    std::vector<typename std::iterator_traits<T>::value_type> value;
+
+    auto get(const T&) { return std::back_inserter(value);}
+
+    void commit(T& out) { std::move(value.begin(), value.end(), out);}
+};
+
+template <typename T>
+struct hedge_buffer<std::reference_wrapper<T>> {
+    T value;
+
+    auto get(const std::reference_wrapper<T>&) { return std::ref(value);}
+
+    void commit(std::reference_wrapper<T>& out) { out.get() = std::move(value);}
+};
+
+/**
+ * Rows of a stream are collected for each issue and passed to the callback
+ * for the completed issue only, so the rows are not streamed while hedging.
+ */
+template <typename Row, typename Callback>
+struct hedge_buffer<row_stream<Row, Callback>> {
+    std::vector<Row> value;
+
+    auto get(const row_stream<Row, Callback>&) { return std::back_inserter(value);}
+
+    void commit(row_stream<Row, Callback>& out) {
+        for (auto& row : value) {
+            out.callback()(std::move(row));
+        }
+    }
+};
+
+/**
+ * Storage of the hedged operation arguments for an issue. The arguments start with
+ * the query and the output, if any, is the last one, so only the output is buffered
+ * while the query is passed as is, e.g. `std::cref(query)`.
+ */
+template <typename ...Args>
+struct hedge_buffers {
+    template <std::size_t ...I>
+    static auto make(std::index_sequence<I...>) -> hana::tuple<std::conditional_t<
+        (I != 0 && I + 1 == sizeof...(Args)), hedge_buffer<Args>, hedge_argument<Args>>...>;
+
+    using type = decltype(make(std::index_sequence_for<Args...>{}));
+};
+
+/**
+ * Handler of a connection obtained for an issue of a hedged operation, registers
+ * the connection so the issue can be cancelled. The connection obtained after the
+ * operation has been completed by the other issue is not used.
+ */
+template <typename Context, typename Handler>
+struct hedge_connection_handler {
+    Context* ctx_;
+    std::size_t issue_;
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection&& conn) {
+        if (!ec && !ctx_->track(issue_, unwrap_connection(conn))) {
+            ec = asio::error::operation_aborted;
+        }
+        handler_(std::move(ec), std::forward<Connection>(conn));
+    }
+
+    using executor_type = asio::associated_executor_t<Handler>;
+
+    executor_type get_executor() const noexcept { return asio::get_associated_executor(handler_);}
+
+    using allocator_type = asio::associated_allocator_t<Handler>;
+
+    allocator_type get_allocator() const noexcept { return asio::get_associated_allocator(handler_);}
+};
+
+/**
+ * `ConnectionSource` of an issue of a hedged operation.
+ */
+template <typename Source, typename Context>
+struct hedge_source {
+    Source source_;
+    Context* ctx_;
+    std::size_t issue_;
+
+    using connection_type = typename connection_source_traits<std::decay_t<Source>>::connection_type;
+
+    template <typename Role>
+    auto rebind_role(const Role& r) const ->
+            hedge_source<decltype(bozo::unwrap(std::declval<const std::decay_t<Source>&>()).rebind_role(r)), Context> {
+        return {bozo::unwrap(source_).rebind_role(r), ctx_, issue_};
+    }
+
+    template <typename TimeConstraint, typename Handler>
+    void operator() (io_context& io, TimeConstraint t, Handler&& h) const {
+        // A new try of the issue, the connection of the previous one is about to be closed
+        ctx_->untrack(issue_);
+        bozo::unwrap(source_)(io, std::move(t),
+            hedge_connection_handler<Context, std::decay_t<Handler>>{ctx_, issue_, std::forward<Handler>(h)});
+    }
+};
+
+template <typename Strategy, typename Operation, typename Handler,
+        typename Source, typename TimeConstraint, typename ...Args>
+class hedge_context : public std::enable_shared_from_this<
+        hedge_context<Strategy, Operation, Handler, Source, TimeConstraint, Args...>> {
+public:
+    using executor_type = asio::associated_executor_t<Handler>;
+    using allocator_type = asio::associated_allocator_t<Handler>;
+
+    hedge_context(const Strategy& strategy, const Operation& op, Handler handler,
+            role_based_connection_provider<Source> provider, TimeConstraint t, Args ...args)
+    : strategy_(strategy), op_(op), handler_(std::move(handler)),
+      executor_(asio::get_associated_executor(handler_)),
+      allocator_(asio::get_associated_allocator(handler_)),
+      provider_(std::move(provider)), time_constraint_(t), args_(std::move(args)...) {}
+
+    void start(time_traits::duration delay) {
+        {
+            const std::lock_guard lock(mutex_);
+            issues_[0].started = true;
+            timer_.emplace(bozo::detail::get_operation_timer(provider_.get_io_context().get_executor(), delay));
+            timer_->async_wait(on_delay{this->shared_from_this()});
+        }
+        initiate(0);
+    }
+
+    /**
+     * Registers the connection of the issue until its try is finished.
+     *
+     * @return false --- the operation has been completed already, so the connection should not be used.
+     */
+    template <typename Connection>
+    bool track(std::size_t issue, Connection& conn) {
+        const std::lock_guard lock(mutex_);
+        if (done_) {
+            return false;
+        }
+        issues_[issue].conn = std::addressof(conn);
+        issues_[issue].cancel = &post_cancel<Connection>;
+        return true;
+    }
+
+    void untrack(std::size_t issue) {
+        const std::lock_guard lock(mutex_);
+        issues_[issue].conn = nullptr;
+        issues_[issue].cancel = nullptr;
+    }
+
+private:
+    using cancel_type = void (*)(std::shared_ptr<hedge_context>, std::size_t, void*);
+
+    struct issue_state {
+        bool started = false;
+        bool finished = false;
+        void* conn = nullptr;
+        cancel_type cancel = nullptr;
+    };
+
+    // The connection is cancelled via its own executor. It is alive until its try
+    // is finished, i.e. while it is registered, so the registration is checked again
+    // under the lock before the cancel.
+    template <typename Connection>
+    static void post_cancel(std::shared_ptr<hedge_context> ctx, std::size_t issue, void* conn) {
+        auto ex = static_cast<Connection*>(conn)->get_executor();
+        asio::post(ex, [ctx = std::move(ctx), issue, conn] {
+            const std::lock_guard lock(ctx->mutex_);
+            const auto& state = ctx->issues_[issue];
+            if (state.conn == conn && state.cancel == &post_cancel<Connection>) {
+                static_cast<Connection*>(conn)->cancel();
+            }
+        });
+    }
+
+    struct on_delay {
+        std::shared_ptr<hedge_context> ctx_;
+
+        void operator() (error_code ec) {
+            {
+                const std::lock_guard lock(ctx_->mutex_);
+                if (ec || ctx_->done_ || ctx_->issues_[0].finished) {
+                    return;
+                }
+                ctx_->issues_[1].started = true;
+            }
+            ctx_->initiate(1);
+        }
+
+        using executor_type = typename hedge_context::executor_type;
+
+        executor_type get_executor() const noexcept { return ctx_->executor_;}
+
+        using allocator_type = typename hedge_context::allocator_type;
+
+        allocator_type get_allocator() const noexcept { return ctx_->allocator_;}
+    };
+
+    struct on_complete {
+        std::shared_ptr<hedge_context> ctx_;
+        std::size_t issue_;
+
+        template <typename Connection>
+        void operator() (error_code ec, Connection&& conn) {
+            ctx_->complete(issue_, std::move(ec), std::forward<Connection>(conn));
+        }
+
+        using executor_type = typename hedge_context::executor_type;
+
+        executor_type get_executor() const noexcept { return ctx_->executor_;}
+
+        using allocator_type = typename hedge_context::allocator_type;
+
+        allocator_type get_allocator() const noexcept { return ctx_->allocator_;}
+    };
+
+    void initiate(std::size_t issue) {
+        initiate(issue, std::index_sequence_for<Args...>{});
+    }
+
+    template <std::size_t ...I>
+    void initiate(std::size_t issue, std::index_sequence<I...>) {
+        using source_type = hedge_source<Source, hedge_context>;
+        role_based_connection_provider<source_type> provider{
+            source_type{provider_.source(), this, issue}, provider_.get_io_context()};
+        auto& buffers = buffers_[issue];
+        auto first_try = get_first_try(op_, strategy_, allocator_, std::move(provider), time_constraint_,
+            buffers[hana::size_c<I>].get(args_[hana::size_c<I>])...);
+        bozo::failover::detail::initiate_operation(op_, std::move(first_try), on_complete{this->shared_from_this(), issue});
+    }
+
+    template <typename Connection>
+    void complete(std::size_t issue, error_code ec, Connection&& conn) {
+        {
+            const std::lock_guard lock(mutex_);
+            issues_[issue].finished = true;
+            issues_[issue].conn = nullptr;
+            issues_[issue].cancel = nullptr;
+            auto& other = issues_[1 - issue];
+            if (done_ || (ec && other.started && !other.finished)) {
+                return;
+            }
+            done_ = true;
+            if (other.conn) {
+                other.cancel(this->shared_from_this(), 1 - issue, other.conn);
+            }
+            timer_->cancel();
+        }
+        // The other issue never touches the outputs since the operation is done
+        try {
+            commit(issue, std::index_sequence_for<Args...>{});
+        } catch (const std::exception&) {
+            if (!ec) {
+                ec = bozo::error::bad_result_process;
+            }
+        }
+        handler_(std::move(ec), std::forward<Connection>(conn));
+    }
+
+    template <std::size_t ...I>
+    void commit(std::size_t issue, std::index_sequence<I...>) {
+        (buffers_[issue][hana::size_c<I>].commit(args_[hana::size_c<I>]), ...);
+    }
+
+    using timer_type = typename bozo::detail::operation_timer<io_context::executor_type>::type;
+
+    Strategy strategy_;
+    Operation op_;
+    Handler handler_;
+    executor_type executor_;
+    allocator_type allocator_;
+    role_based_connection_provider<Source> provider_;
+    TimeConstraint time_constraint_;
+    hana::tuple<Args...> args_;
+    std::array<typename hedge_buffers<Args...>::type, 2> buffers_;
+    std::array<issue_state, 2> issues_;
+    bool done_ = false;
+    std::mutex mutex_;
+    std::optional<timer_type> timer_;
+};
+
+/**
+ * Operation initiator of the role-based strategy with hedging.
+ */
+template <typename Strategy, typename Operation>
+struct hedged_operation_initiator {
+    Strategy strategy_;
+    Operation op_;
+
+    constexpr hedged_operation_initiator(Strategy strategy, const Operation& op)
+    : strategy_(std::move(strategy)), op_(op) {}
+
+    template <typename Handler, typename Source, typename TimeConstraint, typename ...Args>
+    void operator() (Handler&& handler, role_based_connection_provider<Source> provider,
+            TimeConstraint t, Args&& ...args) const {
+        using context_type = hedge_context<Strategy, Operation, std::decay_t<Handler>,
+            Source, decltype(bozo::deadline(t)), std::decay_t<Args>...>;
+        auto allocator = bozo::detail::get_recycling_allocator(asio::get_associated_allocator(handler));
+        auto ctx = std::allocate_shared<context_type>(allocator, strategy_, op_, std::forward<Handler>(handler),
+            std::move(provider), bozo::deadline(t), std::forward<Args>(args)...);
+        ctx->start(strategy_.get(role_based_options::hedge_delay));
+    }
+};
+
+} // namespace detail
+
 } // namespace bozo::failover
 
 namespace bozo {
 
 template <typename ...Ts, typename Op>
-struct construct_initiator_impl<failover::role_based_strategy<Ts...>, Op>
-: failover::construct_initiator_impl {};
+struct construct_initiator_impl<failover::role_based_strategy<Ts...>, Op> {
+    template <typename Strategy>
+    constexpr static auto apply(Strategy&& strategy, const Op& op) {
+        if constexpr (decltype(strategy.has(failover::role_based_options::hedge_delay))::value) {
+            return failover::detail::hedged_operation_initiator{std::decay_t<Strategy>(strategy), op};
+        } else {
+            return failover::construct_initiator_impl::apply(std::forward<Strategy>(strategy), op);
+        }
+    }
+};
 
 } // namespace bozo
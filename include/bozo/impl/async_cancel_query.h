@@ -0,0 +1,134 @@
+#pragma once
+
+#include <bozo/impl/async_request.h>
+#include <bozo/cancel.h>
+
+namespace bozo::impl {
+
+/**
+ * Dispatches the blocking `PQcancel()` call via the executor of the cancel handle,
+ * so it does not block the connection IO.
+ */
+template <typename Handle, typename Handler>
+inline void async_dispatch_cancel(Handle&& handle, Handler&& handler) {
+    initiate_async_cancel{}(std::forward<Handler>(handler), std::forward<Handle>(handle));
+}
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Cancels the query left in progress on the connection, e.g. by a timed out
+ * operation, and drains the rest of its results, so the connection becomes idle
+ * and may be reused rather than closed. The results are drained only after the
+ * cancel request has been delivered, so the cancel could not hit a query made
+ * on the connection later.
+ */
+template <typename Connection, typename Handler>
+struct async_cancel_query_op : boost::asio::coroutine {
+    Connection conn_;
+    time_traits::time_point deadline_;
+    Handler handler_;
+    query_state flush_state_ = query_state::send_finish;
+    bool has_result_ = false;
+
+    async_cancel_query_op(Connection conn, time_traits::time_point deadline, Handler handler)
+    : conn_(std::move(conn)), deadline_(deadline), handler_(std::move(handler)) {}
+
+    void perform() {
+        auto handle = get_cancel_handle(unwrap_connection(conn_));
+        async_dispatch_cancel(std::move(handle), std::move(*this));
+    }
+
+    void done(error_code ec = error_code{}) {
+        handler_(std::move(ec), std::move(conn_));
+    }
+
+    void operator() (error_code ec, std::string msg) {
+        if (ec) {
+            unwrap_connection(conn_).set_error_context(std::move(msg));
+            return done(ec);
+        }
+        (*this)();
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (ec) {
+            return done(ec);
+        }
+
+        // The deadline timer cancels pending IO only, so the operation should
+        // not start to wait after the deadline.
+        if (time_traits::now() >= deadline_) {
+            return done(asio::error::timed_out);
+        }
+
+        auto& conn = unwrap_connection(conn_);
+
+        reenter(*this) {
+            while ((flush_state_ = flush_output(conn)) == query_state::send_in_progress) {
+                yield conn.async_wait_write(std::move(*this));
+            }
+            if (flush_state_ == query_state::error) {
+                return done(error::pg_flush_failed);
+            }
+
+            do {
+                while (is_busy(conn)) {
+                    yield conn.async_wait_read(std::move(*this));
+                    if (auto err = consume_input(conn)) {
+                        return done(err);
+                    }
+                }
+                if (auto res = get_result(conn)) {
+                    has_result_ = true;
+                    switch (result_status(*res)) {
+                        case PGRES_COPY_IN:
+                        case PGRES_COPY_OUT:
+                        case PGRES_COPY_BOTH:
+                            // Copy can not be drained, the connection should be closed
+                            conn.set_error_context(get_result_status_name(result_status(*res)));
+                            return done(error::result_status_unexpected);
+                        default:
+                            break;
+                    }
+                } else {
+                    has_result_ = false;
+                }
+            } while (has_result_);
+
+            done();
+        }
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename Connection, typename Handler>
+async_cancel_query_op(Connection, time_traits::time_point, Handler) -> async_cancel_query_op<Connection, Handler>;
+
+#include <boost/asio/unyield.hpp>
+
+/**
+ * Cancels the query in progress on the connection and drains its results
+ * within the time constraint. The handler is called with the connection which
+ * is ready to be reused if there is no error.
+ */
+template <typename Connection, typename TimeConstraint, typename Handler>
+inline void async_cancel_query(Connection&& conn, TimeConstraint t, Handler&& handler) {
+    static_assert(bozo::Connection<Connection>, "conn should model Connection concept");
+    auto h = make_request_handler(conn, deadline(t), std::forward<Handler>(handler));
+    async_cancel_query_op op{std::forward<Connection>(conn), deadline(t), std::move(h)};
+    op.perform();
+}
+
+} // namespace bozo::impl
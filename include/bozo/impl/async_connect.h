@@ -13,6 +13,9 @@
 #include <boost/asio/strand.hpp>
 #include <boost/asio/post.hpp>
 
+#include <atomic>
+#include <optional>
+
 namespace bozo {
 namespace impl {
 
@@ -97,7 +100,90 @@ template <typename Connection, typename Handler>
 async_connect_op(Connection, Handler) -> async_connect_op<Connection, Handler>;
 
 template <typename Connection, typename Handler>
-inline void request_oid_map(Connection&& conn, Handler&& handler) {
+inline void request_oid_map(Connection&& conn, Handler&& handler,
+        time_traits::time_point deadline = time_traits::time_point::max());
+
+/**
+ * Waits for the OIDs requested by another connection and looks up the cache again via the
+ * handler executor once they are there. The wait is bounded by the deadline of the connect
+ * operation since the OIDs request of another connection may last for too long, so the
+ * handler is called with `asio::error::timed_out` on expiry.
+ */
+template <typename Connection, typename Handler>
+inline void wait_oid_map(oid_map_cache& cache, const oid_map_cache::key_type& key,
+        Connection&& conn, Handler&& handler, time_traits::time_point deadline) {
+    using executor_type = std::decay_t<decltype(unwrap_connection(conn).get_executor())>;
+    using timer_type = typename detail::operation_timer<executor_type>::type;
+
+    struct state {
+        std::decay_t<Connection> conn;
+        std::decay_t<Handler> handler;
+        std::optional<timer_type> timer;
+        std::atomic_bool done {false};
+
+        state(Connection&& conn, Handler&& handler)
+        : conn(std::forward<Connection>(conn)), handler(std::forward<Handler>(handler)) {}
+    };
+
+    const auto ex = unwrap_connection(conn).get_executor();
+    auto allocator = detail::get_recycling_allocator(asio::get_associated_allocator(handler));
+    auto s = std::allocate_shared<state>(allocator, std::forward<Connection>(conn), std::forward<Handler>(handler));
+
+    // The timer is started before the waiter is registered since the waiter may cancel it
+    // from the thread which updates the cache
+    if (deadline != time_traits::time_point::max()) {
+        s->timer.emplace(detail::get_operation_timer(ex, deadline));
+        s->timer->async_wait(asio::bind_executor(asio::get_associated_executor(s->handler), [s] (error_code) {
+            if (!s->done.exchange(true)) {
+                unwrap_connection(s->conn).set_error_context("pending OIDs have not been received in time");
+                s->handler(asio::error::timed_out, std::move(s->conn));
+            }
+        }));
+    }
+
+    cache.wait(key, [s, deadline] {
+        if (!s->done.exchange(true)) {
+            if (s->timer) {
+                s->timer->cancel();
+            }
+            asio::post(asio::get_associated_executor(s->handler), [s, deadline] {
+                request_oid_map(std::move(s->conn), std::move(s->handler), deadline);
+            });
+        }
+    });
+}
+
+/**
+ * Requests OIDs of the connection #OidMap via the cache if it is enabled.
+ *
+ * @param deadline --- deadline of the connect operation to bound waiting for OIDs which
+ *                     are being requested by another connection.
+ */
+template <typename Connection, typename Handler>
+inline void request_oid_map(Connection&& conn, Handler&& handler, time_traits::time_point deadline) {
+    auto& cache = oid_map_cache::global();
+    if (cache.enabled()) {
+        auto key = make_oid_map_cache_key(conn);
+        switch (apply_cached_oid_map(bozo::unwrap_connection(conn).oid_map(), cache, key)) {
+            case cached_oid_map::hit:
+                return handler(error_code{}, std::forward<Connection>(conn));
+            case cached_oid_map::refresh: {
+                auto cached = get_oids(bozo::unwrap_connection(conn).oid_map());
+                bozo::impl::request_oid_map_op op{cache_oid_map_handler{
+                    cache, std::move(key), std::forward<Handler>(handler), std::make_optional(std::move(cached))}};
+                return op.perform(std::forward<Connection>(conn));
+            }
+            case cached_oid_map::update: {
+                bozo::impl::request_oid_map_op op{
+                    cache_oid_map_handler{cache, std::move(key), std::forward<Handler>(handler)}};
+                return op.perform(std::forward<Connection>(conn));
+            }
+            case cached_oid_map::pending:
+                return wait_oid_map(cache, key, std::forward<Connection>(conn), std::forward<Handler>(handler), deadline);
+            case cached_oid_map::miss:
+                break;
+        }
+    }
     bozo::impl::request_oid_map_op op{std::forward<Handler>(handler)};
     op.perform(std::forward<Connection>(conn));
 }
@@ -105,15 +191,17 @@ inline void request_oid_map(Connection&& conn, Handler&& handler) {
 template <typename Handler>
 struct request_oid_map_handler {
     Handler handler_;
+    time_traits::time_point deadline_;
 
-    request_oid_map_handler(Handler handler) : handler_(std::move(handler)) {}
+    request_oid_map_handler(Handler handler, time_traits::time_point deadline)
+    : handler_(std::move(handler)), deadline_(deadline) {}
 
     template <typename Connection>
     void operator() (error_code ec, Connection&& conn) {
         if (ec) {
             handler_(std::move(ec), std::forward<Connection>(conn));
         } else {
-            request_oid_map(std::forward<Connection>(conn), std::move(handler_));
+            request_oid_map(std::forward<Connection>(conn), std::move(handler_), deadline_);
         }
     }
 
@@ -137,9 +225,10 @@ constexpr bool OidMapEmpty = std::is_same_v<
 >;
 
 template <typename Conn, typename Handler>
-constexpr auto apply_oid_map_request(Handler&& handler) {
+constexpr auto apply_oid_map_request(Handler&& handler,
+        [[maybe_unused]] time_traits::time_point deadline = time_traits::time_point::max()) {
     if constexpr (!OidMapEmpty<Conn>) {
-        return request_oid_map_handler{std::forward<Handler>(handler)};
+        return request_oid_map_handler{std::forward<Handler>(handler), deadline};
     } else {
         return std::forward<Handler>(handler);
     }
@@ -159,13 +248,23 @@ inline auto apply_time_constaint(const TimeConstraint& t, [[maybe_unused]] Conne
     }
 }
 
+template <typename TimeConstraint>
+inline time_traits::time_point oid_map_wait_deadline(const TimeConstraint& t) {
+    if constexpr (IsNone<TimeConstraint>) {
+        return time_traits::time_point::max();
+    } else {
+        return deadline(t);
+    }
+}
+
 template <typename Connection, typename TimeConstraint, typename Handler>
 inline void async_connect(std::string conninfo, const TimeConstraint& t,
         Connection&& conn, Handler&& handler) {
     static_assert(bozo::Connection<Connection>, "conn should model Connection concept");
 
     auto wrapped_handler = apply_oid_map_request<Connection>(
-        apply_time_constaint(t, conn, std::forward<Handler>(handler))
+        apply_time_constaint(t, conn, std::forward<Handler>(handler)),
+        oid_map_wait_deadline(t)
     );
     auto op = async_connect_op {std::forward<Connection>(conn), std::move(wrapped_handler)};
     op.perform(conninfo);
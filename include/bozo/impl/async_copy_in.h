@@ -0,0 +1,359 @@
+#pragma once
+
+#include <bozo/impl/async_request.h>
+#include <bozo/io/copy.h>
+
+#include <iterator>
+#include <vector>
+
+namespace bozo::impl {
+
+/**
+ * Rows to be copied into a database and the position of the next row to be sent.
+ * The state is allocated once per operation, so iterators stay valid while the
+ * operation object is moved between the handlers.
+ */
+template <typename Rows>
+struct copy_in_state {
+    Rows rows;
+    decltype(std::begin(std::declval<Rows&>())) next;
+    std::vector<char> buffer;
+    bool started = false;
+    bool finished = false;
+
+    copy_in_state(Rows rows) : rows(std::forward<Rows>(rows)), next(std::begin(this->rows)) {}
+};
+
+/**
+ * Maximum size of the data to be put into the libpq output buffer at once.
+ */
+inline constexpr std::size_t copy_in_batch_size = 64 * 1024;
+
+inline error_code get_copy_result_error(ExecStatusType status) noexcept {
+    switch (status) {
+        case PGRES_BAD_RESPONSE:
+            return error::result_status_bad_response;
+        case PGRES_EMPTY_QUERY:
+            return error::result_status_empty_query;
+        default:
+            break;
+    }
+    return error::result_status_unexpected;
+}
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Sends the `COPY ... FROM STDIN` query, waits for the server to be ready to
+ * receive data and streams the rows in the binary `COPY` format by batches of
+ * `copy_in_batch_size` bytes, flushing each batch before serializing the next one
+ * so memory consumption does not depend on the number of rows.
+ */
+template <typename Context, typename State>
+struct async_put_copy_data_op : boost::asio::coroutine {
+    Context ctx_;
+    binary_query query_;
+    std::shared_ptr<State> state_;
+    using result_type = std::decay_t<decltype(get_result(get_connection(ctx_)))>;
+    result_type result_;
+    copy_state copy_state_ = copy_state::queued;
+    query_state flush_state_ = query_state::send_finish;
+    error_code error_;
+
+    async_put_copy_data_op(Context ctx, binary_query query, std::shared_ptr<State> state)
+    : ctx_(std::move(ctx)), query_(std::move(query)), state_(std::move(state)) {}
+
+    void perform() {
+        decltype(auto) conn = get_connection(ctx_);
+        if (auto ec = set_nonblocking(conn)) {
+            return done(ec);
+        }
+
+        get_statistics(ctx_).set_query(query_);
+        if (!send_query(conn, query_)) {
+            return done(error::pg_send_query_params_failed);
+        }
+
+        (*this)();
+    }
+
+    void done() {
+        return impl::done(ctx_);
+    }
+
+    void done(error_code ec) {
+        if (std::empty(get_error_context(get_connection(ctx_)))) {
+            get_connection(ctx_).set_error_context("error while copy data in");
+        }
+        return impl::done(ctx_, ec);
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+
+        if (ec) {
+            if (ec == asio::error::bad_descriptor) {
+                ec = asio::error::operation_aborted;
+            }
+            return done(ec);
+        }
+
+        reenter(*this) {
+            while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                yield get_connection(ctx_).async_wait_write(std::move(*this));
+            }
+            if (flush_state_ == query_state::error) {
+                return done(error::pg_flush_failed);
+            }
+
+            while (is_busy(get_connection(ctx_))) {
+                yield get_connection(ctx_).async_wait_read(std::move(*this));
+                if (auto err = consume_input(get_connection(ctx_))) {
+                    return done(err);
+                }
+            }
+
+            result_ = get_result(get_connection(ctx_));
+
+            if (!result_) {
+                get_connection(ctx_).set_error_context("no result for COPY query");
+                return done(error::result_status_unexpected);
+            }
+
+            if (result_status(*result_) != PGRES_COPY_IN) {
+                // The query has failed, so consume the rest of its results
+                do {
+                    while (is_busy(get_connection(ctx_))) {
+                        yield get_connection(ctx_).async_wait_read(std::move(*this));
+                        if (auto err = consume_input(get_connection(ctx_))) {
+                            return done(err);
+                        }
+                    }
+                } while (get_result(get_connection(ctx_)));
+                return done(result_error());
+            }
+
+            do {
+                if ((error_ = fill_buffer())) {
+                    break;
+                }
+
+                while ((copy_state_ = put_copy_data(get_connection(ctx_),
+                        state_->buffer.data(), state_->buffer.size())) == copy_state::would_block) {
+                    yield get_connection(ctx_).async_wait_write(std::move(*this));
+                }
+                if (copy_state_ == copy_state::error) {
+                    error_ = error::pg_put_copy_data_failed;
+                    break;
+                }
+                get_statistics(ctx_).add_sent(state_->buffer.size());
+                state_->buffer.clear();
+
+                while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                    yield get_connection(ctx_).async_wait_write(std::move(*this));
+                }
+                if (flush_state_ == query_state::error) {
+                    return done(error::pg_flush_failed);
+                }
+            } while (!state_->finished);
+
+            if (error_) {
+                // Abort the COPY and consume its results so the connection stays usable,
+                // the original error is reported whatever happens on the way
+                while ((copy_state_ = put_copy_end(get_connection(ctx_), error_.message().c_str())) == copy_state::would_block) {
+                    yield get_connection(ctx_).async_wait_write(std::move(*this));
+                }
+                if (copy_state_ == copy_state::error) {
+                    return done(error_);
+                }
+
+                while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                    yield get_connection(ctx_).async_wait_write(std::move(*this));
+                }
+                if (flush_state_ == query_state::error) {
+                    return done(error_);
+                }
+
+                do {
+                    while (is_busy(get_connection(ctx_))) {
+                        yield get_connection(ctx_).async_wait_read(std::move(*this));
+                        if (consume_input(get_connection(ctx_))) {
+                            return done(error_);
+                        }
+                    }
+                } while (get_result(get_connection(ctx_)));
+
+                return done(error_);
+            }
+
+            while ((copy_state_ = put_copy_end(get_connection(ctx_))) == copy_state::would_block) {
+                yield get_connection(ctx_).async_wait_write(std::move(*this));
+            }
+            if (copy_state_ == copy_state::error) {
+                return done(error::pg_put_copy_end_failed);
+            }
+
+            while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                yield get_connection(ctx_).async_wait_write(std::move(*this));
+            }
+            if (flush_state_ == query_state::error) {
+                return done(error::pg_flush_failed);
+            }
+            get_statistics(ctx_).mark_sent();
+
+            while (is_busy(get_connection(ctx_))) {
+                yield get_connection(ctx_).async_wait_read(std::move(*this));
+                if (auto err = consume_input(get_connection(ctx_))) {
+                    return done(err);
+                }
+            }
+
+            result_ = get_result(get_connection(ctx_));
+
+            if (!result_) {
+                get_connection(ctx_).set_error_context("no result for COPY query");
+                return done(error::result_status_unexpected);
+            }
+
+            do {
+                while (is_busy(get_connection(ctx_))) {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    if (auto err = consume_input(get_connection(ctx_))) {
+                        return done(err);
+                    }
+                }
+            } while (get_result(get_connection(ctx_)));
+            get_statistics(ctx_).mark_received();
+
+            if (result_status(*result_) != PGRES_COMMAND_OK) {
+                return done(result_error());
+            }
+
+            done();
+        }
+    }
+
+    error_code result_error() {
+        const auto status = result_status(*result_);
+        if (status == PGRES_FATAL_ERROR) {
+            return impl::result_error(*result_);
+        }
+        const auto retval = get_copy_result_error(status);
+        if (retval == error::result_status_unexpected) {
+            get_connection(ctx_).set_error_context(get_result_status_name(status));
+        }
+        return retval;
+    }
+
+    // Serializes the rows into the buffer up to the batch size, the binary COPY
+    // header goes before the first row and the trailer goes after the last one.
+    error_code fill_buffer() noexcept {
+        using std::end;
+        auto& s = *state_;
+        try {
+            if (!s.started) {
+                s.buffer.reserve(copy_in_batch_size + copy_in_batch_size / 4);
+                s.buffer.insert(s.buffer.end(),
+                    std::begin(detail::copy_binary_header), std::end(detail::copy_binary_header));
+                s.started = true;
+            }
+            const auto& oid_map = get_connection(ctx_).oid_map();
+            std::size_t rows = 0;
+            for (; s.next != end(s.rows) && s.buffer.size() < copy_in_batch_size; ++s.next, ++rows) {
+                detail::send_copy_tuple(s.buffer, oid_map, *s.next);
+            }
+            get_statistics(ctx_).add_rows(rows, 0);
+            if (s.next == end(s.rows)) {
+                ostream out(s.buffer);
+                write(out, detail::copy_binary_trailer);
+                s.finished = true;
+            }
+        } catch (const std::exception& e) {
+            get_connection(ctx_).set_error_context(e.what());
+            return error::bad_copy_data;
+        }
+        return {};
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(get_handler(ctx_));
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(get_handler(ctx_)))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(get_handler(ctx_));
+    }
+};
+
+template <typename Context, typename State>
+async_put_copy_data_op(Context, binary_query, std::shared_ptr<State>) -> async_put_copy_data_op<Context, State>;
+
+#include <boost/asio/unyield.hpp>
+
+template <typename Context, typename Rows>
+inline void async_put_copy_data(Context&& ctx, binary_query query, Rows&& rows) {
+    using state_type = copy_in_state<Rows>;
+    auto state = std::allocate_shared<state_type>(
+        asio::get_associated_allocator(get_handler(ctx)), std::forward<Rows>(rows));
+    async_put_copy_data_op op{std::forward<Context>(ctx), std::move(query), std::move(state)};
+    op.perform();
+}
+
+template <typename Query, typename Rows, typename TimeConstraint, typename Handler>
+struct async_copy_in_op {
+    Query query_;
+    Rows rows_;
+    TimeConstraint time_constraint_;
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection conn) {
+        if (ec) {
+            return handler_(ec, std::move(conn));
+        }
+
+        auto handler = make_request_handler(conn, time_constraint_, std::move(handler_));
+
+        auto query = to_binary_query(std::move(query_), unwrap_connection(conn).oid_map(),
+                        detail::get_query_allocator(unwrap_connection(conn),
+                            asio::get_associated_allocator(handler)));
+
+        auto ctx = make_request_operation_context(std::move(conn), std::move(handler));
+
+        async_put_copy_data(std::move(ctx), std::move(query), std::forward<Rows>(rows_));
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename P, typename Q, typename Rows, typename TimeConstraint, typename Handler>
+inline void async_copy_in(P&& provider, Q&& query, Rows&& rows, TimeConstraint t, Handler&& handler) {
+    static_assert(ConnectionProvider<P>, "is not a ConnectionProvider");
+    static_assert(BinaryQueryConvertible<Q>, "query should be convertible to the binary_query");
+    static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+    async_get_connection(std::forward<P>(provider), deadline(t),
+        async_copy_in_op<std::decay_t<Q>, Rows, decltype(deadline(t)), std::decay_t<Handler>>{
+            std::forward<Q>(query),
+            std::forward<Rows>(rows),
+            deadline(t),
+            std::forward<Handler>(handler)
+        }
+    );
+}
+
+} // namespace bozo::impl
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <bozo/impl/async_copy_in.h>
+#include <bozo/pg/handle.h>
+
+namespace bozo::impl {
+
+/**
+ * Output of the rows copied out of a database. Rows are appended via an insert
+ * iterator or passed to the callback of `bozo::row_stream`.
+ */
+template <typename Out, typename = std::void_t<>>
+struct copy_out_sink {
+    static_assert(InsertIterator<Out>, "copy_out output should be an InsertIterator or a row_stream");
+
+    using row_type = typename Out::container_type::value_type;
+
+    Out out;
+
+    void operator() (row_type&& row) { *out++ = std::move(row);}
+};
+
+template <typename Out>
+struct copy_out_sink<Out, Require<RowStream<Out>>> {
+    using row_type = typename Out::row_type;
+
+    Out out;
+
+    void operator() (row_type&& row) { out.callback()(std::move(row));}
+};
+
+/**
+ * Output of the rows and the state of the binary `COPY` data stream.
+ * The state is allocated once per operation, so the output is not moved
+ * along with the operation object between the handlers.
+ */
+template <typename Out>
+struct copy_out_state {
+    copy_out_sink<Out> sink;
+    detail::copy_tuple_reader reader;
+    pg::buffer data;
+
+    copy_out_state(Out out) : sink{std::move(out)} {}
+};
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Sends the `COPY ... TO STDOUT` query and receives the rows of the binary `COPY`
+ * data one by one as they come from the server. Each row is decoded and passed to
+ * the output at once, so memory consumption does not depend on the number of rows.
+ */
+template <typename Context, typename State>
+struct async_get_copy_data_op : boost::asio::coroutine {
+    Context ctx_;
+    binary_query query_;
+    std::shared_ptr<State> state_;
+    using result_type = std::decay_t<decltype(get_result(get_connection(ctx_)))>;
+    result_type result_;
+    int size_ = 0;
+    query_state flush_state_ = query_state::send_finish;
+
+    async_get_copy_data_op(Context ctx, binary_query query, std::shared_ptr<State> state)
+    : ctx_(std::move(ctx)), query_(std::move(query)), state_(std::move(state)) {}
+
+    void perform() {
+        decltype(auto) conn = get_connection(ctx_);
+        if (auto ec = set_nonblocking(conn)) {
+            return done(ec);
+        }
+
+        get_statistics(ctx_).set_query(query_);
+        if (!send_query(conn, query_)) {
+            return done(error::pg_send_query_params_failed);
+        }
+
+        (*this)();
+    }
+
+    void done() {
+        return impl::done(ctx_);
+    }
+
+    void done(error_code ec) {
+        if (std::empty(get_error_context(get_connection(ctx_)))) {
+            get_connection(ctx_).set_error_context("error while copy data out");
+        }
+        return impl::done(ctx_, ec);
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+
+        if (ec) {
+            if (ec == asio::error::bad_descriptor) {
+                ec = asio::error::operation_aborted;
+            }
+            return done(ec);
+        }
+
+        reenter(*this) {
+            while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                yield get_connection(ctx_).async_wait_write(std::move(*this));
+            }
+            if (flush_state_ == query_state::error) {
+                return done(error::pg_flush_failed);
+            }
+            get_statistics(ctx_).mark_sent();
+
+            while (is_busy(get_connection(ctx_))) {
+                yield get_connection(ctx_).async_wait_read(std::move(*this));
+                if (auto err = consume_input(get_connection(ctx_))) {
+                    return done(err);
+                }
+            }
+
+            result_ = get_result(get_connection(ctx_));
+            get_statistics(ctx_).mark_first_byte();
+
+            if (!result_) {
+                get_connection(ctx_).set_error_context("no result for COPY query");
+                return done(error::result_status_unexpected);
+            }
+
+            if (result_status(*result_) != PGRES_COPY_OUT) {
+                // The query has failed, so consume the rest of its results
+                do {
+                    while (is_busy(get_connection(ctx_))) {
+                        yield get_connection(ctx_).async_wait_read(std::move(*this));
+                        if (consume_input(get_connection(ctx_))) {
+                            return done(result_error());
+                        }
+                    }
+                } while (get_result(get_connection(ctx_)));
+                return done(result_error());
+            }
+
+            while ((size_ = get_copy_data(get_connection(ctx_), state_->data)) >= 0) {
+                if (size_ > 0) {
+                    if (auto err = read_rows()) {
+                        return done(err);
+                    }
+                } else {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    if (auto err = consume_input(get_connection(ctx_))) {
+                        return done(err);
+                    }
+                }
+            }
+            if (size_ != -1) {
+                return done(error::pg_get_copy_data_failed);
+            }
+            get_statistics(ctx_).mark_received();
+
+            while (is_busy(get_connection(ctx_))) {
+                yield get_connection(ctx_).async_wait_read(std::move(*this));
+                if (auto err = consume_input(get_connection(ctx_))) {
+                    return done(err);
+                }
+            }
+
+            result_ = get_result(get_connection(ctx_));
+
+            if (!result_) {
+                get_connection(ctx_).set_error_context("no result for COPY query");
+                return done(error::result_status_unexpected);
+            }
+
+            do {
+                while (is_busy(get_connection(ctx_))) {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    if (consume_input(get_connection(ctx_))) {
+                        return done(result_error());
+                    }
+                }
+            } while (get_result(get_connection(ctx_)));
+
+            if (result_status(*result_) != PGRES_COMMAND_OK) {
+                return done(result_error());
+            }
+
+            done();
+        }
+    }
+
+    error_code result_error() {
+        const auto status = result_status(*result_);
+        if (status == PGRES_FATAL_ERROR) {
+            return impl::result_error(*result_);
+        }
+        const auto retval = get_copy_result_error(status);
+        if (retval == error::result_status_unexpected) {
+            get_connection(ctx_).set_error_context(get_result_status_name(status));
+        }
+        return retval;
+    }
+
+    // Decodes the rows of the data received and passes them to the output, the buffer
+    // is released right away.
+    error_code read_rows() noexcept {
+        auto& s = *state_;
+        std::size_t rows = 0;
+        try {
+            using row_type = typename decltype(s.sink)::row_type;
+            get_statistics(ctx_).decode([&] {
+                s.reader.template read<row_type>(s.data.get(), static_cast<std::size_t>(size_),
+                    get_connection(ctx_).oid_map(), [&](row_type&& row) { ++rows; s.sink(std::move(row));});
+            });
+        } catch (const std::exception& e) {
+            get_statistics(ctx_).add_rows(rows, static_cast<std::size_t>(size_));
+            s.data.reset();
+            get_connection(ctx_).set_error_context(e.what());
+            return error::bad_result_process;
+        }
+        get_statistics(ctx_).add_rows(rows, static_cast<std::size_t>(size_));
+        s.data.reset();
+        return {};
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(get_handler(ctx_));
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(get_handler(ctx_)))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(get_handler(ctx_));
+    }
+};
+
+template <typename Context, typename State>
+async_get_copy_data_op(Context, binary_query, std::shared_ptr<State>) -> async_get_copy_data_op<Context, State>;
+
+#include <boost/asio/unyield.hpp>
+
+template <typename Context, typename Out>
+inline void async_get_copy_data(Context&& ctx, binary_query query, Out&& out) {
+    using state_type = copy_out_state<std::decay_t<Out>>;
+    auto state = std::allocate_shared<state_type>(
+        asio::get_associated_allocator(get_handler(ctx)), std::forward<Out>(out));
+    async_get_copy_data_op op{std::forward<Context>(ctx), std::move(query), std::move(state)};
+    op.perform();
+}
+
+template <typename Query, typename Out, typename TimeConstraint, typename Handler>
+struct async_copy_out_op {
+    Query query_;
+    Out out_;
+    TimeConstraint time_constraint_;
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection conn) {
+        if (ec) {
+            return handler_(ec, std::move(conn));
+        }
+
+        auto handler = make_request_handler(conn, time_constraint_, std::move(handler_));
+
+        auto query = to_binary_query(std::move(query_), unwrap_connection(conn).oid_map(),
+                        detail::get_query_allocator(unwrap_connection(conn),
+                            asio::get_associated_allocator(handler)));
+
+        auto ctx = make_request_operation_context(std::move(conn), std::move(handler));
+
+        async_get_copy_data(std::move(ctx), std::move(query), std::move(out_));
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename P, typename Q, typename Out, typename TimeConstraint, typename Handler>
+inline void async_copy_out(P&& provider, Q&& query, Out&& out, TimeConstraint t, Handler&& handler) {
+    static_assert(ConnectionProvider<P>, "is not a ConnectionProvider");
+    static_assert(BinaryQueryConvertible<Q>, "query should be convertible to the binary_query");
+    static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+    async_get_connection(std::forward<P>(provider), deadline(t),
+        async_copy_out_op<std::decay_t<Q>, std::decay_t<Out>, decltype(deadline(t)), std::decay_t<Handler>>{
+            std::forward<Q>(query),
+            std::forward<Out>(out),
+            deadline(t),
+            std::forward<Handler>(handler)
+        }
+    );
+}
+
+} // namespace bozo::impl
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <bozo/impl/async_request.h>
+#include <bozo/detail/base36.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace bozo {
+
+/**
+ * @brief Cursor configuration
+ * @ingroup group-requests-types
+ *
+ * Configuration of the `bozo::cursor`, i.e. how many rows are fetched by a single `FETCH`.
+ * The number of rows of the next `FETCH` is estimated by the size of the previous batch
+ * to make a batch of about `batch_bytes` of data.
+ */
+struct cursor_config {
+    int initial_fetch_size = 1000; //!< number of rows to fetch by the first `FETCH`
+    int max_fetch_size = 100000; //!< maximum number of rows to fetch by a single `FETCH`
+    std::size_t batch_bytes = 1024 * 1024; //!< target size of the data of a single `FETCH`, 0 disables the adaptation
+};
+
+namespace impl {
+
+/**
+ * Name of a new cursor which is unique within the process, so cursors
+ * of a transaction never clash.
+ */
+inline std::string make_cursor_name() {
+    static std::atomic<long> counter{0};
+    return "bozo_cursor_" + detail::ltob36(++counter);
+}
+
+/**
+ * Number of rows to fetch next so the batch would be of about `cursor_config::batch_bytes`
+ * of data, estimated by the number of rows and the data size of the previous batch.
+ */
+inline int next_fetch_size(const cursor_config& config, int rows, std::size_t bytes) noexcept {
+    const auto max = std::max(config.max_fetch_size, 1);
+    if (config.batch_bytes == 0) {
+        return std::clamp(rows, 1, max);
+    }
+    if (bytes == 0) {
+        return max;
+    }
+    const auto estimate = config.batch_bytes * static_cast<std::size_t>(std::max(rows, 1)) / bytes;
+    return static_cast<int>(std::clamp<std::size_t>(estimate, 1, static_cast<std::size_t>(max)));
+}
+
+template <typename Result>
+inline std::size_t result_data_size(const Result& res) noexcept {
+    const int rows = ntuples(res);
+    const int columns = nfields(res);
+    std::size_t size = 0;
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            size += get_length(res, row, column);
+        }
+    }
+    return size;
+}
+
+template <typename Query, typename OidMap, typename Allocator>
+inline binary_query make_declare_cursor_query(const std::string& name, const Query& query,
+        const OidMap& oid_map, const Allocator& allocator) {
+    static_assert(bozo::Query<Query>, "cursor query should model Query concept");
+    return binary_query("DECLARE " + name + " NO SCROLL CURSOR FOR " + to_const_char(get_query_text(query)),
+        get_query_params(query), oid_map, allocator);
+}
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Declares the cursor and fetches its rows batch by batch. The next `FETCH`
+ * is sent as soon as the previous batch has been received, so the database
+ * prepares the next batch while the previous one is being decoded. The cursor
+ * is closed once a batch is shorter than requested, the last batch is decoded
+ * while `CLOSE` is in flight.
+ */
+template <typename Context, typename ResultProcessor>
+struct async_cursor_op : boost::asio::coroutine {
+    enum class step { declare, fetch, close };
+
+    Context ctx_;
+    std::string name_;
+    binary_query query_;
+    ResultProcessor process_;
+    cursor_config config_;
+    int fetch_size_;
+    step step_ = step::declare;
+    using result_type = std::decay_t<decltype(get_result(get_connection(ctx_)))>;
+    result_type result_{};
+    result_type batch_{};
+    query_state flush_state_ = query_state::send_finish;
+
+    async_cursor_op(Context ctx, std::string name, binary_query query, ResultProcessor process,
+            const cursor_config& config)
+    : ctx_(std::move(ctx)), name_(std::move(name)), query_(std::move(query)), process_(std::move(process)),
+      config_(config), fetch_size_(std::clamp(config.initial_fetch_size, 1, std::max(config.max_fetch_size, 1))) {}
+
+    void perform() {
+        decltype(auto) conn = get_connection(ctx_);
+        if (auto ec = set_nonblocking(conn)) {
+            return done(ec);
+        }
+
+        get_statistics(ctx_).set_query(query_);
+        if (!send_query(conn, query_)) {
+            return done(error::pg_send_query_params_failed);
+        }
+
+        (*this)();
+    }
+
+    void done() {
+        get_statistics(ctx_).mark_received();
+        return impl::done(ctx_);
+    }
+
+    void done(error_code ec) {
+        if (std::empty(get_error_context(get_connection(ctx_)))) {
+            get_connection(ctx_).set_error_context("error while fetch cursor rows");
+        }
+        return impl::done(ctx_, ec);
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+
+        if (ec) {
+            if (ec == asio::error::bad_descriptor) {
+                ec = asio::error::operation_aborted;
+            }
+            return done(ec);
+        }
+
+        reenter(*this) {
+            for (;;) {
+                while ((flush_state_ = flush_output(get_connection(ctx_))) == query_state::send_in_progress) {
+                    yield get_connection(ctx_).async_wait_write(std::move(*this));
+                }
+                if (flush_state_ == query_state::error) {
+                    return done(error::pg_flush_failed);
+                }
+                get_statistics(ctx_).mark_sent();
+
+                // The next query is on the wire, so the batch is decoded
+                // while the database performs it.
+                if (auto err = process_batch()) {
+                    return done(err);
+                }
+
+                while (is_busy(get_connection(ctx_))) {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    get_statistics(ctx_).mark_first_byte();
+                    if (auto err = consume_input(get_connection(ctx_))) {
+                        return done(err);
+                    }
+                }
+
+                result_ = get_result(get_connection(ctx_));
+
+                if (!result_) {
+                    get_connection(ctx_).set_error_context("no result for cursor query");
+                    return done(error::result_status_unexpected);
+                }
+
+                do {
+                    while (is_busy(get_connection(ctx_))) {
+                        yield get_connection(ctx_).async_wait_read(std::move(*this));
+                        if (auto err = consume_input(get_connection(ctx_))) {
+                            return done(err);
+                        }
+                    }
+                } while (get_result(get_connection(ctx_)));
+
+                if (auto err = result_error()) {
+                    return done(err);
+                }
+
+                if (step_ == step::close) {
+                    return done();
+                }
+
+                if (auto err = send_next()) {
+                    return done(err);
+                }
+            }
+        }
+    }
+
+    error_code result_error() {
+        const auto status = result_status(*result_);
+        switch (status) {
+            case PGRES_TUPLES_OK:
+                if (step_ == step::fetch) {
+                    return {};
+                }
+                break;
+            case PGRES_COMMAND_OK:
+                if (step_ != step::fetch) {
+                    return {};
+                }
+                break;
+            case PGRES_BAD_RESPONSE:
+                return error::result_status_bad_response;
+            case PGRES_EMPTY_QUERY:
+                return error::result_status_empty_query;
+            case PGRES_FATAL_ERROR:
+                return impl::result_error(*result_);
+            default:
+                break;
+        }
+        get_connection(ctx_).set_error_context(get_result_status_name(status));
+        return error::result_status_unexpected;
+    }
+
+    // Sends the next FETCH if the batch received is full, otherwise the cursor
+    // is exhausted and it is closed.
+    error_code send_next() {
+        bool exhausted = false;
+        if (step_ == step::fetch) {
+            const int rows = ntuples(*result_);
+            exhausted = rows < fetch_size_;
+            if (!exhausted) {
+                fetch_size_ = next_fetch_size(config_, rows, result_data_size(*result_));
+            }
+            batch_ = std::move(result_);
+        }
+
+        std::string text;
+        if (exhausted) {
+            step_ = step::close;
+            text = "CLOSE " + name_;
+        } else {
+            step_ = step::fetch;
+            text = "FETCH " + std::to_string(fetch_size_) + " FROM " + name_;
+        }
+        if (!send_query(get_connection(ctx_), binary_query(std::move(text), hana::make_tuple(), empty_oid_map{}))) {
+            return error::pg_send_query_params_failed;
+        }
+        return {};
+    }
+
+    error_code process_batch() noexcept {
+        if (!batch_) {
+            return {};
+        }
+        try {
+            get_statistics(ctx_).add_result(*batch_);
+            get_statistics(ctx_).decode([&] { process_(std::move(batch_), get_connection(ctx_));});
+        } catch (const std::exception& e) {
+            get_connection(ctx_).set_error_context(e.what());
+            return error::bad_result_process;
+        }
+        batch_ = result_type{};
+        return {};
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(get_handler(ctx_));
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(get_handler(ctx_)))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(get_handler(ctx_));
+    }
+};
+
+template <typename Context, typename ResultProcessor>
+async_cursor_op(Context, std::string, binary_query, ResultProcessor, const cursor_config&)
+    -> async_cursor_op<Context, ResultProcessor>;
+
+#include <boost/asio/unyield.hpp>
+
+template <typename Context, typename ResultProcessor>
+inline void async_fetch_cursor(Context&& ctx, std::string name, binary_query query,
+        ResultProcessor&& p, const cursor_config& config) {
+    async_cursor_op op{std::forward<Context>(ctx), std::move(name), std::move(query),
+        std::forward<ResultProcessor>(p), config};
+    op.perform();
+}
+
+template <typename Query, typename Out, typename TimeConstraint, typename Handler>
+struct async_cursor_start_op {
+    Query query_;
+    Out out_;
+    cursor_config config_;
+    TimeConstraint time_constraint_;
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection conn) {
+        if (ec) {
+            return handler_(ec, std::move(conn));
+        }
+
+        auto handler = make_request_handler(conn, time_constraint_, std::move(handler_));
+
+        auto name = make_cursor_name();
+        auto query = make_declare_cursor_query(name, query_, unwrap_connection(conn).oid_map(),
+                        detail::get_query_allocator(unwrap_connection(conn),
+                            asio::get_associated_allocator(handler)));
+
+        // The cursor is fetched by the single operation which owns the context.
+        request_operation_context<Connection, decltype(handler)> ctx{std::move(conn), std::move(handler)};
+
+        async_fetch_cursor(std::move(ctx), std::move(name), std::move(query),
+            make_request_out_handler(std::move(out_)), config_);
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename P, typename Q, typename Out, typename TimeConstraint, typename Handler>
+inline void async_cursor(P&& provider, Q&& query, Out&& out, const cursor_config& config,
+        TimeConstraint t, Handler&& handler) {
+    static_assert(ConnectionProvider<P>, "is not a ConnectionProvider");
+    static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+    async_get_connection(std::forward<P>(provider), deadline(t),
+        async_cursor_start_op<std::decay_t<Q>, std::decay_t<Out>, decltype(deadline(t)), std::decay_t<Handler>>{
+            std::forward<Q>(query),
+            std::forward<Out>(out),
+            config,
+            deadline(t),
+            std::forward<Handler>(handler)
+        }
+    );
+}
+
+} // namespace impl
+} // namespace bozo
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <bozo/impl/async_request.h>
+
+#include <boost/hana/ext/std/tuple.hpp>
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
+#include <boost/hana/range.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <array>
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+namespace bozo::impl {
+
+/**
+ * Queries to be sent within a single pipeline and synchronized by
+ * the one sync point.
+ */
+template <std::size_t N>
+struct pipeline_queries {
+    std::array<binary_query, N> queries;
+};
+
+// The connection is in the pipeline mode already while the queries are being sent
+template <std::size_t N>
+struct close_on_send_failure<pipeline_queries<N>> : std::true_type {};
+
+template <typename T, std::size_t N>
+inline int send_query(T& conn, const pipeline_queries<N>& q) noexcept {
+    for (const auto& query : q.queries) {
+        if (!send_query_params(conn, query)) {
+            return 0;
+        }
+    }
+    return pipeline_sync(conn);
+}
+
+template <typename Queries, typename Connection, typename Allocator>
+inline auto make_pipeline_queries(Queries&& queries, const Connection& conn, const Allocator& alloc) {
+    return hana::unpack(std::forward<Queries>(queries), [&](auto&& ...q) {
+        return pipeline_queries<sizeof...(q)>{{
+            to_binary_query(std::forward<decltype(q)>(q), conn.oid_map(), alloc)...
+        }};
+    });
+}
+
+template <typename Out>
+inline auto make_pipeline_out_handler(Out&& out) {
+    static_assert(!RowStream<Out>, "row stream output is not supported within a pipeline");
+    if constexpr (IsNone<Out>) {
+        return none;
+    } else if constexpr (std::is_lvalue_reference_v<Out>) {
+        // Reference element of outputs tuple, e.g. made by std::make_tuple(std::ref(v))
+        return async_request_out_handler{std::ref(out)};
+    } else {
+        return async_request_out_handler{std::forward<Out>(out)};
+    }
+}
+
+template <typename Outs>
+inline auto make_pipeline_out_handlers(Outs&& outs) {
+    return hana::unpack(std::forward<Outs>(outs), [](auto&& ...out) {
+        return hana::make_tuple(make_pipeline_out_handler(std::forward<decltype(out)>(out))...);
+    });
+}
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Receives results of the pipelined queries in order of the queries and
+ * demultiplexes them into the corresponding result processors. All the results
+ * are consumed up to the sync point even if some query fails, then the first
+ * error occurred is reported. Statistics are recorded per query, each query is
+ * accounted as failed if the pipeline has failed.
+ */
+template <typename Context, typename ResultProcessors>
+struct async_get_pipeline_results_op : boost::asio::coroutine {
+    Context ctx_;
+    ResultProcessors process_;
+    using result_type = std::decay_t<decltype(get_result(get_connection(ctx_)))>;
+    result_type result_;
+    std::size_t index_ = 0;
+    error_code ec_;
+
+    static constexpr std::size_t size = decltype(hana::length(process_))::value;
+
+    using statistics_type = detail::request_statistics_t<decltype(get_connection(std::declval<Context&>()))>;
+    std::array<statistics_type, size> statistics_;
+
+    async_get_pipeline_results_op(Context ctx, ResultProcessors process)
+    : ctx_(std::move(ctx)), process_(std::move(process)) {}
+
+    void perform() {
+        (*this)();
+    }
+
+    template <std::size_t N>
+    void set_queries(const pipeline_queries<N>& q) noexcept {
+        static_assert(N == size, "number of queries should be equal to the number of result processors");
+        for (std::size_t i = 0; i != N; ++i) {
+            statistics_[i].set_query(q.queries[i]);
+        }
+    }
+
+    void done() {
+        if (ec_) {
+            return done(ec_);
+        }
+        update_statistics(false);
+        return impl::done(ctx_);
+    }
+
+    void done(error_code ec) {
+        if (std::empty(get_error_context(get_connection(ctx_)))) {
+            get_connection(ctx_).set_error_context("error while get pipeline results");
+        }
+        update_statistics(true);
+        return impl::done(ctx_, ec);
+    }
+
+    void update_statistics(bool failed) noexcept {
+        for (auto& statistics : statistics_) {
+            statistics.update(get_connection(ctx_), failed);
+        }
+    }
+
+    // The connection stays in the pipeline mode with the results of the pipeline
+    // pending, PQexitPipelineMode fails in this state, so the connection is closed
+    // to do not return it into a pool.
+    void abort(error_code ec) {
+        close_connection(get_connection(ctx_));
+        return done(ec);
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+
+        if (ec) {
+            if (ec == asio::error::bad_descriptor) {
+                ec = asio::error::operation_aborted;
+            }
+            return abort(ec);
+        }
+
+        reenter(*this) {
+            for (; index_ != size; ++index_) {
+                while (is_busy(get_connection(ctx_))) {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    if (auto err = consume_input(get_connection(ctx_))) {
+                        return abort(err);
+                    }
+                }
+
+                result_ = get_result(get_connection(ctx_));
+                statistics_[index_].mark_sent(get_statistics(ctx_));
+                statistics_[index_].mark_first_byte();
+
+                if (!result_) {
+                    get_connection(ctx_).set_error_context("no result for pipelined query");
+                    return abort(error::result_status_unexpected);
+                }
+
+                handle_result();
+
+                do {
+                    while (is_busy(get_connection(ctx_))) {
+                        yield get_connection(ctx_).async_wait_read(std::move(*this));
+                        if (auto err = consume_input(get_connection(ctx_))) {
+                            return abort(err);
+                        }
+                    }
+                } while (get_result(get_connection(ctx_)));
+                statistics_[index_].mark_received();
+            }
+
+            while (is_busy(get_connection(ctx_))) {
+                yield get_connection(ctx_).async_wait_read(std::move(*this));
+                if (auto err = consume_input(get_connection(ctx_))) {
+                    return abort(err);
+                }
+            }
+
+            result_ = get_result(get_connection(ctx_));
+
+            if (!result_ || result_status(*result_) != PGRES_PIPELINE_SYNC) {
+                get_connection(ctx_).set_error_context("no pipeline sync result");
+                return abort(error::result_status_unexpected);
+            }
+
+            if (auto err = exit_pipeline_mode(get_connection(ctx_))) {
+                return abort(err);
+            }
+
+            done();
+        }
+    }
+
+    void set_error(error_code ec) {
+        if (!ec_) {
+            ec_ = std::move(ec);
+        }
+    }
+
+    void handle_result() {
+        const auto status = result_status(*result_);
+        switch (status) {
+            case PGRES_SINGLE_TUPLE:
+            case PGRES_TUPLES_OK:
+            case PGRES_COMMAND_OK:
+                process(std::move(result_));
+                return;
+            case PGRES_BAD_RESPONSE:
+                set_error(error::result_status_bad_response);
+                return;
+            case PGRES_EMPTY_QUERY:
+                set_error(error::result_status_empty_query);
+                return;
+            case PGRES_FATAL_ERROR:
+                set_error(result_error(*result_));
+                return;
+            case PGRES_PIPELINE_ABORTED:
+                // The query has been skipped due to the error of a previous one
+                // which has been set already.
+                return;
+            case PGRES_COPY_OUT:
+            case PGRES_COPY_IN:
+            case PGRES_COPY_BOTH:
+            case PGRES_NONFATAL_ERROR:
+            case PGRES_PIPELINE_SYNC:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+            case PGRES_TUPLES_CHUNK:
+#endif
+                break;
+        }
+
+        if (!ec_) {
+            get_connection(ctx_).set_error_context(get_result_status_name(status));
+        }
+        set_error(error::result_status_unexpected);
+    }
+
+    template <typename Result>
+    void process(Result&& res) noexcept {
+        if (ec_) {
+            return;
+        }
+        try {
+            hana::for_each(hana::make_range(hana::size_c<0>, hana::size_c<size>), [&](auto i) {
+                if (i == index_) {
+                    statistics_[i].add_result(*res);
+                    statistics_[i].decode([&] { process_[i](std::forward<Result>(res), get_connection(ctx_));});
+                }
+            });
+        } catch (const std::exception& e) {
+            get_connection(ctx_).set_error_context(e.what());
+            set_error(error::bad_result_process);
+        }
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(get_handler(ctx_));
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(get_handler(ctx_)))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(get_handler(ctx_));
+    }
+};
+
+template <typename Context, typename ResultProcessors>
+async_get_pipeline_results_op(Context, ResultProcessors) -> async_get_pipeline_results_op<Context, ResultProcessors>;
+
+#include <boost/asio/unyield.hpp>
+
+template <typename Context, typename ResultProcessors>
+inline void async_get_pipeline_results(Context&& ctx, ResultProcessors&& p) {
+    async_get_pipeline_results_op op{std::forward<Context>(ctx), std::forward<ResultProcessors>(p)};
+    op.perform();
+}
+
+template <typename Queries, typename TimeConstraint, typename Outs, typename Handler>
+struct async_pipeline_op {
+    Queries queries_;
+    TimeConstraint time_constraint_;
+    Outs outs_;
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection conn) {
+        if (ec) {
+            return handler_(ec, std::move(conn));
+        }
+
+        auto handler = make_request_handler(conn, time_constraint_, std::move(handler_));
+
+        auto queries = make_pipeline_queries(std::move(queries_), unwrap_connection(conn),
+                            detail::get_query_allocator(unwrap_connection(conn),
+                                asio::get_associated_allocator(handler)));
+
+        auto ctx = make_request_operation_context(std::move(conn), std::move(handler));
+
+        if (auto err = enter_pipeline_mode(get_connection(ctx))) {
+            return done(ctx, err);
+        }
+
+        async_get_pipeline_results_op results_op{ctx, make_pipeline_out_handlers(std::move(outs_))};
+        results_op.set_queries(queries);
+
+        async_send_query_params_op send_op{ctx, std::move(queries)};
+        send_op.perform();
+
+        results_op.perform();
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename Queries, typename TimeConstraint, typename Outs, typename Handler>
+async_pipeline_op(Queries, TimeConstraint, Outs, Handler) -> async_pipeline_op<Queries, TimeConstraint, Outs, Handler>;
+
+template <typename P, typename Queries, typename TimeConstraint, typename Outs, typename Handler>
+inline void async_pipeline(P&& provider, Queries&& queries, TimeConstraint t, Outs&& outs, Handler&& handler) {
+    static_assert(ConnectionProvider<P>, "is not a ConnectionProvider");
+    static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+    static_assert(decltype(hana::length(queries) == hana::length(outs))::value,
+        "number of outputs should be equal to the number of queries");
+    async_get_connection(std::forward<P>(provider), deadline(t),
+        async_pipeline_op{
+            std::forward<Queries>(queries),
+            deadline(t),
+            std::forward<Outs>(outs),
+            std::forward<Handler>(handler)
+        }
+    );
+}
+
+} // namespace bozo::impl
+
+#endif
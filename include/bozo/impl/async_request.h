@@ -1,6 +1,10 @@
 #pragma once
 
 #include <bozo/detail/deadline.h>
+#include <bozo/detail/query_arena.h>
+#include <bozo/detail/recycling_allocator.h>
+#include <bozo/detail/request_statistics.h>
+#include <bozo/detail/statement_cache.h>
 #include <bozo/detail/timeout_handler.h>
 #include <bozo/detail/wrap_executor.h>
 #include <bozo/impl/io.h>
@@ -8,6 +12,7 @@
 #include <bozo/connection.h>
 #include <bozo/query_builder.h>
 #include <bozo/deadline.h>
+#include <bozo/row_stream.h>
 
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/coroutine.hpp>
@@ -20,6 +25,7 @@ struct request_operation_context {
     std::decay_t<Connection> conn;
     std::decay_t<Handler> handler;
     query_state state = query_state::send_in_progress;
+    detail::request_statistics_t<decltype(unwrap_connection(std::declval<std::decay_t<Connection>&>()))> statistics;
 
     request_operation_context(Connection conn, Handler handler)
       : conn(std::forward<Connection>(conn)),
@@ -28,7 +34,7 @@ struct request_operation_context {
 
 template <typename Connection, typename Handler>
 inline decltype(auto) make_request_operation_context(Connection&& conn, Handler&& h) {
-    auto allocator = asio::get_associated_allocator(h);
+    auto allocator = detail::get_recycling_allocator(asio::get_associated_allocator(h));
     return std::allocate_shared<request_operation_context<Connection, Handler>>(
         allocator, std::forward<Connection>(conn), std::forward<Handler>(h)
     );
@@ -58,34 +64,152 @@ auto& get_handler(const request_operation_context_ptr<Ts ...>& context) noexcept
     return context->handler;
 }
 
+template <typename ...Ts>
+inline auto& get_statistics(const request_operation_context_ptr<Ts...>& ctx) noexcept {
+    return ctx->statistics;
+}
+
 template <typename ...Ts>
 inline void done(const request_operation_context_ptr<Ts...>& ctx, error_code ec) {
     set_query_state(ctx, query_state::error);
     get_connection(ctx).cancel();
+    get_statistics(ctx).update(get_connection(ctx), true);
     std::move(get_handler(ctx))(std::move(ec), ctx->conn);
 }
 
 template <typename ...Ts>
 inline void done(const request_operation_context_ptr<Ts...>& ctx) {
+    get_statistics(ctx).update(get_connection(ctx), false);
     std::move(get_handler(ctx))(error_code {}, ctx->conn);
 }
 
-template <typename Context>
+// The context may be owned by the operation itself rather than shared between
+// the send and the receive operations, then it is moved from one operation
+// to another without any allocation or reference counting.
+
+template <typename ...Ts>
+inline auto& get_connection(request_operation_context<Ts...>& ctx) noexcept {
+    return unwrap_connection(ctx.conn);
+}
+
+template <typename ...Ts>
+inline query_state get_query_state(const request_operation_context<Ts...>& ctx) noexcept {
+    return ctx.state;
+}
+
+template <typename ...Ts>
+inline void set_query_state(request_operation_context<Ts...>& ctx, query_state state) noexcept {
+    ctx.state = state;
+}
+
+template <typename ...Ts>
+auto& get_handler(request_operation_context<Ts...>& ctx) noexcept {
+    return ctx.handler;
+}
+
+template <typename ...Ts>
+const auto& get_handler(const request_operation_context<Ts...>& ctx) noexcept {
+    return ctx.handler;
+}
+
+template <typename ...Ts>
+inline auto& get_statistics(request_operation_context<Ts...>& ctx) noexcept {
+    return ctx.statistics;
+}
+
+template <typename ...Ts>
+inline void done(request_operation_context<Ts...>& ctx, error_code ec) {
+    set_query_state(ctx, query_state::error);
+    get_connection(ctx).cancel();
+    get_statistics(ctx).update(get_connection(ctx), true);
+    std::move(ctx.handler)(std::move(ec), std::move(ctx.conn));
+}
+
+template <typename ...Ts>
+inline void done(request_operation_context<Ts...>& ctx) {
+    get_statistics(ctx).update(get_connection(ctx), false);
+    std::move(ctx.handler)(error_code {}, std::move(ctx.conn));
+}
+
+/**
+ * Query to prepare a statement with the given name on the server.
+ */
+struct prepare_statement {
+    std::string name;
+    binary_query query;
+};
+
+/**
+ * Query to execute the statement prepared with the given name.
+ */
+struct prepared_statement {
+    std::string name;
+    binary_query query;
+};
+
+/**
+ * Query to deallocate a prepared statement, it is not accounted in the statistics.
+ */
+struct deallocate_statement {
+    binary_query query;
+};
+
+template <typename T>
+inline int send_query(T& conn, const binary_query& q) noexcept {
+    return send_query_params(conn, q);
+}
+
+template <typename T>
+inline int send_query(T& conn, const prepare_statement& q) noexcept {
+    return send_prepare(conn, q.name.c_str(), q.query);
+}
+
+template <typename T>
+inline int send_query(T& conn, const prepared_statement& q) noexcept {
+    return send_query_prepared(conn, q.name.c_str(), q.query);
+}
+
+template <typename T>
+inline int send_query(T& conn, const deallocate_statement& q) noexcept {
+    return send_query_params(conn, q.query);
+}
+
+/**
+ * Query which leaves the connection unusable if it has not been sent completely,
+ * so the connection is closed on the send failure instead of being reused.
+ */
+template <typename Query>
+struct close_on_send_failure : std::false_type {};
+
+/**
+ * Sends the query to the server. If the continuation is given the operation
+ * passes the context to it when the query has been sent, otherwise the context
+ * should be shared with the operation which receives the result concurrently.
+ */
+template <typename Context, typename Query = binary_query, typename Continuation = none_t>
 struct async_send_query_params_op {
     Context ctx_;
-    binary_query query_;
+    Query query_;
+    Continuation next_;
 
-    async_send_query_params_op(Context ctx, binary_query query)
-    : ctx_(std::move(ctx)), query_(std::move(query)) {}
+    async_send_query_params_op(Context ctx, Query query, Continuation next = Continuation{})
+    : ctx_(std::move(ctx)), query_(std::move(query)), next_(std::move(next)) {}
+
+    void fail(error_code ec) {
+        if constexpr (close_on_send_failure<Query>::value) {
+            close_connection(get_connection(ctx_));
+        }
+        done(ctx_, std::move(ec));
+    }
 
     void perform() {
         decltype(auto) conn = get_connection(ctx_);
         if (auto ec = set_nonblocking(conn)) {
-            return done(ctx_, ec);
+            return fail(ec);
         }
 
-        if (!send_query_params(conn, query_)) {
-            return done(ctx_, error::pg_send_query_params_failed);
+        if (!send_query(conn, query_)) {
+            return fail(error::pg_send_query_params_failed);
         }
 
         (*this)();
@@ -102,24 +226,44 @@ struct async_send_query_params_op {
         // In case of write operation error - finish the request
         // with error.
         if (ec) {
-            return done(ctx_, ec);
+            return fail(ec);
         }
 
         // Trying to flush output one more time according to the
         // documentation
         switch (flush_output(get_connection(ctx_))) {
             case query_state::error:
-                done(ctx_, error::pg_flush_failed);
+                fail(error::pg_flush_failed);
                 break;
             case query_state::send_in_progress:
-                get_connection(ctx_).async_wait_write(std::move(*this));
+                if constexpr (IsNone<Continuation>) {
+                    get_connection(ctx_).async_wait_write(std::move(*this));
+                } else {
+                    share_context();
+                }
                 break;
             case query_state::send_finish:
                 set_query_state(ctx_, query_state::send_finish);
+                get_statistics(ctx_).mark_sent();
+                if constexpr (!IsNone<Continuation>) {
+                    std::move(next_)(std::move(ctx_));
+                }
                 break;
         }
     }
 
+    // The query does not fit the socket buffer, so the rest of it is sent while
+    // the continuation reads the input concurrently, otherwise the server may
+    // get stuck on sending its output. This needs the context to be shared by
+    // the operations, so the owned one is moved into the shared one.
+    void share_context() {
+        auto ctx = make_request_operation_context(std::move(ctx_.conn), std::move(ctx_.handler));
+        ctx->statistics = std::move(ctx_.statistics);
+        async_send_query_params_op<decltype(ctx), Query> send{ctx, std::move(query_)};
+        get_connection(ctx).async_wait_write(std::move(send));
+        std::move(next_)(std::move(ctx));
+    }
+
     using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
 
     executor_type get_executor() const noexcept {
@@ -133,16 +277,40 @@ struct async_send_query_params_op {
     }
 };
 
-template <typename Context>
-async_send_query_params_op(Context, binary_query) -> async_send_query_params_op<Context>;
-
 template <typename Context, typename Query>
-void async_send_query_params(std::shared_ptr<Context> ctx, Query&& query) {
+async_send_query_params_op(Context, Query) -> async_send_query_params_op<Context, Query>;
+
+template <typename Context, typename Query, typename Continuation>
+async_send_query_params_op(Context, Query, Continuation) -> async_send_query_params_op<Context, Query, Continuation>;
+
+template <typename Context, typename Query, typename Continuation = none_t>
+void async_send_query_params(Context ctx, Query&& query, Continuation next = Continuation{}) {
     auto q = to_binary_query(std::forward<Query>(query),
                         get_connection(ctx).oid_map(),
-                        asio::get_associated_allocator(get_handler(ctx)));
+                        detail::get_query_allocator(get_connection(ctx),
+                            asio::get_associated_allocator(get_handler(ctx))));
+
+    get_statistics(ctx).set_query(q);
+    async_send_query_params_op op{std::move(ctx), std::move(q), std::move(next)};
+    op.perform();
+}
+
+template <typename Context, typename Continuation = none_t>
+void async_send_query_params(Context ctx, prepare_statement query, Continuation next = Continuation{}) {
+    async_send_query_params_op op{std::move(ctx), std::move(query), std::move(next)};
+    op.perform();
+}
 
-    async_send_query_params_op op{std::move(ctx), std::move(q)};
+template <typename Context, typename Continuation = none_t>
+void async_send_query_params(Context ctx, deallocate_statement query, Continuation next = Continuation{}) {
+    async_send_query_params_op op{std::move(ctx), std::move(query), std::move(next)};
+    op.perform();
+}
+
+template <typename Context, typename Continuation = none_t>
+void async_send_query_params(Context ctx, prepared_statement query, Continuation next = Continuation{}) {
+    get_statistics(ctx).set_query(query.query);
+    async_send_query_params_op op{std::move(ctx), std::move(query), std::move(next)};
     op.perform();
 }
 
@@ -156,7 +324,7 @@ struct async_get_result_op : boost::asio::coroutine {
     result_type result_;
 
     async_get_result_op(Context ctx, ResultProcessor process)
-    : ctx_(ctx), process_(process) {}
+    : ctx_(std::move(ctx)), process_(std::move(process)) {}
 
     void perform() {
         (*this)();
@@ -192,11 +360,13 @@ struct async_get_result_op : boost::asio::coroutine {
         reenter(*this) {
             while (is_busy(get_connection(ctx_))) {
                 yield get_connection(ctx_).async_wait_read(std::move(*this));
+                get_statistics(ctx_).mark_first_byte();
                 if (auto err = consume_input(get_connection(ctx_))) {
                     return done(err);
                 }
             }
 
+            get_statistics(ctx_).mark_first_byte();
             result_ = get_result(get_connection(ctx_));
 
             if (!result_) {
@@ -219,6 +389,7 @@ struct async_get_result_op : boost::asio::coroutine {
     }
 
     void handle_result() {
+        get_statistics(ctx_).mark_received();
         const auto status = result_status(*result_);
         switch (status) {
             case PGRES_SINGLE_TUPLE:
@@ -256,7 +427,8 @@ struct async_get_result_op : boost::asio::coroutine {
     template <typename Result>
     void process_and_done(Result&& res) noexcept {
         try {
-            process_(std::forward<Result>(res), get_connection(ctx_));
+            get_statistics(ctx_).add_result(*res);
+            get_statistics(ctx_).decode([&] { process_(std::forward<Result>(res), get_connection(ctx_));});
         } catch (const std::exception& e) {
             get_connection(ctx_).set_error_context(e.what());
             return done(error::bad_result_process);
@@ -282,10 +454,362 @@ async_get_result_op(Context, ResultProcessor) -> async_get_result_op<Context, Re
 
 #include <boost/asio/unyield.hpp>
 
+#include <boost/asio/yield.hpp>
+
+/**
+ * Receives a result of the query row by row in the libpq single-row mode or
+ * by chunks of rows in the chunked rows mode. Each partial result is passed to
+ * the processor as soon as it has been received. All the results are consumed
+ * up to the end of the query even if the query fails, then the first error
+ * occurred is reported. If the processor fails the rest of the results is
+ * abandoned.
+ */
+template <typename Context, typename RowsProcessor>
+struct async_get_rows_op : boost::asio::coroutine {
+    Context ctx_;
+    RowsProcessor process_;
+    int chunk_size_;
+    using result_type = std::decay_t<decltype(get_result(get_connection(ctx_)))>;
+    result_type result_;
+    error_code ec_;
+
+    async_get_rows_op(Context ctx, RowsProcessor process, int chunk_size)
+    : ctx_(std::move(ctx)), process_(std::move(process)), chunk_size_(chunk_size) {}
+
+    void perform() {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+        if (auto ec = set_rows_mode()) {
+            return done(ec);
+        }
+        (*this)();
+    }
+
+    error_code set_rows_mode() {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        if (chunk_size_ > 1) {
+            return set_chunked_rows_mode(get_connection(ctx_), chunk_size_);
+        }
+#endif
+        return set_single_row_mode(get_connection(ctx_));
+    }
+
+    void done() {
+        get_statistics(ctx_).mark_received();
+        if (ec_) {
+            return done(ec_);
+        }
+        return impl::done(ctx_);
+    }
+
+    void done(error_code ec) {
+        get_statistics(ctx_).mark_received();
+        if (std::empty(get_error_context(get_connection(ctx_)))) {
+            get_connection(ctx_).set_error_context("error while get request rows");
+        }
+        return impl::done(ctx_, ec);
+    }
+
+    void operator() (error_code ec = error_code{}, std::size_t = 0) {
+        if (get_query_state(ctx_) == query_state::error) {
+            return;
+        }
+
+        if (ec) {
+            if (ec == asio::error::bad_descriptor) {
+                ec = asio::error::operation_aborted;
+            }
+            return done(ec);
+        }
+
+        reenter(*this) {
+            for (;;) {
+                while (is_busy(get_connection(ctx_))) {
+                    yield get_connection(ctx_).async_wait_read(std::move(*this));
+                    get_statistics(ctx_).mark_first_byte();
+                    if (auto err = consume_input(get_connection(ctx_))) {
+                        return done(err);
+                    }
+                }
+
+                get_statistics(ctx_).mark_first_byte();
+                result_ = get_result(get_connection(ctx_));
+
+                if (!result_) {
+                    break;
+                }
+
+                if (!handle_result()) {
+                    return;
+                }
+            }
+
+            done();
+        }
+    }
+
+    void set_error(error_code ec) {
+        if (!ec_) {
+            ec_ = std::move(ec);
+        }
+    }
+
+    // Returns false if the operation has been completed due to the processor failure.
+    bool handle_result() {
+        const auto status = result_status(*result_);
+        switch (status) {
+            case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+            case PGRES_TUPLES_CHUNK:
+#endif
+            case PGRES_TUPLES_OK:
+            case PGRES_COMMAND_OK:
+                return process(std::move(result_));
+            case PGRES_BAD_RESPONSE:
+                set_error(error::result_status_bad_response);
+                return true;
+            case PGRES_EMPTY_QUERY:
+                set_error(error::result_status_empty_query);
+                return true;
+            case PGRES_FATAL_ERROR:
+                set_error(result_error(*result_));
+                return true;
+            case PGRES_COPY_OUT:
+            case PGRES_COPY_IN:
+            case PGRES_COPY_BOTH:
+            case PGRES_NONFATAL_ERROR:
+#ifdef LIBPQ_HAS_PIPELINING
+            case PGRES_PIPELINE_SYNC:
+            case PGRES_PIPELINE_ABORTED:
+#endif
+                break;
+        }
+
+        if (!ec_) {
+            get_connection(ctx_).set_error_context(get_result_status_name(status));
+        }
+        set_error(error::result_status_unexpected);
+        return true;
+    }
+
+    template <typename Result>
+    bool process(Result&& res) noexcept {
+        if (ec_) {
+            return true;
+        }
+        try {
+            get_statistics(ctx_).add_result(*res);
+            get_statistics(ctx_).decode([&] { process_(std::forward<Result>(res), get_connection(ctx_));});
+        } catch (const std::exception& e) {
+            get_connection(ctx_).set_error_context(e.what());
+            done(error::bad_result_process);
+            return false;
+        }
+        return true;
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(get_handler(ctx_)))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(get_handler(ctx_));
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(get_handler(ctx_)))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(get_handler(ctx_));
+    }
+};
+
+template <typename Context, typename RowsProcessor>
+async_get_rows_op(Context, RowsProcessor, int) -> async_get_rows_op<Context, RowsProcessor>;
+
+#include <boost/asio/unyield.hpp>
+
+template <typename Context, typename RowsProcessor>
+inline void async_get_rows(Context&& ctx, RowsProcessor&& p, int chunk_size) {
+    async_get_rows_op op{std::forward<Context>(ctx), std::forward<RowsProcessor>(p), chunk_size};
+    op.perform();
+}
+
 template <typename Context, typename ResultProcessor>
 inline void async_get_result(Context&& ctx, ResultProcessor&& p) {
-    async_get_result_op op{std::forward<Context>(ctx), std::forward<ResultProcessor>(p)};
-    op.perform();
+    if constexpr (RowStream<ResultProcessor>) {
+        const auto chunk_size = p.chunk_size();
+        async_get_rows(std::forward<Context>(ctx), std::forward<ResultProcessor>(p), chunk_size);
+    } else {
+        async_get_result_op op{std::forward<Context>(ctx), std::forward<ResultProcessor>(p)};
+        op.perform();
+    }
+}
+
+/**
+ * Continuation of the query sending which receives the result.
+ */
+template <typename ResultProcessor>
+struct then_get_result {
+    ResultProcessor process_;
+
+    template <typename Context>
+    void operator() (Context&& ctx) {
+        async_get_result(std::forward<Context>(ctx), std::move(process_));
+    }
+};
+
+template <typename ResultProcessor>
+then_get_result(ResultProcessor) -> then_get_result<ResultProcessor>;
+
+/**
+ * Sends the query and then receives its result by the single operation object
+ * which owns the request context, so the request needs neither the context
+ * allocation nor the reference counting on each IO wait. If the query could not
+ * be flushed at once the context becomes shared and the result is received while
+ * the rest of the query is sent, as the separate operations do.
+ */
+template <typename Connection, typename Query, typename ResultProcessor, typename Handler>
+inline void async_send_query_and_get_result(Connection&& conn, Query&& query,
+        ResultProcessor&& p, Handler&& handler) {
+    request_operation_context<std::decay_t<Connection>, std::decay_t<Handler>> ctx{
+        std::forward<Connection>(conn), std::forward<Handler>(handler)};
+    async_send_query_params(std::move(ctx), std::forward<Query>(query),
+        then_get_result{std::forward<ResultProcessor>(p)});
+}
+
+/**
+ * Completion handler of a prepared statement execution. Drops the cache of
+ * prepared statements if the server does not know the statement anymore,
+ * e.g. after `DISCARD ALL`, so statements would be prepared again.
+ */
+template <typename Handler>
+struct prepared_statement_handler {
+    Handler handler_;
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection&& conn) {
+        if (ec == sqlstate::invalid_sql_statement_name) {
+            unwrap_connection(conn).statement_cache().clear();
+        }
+        handler_(std::move(ec), std::forward<Connection>(conn));
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename Handler>
+prepared_statement_handler(Handler) -> prepared_statement_handler<Handler>;
+
+#include <boost/asio/yield.hpp>
+
+/**
+ * Request operation via the connection's cache of prepared statements.
+ * If the query has no statement prepared yet the operation deallocates the
+ * statements evicted from the cache, prepares a new one and then executes it.
+ * A statement which is not known by the server anymore, e.g. after `DISCARD ALL`,
+ * does not fail the request on its deallocation since it has gone already.
+ */
+template <typename ResultProcessor, typename Handler>
+struct async_prepared_request_op : boost::asio::coroutine {
+    binary_query query_;
+    ResultProcessor process_;
+    Handler handler_;
+    std::string name_;
+    bool deallocating_ = false;
+
+    async_prepared_request_op(binary_query query, ResultProcessor process, Handler handler)
+    : query_(std::move(query)), process_(std::move(process)), handler_(std::move(handler)) {}
+
+    template <typename Connection>
+    void perform(Connection& conn) {
+        (*this)(error_code{}, conn);
+    }
+
+    // The connection is passed by the reference to the object owned by
+    // the previous step context which is not used anymore so it is safe
+    // to move the connection to the next step.
+    template <typename Connection>
+    void operator() (error_code ec, Connection&& conn) {
+        if (ec) {
+            if (!deallocating_ || ec != sqlstate::invalid_sql_statement_name) {
+                return handler_(std::move(ec), std::move(conn));
+            }
+            // The name of the statement has been dropped from the cache already
+            unwrap_connection(conn).set_error_context();
+        }
+
+        auto& cache = unwrap_connection(conn).statement_cache();
+
+        reenter(*this) {
+            if (!cache.find(query_)) {
+                while (!cache.evicted().empty()) {
+                    deallocating_ = true;
+                    yield step(conn, deallocate_statement{binary_query(
+                        "DEALLOCATE " + cache.pop_evicted(), hana::make_tuple(), empty_oid_map{})});
+                    deallocating_ = false;
+                }
+
+                name_ = cache.make_name();
+                yield step(conn, prepare_statement{name_, query_});
+                cache.insert(query_, std::move(name_));
+            }
+
+            async_send_query_and_get_result(std::move(conn),
+                prepared_statement{*cache.find(query_), std::move(query_)},
+                std::move(process_),
+                prepared_statement_handler{std::move(handler_)});
+        }
+    }
+
+    template <typename Connection, typename Query>
+    void step(Connection& conn, Query query) {
+        async_send_query_and_get_result(std::move(conn), std::move(query), none, std::move(*this));
+    }
+
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = std::decay_t<decltype(asio::get_associated_allocator(handler_))>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename ResultProcessor, typename Handler>
+async_prepared_request_op(binary_query, ResultProcessor, Handler) -> async_prepared_request_op<ResultProcessor, Handler>;
+
+#include <boost/asio/unyield.hpp>
+
+/**
+ * Wraps a request handler to be invoked via a strand of the connection executor
+ * and, if a time constraint is given, to cancel the connection IO on the deadline.
+ */
+template <typename Connection, typename TimeConstraint, typename Handler>
+inline auto make_request_handler(Connection& conn, [[maybe_unused]] TimeConstraint t, Handler&& handler) {
+    auto h = detail::wrap_executor {
+        detail::make_strand_executor(bozo::get_executor(conn)),
+        std::forward<Handler>(handler)
+    };
+    if constexpr (IsNone<TimeConstraint>) {
+        return h;
+    } else {
+        return detail::io_deadline_handler<std::decay_t<decltype(unwrap_connection(conn))>, decltype(h), Connection> {
+            unwrap_connection(conn), t, std::move(h)
+        };
+    }
 }
 
 template <typename OutHandler, typename Query, typename TimeConstraint, typename Handler>
@@ -298,32 +822,25 @@ struct async_request_op {
     async_request_op(Query query, TimeConstraint time_constrain, OutHandler out, Handler handler)
     : out_(std::move(out)), query_(std::move(query)), time_constraint_(time_constrain), handler_(std::move(handler)) {}
 
-    template <typename Connection, typename SourceHandler>
-    auto apply_time_constaint_or_strand (Connection& conn, SourceHandler&& handler) const {
-        if constexpr (IsNone<TimeConstraint>) {
-            return std::forward<SourceHandler>(handler);
-        } else {
-            return detail::io_deadline_handler<std::decay_t<decltype(unwrap_connection(conn))>, std::decay_t<SourceHandler>, Connection> {
-                unwrap_connection(conn), time_constraint_, std::forward<SourceHandler>(handler)
-            };
-        }
-    }
-
     template <typename Connection>
     void operator() (error_code ec, Connection conn) {
         if (ec) {
             return handler_(ec, std::move(conn));
         }
 
-        auto handler = apply_time_constaint_or_strand(conn, detail::wrap_executor {
-            detail::make_strand_executor(bozo::get_executor(conn)),
-            std::move(handler_)
-        });
+        auto handler = make_request_handler(conn, time_constraint_, std::move(handler_));
 
-        auto ctx = make_request_operation_context(std::move(conn), std::move(handler));
+        if constexpr (detail::HasStatementCache<decltype(unwrap_connection(conn))>) {
+            if (unwrap_connection(conn).statement_cache().enabled()) {
+                auto query = to_binary_query(std::move(query_), unwrap_connection(conn).oid_map(),
+                                detail::get_query_allocator(unwrap_connection(conn),
+                                    asio::get_associated_allocator(handler)));
+                async_prepared_request_op op{std::move(query), std::move(out_), std::move(handler)};
+                return op.perform(conn);
+            }
+        }
 
-        async_send_query_params(ctx, std::move(query_));
-        async_get_result(std::move(ctx), std::move(out_));
+        async_send_query_and_get_result(std::move(conn), std::move(query_), std::move(out_), std::move(handler));
     }
 
     using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler_))>;
@@ -358,6 +875,16 @@ struct async_request_out_handler {
 template <typename T>
 async_request_out_handler(T) -> async_request_out_handler<T>;
 
+template <typename Out>
+inline auto make_request_out_handler(Out&& out) {
+    if constexpr (RowStream<Out>) {
+        // Row stream receives the result by itself row by row
+        return std::decay_t<Out>{std::forward<Out>(out)};
+    } else {
+        return async_request_out_handler{std::forward<Out>(out)};
+    }
+}
+
 template <typename P, typename Q, typename TimeConstraint, typename Out, typename Handler>
 inline void async_request(P&& provider, Q&& query, TimeConstraint t, Out&& out, Handler&& handler) {
     static_assert(ConnectionProvider<P>, "is not a ConnectionProvider");
@@ -367,7 +894,7 @@ inline void async_request(P&& provider, Q&& query, TimeConstraint t, Out&& out,
         async_request_op{
             std::forward<Q>(query),
             deadline(t),
-            async_request_out_handler{std::forward<Out>(out)},
+            make_request_out_handler(std::forward<Out>(out)),
             std::forward<Handler>(handler)
         }
     );
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <bozo/deadline.h>
+#include <bozo/dns_cache.h>
+#include <bozo/impl/async_connect.h>
+#include <bozo/detail/conninfo.h>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace bozo::impl {
+
+/**
+ * Orders addresses so the address families alternate starting with the family
+ * of the most preferred address, as happy eyeballs suggests.
+ */
+inline dns_cache::addresses_type interleave_address_families(const asio::ip::tcp::resolver::results_type& results) {
+    std::vector<asio::ip::address> first;
+    std::vector<asio::ip::address> second;
+    for (const auto& entry : results) {
+        const auto address = entry.endpoint().address();
+        if (std::find(first.begin(), first.end(), address) != first.end()
+                || std::find(second.begin(), second.end(), address) != second.end()) {
+            continue;
+        }
+        if (first.empty() || first.front().is_v6() == address.is_v6()) {
+            first.push_back(address);
+        } else {
+            second.push_back(address);
+        }
+    }
+    dns_cache::addresses_type retval;
+    retval.reserve(first.size() + second.size());
+    for (std::size_t i = 0; i < std::max(first.size(), second.size()); ++i) {
+        if (i < first.size()) {
+            retval.push_back(first[i].to_string());
+        }
+        if (i < second.size()) {
+            retval.push_back(second[i].to_string());
+        }
+    }
+    return retval;
+}
+
+/**
+ * Asynchronous resolution of the connection host followed by the connection attempts
+ * to the resolved addresses. The attempts are raced: the next address is tried if the
+ * previous attempt has failed or has not completed within `dns_cache::attempt_delay()`,
+ * the first established connection is passed to the handler and the rest are cancelled.
+ * If all the attempts to the cached addresses fail the addresses are dropped from the cache.
+ */
+template <typename Factory, typename Deadline, typename Handler>
+class async_resolve_connect_op
+        : public std::enable_shared_from_this<async_resolve_connect_op<Factory, Deadline, Handler>> {
+public:
+    using connection_type = std::decay_t<decltype(std::declval<Factory&>()())>;
+    using executor_type = asio::associated_executor_t<Handler, io_context::executor_type>;
+    using allocator_type = asio::associated_allocator_t<Handler>;
+
+    async_resolve_connect_op(io_context& io, std::string conninfo, std::string host,
+            Deadline deadline, Factory factory, Handler handler)
+    : conninfo_(std::move(conninfo)), host_(std::move(host)), deadline_(deadline),
+      factory_(std::move(factory)), handler_(std::move(handler)),
+      executor_(asio::get_associated_executor(handler_, io.get_executor())),
+      allocator_(asio::get_associated_allocator(handler_)),
+      resolver_(io), attempt_timer_(io) {
+        if constexpr (!IsNone<Deadline>) {
+            deadline_timer_.emplace(detail::get_operation_timer(io.get_executor(), deadline_));
+        }
+    }
+
+    void perform() {
+        if (auto addresses = dns_cache::global().lookup(host_)) {
+            cached_ = true;
+            return connect(std::move(*addresses));
+        }
+        const std::lock_guard lock(mutex_);
+        if (deadline_timer_) {
+            deadline_timer_->async_wait(bind(&async_resolve_connect_op::on_deadline));
+        }
+        resolver_.async_resolve(host_, "", bind(&async_resolve_connect_op::on_resolve));
+    }
+
+private:
+    template <typename Method>
+    struct bound_handler {
+        std::shared_ptr<async_resolve_connect_op> self_;
+        Method method_;
+
+        template <typename ...Args>
+        void operator() (Args&& ...args) {
+            ((*self_).*method_)(std::forward<Args>(args)...);
+        }
+
+        using executor_type = typename async_resolve_connect_op::executor_type;
+
+        executor_type get_executor() const noexcept { return self_->executor_;}
+
+        using allocator_type = typename async_resolve_connect_op::allocator_type;
+
+        allocator_type get_allocator() const noexcept { return self_->allocator_;}
+    };
+
+    template <typename Method>
+    bound_handler<Method> bind(Method method) {
+        return {this->shared_from_this(), method};
+    }
+
+    struct attempt {
+        std::string conninfo;
+        connection_type conn;
+    };
+
+    void on_deadline(error_code ec) {
+        const std::lock_guard lock(mutex_);
+        if (!ec && !resolved_) {
+            timed_out_ = true;
+            resolver_.cancel();
+        }
+    }
+
+    void on_resolve(error_code ec, asio::ip::tcp::resolver::results_type results) {
+        {
+            const std::lock_guard lock(mutex_);
+            resolved_ = true;
+            if (deadline_timer_) {
+                deadline_timer_->cancel();
+            }
+            if (timed_out_) {
+                ec = asio::error::timed_out;
+            }
+        }
+        if (ec) {
+            auto conn = factory_();
+            unwrap_connection(conn).set_error_context("error while resolving host " + host_);
+            return handler_(std::move(ec), std::move(conn));
+        }
+        auto addresses = interleave_address_families(results);
+        dns_cache::global().update(host_, addresses);
+        connect(std::move(addresses));
+    }
+
+    void connect(dns_cache::addresses_type addresses) {
+        std::optional<attempt> next;
+        {
+            const std::lock_guard lock(mutex_);
+            addresses_ = std::move(addresses);
+            next = prepare_attempt();
+        }
+        start(std::move(*next));
+    }
+
+    attempt prepare_attempt() {
+        attempt retval{detail::with_hostaddr(conninfo_, addresses_[started_++]), factory_()};
+        attempts_.push_back(retval.conn);
+        if (started_ < addresses_.size()) {
+            attempt_timer_.expires_after(dns_cache::global().attempt_delay());
+            attempt_timer_.async_wait(bind(&async_resolve_connect_op::on_attempt_delay));
+        }
+        return retval;
+    }
+
+    void start(attempt a) {
+        async_connect(std::move(a.conninfo), deadline_, std::move(a.conn),
+            bind(&async_resolve_connect_op::template on_attempt<connection_type>));
+    }
+
+    void on_attempt_delay(error_code ec) {
+        std::optional<attempt> next;
+        {
+            const std::lock_guard lock(mutex_);
+            if (ec || done_ || started_ == addresses_.size()) {
+                return;
+            }
+            next = prepare_attempt();
+        }
+        start(std::move(*next));
+    }
+
+    template <typename Connection>
+    void on_attempt(error_code ec, Connection&& conn) {
+        std::vector<connection_type> losers;
+        std::optional<attempt> next;
+        bool complete = false;
+        {
+            const std::lock_guard lock(mutex_);
+            ++finished_;
+            attempts_.erase(std::remove_if(attempts_.begin(), attempts_.end(), [&] (const auto& v) {
+                return std::addressof(unwrap_connection(v)) == std::addressof(unwrap_connection(conn));
+            }), attempts_.end());
+            if (done_) {
+                return;
+            }
+            if (!ec || finished_ == addresses_.size()) {
+                done_ = complete = true;
+                attempt_timer_.cancel();
+                losers.swap(attempts_);
+            } else if (started_ < addresses_.size()) {
+                next = prepare_attempt();
+            }
+        }
+        for (auto& loser : losers) {
+            asio::post(unwrap_connection(loser).get_executor(), [loser] { unwrap_connection(loser).cancel();});
+        }
+        if (next) {
+            return start(std::move(*next));
+        }
+        if (complete) {
+            if (ec && cached_) {
+                // None of the cached addresses is reachable, they may be stale, so the host
+                // is resolved again by the next connect.
+                dns_cache::global().invalidate(host_);
+            }
+            handler_(std::move(ec), std::forward<Connection>(conn));
+        }
+    }
+
+    using timer_type = typename detail::operation_timer<io_context::executor_type>::type;
+
+    const std::string conninfo_;
+    const std::string host_;
+    const Deadline deadline_;
+    Factory factory_;
+    Handler handler_;
+    executor_type executor_;
+    allocator_type allocator_;
+    std::mutex mutex_;
+    asio::ip::tcp::resolver resolver_;
+    std::optional<timer_type> deadline_timer_;
+    asio::steady_timer attempt_timer_;
+    bool cached_ = false;
+    bool resolved_ = false;
+    bool timed_out_ = false;
+    dns_cache::addresses_type addresses_;
+    std::vector<connection_type> attempts_;
+    std::size_t started_ = 0;
+    std::size_t finished_ = 0;
+    bool done_ = false;
+};
+
+/**
+ * Resolves the host of the connection string asynchronously and connects to the resolved
+ * addresses. The connections for the attempts are made via the factory.
+ */
+template <typename Factory, typename TimeConstraint, typename Handler>
+inline void async_resolve_connect(io_context& io, std::string conninfo, std::string host,
+        const TimeConstraint& t, Factory&& factory, Handler&& handler) {
+    using op_type = async_resolve_connect_op<
+        std::decay_t<Factory>, std::decay_t<decltype(bozo::deadline(t))>, std::decay_t<Handler>>;
+    std::make_shared<op_type>(io, std::move(conninfo), std::move(host), bozo::deadline(t),
+        std::forward<Factory>(factory), std::forward<Handler>(handler))->perform();
+}
+
+} // namespace bozo::impl
@@ -43,7 +43,7 @@ public:
     template <typename TimeConstraint>
     deadline_cancel_handler(const Executor& ex, TimeConstraint t, Continuation handler)
     : timer_(bozo::detail::get_operation_timer(ex, t)) {
-        auto allocator = asio::get_associated_allocator(handler);
+        auto allocator = detail::get_recycling_allocator(asio::get_associated_allocator(handler));
         ctx_ = std::allocate_shared<context>(allocator, std::move(handler));
         timer_.async_wait(on_timer_expired{ctx_});
     }
@@ -52,12 +52,14 @@ error_code connection<OidMap, Statistics>::assign(bozo::pg::conn&& handle) {
 
     socket_ = std::move(new_socket);
     handle_ = std::move(handle);
+    statement_cache_.clear();
     return {};
 }
 
 template <typename OidMap, typename Statistics>
 bozo::pg::conn connection<OidMap, Statistics>::release() {
     socket_.release();
+    statement_cache_.clear();
     bozo::pg::conn retval;
     using std::swap;
     swap(retval, handle_);
@@ -1,17 +1,29 @@
 #pragma once
 
 #include <bozo/connection.h>
+#include <bozo/impl/async_cancel_query.h>
 #include <yamail/resource_pool/async/pool.hpp>
 #include <bozo/asio.h>
 #include <bozo/ext/std/shared_ptr.h>
 #include <bozo/detail/make_copyable.h>
+#include <bozo/detail/recycling_allocator.h>
+#include <bozo/detail/bind.h>
 
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 namespace bozo::detail {
 
 template <typename Allocator, typename Executor, typename Rep>
-auto create_pooled_connection(const Allocator& alloc, const Executor& ex, Rep&& rep) {
-    return std::allocate_shared<pooled_connection<std::decay_t<Rep>, Executor>>(alloc, ex, std::forward<Rep>(rep));
+auto create_pooled_connection(const Allocator& alloc, const Executor& ex, Rep&& rep,
+        time_traits::duration cancel_timeout = time_traits::duration::zero(),
+        time_traits::duration idle_timeout = time_traits::duration::max()) {
+    return std::allocate_shared<pooled_connection<std::decay_t<Rep>, Executor>>(
+        get_recycling_allocator(alloc), ex, std::forward<Rep>(rep), cancel_timeout, idle_timeout);
 }
 
 template <typename Source, typename Handler, typename TimeConstraint>
@@ -24,10 +36,25 @@ struct pooled_connection_wrapper {
     Source source_;
     detail::make_copyable_t<Handler> handler_;
     TimeConstraint time_constrain_;
+    pooled_connection_options options_;
+    time_traits::time_point requested_ = {};
+
+    static constexpr bool collects_statistics = detail::CollectsStatistics<decltype(bozo::unwrap(std::declval<handle_type&>()))>;
+
+    static void update_checkout_statistics([[maybe_unused]] handle_type& handle,
+            [[maybe_unused]] time_traits::duration queue_wait) {
+        if constexpr (collects_statistics) {
+            checkout_sample sample;
+            sample.queue_wait = queue_wait;
+            bozo::unwrap(handle).update_statistics(checkout_key{}, sample);
+        }
+    }
 
     struct wrapper {
         Handler handler_;
         handle_type handle_;
+        pooled_connection_options options_;
+        time_traits::duration queue_wait_;
 
         template <typename Conn>
         void operator () (error_code ec, Conn&& conn) {
@@ -36,9 +63,19 @@ struct pooled_connection_wrapper {
             if (!is_null(conn)) {
                 auto& target = bozo::unwrap_connection(conn);
 
-                handle_.reset({target.release(), target.oid_map(), target.get_error_context()});
+                if constexpr (collects_statistics) {
+                    handle_.reset({target.release(), target.oid_map(), target.get_error_context(), target.statistics()});
+                    update_checkout_statistics(handle_, queue_wait_);
+                } else {
+                    handle_.reset({target.release(), target.oid_map(), target.get_error_context()});
+                }
+                if (options_.statement_cache_capacity) {
+                    detail::set_statement_cache_capacity(bozo::unwrap(handle_), options_.statement_cache_capacity);
+                }
+                detail::set_connection_expiry(bozo::unwrap(handle_), get_connection_expiry(options_));
                 auto res = create_pooled_connection(
-                    get_allocator(), target.get_executor(), std::move(handle_)
+                    get_allocator(), target.get_executor(), std::move(handle_), options_.cancel_timeout,
+                    get_connection_idle_timeout(options_)
                 );
 
                 handler_(std::move(ec), std::move(res));
@@ -65,12 +102,18 @@ struct pooled_connection_wrapper {
             return handler_(std::move(ec), connection_ptr{});
         }
 
-        if (!handle.empty() && !connection_status_bad(handle->safe_native_handle().get())) {
-            auto conn = create_pooled_connection(get_allocator(), io_executor_, std::move(handle));
+        const auto queue_wait = collects_statistics ? time_traits::now() - requested_ : time_traits::duration{};
+
+        // An expired or too long idle connection is replaced with a new one like a bad one
+        if (!handle.empty() && !connection_status_bad(handle->safe_native_handle().get())
+                && !connection_expired(bozo::unwrap(handle)) && !connection_idle_expired(bozo::unwrap(handle))) {
+            update_checkout_statistics(handle, queue_wait);
+            auto conn = create_pooled_connection(get_allocator(), io_executor_, std::move(handle), options_.cancel_timeout,
+                get_connection_idle_timeout(options_));
             return handler_(std::move(ec), std::move(conn));
         }
 
-        source_(io_executor_.context(), time_constrain_, wrapper{std::move(handler_), std::move(handle)});
+        source_(io_executor_.context(), time_constrain_, wrapper{std::move(handler_), std::move(handle), options_, queue_wait});
     }
 
     using executor_type = decltype(asio::get_associated_executor(handler_));
@@ -87,47 +130,275 @@ struct pooled_connection_wrapper {
 };
 
 template <typename Source, typename Executor, typename TimeConstraint, typename Handler>
-auto wrap_pooled_connection_handler(const Executor& ex, Source&& source, TimeConstraint t, Handler&& handler) {
+auto wrap_pooled_connection_handler(const Executor& ex, Source&& source, TimeConstraint t, Handler&& handler,
+        const pooled_connection_options& options = {}) {
     static_assert(ConnectionSource<Source>, "is not a ConnectionSource");
 
-    return pooled_connection_wrapper<std::decay_t<Source>, std::decay_t<Handler>, TimeConstraint> {
-        ex, std::forward<Source>(source), std::forward<Handler>(handler), t
+    using wrapper_type = pooled_connection_wrapper<std::decay_t<Source>, std::decay_t<Handler>, TimeConstraint>;
+    return wrapper_type {
+        ex, std::forward<Source>(source), std::forward<Handler>(handler), t, options,
+        wrapper_type::collects_statistics ? time_traits::now() : time_traits::time_point{}
     };
 }
 
-} // namespace bozo::detail
+/**
+ * Number of connections to get from the pool shard to have at least min_idle connections
+ * open in it. The idle connections are got too, since the pool opens a new connection only
+ * if there is no idle one.
+ */
+template <typename Stats>
+constexpr std::size_t min_idle_top_up_count(const Stats& stats, std::size_t min_idle) noexcept {
+    return stats.size < min_idle ? stats.available + (min_idle - stats.size) : 0;
+}
 
-namespace bozo {
+/**
+ * Collects the handles got from the pool to top it up. The handles are held until all of them
+ * are got, so each empty handle is a room for a new connection rather than the idle one released
+ * by the previous request. Then the idle connections return to the pool at once, the new ones are
+ * opened and return to the pool as soon as they are connected. The handler is called with the first
+ * error if any once all of them are done.
+ */
+template <typename Handle, typename Mutex, typename Executor, typename Handler>
+class pool_top_up_state {
+public:
+    pool_top_up_state(std::size_t pending, std::shared_ptr<std::atomic<bool>> in_progress,
+            const Executor& ex, Handler handler)
+    : pending_(pending), in_progress_(std::move(in_progress)), ex_(ex), handler_(std::move(handler)) {
+        handles_.reserve(pending);
+    }
+
+    /**
+     * Adds the handle got from the pool.
+     *
+     * @return empty handles to open new connections for once all the handles are got.
+     */
+    std::vector<Handle> add(error_code ec, Handle handle) {
+        std::unique_lock lock(mutex_);
+        set_error(std::move(ec));
+        handles_.push_back(std::move(handle));
+        if (--pending_) {
+            return {};
+        }
+        auto handles = std::move(handles_);
+        lock.unlock();
+
+        handles.erase(std::remove_if(handles.begin(), handles.end(),
+            [](const Handle& h) { return !h.empty();}), handles.end());
+        if (handles.empty()) {
+            complete();
+            return {};
+        }
+        lock.lock();
+        connecting_ = handles.size();
+        return handles;
+    }
+
+    /**
+     * A new connection is opened or failed.
+     */
+    void connected(error_code ec) {
+        std::unique_lock lock(mutex_);
+        set_error(std::move(ec));
+        if (--connecting_) {
+            return;
+        }
+        lock.unlock();
+        complete();
+    }
 
-template <typename V>
-struct unwrap_impl<yamail::resource_pool::handle<V>> {
-    template <typename T>
-    static constexpr decltype(auto) apply(T&& handle) {
-        return *handle;
+    void complete() {
+        if (in_progress_) {
+            in_progress_->store(false);
+        }
+        auto ex = asio::get_associated_executor(handler_, ex_);
+        asio::post(ex, detail::bind(std::move(handler_), std::move(ec_)));
+    }
+
+private:
+    void set_error(error_code ec) {
+        if (ec && !ec_) {
+            ec_ = std::move(ec);
+        }
+    }
+
+    Mutex mutex_;
+    std::size_t pending_;
+    std::size_t connecting_ = 0;
+    error_code ec_;
+    std::vector<Handle> handles_;
+    std::shared_ptr<std::atomic<bool>> in_progress_;
+    Executor ex_;
+    Handler handler_;
+};
+
+/**
+ * Tops up the number of connections of the pool shard to its part of min_idle.
+ */
+template <typename Context, typename Handler>
+void async_top_up(std::shared_ptr<Context> ctx, io_context& io, std::size_t shard,
+        std::shared_ptr<std::atomic<bool>> in_progress, Handler&& handler) {
+    using connection_ptr = typename Context::connection_type;
+    using handle_type = typename connection_ptr::element_type::rep_type;
+    using state_type = pool_top_up_state<handle_type, typename Context::mutex_type,
+        io_context::executor_type, std::decay_t<Handler>>;
+
+    const auto count = min_idle_top_up_count(ctx->impl.shard(shard).stats(), ctx->shard_min_idle(shard));
+    auto state = std::make_shared<state_type>(count, std::move(in_progress), io.get_executor(), std::forward<Handler>(handler));
+    if (!count) {
+        return state->complete();
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        ctx->impl.get_shard_auto_recycle(
+            shard,
+            io,
+            [ctx, state, io = std::addressof(io)](error_code ec, handle_type handle) {
+                for (auto& h : state->add(std::move(ec), std::move(handle))) {
+                    wrap_pooled_connection_handler(
+                        io->get_executor(),
+                        ctx->source,
+                        ctx->min_idle_connect_timeout,
+                        [state](error_code ec, connection_ptr) { state->connected(std::move(ec)); },
+                        ctx->options
+                    )(error_code{}, std::move(h));
+                }
+            },
+            ctx->min_idle_connect_timeout
+        );
+    }
+}
+
+/**
+ * Periodically tops up the number of connections of the pool shard via the `io_context`
+ * while the shard is used. The keeper stops if the shard has not been used since the
+ * previous check, so it does not keep the `io_context` running, and it is started again
+ * by the next request. It stops when the pool is gone too. A check is skipped while
+ * the previous top up is in progress.
+ */
+template <typename Context, typename ShardState>
+class pool_min_idle_keeper {
+public:
+    pool_min_idle_keeper(std::weak_ptr<Context> ctx, io_context& io, std::size_t shard,
+            std::shared_ptr<ShardState> state, time_traits::duration interval)
+    : ctx_(std::move(ctx)), io_(std::addressof(io)), shard_(shard), state_(std::move(state)),
+      interval_(interval), timer_(std::make_shared<asio::steady_timer>(io)) {
+        state_->timer = timer_;
+    }
+
+    void schedule() {
+        auto& timer = *timer_;
+        timer.expires_after(interval_);
+        timer.async_wait(std::move(*this));
+    }
+
+    void operator() (error_code ec) {
+        const auto ctx = ctx_.lock();
+        if (ec || !ctx) {
+            return state_->maintained.store(false);
+        }
+        if (!state_->topping_up.exchange(true)) {
+            auto in_progress = std::shared_ptr<std::atomic<bool>>(state_, std::addressof(state_->topping_up));
+            async_top_up(ctx, *io_, shard_, std::move(in_progress), [](error_code) {});
+        }
+        if (!state_->used.exchange(false)) {
+            state_->maintained.store(false);
+            // A request may have come just before the keeper is stopped
+            if (!state_->used.load() || state_->maintained.exchange(true)) {
+                return;
+            }
+        }
+        schedule();
     }
+
+private:
+    std::weak_ptr<Context> ctx_;
+    io_context* io_;
+    std::size_t shard_;
+    std::shared_ptr<ShardState> state_;
+    time_traits::duration interval_;
+    std::shared_ptr<asio::steady_timer> timer_;
 };
 
+} // namespace bozo::detail
+
+namespace bozo {
+
 template <typename Source, typename ThreadSafety>
 template <typename TimeConstraint, typename Handler>
 void connection_pool<Source, ThreadSafety>::operator ()(io_context& io, TimeConstraint t, Handler&& handler) {
     static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
-    impl_.get_auto_recycle(
+    if (ctx_->min_idle) {
+        const auto shard = ctx_->impl.shard_index(io);
+        const auto& state = ctx_->min_idle_shards[shard];
+        state->used.store(true, std::memory_order_relaxed);
+        if (state->enabled.load(std::memory_order_relaxed) && !state->maintained.load(std::memory_order_relaxed)) {
+            maintain(ctx_, io, shard);
+        }
+    }
+    ctx_->impl.get_auto_recycle(
         io,
         detail::wrap_pooled_connection_handler(
             io.get_executor(),
-            source_,
+            ctx_->source,
             t,
-            std::forward<Handler>(handler)
+            std::forward<Handler>(handler),
+            ctx_->options
         ),
         queue_timeout(t)
     );
 }
 
+template <typename Source, typename ThreadSafety>
+template <typename CompletionToken>
+auto connection_pool<Source, ThreadSafety>::warm_up(io_context& io, CompletionToken&& token) {
+    return async_initiate<CompletionToken, void(error_code)>(
+        [ctx = ctx_](auto&& handler, io_context* io) {
+            const auto shard = ctx->impl.shard_index(*io);
+            const auto& state = ctx->min_idle_shards[shard];
+            state->topping_up.store(true);
+            detail::async_top_up(ctx, *io, shard,
+                std::shared_ptr<std::atomic<bool>>(state, std::addressof(state->topping_up)),
+                std::forward<decltype(handler)>(handler));
+            if (ctx->min_idle) {
+                state->enabled.store(true);
+                maintain(ctx, *io, shard);
+            }
+        },
+        token, std::addressof(io)
+    );
+}
+
+template <typename Source, typename ThreadSafety>
+void connection_pool<Source, ThreadSafety>::maintain(const std::shared_ptr<context>& ctx, io_context& io, std::size_t shard) {
+    const auto& state = ctx->min_idle_shards[shard];
+    if (!state->maintained.exchange(true)) {
+        detail::pool_min_idle_keeper<context, min_idle_shard_state>{
+            ctx, io, shard, state, ctx->min_idle_check_interval
+        }.schedule();
+    }
+}
+
 template <typename Rep, typename Executor>
-pooled_connection<Rep, Executor>::pooled_connection(const Executor& ex, Rep&& rep)
-: rep_(std::move(rep)), ex_(ex), stream_(get_executor().context()) {
-    if (auto fd = PQsocket(native_handle()); fd != -1) {
-        stream_.assign(fd);
+pooled_connection<Rep, Executor>::pooled_connection(const Executor& ex, Rep&& rep,
+        time_traits::duration cancel_timeout, time_traits::duration idle_timeout)
+: rep_(std::move(rep)), ex_(ex), own_stream_(make_own_stream()), cancel_timeout_(cancel_timeout),
+  idle_timeout_(idle_timeout) {
+    if constexpr (uses_rep_socket) {
+        stream_ = std::addressof(bozo::unwrap(rep_).socket().bind(get_executor().context(), PQsocket(native_handle())));
+    } else {
+        stream_ = std::addressof(own_stream_);
+        if (auto fd = PQsocket(native_handle()); fd != -1) {
+            stream_->assign(fd);
+        }
+    }
+}
+
+template <typename Rep, typename Executor>
+typename pooled_connection<Rep, Executor>::own_stream_type
+pooled_connection<Rep, Executor>::make_own_stream() {
+    if constexpr (uses_rep_socket) {
+        return {};
+    } else {
+        return detail::get_connection_stream(get_executor());
     }
 }
 
@@ -143,18 +414,24 @@ pooled_connection<Rep, Executor>::native_handle() const noexcept {
 template <typename Rep, typename Executor>
 template <typename WaitHandler>
 void pooled_connection<Rep, Executor>::async_wait_write(WaitHandler&& h) {
-    stream_.async_write_some(asio::null_buffers(), std::forward<WaitHandler>(h));
+    stream().async_write_some(asio::null_buffers(), std::forward<WaitHandler>(h));
 }
 
 template <typename Rep, typename Executor>
 template <typename WaitHandler>
 void pooled_connection<Rep, Executor>::async_wait_read(WaitHandler&& h) {
-    stream_.async_read_some(asio::null_buffers(), std::forward<WaitHandler>(h));
+    stream().async_read_some(asio::null_buffers(), std::forward<WaitHandler>(h));
 }
 
 template <typename Rep, typename Executor>
 error_code pooled_connection<Rep, Executor>::close() noexcept {
-    stream_.release();
+    if constexpr (uses_rep_socket) {
+        auto& socket = bozo::unwrap(rep_).socket();
+        socket.release();
+        stream_ = std::addressof(socket.bind(get_executor().context(), -1));
+    } else {
+        stream().release();
+    }
     bozo::unwrap(rep_).safe_native_handle().reset();
     return error_code{};
 }
@@ -162,7 +439,7 @@ error_code pooled_connection<Rep, Executor>::close() noexcept {
 template <typename Rep, typename Executor>
 void pooled_connection<Rep, Executor>::cancel() noexcept {
     error_code _;
-    stream_.cancel(_);
+    stream().cancel(_);
 }
 
 template <typename Rep, typename Executor>
@@ -172,10 +449,46 @@ bool pooled_connection<Rep, Executor>::is_bad() const noexcept {
 
 template <typename Rep, typename Executor>
 pooled_connection<Rep, Executor>::~pooled_connection() {
-    stream_.release();
+    // The socket of the representation stays registered for the next checkout
+    if constexpr (!uses_rep_socket) {
+        stream().release();
+    }
     if (!rep_.empty() && (is_bad() || get_transaction_status(*this) != transaction_status::idle)) {
+        if (cancel_timeout_ == time_traits::duration::zero() || is_bad()
+                || get_transaction_status(*this) != transaction_status::active || !cancel_and_reuse()) {
+            rep_.waste();
+        }
+    } else if (!rep_.empty() && detail::connection_expired(bozo::unwrap(rep_))) {
         rep_.waste();
+    } else if (!rep_.empty()) {
+        detail::set_connection_idle_expiry(bozo::unwrap(rep_), idle_timeout_);
+    }
+}
+
+template <typename Rep, typename Executor>
+bool pooled_connection<Rep, Executor>::cancel_and_reuse() noexcept {
+    // No operation would be performed on the stopped context, e.g. while it is destroyed,
+    // so the connection could never return to the pool.
+    if (ex_.context().stopped()) {
+        return false;
+    }
+    try {
+        // The connection is moved to a new object which returns it to the pool
+        // on destruction if the query has been cancelled and the connection is idle.
+        // The drain is bound to the executor of the connection, so it never runs
+        // concurrently with the pool or the IO of the connection.
+        auto conn = detail::create_pooled_connection(std::allocator<void>{}, ex_, std::move(rep_),
+            time_traits::duration::zero(), idle_timeout_);
+        impl::async_cancel_query(std::move(conn), cancel_timeout_,
+            asio::bind_executor(ex_, [](error_code, auto&&) {}));
+    } catch (const std::exception&) {
+        // If the connection has been moved out already the new object wastes it
+        // on destruction since it has no cancel timeout.
+        if (!rep_.empty()) {
+            rep_.waste();
+        }
     }
+    return true;
 }
 
 } // namespace bozo
@@ -62,6 +62,111 @@ inline int send_query_params(T& conn, const binary_query& q) noexcept {
             );
 }
 
+template <typename T>
+inline int send_prepare(T& conn, const char* name, const binary_query& q) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    return PQsendPrepare(get_native_handle(conn),
+                name,
+                q.text(),
+                q.params_count(),
+                q.types()
+            );
+}
+
+template <typename T>
+inline int send_query_prepared(T& conn, const char* name, const binary_query& q) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    return PQsendQueryPrepared(get_native_handle(conn),
+                name,
+                q.params_count(),
+                q.values(),
+                q.lengths(),
+                q.formats(),
+                int(result_format::binary)
+            );
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+template <typename T>
+inline error_code enter_pipeline_mode(T& conn) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    if (!PQenterPipelineMode(get_native_handle(conn))) {
+        return error::pg_enter_pipeline_mode_failed;
+    }
+    return {};
+}
+
+template <typename T>
+inline error_code exit_pipeline_mode(T& conn) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    if (!PQexitPipelineMode(get_native_handle(conn))) {
+        return error::pg_exit_pipeline_mode_failed;
+    }
+    return {};
+}
+
+template <typename T>
+inline int pipeline_sync(T& conn) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    return PQpipelineSync(get_native_handle(conn));
+}
+#endif
+
+template <typename T>
+inline error_code set_single_row_mode(T& conn) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    if (!PQsetSingleRowMode(get_native_handle(conn))) {
+        return error::pg_set_single_row_mode_failed;
+    }
+    return {};
+}
+
+#ifdef LIBPQ_HAS_CHUNK_MODE
+template <typename T>
+inline error_code set_chunked_rows_mode(T& conn, int chunk_size) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    if (!PQsetChunkedRowsMode(get_native_handle(conn), chunk_size)) {
+        return error::pg_set_chunked_rows_mode_failed;
+    }
+    return {};
+}
+#endif
+
+/**
+* Results of PQputCopyData and PQputCopyEnd functions in nonblocking mode.
+*/
+enum class copy_state : int {
+    error = -1,
+    would_block = 0,
+    queued = 1
+};
+
+template <typename T>
+inline copy_state put_copy_data(T& conn, const char* data, std::size_t size) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    return static_cast<copy_state>(PQputCopyData(get_native_handle(conn), data, static_cast<int>(size)));
+}
+
+template <typename T>
+inline copy_state put_copy_end(T& conn, const char* error_message = nullptr) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    return static_cast<copy_state>(PQputCopyEnd(get_native_handle(conn), error_message));
+}
+
+/**
+* Receives a row of `COPY TO STDOUT` data without blocking. Returns the size of the row
+* received into the buffer, 0 if no row is available yet, -1 if the copy is done
+* and -2 on error, like PQgetCopyData function in asynchronous mode does.
+*/
+template <typename T>
+inline int get_copy_data(T& conn, pg::buffer& buffer) noexcept {
+    static_assert(Connection<T>, "T must be a Connection");
+    char* data = nullptr;
+    const int retval = PQgetCopyData(get_native_handle(conn), std::addressof(data), 1);
+    buffer.reset(data);
+    return retval;
+}
+
 template <typename T>
 inline error_code set_nonblocking(T& conn) noexcept {
     static_assert(Connection<T>, "T must be a Connection");
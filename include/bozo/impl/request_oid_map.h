@@ -1,7 +1,12 @@
 #pragma once
 
 #include <bozo/impl/async_request.h>
+#include <bozo/oid_map_cache.h>
 #include <bozo/time_traits.h>
+#include <bozo/transaction_status.h>
+
+#include <typeindex>
+#include <utility>
 
 namespace bozo::impl {
 
@@ -50,6 +55,150 @@ inline void set_oid_map(oid_map_t<Ts...>& oid_map, const oids_result& res) {
     });
 }
 
+template <typename ...Ts>
+inline oids_result get_oids(const oid_map_t<Ts...>& oid_map) {
+    oids_result retval;
+    retval.reserve(hana::length(oid_map.impl));
+    hana::for_each(hana::values(oid_map.impl), [&] (oid_t oid) { retval.push_back(oid);});
+    return retval;
+}
+
+template <typename Connection>
+inline oid_map_cache::key_type make_oid_map_cache_key(const Connection& conn) {
+    using oid_map_type = std::decay_t<decltype(unwrap_connection(conn).oid_map())>;
+    return {
+        std::type_index(typeid(oid_map_type)),
+        std::string(get_host(conn)),
+        std::string(get_port(conn)),
+        std::string(get_database(conn)),
+        std::string(get_user(conn)),
+    };
+}
+
+enum class cached_oid_map {
+    hit, //!< OIDs have been set from the cache
+    refresh, //!< OIDs have been set from the cache and should be requested again to refresh it
+    update, //!< OIDs should be requested and stored into the cache
+    pending, //!< OIDs are being requested by another connection, wait for them via the cache
+    miss, //!< OIDs should be requested
+};
+
+/**
+ * Sets OIDs of the map from the cache if they are there.
+ */
+template <typename ...Ts>
+inline cached_oid_map apply_cached_oid_map(oid_map_t<Ts...>& oid_map, oid_map_cache& cache,
+        const oid_map_cache::key_type& key) {
+    auto cached = cache.lookup(key);
+    if (cached.pending) {
+        return cached_oid_map::pending;
+    }
+    bool applied = false;
+    if (cached.oids) try {
+        set_oid_map(oid_map, *cached.oids);
+        applied = true;
+    } catch (const std::exception&) {
+        // Cached OIDs do not fit the map, so they are requested again
+        cached.refresh = true;
+    }
+    if (cached.refresh) {
+        return applied ? cached_oid_map::refresh : cached_oid_map::update;
+    }
+    return applied ? cached_oid_map::hit : cached_oid_map::miss;
+}
+
+/**
+ * Connection may be used after a failed request if it is still idle.
+ */
+template <typename Connection>
+inline bool connection_reusable(const Connection& conn) {
+    return !connection_bad(conn) && get_transaction_status(conn) == transaction_status::idle;
+}
+
+/**
+ * Reports the result of the OIDs request to the cache once. If the guard is destroyed
+ * without the result reported, e.g. the request handler has been dropped, the request is
+ * reported as failed, so the pending OIDs are requested again instead of keeping their
+ * waiters forever.
+ */
+class oid_map_cache_update_guard {
+public:
+    oid_map_cache_update_guard(oid_map_cache& cache, oid_map_cache::key_type key)
+    : cache_(std::addressof(cache)), key_(std::move(key)) {}
+
+    oid_map_cache_update_guard(oid_map_cache_update_guard&& other) noexcept
+    : cache_(std::exchange(other.cache_, nullptr)), key_(std::move(other.key_)) {}
+
+    oid_map_cache_update_guard& operator =(oid_map_cache_update_guard&&) = delete;
+
+    ~oid_map_cache_update_guard() {
+        if (cache_) {
+            cache_->update_failed(key_);
+        }
+    }
+
+    void update(oid_map_cache::oids_type oids) {
+        std::exchange(cache_, nullptr)->update(key_, std::move(oids));
+    }
+
+    void update_failed() {
+        std::exchange(cache_, nullptr)->update_failed(key_);
+    }
+
+private:
+    oid_map_cache* cache_;
+    oid_map_cache::key_type key_;
+};
+
+/**
+ * Stores OIDs requested from a database into the cache. If the cached OIDs have been set
+ * already and the refresh has failed the connection keeps them and the error is not passed
+ * to the handler, unless the connection is not usable anymore.
+ */
+template <typename Handler>
+struct cache_oid_map_handler {
+    oid_map_cache_update_guard guard_;
+    Handler handler_;
+    std::optional<oids_result> cached_;
+
+    cache_oid_map_handler(oid_map_cache& cache, oid_map_cache::key_type key, Handler handler,
+            std::optional<oids_result> cached = std::nullopt)
+    : guard_(cache, std::move(key)), handler_(std::move(handler)), cached_(std::move(cached)) {}
+
+    template <typename Connection>
+    void operator() (error_code ec, Connection&& conn) {
+        if (ec) {
+            guard_.update_failed();
+            if (cached_ && connection_reusable(conn)) {
+                // The failed request may have set some of OIDs
+                set_oid_map(unwrap_connection(conn).oid_map(), *cached_);
+                ec = error_code{};
+            }
+        } else {
+            guard_.update(get_oids(unwrap_connection(conn).oid_map()));
+        }
+        handler_(std::move(ec), std::forward<Connection>(conn));
+    }
+
+    using executor_type = asio::associated_executor_t<Handler>;
+
+    executor_type get_executor() const noexcept {
+        return asio::get_associated_executor(handler_);
+    }
+
+    using allocator_type = asio::associated_allocator_t<Handler>;
+
+    allocator_type get_allocator() const noexcept {
+        return asio::get_associated_allocator(handler_);
+    }
+};
+
+template <typename Handler>
+cache_oid_map_handler(oid_map_cache&, oid_map_cache::key_type, Handler) -> cache_oid_map_handler<Handler>;
+
+template <typename Handler>
+cache_oid_map_handler(oid_map_cache&, oid_map_cache::key_type, Handler, std::optional<oids_result>) -> cache_oid_map_handler<Handler>;
+
 template <typename Handler>
 struct request_oid_map_op {
     struct context {
@@ -62,7 +211,7 @@ struct request_oid_map_op {
     std::shared_ptr<context> ctx_;
 
     request_oid_map_op(Handler handler) {
-        auto allocator = asio::get_associated_allocator(handler);
+        auto allocator = detail::get_recycling_allocator(asio::get_associated_allocator(handler));
         ctx_ = std::allocate_shared<context>(allocator, std::move(handler));
     }
 
@@ -4,6 +4,7 @@
 #include <bozo/connection.h>
 #include <bozo/transaction_options.h>
 #include <bozo/impl/async_execute.h>
+#include <bozo/impl/async_pipeline.h>
 
 namespace bozo {
 
@@ -50,6 +51,18 @@ struct async_start_transaction_op {
             t, std::move(*this));
     }
 
+#ifdef LIBPQ_HAS_PIPELINING
+    template <typename T, typename BeginQuery, typename Query, typename TimeConstraint, typename Out>
+    void perform(T&& provider, BeginQuery&& begin, Query&& query, TimeConstraint t, Out out) {
+        static_assert(ConnectionProvider<T>, "T is not a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        using bozo::impl::async_pipeline;
+        async_pipeline(std::forward<T>(provider),
+            hana::make_tuple(std::forward<BeginQuery>(begin), std::forward<Query>(query)),
+            t, hana::make_tuple(none, std::move(out)), std::move(*this));
+    }
+#endif
+
     template <typename Connection>
     void operator ()(error_code ec, Connection&& connection) {
         asio::dispatch(
@@ -74,6 +87,17 @@ Require<ConnectionProvider<T>> async_start_transaction(T&& provider, Options&& o
         .perform(std::forward<T>(provider), std::forward<Query>(query), t);
 }
 
+#ifdef LIBPQ_HAS_PIPELINING
+template <typename T, typename Options, typename BeginQuery, typename Query, typename TimeConstraint,
+        typename Out, typename Handler>
+Require<ConnectionProvider<T>> async_start_transaction(T&& provider, Options&& options, BeginQuery&& begin,
+        Query&& query, TimeConstraint t, Out out, Handler&& handler) {
+    make_async_start_transaction_op(std::forward<Handler>(handler), std::forward<Options>(options))
+        .perform(std::forward<T>(provider), std::forward<BeginQuery>(begin), std::forward<Query>(query),
+            t, std::move(out));
+}
+#endif
+
 template <typename Handler, typename ...Args>
 constexpr void initiate_async_start_transaction::operator()(Handler&& h, Args&& ...args) const {
     async_start_transaction(std::forward<Args>(args)..., std::forward<Handler>(h));
@@ -91,6 +115,18 @@ struct async_end_transaction_op {
         async_execute(std::forward<T>(provider), std::forward<Query>(query), t, std::move(*this));
     }
 
+#ifdef LIBPQ_HAS_PIPELINING
+    template <typename T, typename Query, typename EndQuery, typename TimeConstraint, typename Out>
+    void perform(T&& provider, Query&& query, EndQuery&& end, TimeConstraint t, Out out) {
+        static_assert(Connection<T>, "T is not a Connection");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        using bozo::impl::async_pipeline;
+        async_pipeline(std::forward<T>(provider),
+            hana::make_tuple(std::forward<Query>(query), std::forward<EndQuery>(end)),
+            t, hana::make_tuple(std::move(out), none), std::move(*this));
+    }
+#endif
+
     template <typename Connection, typename Options>
     void operator ()(error_code ec, transaction<Connection, Options> transaction) {
         asio::dispatch(
@@ -115,6 +151,16 @@ Require<ConnectionProvider<T>> async_end_transaction(T&& provider, Query&& query
         .perform(std::forward<T>(provider), std::forward<Query>(query), t);
 }
 
+#ifdef LIBPQ_HAS_PIPELINING
+template <typename T, typename Query, typename EndQuery, typename TimeConstraint, typename Out, typename Handler>
+Require<ConnectionProvider<T>> async_end_transaction(T&& provider, Query&& query, EndQuery&& end,
+        TimeConstraint t, Out out, Handler&& handler) {
+    make_async_end_transaction_op(std::forward<Handler>(handler))
+        .perform(std::forward<T>(provider), std::forward<Query>(query), std::forward<EndQuery>(end),
+            t, std::move(out));
+}
+#endif
+
 template <typename Handler, typename ...Args>
 constexpr void initiate_async_end_transaction::operator()(Handler&& h, Args&& ...args) const {
     async_end_transaction(std::forward<Args>(args)..., std::forward<Handler>(h));
@@ -3,6 +3,7 @@
 #include <bozo/type_traits.h>
 #include <bozo/io/send.h>
 #include <bozo/io/recv.h>
+#include <bozo/detail/bulk_endian.h>
 #include <boost/hana/adapt_struct.hpp>
 #include <boost/hana/size.hpp>
 #include <boost/hana/fold.hpp>
@@ -129,6 +130,41 @@ struct send_impl_dispatcher<T, Require<Array<T>>> { using type = send_array_impl
 template <typename T>
 struct recv_array_impl {
     using out_type = T;
+    using bulk_item_type = contiguous_item_t<out_type>;
+
+    // Contiguous array of fixed size arithmetic items, e.g. std::vector<std::int64_t>
+    static constexpr bool bulk_receivable = BulkByteOrderConvertible<bulk_item_type>
+        && std::is_same_v<bulk_item_type, typename out_type::value_type>;
+
+    /**
+     * Receives all the items at once if all of them are not null. Items are copied
+     * from their data frames into the array and then converted from the big endian
+     * byte order in bulk.
+     *
+     * @return false if the array contains null items and should be received
+     * item by item, the stream is not modified in this case.
+     */
+    static bool recv_items_in_bulk(istream& in, out_type& out) {
+        constexpr std::size_t item_size = sizeof(bulk_item_type);
+        constexpr std::size_t frame_size = sizeof(size_type) + item_size;
+        const std::size_t count = std::size(out);
+        const char* frame = in.peek(count * frame_size);
+        if (!frame) {
+            return false;
+        }
+        auto dst = reinterpret_cast<char*>(std::data(out));
+        for (std::size_t i = 0; i != count; ++i, frame += frame_size, dst += item_size) {
+            size_type size;
+            std::memcpy(&size, frame, sizeof(size));
+            if (convert_from_big_endian(size) != item_size) {
+                return false;
+            }
+            std::memcpy(dst, frame + sizeof(size_type), item_size);
+        }
+        convert_from_big_endian(std::data(out), count);
+        in.skip(count * frame_size);
+        return true;
+    }
 
     template <typename OidMap>
     static istream& apply(istream& in, size_type, const OidMap& oids, out_type& out) {
@@ -163,6 +199,12 @@ struct recv_array_impl {
 
         fit_array_size(out, dim_header.size);
 
+        if constexpr (bulk_receivable) {
+            if (recv_items_in_bulk(in, out)) {
+                return in;
+            }
+        }
+
         for (auto& item : out) {
             recv_data_frame(in, oids, item);
         }
@@ -14,10 +14,13 @@
 #include <boost/hana/for_each.hpp>
 #include <boost/hana/tuple.hpp>
 #include <boost/hana/ext/std/array.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
 
 #include <libpq-fe.h>
 
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <iterator>
 #include <memory>
 #include <string_view>
@@ -47,9 +50,7 @@ public:
      */
     template <class Text, class Params, class OidMap, class Allocator = std::allocator<char>>
     binary_query(Text text, const Params& params, const OidMap& oid_map, const Allocator& allocator = Allocator{})
-    : impl{std::allocate_shared<impl_type<Text, Params, OidMap, Allocator>>(
-        allocator, std::move(text), params, oid_map, allocator
-    )} {}
+    : impl{impl_type<Text, Params, OidMap, Allocator>::create(std::move(text), params, oid_map, allocator), false} {}
 
     /**
      * Get raw query text buffer.
@@ -116,54 +117,98 @@ private:
         virtual const int* lengths() const noexcept = 0;
         virtual const char* const* values() const noexcept = 0;
         virtual std::ptrdiff_t params_count() const noexcept = 0;
-        virtual ~interface() = default;
+        virtual void destroy() const noexcept = 0;
+
+        mutable std::atomic<std::size_t> refs{1};
+
+        friend void intrusive_ptr_add_ref(const interface* p) noexcept {
+            p->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        friend void intrusive_ptr_release(const interface* p) noexcept {
+            if (p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                p->destroy();
+            }
+        }
+
+    protected:
+        ~interface() = default;
     };
 
+    // The implementation object, its arrays and the binary representation of the parameters
+    // are placed within a single memory block: the parameters buffer immediately follows the object.
     template <class Text, class Params, class OidMap, class Allocator = std::allocator<char>>
     struct impl_type final : interface {
         static_assert(bozo::HanaSequence<Params>, "Params should be Hana.Sequence");
         static_assert(bozo::OidMap<OidMap>, "OidMap should model bozo::OidMap");
         static_assert(bozo::QueryText<Text>, "Text should model bozo::QueryText concept");
 
-        using allocator_type = std::conditional_t<
-                                std::is_same_v<typename Allocator::value_type, char>,
-                                    Allocator,
-                                    typename std::allocator_traits<Allocator>::template rebind_alloc<char>>;
-        using buffer_type = std::vector<char, allocator_type>;
+        using storage_type = std::max_align_t;
+        using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<storage_type>;
+        using allocator_traits = std::allocator_traits<allocator_type>;
         using oid_map_type = OidMap;
         using text_type = std::decay_t<Text>;
         using params_type = Params;
 
         static constexpr auto params_count_ = decltype(hana::length(std::declval<params_type>()))::value;
 
+        allocator_type allocator_;
+        std::size_t storage_size_;
         text_type text_;
-        buffer_type buffer_;
         std::array<oid_t, params_count_> types_;
         std::array<int, params_count_> formats_;
         std::array<int, params_count_> lengths_;
         std::array<const char*, params_count_> values_;
 
-        impl_type(Text text, const Params& params,
-            const OidMap& oid_map, const Allocator& allocator)
-        : text_(std::move(text)), buffer_(allocator) {
+        static constexpr std::size_t storage_size(std::size_t buffer_size) noexcept {
+            return (sizeof(impl_type) + buffer_size + sizeof(storage_type) - 1) / sizeof(storage_type);
+        }
+
+        static const interface* create(Text text, const Params& params,
+                const OidMap& oid_map, const Allocator& allocator) {
+            static_assert(alignof(impl_type) <= alignof(storage_type), "impl_type is overaligned");
+
+            std::array<int, params_count_> lengths;
+            const auto range = hana::to_tuple(hana::make_range(hana::size_c<0>, hana::size_c<params_count_>));
+            hana::for_each(range, [&] (auto i) {
+                lengths[i] = std::max(0, size_of(params[i]));
+            });
+            const std::size_t buffer_size = hana::unpack(lengths, [](auto ...x) {return (std::size_t(x) + ... + 0);});
+
+            allocator_type alloc(allocator);
+            const auto n = storage_size(buffer_size);
+            const auto storage = allocator_traits::allocate(alloc, n);
+            try {
+                return ::new (static_cast<void*>(std::addressof(*storage))) impl_type(
+                    std::move(text), params, oid_map, lengths, alloc, n);
+            } catch (...) {
+                allocator_traits::deallocate(alloc, storage, n);
+                throw;
+            }
+        }
+
+        impl_type(Text text, const Params& params, const OidMap& oid_map,
+            const std::array<int, params_count_>& lengths, const allocator_type& allocator,
+            std::size_t storage_size)
+        : allocator_(allocator), storage_size_(storage_size), text_(std::move(text)), lengths_(lengths) {
             formats_.fill(binary_format);
 
             const auto range = hana::to_tuple(hana::make_range(hana::size_c<0>, hana::size_c<params_count_>));
 
             hana::for_each(range, [&] (auto i) {
-                lengths_[i] = std::max(0, size_of(params[i]));
                 types_[i] = type_oid(oid_map, params[i]);
             });
 
-            buffer_.reserve(hana::unpack(lengths_, [](auto ...x) {return (x + ... + 0);}));
+            char* buffer = reinterpret_cast<char*>(this) + sizeof(impl_type);
+            const std::size_t buffer_size = storage_size_ * sizeof(storage_type) - sizeof(impl_type);
 
-            bozo::ostream os(buffer_);
+            bozo::ostream os(buffer, buffer + buffer_size);
 
             hana::for_each(params, [&] (auto& param) { send(os, oid_map, param);});
 
             std::size_t offset = 0;
             hana::for_each(range, [&] (auto i) {
-                values_[i] = lengths_[i] ? std::data(buffer_) + offset : nullptr;
+                values_[i] = lengths_[i] ? buffer + offset : nullptr;
                 offset += lengths_[i];
             });
         }
@@ -194,9 +239,17 @@ private:
         std::ptrdiff_t params_count() const noexcept override {
             return params_count_;
         }
+
+        void destroy() const noexcept override {
+            auto self = const_cast<impl_type*>(this);
+            allocator_type alloc(std::move(self->allocator_));
+            const auto n = storage_size_;
+            self->~impl_type();
+            allocator_traits::deallocate(alloc, reinterpret_cast<storage_type*>(self), n);
+        }
     };
 
-    std::shared_ptr<const interface> impl;
+    boost::intrusive_ptr<const interface> impl;
 };
 
 namespace detail {
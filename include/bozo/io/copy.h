@@ -0,0 +1,162 @@
+#pragma once
+
+#include <bozo/core/concept.h>
+#include <bozo/io/send.h>
+#include <bozo/io/size_of.h>
+#include <bozo/io/ostream.h>
+#include <bozo/io/istream.h>
+#include <bozo/io/recv.h>
+
+#include <boost/fusion/include/for_each.hpp>
+#include <boost/fusion/include/size.hpp>
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
+#include <boost/hana/accessors.hpp>
+#include <boost/hana/members.hpp>
+#include <boost/hana/second.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bozo::detail {
+
+/**
+ * Signature of the PostgreSQL binary `COPY` format followed by the flags field
+ * and the header extension area length, both are zero.
+ */
+inline constexpr std::array<char, 19> copy_binary_header = {
+    'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0',
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+};
+
+/**
+ * Trailer of the PostgreSQL binary `COPY` format, i.e. the field count of -1.
+ */
+inline constexpr std::int16_t copy_binary_trailer = -1;
+
+/**
+ * Size of the signature of the PostgreSQL binary `COPY` format.
+ */
+inline constexpr std::size_t copy_binary_signature_size = 11;
+
+template <typename T, typename Func>
+inline void for_each_copy_field(T&& row, Func&& f) {
+    using type = std::decay_t<T>;
+    if constexpr (HanaStruct<type>) {
+        hana::for_each(hana::accessors<type>(), [&](auto accessor) {
+            f(hana::second(accessor)(row));
+        });
+    } else if constexpr (FusionSequence<type>) {
+        fusion::for_each(row, std::forward<Func>(f));
+    } else {
+        static_assert(HanaSequence<type>, "COPY row should be a HanaStruct, FusionSequence or HanaSequence");
+        hana::for_each(row, std::forward<Func>(f));
+    }
+}
+
+template <typename T>
+constexpr std::int16_t copy_fields_count(const T& row) {
+    if constexpr (HanaStruct<T>) {
+        return std::int16_t(decltype(hana::length(hana::members(row)))::value);
+    } else if constexpr (FusionSequence<T>) {
+        return std::int16_t(fusion::result_of::size<T>::value);
+    } else {
+        return std::int16_t(decltype(hana::length(row))::value);
+    }
+}
+
+/**
+ * Size of the binary `COPY` tuple of the row: the fields count and
+ * a data frame for each field.
+ */
+template <typename T>
+inline std::size_t copy_tuple_size(const T& row) {
+    std::size_t retval = sizeof(std::int16_t);
+    for_each_copy_field(row, [&](const auto& v) { retval += data_frame_size(v);});
+    return retval;
+}
+
+/**
+ * Appends the row as a binary `COPY` tuple to the buffer.
+ */
+template <typename OidMap, typename T>
+inline void send_copy_tuple(std::vector<char>& buffer, const OidMap& oid_map, const T& row) {
+    const auto offset = buffer.size();
+    buffer.resize(offset + copy_tuple_size(row));
+    ostream out(buffer.data() + offset, buffer.data() + buffer.size());
+    write(out, copy_fields_count(row));
+    for_each_copy_field(row, [&](const auto& v) { send_data_frame(out, oid_map, v);});
+}
+
+/**
+ * Receives rows from the binary `COPY` data stream. The stream is read by messages
+ * as they come from the server: the header precedes the first tuple and the
+ * trailer ends the stream.
+ */
+class copy_tuple_reader {
+public:
+    /**
+     * Receives the tuples of the message into the `Row` objects and passes them to the output.
+     */
+    template <typename Row, typename OidMap, typename Out>
+    void read(const char* data, std::size_t size, const OidMap& oids, Out&& out) {
+        istream in(data, size);
+        if (!started_) {
+            read_header(in);
+            started_ = true;
+        }
+        while (!finished_ && in.peek(1)) {
+            std::int16_t count = 0;
+            bozo::read(in, count);
+            if (count == copy_binary_trailer) {
+                finished_ = true;
+                break;
+            }
+            Row row{};
+            if (count != copy_fields_count(row)) {
+                throw std::range_error("COPY tuple size " + std::to_string(count)
+                    + " does not match row " + boost::core::demangle(typeid(row).name())
+                    + " size " + std::to_string(copy_fields_count(row)));
+            }
+            for_each_copy_field(row, [&](auto& v) { recv_data_frame(in, null_oid, oids, v);});
+            out(std::move(row));
+        }
+    }
+
+    /**
+     * Indicates if the trailer of the stream has been received.
+     */
+    bool finished() const noexcept { return finished_;}
+
+private:
+    static void read_header(istream& in) {
+        const auto signature = in.peek(copy_binary_signature_size);
+        if (!signature || !std::equal(signature, signature + copy_binary_signature_size,
+                copy_binary_header.begin())) {
+            throw std::invalid_argument("unexpected binary COPY signature");
+        }
+        in.skip(copy_binary_signature_size);
+        std::int32_t flags = 0;
+        std::int32_t extension_size = 0;
+        bozo::read(in, flags);
+        bozo::read(in, extension_size);
+        // Bits 16-31 of the flags are critical, e.g. OIDs included into the data
+        if (flags & std::int32_t(0xFFFF0000)) {
+            throw std::invalid_argument("unsupported binary COPY flags " + std::to_string(flags));
+        }
+        if (extension_size < 0 || !in.skip(static_cast<std::size_t>(extension_size))) {
+            throw system_error(error::unexpected_eof, "binary COPY header extension");
+        }
+    }
+
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace bozo::detail
@@ -27,6 +27,12 @@ class istream {
             i_ = last;
             return n;
         }
+
+        const char* data() const noexcept { return i_;}
+
+        std::size_t size() const noexcept { return static_cast<std::size_t>(last_ - i_);}
+
+        void skip(std::size_t n) noexcept { i_ += std::min(n, size());}
     };
 public:
     using traits_type = std::istream::traits_type;
@@ -53,6 +59,26 @@ public:
 
     operator bool() const noexcept { return !unexpected_eof_;}
 
+    /**
+     * Get access to the next `len` bytes of the stream without extracting them.
+     *
+     * @return pointer to the bytes or `nullptr` if the stream contains less bytes.
+     */
+    const char_type* peek(std::size_t len) const noexcept {
+        return buf_.size() < len ? nullptr : buf_.data();
+    }
+
+    /**
+     * Extract and discard `len` bytes from the stream.
+     */
+    istream& skip(std::size_t len) noexcept {
+        if (buf_.size() < len) {
+            unexpected_eof_ = true;
+        }
+        buf_.skip(len);
+        return *this;
+    }
+
     template <typename T>
     Require<RawDataWritable<T>, istream&> read(T& out) {
         using std::data;
@@ -10,8 +10,11 @@
 #include <boost/hana/members.hpp>
 #include <boost/hana/tuple.hpp>
 
-#include <vector>
+#include <cstring>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <vector>
 
 namespace bozo {
 
@@ -20,15 +23,36 @@ public:
     using traits_type = std::ostream::traits_type;
     using char_type = std::ostream::char_type;
 
-    ostream(std::vector<char_type>& buf) : buf_(buf) {}
+    /**
+     * Constructs the stream which appends data to the growing buffer.
+     */
+    ostream(std::vector<char_type>& buf) : buf_(std::addressof(buf)) {}
+
+    /**
+     * Constructs the stream which writes data into the preallocated memory
+     * `[first, last)`, e.g. sized by `bozo::size_of()` beforehand. Writing
+     * beyond the memory causes `std::length_error` exception.
+     */
+    ostream(char_type* first, char_type* last) noexcept : pos_(first), end_(last) {}
 
     ostream& write(const char_type* s, std::streamsize n) {
-        buf_.insert(buf_.end(), s, s + n);
+        if (buf_) {
+            buf_->insert(buf_->end(), s, s + n);
+        } else {
+            reserve(n);
+            std::memcpy(pos_, s, static_cast<std::size_t>(n));
+            pos_ += n;
+        }
         return *this;
     }
 
     ostream& put(char_type ch) {
-        buf_.push_back(ch);
+        if (buf_) {
+            buf_->push_back(ch);
+        } else {
+            reserve(1);
+            *pos_++ = ch;
+        }
         return *this;
     }
 
@@ -73,7 +97,15 @@ public:
     }
 
 private:
-    std::vector<char_type>& buf_;
+    void reserve(std::streamsize n) const {
+        if (n > end_ - pos_) {
+            throw std::length_error("data size exceeds preallocated ostream buffer size");
+        }
+    }
+
+    std::vector<char_type>* buf_ = nullptr;
+    char_type* pos_ = nullptr;
+    char_type* end_ = nullptr;
 };
 
 template <typename ...Ts>
@@ -10,10 +10,15 @@
 #include <bozo/io/istream.h>
 #include <bozo/io/type_traits.h>
 #include <boost/core/demangle.hpp>
+#include <boost/hana/accessors.hpp>
+#include <boost/hana/first.hpp>
 #include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
 #include <boost/hana/members.hpp>
 #include <boost/hana/size.hpp>
 
+#include <array>
+
 namespace bozo {
 template <int... I>
 constexpr std::tuple<boost::mpl::int_<I>...>
@@ -325,11 +330,128 @@ recv_row(const row<T>& in, const OidMap& oid_map, Out& out) {
     });
 }
 
+namespace detail {
+
+template <typename Out, typename = std::void_t<>>
+struct row_columns_count : std::integral_constant<std::size_t, 1> {};
+
+template <typename Out>
+struct row_columns_count<Out, std::enable_if_t<
+    (FusionSequence<Out> || FusionAdaptedStruct<Out>) && !HanaStruct<Out>>>
+: std::integral_constant<std::size_t, fusion::result_of::size<Out>::value> {};
+
+template <typename Out>
+struct row_columns_count<Out, std::enable_if_t<HanaStruct<Out>>>
+: std::integral_constant<std::size_t,
+    decltype(hana::length(hana::accessors<Out>()))::value> {};
+
+/**
+ * Columns of a result which correspond to the members of the row type
+ * in order of the members. The mapping and the columns oids are the same
+ * for all the rows of a result, so they are resolved and checked once
+ * per result rather than for each row.
+ */
+template <std::size_t N>
+struct result_columns {
+    std::array<int, N> index {};
+    std::array<bool, N> oid_checked {};
+};
+
+template <typename Out>
+using result_columns_of = result_columns<row_columns_count<Out>::value>;
+
+template <typename Out, typename T>
+inline result_columns_of<Out> make_result_columns(const row<T>& in) {
+    result_columns_of<Out> retval;
+    constexpr std::size_t size = std::tuple_size_v<decltype(retval.index)>;
+
+    if constexpr (!FusionSequence<Out> && !FusionAdaptedStruct<Out> && !HanaStruct<Out>) {
+        if (std::size(in) != 1) {
+            throw std::range_error("row size " + std::to_string(std::size(in))
+                + " does not equal 1 for single column result");
+        }
+    } else if (size != std::size(in)) {
+        throw std::range_error("row size " + std::to_string(std::size(in))
+            + " does not match " + (FusionSequence<Out> && !FusionAdaptedStruct<Out> ? "sequence " : "structure ")
+            + boost::core::demangle(typeid(Out).name())
+            + " size " + std::to_string(size));
+    }
+
+    const auto find = [&](std::size_t n, const char* name) {
+        auto i = in.find(name);
+        if (i == in.end()) {
+            throw std::range_error(std::string("row does not contain \"")
+                + name + "\" column for "
+                + boost::core::demangle(typeid(Out).name()));
+        }
+        retval.index[n] = static_cast<int>(i - in.begin());
+    };
+
+    if constexpr (HanaStruct<Out>) {
+        std::size_t n = 0;
+        hana::for_each(hana::accessors<Out>(), [&](auto accessor) {
+            find(n++, hana::to<const char*>(hana::first(accessor)));
+        });
+    } else if constexpr (FusionAdaptedStruct<Out>) {
+        fusion::for_each(make_index_sequence(boost::mpl::int_<int(size)>{}), [&](auto idx) {
+            find(idx.value, fusion::extension::struct_member_name<Out, idx.value>::call());
+        });
+    } else {
+        for (std::size_t n = 0; n != size; ++n) {
+            retval.index[n] = static_cast<int>(n);
+        }
+    }
+    return retval;
+}
+
+template <typename T, typename OidMap, std::size_t N, typename Out>
+inline void recv_column(const row<T>& in, const OidMap& oids,
+        result_columns<N>& columns, std::size_t n, Out& out) {
+    const auto v = in[columns.index[n]];
+    const bool is_null = v.is_null();
+    istream s(v.data(), v.size());
+    const auto size = (is_null ? null_state_size : v.size());
+    if (columns.oid_checked[n]) {
+        recv(s, null_oid, size, oids, out);
+    } else {
+        recv(s, v.oid(), size, oids, out);
+        // Null value of a nullable is received without the oid check
+        columns.oid_checked[n] = !is_null;
+    }
+}
+
+template <typename T, typename OidMap, std::size_t N, typename Out>
+inline void recv_row(const row<T>& in, const OidMap& oids, result_columns<N>& columns, Out& out) {
+    if constexpr (HanaStruct<Out>) {
+        std::size_t n = 0;
+        hana::for_each(hana::keys(out), [&](auto key) {
+            recv_column(in, oids, columns, n++, hana::at_key(out, key));
+        });
+    } else if constexpr (FusionAdaptedStruct<Out>) {
+        fusion::for_each(make_index_sequence(fusion::size(out)), [&](auto idx) {
+            recv_column(in, oids, columns, idx.value, member_value(out, idx));
+        });
+    } else if constexpr (FusionSequence<Out>) {
+        std::size_t n = 0;
+        fusion::for_each(out, [&](auto& item) {
+            recv_column(in, oids, columns, n++, item);
+        });
+    } else {
+        recv_column(in, oids, columns, 0, out);
+    }
+}
+
+} // namespace detail
+
 template <typename T, typename OidMap, typename Out>
 Require<ForwardIterator<Out>, Out>
 recv_result(const basic_result<T>& in, const OidMap& oid_map, Out out) {
+    if (std::empty(in)) {
+        return out;
+    }
+    auto columns = detail::make_result_columns<std::decay_t<decltype(*out)>>(*in.begin());
     for (auto row : in) {
-        recv_row(row, oid_map, *out++);
+        detail::recv_row(row, oid_map, columns, *out++);
     }
     return out;
 }
@@ -337,9 +459,14 @@ recv_result(const basic_result<T>& in, const OidMap& oid_map, Out out) {
 template <typename T, typename OidMap, typename Out>
 Require<InsertIterator<Out>, Out>
 recv_result(const basic_result<T>& in, const OidMap& oid_map, Out out) {
+    using value_type = typename Out::container_type::value_type;
+    if (std::empty(in)) {
+        return out;
+    }
+    auto columns = detail::make_result_columns<value_type>(*in.begin());
     for (auto row : in) {
-        typename Out::container_type::value_type v{};
-        recv_row(row, oid_map, v);
+        value_type v{};
+        detail::recv_row(row, oid_map, columns, v);
         *out++ = std::move(v);
     }
     return out;
@@ -352,8 +479,9 @@ basic_result<T>& recv_result(basic_result<T>& in, const OidMap&, basic_result<T>
 }
 
 template <typename T, typename OidMap, typename Out>
-basic_result<T>& recv_result(basic_result<T>& in, const OidMap& oid_map, std::reference_wrapper<Out> out) {
-    return recv_result(in, oid_map, out.get());
+Out& recv_result(basic_result<T>& in, const OidMap& oid_map, std::reference_wrapper<Out> out) {
+    recv_result(in, oid_map, out.get());
+    return out.get();
 }
 
 } // namespace bozo
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <bozo/error.h>
+#include <bozo/request.h>
+#include <bozo/shortcuts.h>
+#include <bozo/time_traits.h>
+#include <bozo/detail/bind.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bozo {
+
+/**
+ * @brief Lookup batcher configuration
+ * @ingroup group-requests-types
+ *
+ * Configuration of the `bozo::lookup_batcher`, i.e. how long and how many lookups are
+ * collected into a single batch query.
+ */
+struct lookup_batcher_config {
+    time_traits::duration window = std::chrono::milliseconds(1); //!< time interval since the first lookup of a batch to send the batch query
+    std::size_t max_batch_size = 1000; //!< maximum number of lookups in a batch, the batch query is sent immediately once it is reached
+    time_traits::duration timeout = std::chrono::seconds(10); //!< time constraint of a batch query, 0 disables it
+};
+
+namespace detail {
+
+struct first_column {
+    template <typename Row>
+    decltype(auto) operator() (const Row& row) const {
+        using std::get;
+        return get<0>(row);
+    }
+};
+
+template <typename Key, typename Row>
+struct lookup_waiter {
+    Key key;
+
+    explicit lookup_waiter(Key key) : key(std::move(key)) {}
+
+    virtual ~lookup_waiter() = default;
+
+    virtual void complete(error_code ec, const Row* const* first, const Row* const* last) = 0;
+};
+
+template <typename Key, typename Row, typename Out, typename Handler>
+class lookup_waiter_impl final : public lookup_waiter<Key, Row> {
+public:
+    lookup_waiter_impl(Key key, Out out, Handler handler, io_context& io)
+    : lookup_waiter<Key, Row>(std::move(key)), out_(std::move(out)), handler_(std::move(handler)),
+      work_(asio::get_associated_executor(handler_, io.get_executor())) {}
+
+    void complete(error_code ec, const Row* const* first, const Row* const* last) override {
+        if (!ec) {
+            try {
+                std::for_each(first, last, [&] (const Row* row) { *out_++ = *row;});
+            } catch (const std::exception&) {
+                ec = error::bad_result_process;
+            }
+        }
+        asio::post(work_.get_executor(), detail::bind(std::move(handler_), std::move(ec)));
+        work_.reset();
+    }
+
+private:
+    using executor_type = asio::associated_executor_t<Handler, io_context::executor_type>;
+
+    Out out_;
+    Handler handler_;
+    asio::executor_work_guard<executor_type> work_;
+};
+
+template <typename Key, typename Row, typename Provider, typename QueryBuilder, typename KeyOf, typename Operation>
+class lookup_batcher_state : public std::enable_shared_from_this<
+        lookup_batcher_state<Key, Row, Provider, QueryBuilder, KeyOf, Operation>> {
+public:
+    using waiter_type = lookup_waiter<Key, Row>;
+
+    lookup_batcher_state(io_context& io, Provider provider, QueryBuilder builder,
+            const lookup_batcher_config& config, KeyOf key_of, Operation op)
+    : io_(io), provider_(std::move(provider)), builder_(std::move(builder)),
+      config_(config), key_of_(std::move(key_of)), op_(std::move(op)) {}
+
+    io_context& get_io_context() const noexcept { return io_;}
+
+    void add(std::unique_ptr<waiter_type> waiter) {
+        std::shared_ptr<batch> full;
+        {
+            const std::lock_guard lock(mutex_);
+            if (!pending_) {
+                pending_ = std::make_shared<batch>(io_);
+                pending_->timer.expires_after(config_.window);
+                pending_->timer.async_wait([self = this->shared_from_this(), b = pending_] (error_code ec) {
+                    if (!ec) {
+                        self->flush(b);
+                    }
+                });
+            }
+            pending_->waiters.push_back(std::move(waiter));
+            if (pending_->waiters.size() >= config_.max_batch_size) {
+                full = std::move(pending_);
+                full->timer.cancel();
+            }
+        }
+        if (full) {
+            send(std::move(full));
+        }
+    }
+
+private:
+    struct batch {
+        asio::steady_timer timer;
+        std::vector<std::unique_ptr<waiter_type>> waiters;
+        std::vector<Row> rows;
+        std::atomic_bool completed {false};
+
+        explicit batch(io_context& io) : timer(io) {}
+    };
+
+    struct batch_handler {
+        std::shared_ptr<lookup_batcher_state> self_;
+        std::shared_ptr<batch> batch_;
+
+        template <typename Connection>
+        void operator() (error_code ec, Connection&&) {
+            self_->scatter(*batch_, std::move(ec));
+        }
+    };
+
+    void flush(const std::shared_ptr<batch>& b) {
+        {
+            const std::lock_guard lock(mutex_);
+            if (pending_ != b) {
+                return;
+            }
+            pending_.reset();
+        }
+        send(b);
+    }
+
+    void send(std::shared_ptr<batch> b) {
+        // Waiters must not hang and the exception must not escape into the timer
+        // handler, so a failure to make or to send the query completes the batch.
+        try {
+            std::vector<Key> keys;
+            keys.reserve(b->waiters.size());
+            for (const auto& waiter : b->waiters) {
+                keys.push_back(waiter->key);
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            auto query = builder_(std::move(keys));
+            auto out = bozo::into(b->rows);
+            batch_handler handler{this->shared_from_this(), b};
+            if (config_.timeout == time_traits::duration::zero()) {
+                op_(provider_, std::move(query), none, std::move(out), std::move(handler));
+            } else {
+                op_(provider_, std::move(query), config_.timeout, std::move(out), std::move(handler));
+            }
+        } catch (...) {
+            fail(*b, error::bad_batch_query);
+        }
+    }
+
+    void fail(batch& b, error_code ec) {
+        if (b.completed.exchange(true)) {
+            return;
+        }
+        for (auto& waiter : b.waiters) {
+            waiter->complete(ec, nullptr, nullptr);
+        }
+    }
+
+    void scatter(batch& b, error_code ec) {
+        if (b.completed.exchange(true)) {
+            return;
+        }
+        std::size_t i = 0;
+        try {
+            std::vector<const Row*> index;
+            index.reserve(b.rows.size());
+            for (const auto& row : b.rows) {
+                index.push_back(std::addressof(row));
+            }
+            std::stable_sort(index.begin(), index.end(), [&] (const Row* lhs, const Row* rhs) {
+                return key_of_(*lhs) < key_of_(*rhs);
+            });
+            while (i != b.waiters.size()) {
+                const auto& key = b.waiters[i]->key;
+                const auto first = std::lower_bound(index.begin(), index.end(), key,
+                    [&] (const Row* row, const Key& k) { return key_of_(*row) < k;});
+                auto last = first;
+                while (last != index.end() && !(key < key_of_(**last))) {
+                    ++last;
+                }
+                b.waiters[i++]->complete(ec, index.data() + (first - index.begin()), index.data() + (last - index.begin()));
+            }
+        } catch (...) {
+            while (i != b.waiters.size()) {
+                b.waiters[i++]->complete(error::bad_result_process, nullptr, nullptr);
+            }
+        }
+    }
+
+    io_context& io_;
+    Provider provider_;
+    QueryBuilder builder_;
+    const lookup_batcher_config config_;
+    KeyOf key_of_;
+    Operation op_;
+    std::mutex mutex_;
+    std::shared_ptr<batch> pending_;
+};
+
+} // namespace detail
+
+/**
+ * @brief Coalesces concurrent single-key lookups into batch queries
+ *
+ * Handlers often request the same `SELECT ... WHERE id = $1` concurrently, each call costs
+ * a round trip and a connection from the pool. The batcher collects the lookups made within
+ * `lookup_batcher_config::window` since the first one (or until `lookup_batcher_config::max_batch_size`
+ * lookups are collected) and sends them as a single query for all the distinct keys, e.g.
+ * `SELECT ... WHERE id = ANY($1::bigint[])`, where the keys are bound as a `std::vector` parameter.
+ * The rows of the batch query are scattered back to the lookups by the key of a row, so each lookup
+ * receives the rows with its key only.
+ *
+ * Each lookup completes with the signature `void(error_code)` since the batch connection is shared
+ * between the lookups. If the batch query fails every lookup of the batch completes with the error,
+ * if the query could not be made or sent, e.g. the builder or the operation throws, every lookup of
+ * the batch completes with `bozo::error::bad_batch_query`.
+ *
+ * @tparam Row --- type of a row of the batch query result.
+ * @tparam Key --- type of a key, should be less than comparable.
+ * @tparam Provider --- `ConnectionProvider` to send batch queries through.
+ * @tparam QueryBuilder --- callable which makes the batch query of `std::vector<Key>` of distinct keys.
+ * @tparam KeyOf --- callable which returns the key of a row, the first column of the row by default.
+ * @tparam Operation --- operation to send batch queries via, `bozo::request` by default,
+ * `bozo::request[strategy]` may be used for failover.
+ *
+ * ### Example
+ *
+ * @code
+auto users = bozo::make_lookup_batcher<std::tuple<std::int64_t, std::string>>(io, conn_pool[io],
+    [] (std::vector<std::int64_t> ids) {
+        return "SELECT id, name FROM users WHERE id = ANY("_SQL + std::move(ids) + "::bigint[])"_SQL;
+    });
+
+std::vector<std::tuple<std::int64_t, std::string>> user;
+users(user_id, bozo::into(user), yield);
+ * @endcode
+ *
+ * @thread_safety{Safe,Safe}
+ * @ingroup group-requests-types
+ */
+template <typename Row, typename Key, typename Provider, typename QueryBuilder,
+        typename KeyOf = detail::first_column, typename Operation = std::decay_t<decltype(bozo::request)>>
+class lookup_batcher {
+public:
+    using row_type = Row; //!< Type of a row of the batch query result
+    using key_type = Key; //!< Type of a key
+
+    /**
+     * Construct a new lookup batcher object
+     *
+     * @param io --- `io_context` to run the batch window timers on.
+     * @param provider --- `ConnectionProvider` to send batch queries through.
+     * @param builder --- callable which makes the batch query of `std::vector<Key>`.
+     * @param config --- batching configuration.
+     * @param key_of --- callable which returns the key of a row.
+     * @param op --- operation to send batch queries via.
+     */
+    lookup_batcher(io_context& io, Provider provider, QueryBuilder builder,
+            const lookup_batcher_config& config = lookup_batcher_config{},
+            KeyOf key_of = KeyOf{}, Operation op = Operation{})
+    : state_(std::make_shared<state_type>(io, std::move(provider), std::move(builder),
+            config, std::move(key_of), std::move(op))) {}
+
+    /**
+     * Looks up rows with the key, the rows are written into the output once the batch is completed.
+     *
+     * @param key --- key to look up.
+     * @param out --- output iterator of `Row`, e.g. `bozo::into(std::vector<Row>&)`.
+     * @param token --- operation #CompletionToken with the signature `void(error_code)`.
+     * @return deduced from #CompletionToken.
+     */
+    template <typename Out, typename CompletionToken>
+    decltype(auto) operator() (Key key, Out out, CompletionToken&& token) const {
+        return async_initiate<CompletionToken, void(error_code)>(
+            initiator{state_}, token, std::move(key), std::move(out));
+    }
+
+private:
+    using state_type = detail::lookup_batcher_state<Key, Row, Provider, QueryBuilder, KeyOf, Operation>;
+
+    struct initiator {
+        std::shared_ptr<state_type> state_;
+
+        template <typename Handler, typename Out>
+        void operator() (Handler&& handler, Key key, Out out) const {
+            using waiter_type = detail::lookup_waiter_impl<Key, Row, Out, std::decay_t<Handler>>;
+            state_->add(std::make_unique<waiter_type>(std::move(key), std::move(out),
+                std::forward<Handler>(handler), state_->get_io_context()));
+        }
+    };
+
+    std::shared_ptr<state_type> state_;
+};
+
+/**
+ * @brief Creates `bozo::lookup_batcher`
+ *
+ * @tparam Row --- type of a row of the batch query result.
+ * @tparam Key --- type of a key, `std::int64_t` by default.
+ * @param io --- `io_context` to run the batch window timers on.
+ * @param provider --- `ConnectionProvider` to send batch queries through.
+ * @param builder --- callable which makes the batch query of `std::vector<Key>`.
+ * @param config --- batching configuration.
+ * @param key_of --- callable which returns the key of a row, the first column of the row by default.
+ * @param op --- operation to send batch queries via, `bozo::request` by default.
+ * @return `bozo::lookup_batcher` object.
+ * @ingroup group-requests-functions
+ */
+template <typename Row, typename Key = std::int64_t, typename Provider, typename QueryBuilder,
+        typename KeyOf = detail::first_column, typename Operation = std::decay_t<decltype(bozo::request)>>
+auto make_lookup_batcher(io_context& io, Provider&& provider, QueryBuilder&& builder,
+        const lookup_batcher_config& config = lookup_batcher_config{},
+        KeyOf key_of = KeyOf{}, Operation op = bozo::request) {
+    return lookup_batcher<Row, Key, std::decay_t<Provider>, std::decay_t<QueryBuilder>, KeyOf, Operation>(
+        io, std::forward<Provider>(provider), std::forward<QueryBuilder>(builder), config,
+        std::move(key_of), std::move(op));
+}
+
+} // namespace bozo
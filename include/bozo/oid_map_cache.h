@@ -0,0 +1,263 @@
+#pragma once
+
+#include <bozo/time_traits.h>
+#include <bozo/type_traits.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <typeindex>
+#include <vector>
+
+namespace bozo {
+
+/**
+ * @brief Process-wide cache of custom types OIDs
+ *
+ * Connections with a not empty #OidMap request OIDs of the custom types from a database
+ * right after the connection is established. It costs an additional round trip per
+ * connection which may be significant, e.g. during reconnect storms. With the cache
+ * enabled OIDs are requested once per database and #OidMap type and shared between all
+ * the connections and connection pools of the process, so a new connection is usable
+ * right after it has been established.
+ *
+ * Cached OIDs are refreshed in the background of the regular work: once the refresh
+ * interval has passed, a single new connection requests OIDs again and updates the cache while
+ * the other connections keep using the cached OIDs. The same way a single connection requests
+ * OIDs missing in the cache while the other ones wait for them within their connect deadline.
+ * If the request fails or its handler is dropped, the waiters look the OIDs up again.
+ * If custom types have been recreated, the cache should be invalidated explicitly via
+ * `invalidate()`.
+ *
+ * The cache is disabled by default.
+ *
+ * ### Example
+ *
+@code{cpp}
+bozo::oid_map_cache::global().enable(std::chrono::minutes(10));
+@endcode
+ *
+ * @thread_safety{Safe,Safe}
+ * @ingroup group-type_system-types
+ */
+class oid_map_cache {
+public:
+    using oids_type = std::vector<oid_t>;
+
+    /**
+     * Identity of cached OIDs: #OidMap type and database the connection is established to.
+     */
+    struct key_type {
+        std::type_index oid_map;
+        std::string host;
+        std::string port;
+        std::string database;
+        std::string user;
+
+        friend bool operator< (const key_type& lhs, const key_type& rhs) noexcept {
+            return std::tie(lhs.oid_map, lhs.host, lhs.port, lhs.database, lhs.user)
+                < std::tie(rhs.oid_map, rhs.host, rhs.port, rhs.database, rhs.user);
+        }
+    };
+
+    /**
+     * Result of the cache lookup.
+     */
+    struct lookup_result {
+        std::optional<oids_type> oids; //!< cached OIDs if any
+        bool refresh = false; //!< the caller should request OIDs and update the cache
+        bool pending = false; //!< OIDs are being requested by another caller, see `wait()`
+    };
+
+    using waiter_type = std::function<void()>;
+
+    /**
+     * Cache shared by all the connection sources of the process.
+     */
+    static oid_map_cache& global() {
+        static oid_map_cache instance;
+        return instance;
+    }
+
+    /**
+     * Enables the cache.
+     *
+     * @param refresh_interval --- time interval to request cached OIDs again.
+     */
+    void enable(time_traits::duration refresh_interval = std::chrono::minutes(5)) {
+        const std::lock_guard lock(mutex_);
+        refresh_interval_ = refresh_interval;
+        enabled_ = true;
+    }
+
+    /**
+     * Disables the cache and drops all the cached OIDs.
+     */
+    void disable() {
+        std::vector<waiter_type> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            enabled_ = false;
+            for (auto& [key, entry] : entries_) {
+                take_waiters(entry, waiters);
+            }
+            entries_.clear();
+        }
+        notify(waiters);
+    }
+
+    bool enabled() const {
+        const std::lock_guard lock(mutex_);
+        return enabled_;
+    }
+
+    /**
+     * Drops all the cached OIDs.
+     */
+    void invalidate() {
+        std::vector<waiter_type> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            for (auto& [key, entry] : entries_) {
+                take_waiters(entry, waiters);
+            }
+            entries_.clear();
+        }
+        notify(waiters);
+    }
+
+    /**
+     * Drops cached OIDs for the database.
+     */
+    void invalidate(std::string_view host, std::string_view port, std::string_view database) {
+        std::vector<waiter_type> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            for (auto i = entries_.begin(); i != entries_.end();) {
+                if (i->first.host == host && i->first.port == port && i->first.database == database) {
+                    take_waiters(i->second, waiters);
+                    i = entries_.erase(i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+        notify(waiters);
+    }
+
+    /**
+     * Looks up cached OIDs. If there are no OIDs or they should be refreshed the caller
+     * is asked to request them and to `update()` the cache or to report `update_failed()`.
+     * Only one caller at a time is asked to request OIDs, while missing OIDs are requested
+     * the other callers are told they are pending.
+     */
+    lookup_result lookup(const key_type& key, time_traits::time_point now = time_traits::now()) {
+        const std::lock_guard lock(mutex_);
+        lookup_result retval;
+        if (!enabled_) {
+            return retval;
+        }
+        const auto i = entries_.find(key);
+        if (i == entries_.end()) {
+            entries_.emplace(key, entry{std::nullopt, now, true, {}});
+            retval.refresh = true;
+            return retval;
+        }
+        if (!i->second.oids) {
+            retval.pending = true;
+            return retval;
+        }
+        retval.oids = i->second.oids;
+        if (!i->second.refreshing && now - i->second.updated >= refresh_interval_) {
+            i->second.refreshing = true;
+            retval.refresh = true;
+        }
+        return retval;
+    }
+
+    /**
+     * Calls the waiter once pending OIDs are stored or their request has failed, so the waiter
+     * should look them up again. The waiter is called right away if OIDs are not pending anymore,
+     * otherwise it is called by the thread which updates the cache.
+     */
+    void wait(const key_type& key, waiter_type waiter) {
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto i = entries_.find(key); i != entries_.end() && !i->second.oids) {
+                i->second.waiters.push_back(std::move(waiter));
+                return;
+            }
+        }
+        waiter();
+    }
+
+    /**
+     * Stores OIDs requested from a database.
+     */
+    void update(const key_type& key, oids_type oids, time_traits::time_point now = time_traits::now()) {
+        std::vector<waiter_type> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto i = entries_.find(key); i != entries_.end()) {
+                take_waiters(i->second, waiters);
+                i->second = entry{std::move(oids), now, false, {}};
+            } else if (enabled_) {
+                entries_.emplace(key, entry{std::move(oids), now, false, {}});
+            }
+        }
+        notify(waiters);
+    }
+
+    /**
+     * Reports failed OIDs request, cached OIDs are kept to be refreshed by the next lookup.
+     * Missing OIDs are requested again by the next lookup.
+     */
+    void update_failed(const key_type& key) {
+        std::vector<waiter_type> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto i = entries_.find(key); i != entries_.end()) {
+                if (i->second.oids) {
+                    i->second.refreshing = false;
+                } else {
+                    take_waiters(i->second, waiters);
+                    entries_.erase(i);
+                }
+            }
+        }
+        notify(waiters);
+    }
+
+private:
+    struct entry {
+        std::optional<oids_type> oids;
+        time_traits::time_point updated;
+        bool refreshing;
+        std::vector<waiter_type> waiters;
+    };
+
+    static void take_waiters(entry& e, std::vector<waiter_type>& waiters) {
+        std::move(e.waiters.begin(), e.waiters.end(), std::back_inserter(waiters));
+        e.waiters.clear();
+    }
+
+    // Waiters are called out of the lock since they may look up the cache again
+    static void notify(std::vector<waiter_type>& waiters) {
+        for (auto& waiter : waiters) {
+            waiter();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    bool enabled_ = false;
+    time_traits::duration refresh_interval_ = std::chrono::minutes(5);
+    std::map<key_type, entry> entries_;
+};
+
+} // namespace bozo
@@ -39,6 +39,15 @@ using result = pg::safe_handle_t<::PGresult>;
 
 using shared_result = std::shared_ptr<::PGresult>;
 
+/**
+ * Buffer allocated by libpq, e.g. a row of `COPY` data returned by `PQgetCopyData`.
+ */
+struct buffer_deleter {
+    void operator() (char *ptr) const noexcept { ::PQfreemem(ptr); }
+};
+
+using buffer = std::unique_ptr<char, buffer_deleter>;
+
 } // namespace bozo::pg
 
 namespace boost::hana {
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bozo/impl/async_pipeline.h>
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+namespace bozo {
+#ifdef BOZO_DOCUMENTATION
+/**
+ * @brief Executes queries in a single round trip and retrives their results from a database with time constraint
+ *
+ * The function sends all the queries to a database within libpq pipeline mode with the one sync point
+ * and provides results of the queries via corresponding out parameters. The handler is called once
+ * all the results are received. If one of the queries fails the following ones are not executed
+ * by the database and the handler is called with the error of the failed query.
+ * The function can be called as any of Boost.Asio asynchronous function with #CompletionToken.
+ * The request would be cancelled if time constrain is reached while performing.
+ *
+ * @note The function is available only if libpq supports pipeline mode (`LIBPQ_HAS_PIPELINING`).
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider object to get connection from.
+ * @param queries --- `boost::hana::tuple` or `std::tuple` of queries to request from a database.
+ * @param time_constraint --- request #TimeConstraint; this time constrain <b>includes</b> time for getting connection from provider.
+ * @param outs --- `boost::hana::tuple` or `std::tuple` of output objects like Iterator, #InsertIterator or `bozo::result`,
+ *                 one for each query; `bozo::none` may be used to ignore a query result.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ *
+ * ###Example
+ *
+ * @code
+bozo::rows_of<std::int64_t> ids;
+bozo::result names;
+
+bozo::pipeline(conn_info[io],
+    hana::make_tuple("SELECT id FROM users"_SQL, "SELECT name FROM users"_SQL),
+    500ms,
+    hana::make_tuple(bozo::into(ids), std::ref(names)),
+    yield);
+ * @endcode
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename Queries, typename TimeConstraint, typename Outs, typename CompletionToken>
+decltype(auto) pipeline (ConnectionProvider&& provider, Queries&& queries, TimeConstraint time_constraint, Outs outs, CompletionToken&& token);
+
+/**
+ * @brief Executes queries in a single round trip and retrives their results from a database
+ *
+ * This function is time constrain free shortcut to `bozo::pipeline()` function.
+ * Its call is equal to `bozo::pipeline(provider, queries, bozo::none, outs, token)` call.
+ *
+ * @note The function does not participate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- connection provider to get connection from.
+ * @param queries --- `boost::hana::tuple` or `std::tuple` of queries to request from a database.
+ * @param outs --- `boost::hana::tuple` or `std::tuple` of output objects, one for each query.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ * @ingroup group-requests-functions
+ */
+template <typename ConnectionProvider, typename Queries, typename Outs, typename CompletionToken>
+decltype(auto) pipeline (ConnectionProvider&& provider, Queries&& queries, Outs outs, CompletionToken&& token);
+
+#else
+
+template <typename Initiator>
+struct pipeline_op : base_async_operation <pipeline_op<Initiator>, Initiator> {
+    using base = typename pipeline_op::base;
+    using base::base;
+
+    template <typename P, typename Q, typename TimeConstraint, typename Outs, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& queries, TimeConstraint t,
+            Outs outs, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<P>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, handler_signature<P>>(
+            get_operation_initiator(*this), token, std::forward<P>(provider), t, std::forward<Q>(queries), std::move(outs));
+    }
+
+    template <typename P, typename Q, typename Outs, typename CompletionToken>
+    decltype(auto) operator()(P&& provider, Q&& queries, Outs outs, CompletionToken&& token) const {
+        return (*this)(std::forward<P>(provider), std::forward<Q>(queries), none, std::move(outs),
+            std::forward<CompletionToken>(token));
+    }
+
+    template <typename OtherInitiator>
+    constexpr static auto rebind_initiator(const OtherInitiator& other) {
+        return pipeline_op<OtherInitiator>{other};
+    }
+};
+
+namespace detail {
+struct initiate_async_pipeline {
+    template <typename Handler, typename P, typename Q, typename TimeConstraint, typename Outs>
+    constexpr void operator()(Handler&& h, P&& p, TimeConstraint t, Q&& q, Outs outs) const {
+        impl::async_pipeline(std::forward<P>(p), std::forward<Q>(q), t, std::move(outs), std::forward<Handler>(h));
+    }
+};
+} // namespace detail
+
+constexpr pipeline_op<detail::initiate_async_pipeline> pipeline;
+
+#endif
+
+} // namespace bozo
+
+#endif
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <bozo/request.h>
+#include <bozo/result.h>
+#include <bozo/shortcuts.h>
+#include <bozo/time_traits.h>
+#include <bozo/detail/query_key.h>
+#include <bozo/detail/shared_result_waiter.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace bozo {
+
+/**
+ * @brief Result cache configuration
+ * @ingroup group-requests-types
+ *
+ * Configuration of the `bozo::result_cache`, i.e. how many results and how long are cached.
+ */
+struct result_cache_config {
+    std::size_t capacity = 1024; //!< maximum number of cached results, the least recently used ones are evicted
+    time_traits::duration ttl = std::chrono::seconds(60); //!< time to live of a cached result
+};
+
+namespace detail {
+
+template <typename OidMap, typename Operation>
+class result_cache_state : public std::enable_shared_from_this<result_cache_state<OidMap, Operation>> {
+public:
+    using waiter_type = shared_result_waiter<OidMap>;
+
+    result_cache_state(io_context& io, const result_cache_config& config, Operation op)
+    : io_(io), config_(config), op_(std::move(op)) {}
+
+    io_context& get_io_context() const noexcept { return io_;}
+
+    std::size_t size() const {
+        const std::lock_guard lock(mutex_);
+        return entries_.size();
+    }
+
+    void invalidate() {
+        const std::lock_guard lock(mutex_);
+        ++generation_;
+        index_.clear();
+        entries_.clear();
+    }
+
+    void invalidate(std::string_view name) {
+        const std::lock_guard lock(mutex_);
+        ++generation_;
+        for (auto i = entries_.begin(); i != entries_.end();) {
+            if (i->name == name) {
+                index_.erase(i->key);
+                i = entries_.erase(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    template <typename P, typename Q, typename TimeConstraint>
+    void request(std::string_view name, P&& provider, Q&& query, TimeConstraint t,
+            std::unique_ptr<waiter_type> waiter) {
+        auto key = make_key(name, query);
+        std::uint64_t generation = 0;
+        shared_result res;
+        OidMap oid_map;
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto i = index_.find(key); i != index_.end()) {
+                const auto e = i->second;
+                if (time_traits::now() < e->expires) {
+                    entries_.splice(entries_.begin(), entries_, e);
+                    res = e->result;
+                    oid_map = e->oid_map;
+                } else {
+                    index_.erase(i);
+                    entries_.erase(e);
+                }
+            }
+            generation = generation_;
+        }
+        if (res.valid()) {
+            return waiter->complete(error_code{}, res, oid_map);
+        }
+        auto m = std::make_shared<miss>(std::string(name), std::move(key), generation, std::move(waiter));
+        try {
+            auto& result = m->result;
+            op_(std::forward<P>(provider), std::forward<Q>(query), t, std::ref(result),
+                miss_handler{this->shared_from_this(), m});
+        } catch (...) {
+            m->complete(error::bad_cache_query, shared_result{}, OidMap{});
+        }
+    }
+
+private:
+    struct entry {
+        std::string name;
+        std::string key;
+        shared_result result;
+        OidMap oid_map;
+        time_traits::time_point expires;
+    };
+
+    struct miss {
+        std::string name;
+        std::string key;
+        std::uint64_t generation;
+        bozo::result result;
+        std::unique_ptr<waiter_type> waiter;
+        std::atomic_bool completed {false};
+
+        miss(std::string name, std::string key, std::uint64_t generation, std::unique_ptr<waiter_type> waiter)
+        : name(std::move(name)), key(std::move(key)), generation(generation), waiter(std::move(waiter)) {}
+
+        // The operation may throw after its handler has been called
+        void complete(error_code ec, const shared_result& res, const OidMap& oid_map) {
+            if (!completed.exchange(true)) {
+                waiter->complete(ec, res, oid_map);
+            }
+        }
+    };
+
+    struct miss_handler {
+        std::shared_ptr<result_cache_state> self_;
+        std::shared_ptr<miss> miss_;
+
+        template <typename Connection>
+        void operator() (error_code ec, Connection&& conn) {
+            shared_result res;
+            OidMap oid_map;
+            if (!ec) {
+                static_assert(std::is_same_v<std::decay_t<decltype(unwrap_connection(conn).oid_map())>, OidMap>,
+                    "OidMap of the result_cache should be the same as of the connection");
+                oid_map = unwrap_connection(conn).oid_map();
+                if (miss_->result.valid()) {
+                    res = shared_result(std::move(miss_->result));
+                    self_->store(*miss_, res, oid_map);
+                }
+            }
+            miss_->complete(ec, res, oid_map);
+        }
+    };
+
+    template <typename Q>
+    static std::string make_key(std::string_view name, const Q& query) {
+        std::string key(name);
+        key.push_back('\0');
+        key += detail::make_query_key(query, OidMap{});
+        return key;
+    }
+
+    void store(const miss& m, const shared_result& res, const OidMap& oid_map) {
+        const std::lock_guard lock(mutex_);
+        if (m.generation != generation_ || config_.capacity == 0) {
+            return;
+        }
+        if (const auto i = index_.find(m.key); i != index_.end()) {
+            const auto e = i->second;
+            index_.erase(i);
+            entries_.erase(e);
+        }
+        while (entries_.size() >= config_.capacity) {
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+        }
+        entries_.push_front(entry{m.name, m.key, res, oid_map, time_traits::now() + config_.ttl});
+        index_.emplace(entries_.front().key, entries_.begin());
+    }
+
+    io_context& io_;
+    const result_cache_config config_;
+    Operation op_;
+    mutable std::mutex mutex_;
+    std::list<entry> entries_;
+    std::unordered_map<std::string_view, typename std::list<entry>::iterator> index_;
+    std::uint64_t generation_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Client-side cache of read-only query results
+ *
+ * A large share of traffic often re-reads slowly changing reference data like configuration
+ * tables. The cache keeps the results of such queries in the process for the time to live,
+ * so a cache hit is completed without a connection from the provider and without a round trip.
+ * Results are cached by the query name and the query itself, i.e. its text, parameter types and
+ * serialized parameter values. The name is used for the invalidation, e.g. the name of a query
+ * from a `bozo::query_repository` which may be obtained via `bozo::get_query_name()`.
+ *
+ * The result is shared between the requests and each of them receives it into its own output.
+ * A request completes with the signature `void(error_code)` since a cache hit has no connection.
+ * Handlers are called via their associated executor or the `io_context` of the cache.
+ *
+ * Failed queries are not cached, if the operation throws the request completes with
+ * `bozo::error::bad_cache_query`. Cached results may be dropped explicitly via `invalidate()`,
+ * e.g. on a `NOTIFY` about a table change; results of the queries which are in flight while
+ * the cache is invalidated are not cached.
+ *
+ * Query parameters are serialized with a default constructed `OidMap` to build a key, so
+ * it should be the `OidMap` of the connections the provider gives.
+ *
+ * @tparam OidMap --- `OidMap` of the connections.
+ * @tparam Operation --- operation to send queries via, `bozo::request` by default,
+ * `bozo::request[strategy]` may be used for failover.
+ *
+ * ### Example
+ *
+ * @code
+bozo::result_cache<> cache(io, bozo::result_cache_config{256, 5min});
+
+bozo::rows_of<std::string, std::string> settings;
+cache(bozo::get_query_name(get_settings{}), conn_pool[io], repository.make_query<get_settings>(),
+    500ms, bozo::into(settings), yield);
+
+// On NOTIFY settings_changed
+cache.invalidate(bozo::get_query_name(get_settings{}));
+ * @endcode
+ *
+ * @thread_safety{Safe,Safe}
+ * @ingroup group-requests-types
+ */
+template <typename OidMap = empty_oid_map, typename Operation = std::decay_t<decltype(bozo::request)>>
+class result_cache {
+public:
+    /**
+     * Construct a new result cache object
+     *
+     * @param io --- `io_context` to complete requests on if handlers have no associated executor.
+     * @param config --- cache configuration.
+     * @param op --- operation to send queries via.
+     */
+    explicit result_cache(io_context& io, const result_cache_config& config = result_cache_config{},
+            Operation op = Operation{})
+    : state_(std::make_shared<state_type>(io, config, std::move(op))) {}
+
+    /**
+     * Gets the cached result of the query or executes it and caches the result.
+     *
+     * @param name --- name of the query to invalidate its results by.
+     * @param provider --- connection provider object to get connection from.
+     * @param query --- query object to request from a database.
+     * @param time_constraint --- request #TimeConstraint, applies on a cache miss.
+     * @param out --- output object like Iterator, #InsertIterator or `std::ref(bozo::shared_result&)`.
+     * @param token --- operation #CompletionToken with the signature `void(error_code)`.
+     * @return deduced from #CompletionToken.
+     */
+    template <typename P, typename Q, typename TimeConstraint, typename Out, typename CompletionToken>
+    decltype(auto) operator() (std::string_view name, P&& provider, Q&& query, TimeConstraint time_constraint,
+            Out out, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<P>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, void(error_code)>(initiator{state_}, token,
+            name, std::forward<P>(provider), std::forward<Q>(query), time_constraint, std::move(out));
+    }
+
+    /**
+     * Time constraint free version of the call.
+     */
+    template <typename P, typename Q, typename Out, typename CompletionToken>
+    decltype(auto) operator() (std::string_view name, P&& provider, Q&& query, Out out, CompletionToken&& token) const {
+        return (*this)(name, std::forward<P>(provider), std::forward<Q>(query), none, std::move(out),
+            std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * Drops all the cached results.
+     */
+    void invalidate() const { state_->invalidate();}
+
+    /**
+     * Drops the cached results of the query with the name.
+     */
+    void invalidate(std::string_view name) const { state_->invalidate(name);}
+
+    /**
+     * Number of cached results including the expired ones which are not dropped yet.
+     */
+    std::size_t size() const { return state_->size();}
+
+private:
+    using state_type = detail::result_cache_state<OidMap, Operation>;
+
+    struct initiator {
+        std::shared_ptr<state_type> state_;
+
+        template <typename Handler, typename P, typename Q, typename TimeConstraint, typename Out>
+        void operator() (Handler&& handler, std::string_view name, P&& provider, Q&& query,
+                TimeConstraint t, Out out) const {
+            using waiter_type = detail::shared_result_waiter_impl<OidMap, Out, std::decay_t<Handler>>;
+            state_->request(name, std::forward<P>(provider), std::forward<Q>(query), t,
+                std::make_unique<waiter_type>(std::move(out), std::forward<Handler>(handler), state_->get_io_context()));
+        }
+    };
+
+    std::shared_ptr<state_type> state_;
+};
+
+} // namespace bozo
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <bozo/connection.h>
+#include <bozo/io/recv.h>
+#include <bozo/result.h>
+
+#include <optional>
+
+namespace bozo {
+
+/**
+ * @brief Output object which receives rows of a request result one by one
+ *
+ * Being passed as an output object to `bozo::request()` makes the request retrieve
+ * its result in the `libpq` single-row mode. Each row is converted into the `Row`
+ * type via the same rules as `bozo::recv_row()` and passed to the callback as soon
+ * as it has been received, so the whole result is never held in memory. It is
+ * suitable for the huge results like exports of the whole tables.
+ *
+ * If `libpq` supports chunked rows mode (`LIBPQ_HAS_CHUNK_MODE`) and the chunk size
+ * is greater than 1, rows are retrieved by chunks of up to the given number of rows.
+ * Otherwise the chunk size is ignored.
+ *
+ * @note Since the rows are passed to the callback while the query is in progress,
+ * the callback could be called for some rows of a request which completes with an error.
+ * If the callback throws an exception the request completes with
+ * `bozo::error::bad_result_process` error and the rest of the result is abandoned,
+ * so the connection is not suitable for new requests anymore.
+ *
+ * @tparam Row --- type of a row to receive, e.g. `bozo::typed_row` or an adapted structure.
+ * @tparam Callback --- callback with `void(Row&&)` signature.
+ * @ingroup group-requests-types
+ */
+template <typename Row, typename Callback>
+class row_stream {
+public:
+    using row_type = Row;
+
+    row_stream(Callback callback, int chunk_size = 1)
+    : callback_(std::move(callback)), chunk_size_(chunk_size) {}
+
+    /**
+     * Maximum number of rows to be retrieved within a single chunk.
+     */
+    int chunk_size() const noexcept { return chunk_size_;}
+
+    /**
+     * Callback to be called for each row received.
+     */
+    Callback& callback() noexcept { return callback_;}
+
+    /**
+     * Receives rows of a partial result and passes them to the callback.
+     * The result columns are resolved by the first non-empty result for all
+     * the following ones since all of them belong to the same query.
+     */
+    template <typename Handle, typename Connection>
+    void operator() (Handle&& h, Connection& conn) {
+        auto res = bozo::make_result(std::forward<Handle>(h));
+        if (std::empty(res)) {
+            return;
+        }
+        if (!columns_) {
+            columns_ = detail::make_result_columns<Row>(*res.begin());
+        }
+        for (auto row : res) {
+            Row v{};
+            detail::recv_row(row, unwrap_connection(conn).oid_map(), *columns_, v);
+            callback_(std::move(v));
+        }
+    }
+
+private:
+    Callback callback_;
+    int chunk_size_;
+    std::optional<detail::result_columns_of<Row>> columns_;
+};
+
+template <typename T>
+struct is_row_stream : std::false_type {};
+
+template <typename Row, typename Callback>
+struct is_row_stream<row_stream<Row, Callback>> : std::true_type {};
+
+/**
+ * Indicates if the type is a `bozo::row_stream` output object.
+ */
+template <typename T>
+constexpr auto RowStream = is_row_stream<std::decay_t<T>>::value;
+
+/**
+ * @ingroup group-requests-functions
+ * @brief Shortcut for create `bozo::row_stream` output object.
+ *
+ * ### Example
+ *
+@code{cpp}
+
+// Query statement
+const auto query = "SELECT id, name FROM users_info"_SQL;
+
+bozo::request(conn_info[io], query,
+    bozo::for_each_row<bozo::typed_row<std::int64_t, std::string>>([&](auto&& row) {
+        std::cout << std::get<0>(row) << '\t' << std::get<1>(row) << std::endl;
+    }),
+    yield);
+@endcode
+ * @tparam Row --- type of a row to receive.
+ * @param callback --- callback to be called for each row of the result.
+ * @param chunk_size --- maximum number of rows within a single chunk, see `bozo::row_stream`.
+ */
+template <typename Row, typename Callback>
+inline auto for_each_row(Callback&& callback, int chunk_size = 1) {
+    return row_stream<Row, std::decay_t<Callback>>{std::forward<Callback>(callback), chunk_size};
+}
+
+} // namespace bozo
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <bozo/error.h>
+#include <bozo/request.h>
+#include <bozo/result.h>
+#include <bozo/shortcuts.h>
+#include <bozo/detail/query_key.h>
+#include <bozo/detail/shared_result_waiter.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bozo {
+namespace detail {
+
+template <typename OidMap, typename Operation>
+class single_flight_state : public std::enable_shared_from_this<single_flight_state<OidMap, Operation>> {
+public:
+    using waiter_type = shared_result_waiter<OidMap>;
+
+    single_flight_state(io_context& io, Operation op) : io_(io), op_(std::move(op)) {}
+
+    io_context& get_io_context() const noexcept { return io_;}
+
+    std::size_t size() const {
+        const std::lock_guard lock(mutex_);
+        return flights_.size();
+    }
+
+    template <typename P, typename Q, typename TimeConstraint>
+    void join(P&& provider, Q&& query, TimeConstraint t, std::unique_ptr<waiter_type> waiter) {
+        auto binary = to_binary_query(query, OidMap{});
+        auto key = detail::make_query_key(binary);
+        std::shared_ptr<flight> leader;
+        {
+            const std::lock_guard lock(mutex_);
+            auto& f = flights_[key];
+            if (f) {
+                f->waiters.push_back(std::move(waiter));
+                return;
+            }
+            f = leader = std::make_shared<flight>(std::move(key));
+            leader->waiters.push_back(std::move(waiter));
+        }
+        try {
+            auto& result = leader->result;
+            flight_handler handler{this->shared_from_this(), leader};
+            // Types of the empty OidMap have constant OIDs, so the query serialized for the key
+            // is the same as for the connection and it is sent as is.
+            if constexpr (std::is_same_v<OidMap, empty_oid_map>) {
+                op_(std::forward<P>(provider), std::move(binary), t, std::ref(result), std::move(handler));
+            } else {
+                op_(std::forward<P>(provider), std::forward<Q>(query), t, std::ref(result), std::move(handler));
+            }
+        } catch (...) {
+            complete(*leader, error::bad_flight_query, shared_result{}, OidMap{});
+        }
+    }
+
+private:
+    struct flight {
+        std::string key;
+        bozo::result result;
+        std::vector<std::unique_ptr<waiter_type>> waiters;
+
+        explicit flight(std::string key) : key(std::move(key)) {}
+    };
+
+    struct flight_handler {
+        std::shared_ptr<single_flight_state> self_;
+        std::shared_ptr<flight> flight_;
+
+        template <typename Connection>
+        void operator() (error_code ec, Connection&& conn) {
+            shared_result res;
+            OidMap oid_map;
+            if (!ec) {
+                static_assert(std::is_same_v<std::decay_t<decltype(unwrap_connection(conn).oid_map())>, OidMap>,
+                    "OidMap of the single_flight should be the same as of the connection");
+                if (flight_->result.valid()) {
+                    res = shared_result(std::move(flight_->result));
+                }
+                oid_map = unwrap_connection(conn).oid_map();
+            }
+            self_->complete(*flight_, ec, res, oid_map);
+        }
+    };
+
+    // Completes the waiters of the flight once, the flight may be completed by
+    // the operation before it throws.
+    void complete(flight& f, error_code ec, const shared_result& res, const OidMap& oid_map) {
+        std::vector<std::unique_ptr<waiter_type>> waiters;
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto i = flights_.find(f.key); i != flights_.end() && i->second.get() == std::addressof(f)) {
+                flights_.erase(i);
+            }
+            waiters.swap(f.waiters);
+        }
+        for (auto& waiter : waiters) {
+            waiter->complete(ec, res, oid_map);
+        }
+    }
+
+    io_context& io_;
+    Operation op_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<flight>> flights_;
+};
+
+} // namespace detail
+
+/**
+ * @brief Deduplicates identical read queries in flight
+ *
+ * When a hot entry of an upstream cache expires many identical requests hit the database
+ * at once. The single flight sends only the first of the identical queries which are
+ * in flight at the same time, the others wait for its result. Queries are identical if their
+ * texts, parameter types and serialized parameter values are equal. The result is shared
+ * between the waiters and each of them receives it into its own output, so the outputs may
+ * differ for the same query.
+ *
+ * Each request completes with the signature `void(error_code)` since the single connection
+ * cannot be passed to every waiter. If the query fails every waiter completes with the error,
+ * if the operation throws every waiter completes with `bozo::error::bad_flight_query`.
+ * The time constraint of the first request of a flight applies to the whole flight.
+ *
+ * Query parameters are serialized with a default constructed `OidMap` to build a key, so
+ * it should be the `OidMap` of the connections the provider gives. With `bozo::empty_oid_map`
+ * the serialized query is sent as is, otherwise it is serialized again with the OIDs of the connection.
+ *
+ * @warning The single flight is for read-only queries only since the waiters do not execute
+ * the query by themselves.
+ *
+ * @tparam OidMap --- `OidMap` of the connections.
+ * @tparam Operation --- operation to send queries via, `bozo::request` by default,
+ * `bozo::request[strategy]` may be used for failover.
+ *
+ * ### Example
+ *
+ * @code
+bozo::single_flight<> single_flight(io);
+
+std::vector<std::tuple<std::string>> names;
+single_flight(conn_pool[io], "SELECT name FROM users WHERE id = "_SQL + id, 500ms, bozo::into(names), yield);
+ * @endcode
+ *
+ * @thread_safety{Safe,Safe}
+ * @ingroup group-requests-types
+ */
+template <typename OidMap = empty_oid_map, typename Operation = std::decay_t<decltype(bozo::request)>>
+class single_flight {
+public:
+    /**
+     * Construct a new single flight object
+     *
+     * @param io --- `io_context` to complete requests on if handlers have no associated executor.
+     * @param op --- operation to send queries via.
+     */
+    explicit single_flight(io_context& io, Operation op = Operation{})
+    : state_(std::make_shared<state_type>(io, std::move(op))) {}
+
+    /**
+     * Executes the query or joins the identical query in flight.
+     *
+     * @param provider --- connection provider object to get connection from.
+     * @param query --- query object to request from a database.
+     * @param time_constraint --- request #TimeConstraint, applies if the query is not in flight yet.
+     * @param out --- output object like Iterator, #InsertIterator or `std::ref(bozo::shared_result&)`.
+     * @param token --- operation #CompletionToken with the signature `void(error_code)`.
+     * @return deduced from #CompletionToken.
+     */
+    template <typename P, typename Q, typename TimeConstraint, typename Out, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, TimeConstraint time_constraint,
+            Out out, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<P>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, void(error_code)>(initiator{state_}, token,
+            std::forward<P>(provider), std::forward<Q>(query), time_constraint, std::move(out));
+    }
+
+    /**
+     * Time constraint free version of the call.
+     */
+    template <typename P, typename Q, typename Out, typename CompletionToken>
+    decltype(auto) operator() (P&& provider, Q&& query, Out out, CompletionToken&& token) const {
+        return (*this)(std::forward<P>(provider), std::forward<Q>(query), none, std::move(out),
+            std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * Number of distinct queries in flight.
+     */
+    std::size_t size() const { return state_->size();}
+
+private:
+    using state_type = detail::single_flight_state<OidMap, Operation>;
+
+    struct initiator {
+        std::shared_ptr<state_type> state_;
+
+        template <typename Handler, typename P, typename Q, typename TimeConstraint, typename Out>
+        void operator() (Handler&& handler, P&& provider, Q&& query, TimeConstraint t, Out out) const {
+            using waiter_type = detail::shared_result_waiter_impl<OidMap, Out, std::decay_t<Handler>>;
+            state_->join(std::forward<P>(provider), std::forward<Q>(query), t,
+                std::make_unique<waiter_type>(std::move(out), std::forward<Handler>(handler), state_->get_io_context()));
+        }
+    };
+
+    std::shared_ptr<state_type> state_;
+};
+
+} // namespace bozo
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <bozo/time_traits.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bozo {
+
+/**
+ * @brief Phases of a query latency
+ * @ingroup group-connection-types
+ */
+enum class query_phase : std::size_t {
+    queue_wait, //!< wait for a free connection in the connection pool queue
+    connect, //!< establishing of a new connection
+    send, //!< sending of the query to the server
+    server, //!< wait for the first bytes of the result after the query has been sent
+    receive, //!< receiving of the result
+    decode, //!< conversion of the result into the user's output object
+};
+
+constexpr std::size_t query_phases_count = 6;
+
+/**
+ * @brief Measurements of a single query
+ * @ingroup group-connection-types
+ *
+ * The `queue_wait` and `connect` phases are measured on the connection
+ * acquisition and are attributed to the first query made via the connection.
+ *
+ * The byte counters hold the payload size, i.e. the query text, the parameters,
+ * the result values and the `COPY` data, without the protocol overhead. For `COPY`
+ * the rows are the rows copied, and the `send` phase includes the sending of the data.
+ * Each query of a pipeline has its own sample, its `server` phase lasts until its first
+ * result, so it includes the time the server spends on the previous queries.
+ */
+struct query_sample {
+    std::array<time_traits::duration, query_phases_count> phases{}; //!< duration of each `bozo::query_phase`
+    std::size_t rows = 0; //!< number of rows returned or copied
+    std::size_t bytes_sent = 0; //!< payload size sent: the query text, the parameters and the `COPY` data
+    std::size_t bytes_received = 0; //!< payload size received: the result values or the `COPY` data
+    bool failed = false; //!< the query has failed
+
+    time_traits::duration& operator[] (query_phase phase) noexcept {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    time_traits::duration operator[] (query_phase phase) const noexcept {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+};
+
+/**
+ * @brief Key of the connection acquisition measurements for `update_statistics()`
+ * @ingroup group-connection-types
+ */
+struct checkout_key {};
+
+/**
+ * @brief Measurements of the connection acquisition
+ * @ingroup group-connection-types
+ *
+ * Time spent before the connection could be used, it is added to the next query sample.
+ */
+struct checkout_sample {
+    time_traits::duration queue_wait{}; //!< wait in the connection pool queue
+    time_traits::duration connect{}; //!< establishing of a new connection
+};
+
+/**
+ * @brief Latency histogram with power of two microsecond buckets
+ * @ingroup group-connection-types
+ *
+ * Bucket 0 counts latencies below 1 microsecond, bucket i counts latencies from
+ * 2^(i-1) up to 2^i microseconds, the last bucket counts all the longer latencies.
+ */
+class latency_histogram {
+public:
+    static constexpr std::size_t buckets_count = 32;
+
+    static std::size_t bucket(time_traits::duration v) noexcept {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(v).count();
+        std::size_t i = 0;
+        for (auto n = us; n > 0 && i + 1 < buckets_count; n >>= 1) {
+            ++i;
+        }
+        return i;
+    }
+
+    static time_traits::duration upper_bound(std::size_t bucket) noexcept {
+        return std::chrono::microseconds(std::int64_t(1) << bucket);
+    }
+
+    void add(time_traits::duration v, std::uint64_t n = 1) noexcept {
+        counts_[bucket(v)] += n;
+        sum_ += v * n;
+    }
+
+    void merge(const latency_histogram& other) noexcept {
+        for (std::size_t i = 0; i < buckets_count; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        sum_ += other.sum_;
+    }
+
+    std::uint64_t count() const noexcept {
+        std::uint64_t retval = 0;
+        for (auto v : counts_) {
+            retval += v;
+        }
+        return retval;
+    }
+
+    time_traits::duration sum() const noexcept { return sum_;}
+
+    /**
+     * Upper bound of the bucket which holds the given percentile, e.g. 0.99.
+     */
+    time_traits::duration percentile(double p) const noexcept {
+        const auto total = count();
+        if (!total) {
+            return {};
+        }
+        const auto rank = static_cast<std::uint64_t>(std::max(1.0, p * total + 0.5));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets_count; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return upper_bound(i);
+            }
+        }
+        return upper_bound(buckets_count - 1);
+    }
+
+    const std::array<std::uint64_t, buckets_count>& counts() const noexcept { return counts_;}
+
+    std::array<std::uint64_t, buckets_count>& counts() noexcept { return counts_;}
+
+    void set_sum(time_traits::duration v) noexcept { sum_ = v;}
+
+private:
+    std::array<std::uint64_t, buckets_count> counts_{};
+    time_traits::duration sum_{};
+};
+
+/**
+ * @brief Accumulated statistics of queries
+ * @ingroup group-connection-types
+ */
+struct query_counters {
+    std::uint64_t count = 0; //!< number of queries
+    std::uint64_t errors = 0; //!< number of failed queries
+    std::uint64_t rows = 0; //!< number of rows returned or copied
+    std::uint64_t bytes_sent = 0; //!< payload size sent, see `bozo::query_sample::bytes_sent`
+    std::uint64_t bytes_received = 0; //!< payload size received, see `bozo::query_sample::bytes_received`
+    std::array<latency_histogram, query_phases_count> phases; //!< latency histogram per `bozo::query_phase`
+
+    const latency_histogram& operator[] (query_phase phase) const noexcept {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    void add(const query_sample& sample) noexcept {
+        ++count;
+        errors += sample.failed;
+        rows += sample.rows;
+        bytes_sent += sample.bytes_sent;
+        bytes_received += sample.bytes_received;
+        for (std::size_t i = 0; i < query_phases_count; ++i) {
+            phases[i].add(sample.phases[i]);
+        }
+    }
+
+    void merge(const query_counters& other) noexcept {
+        count += other.count;
+        errors += other.errors;
+        rows += other.rows;
+        bytes_sent += other.bytes_sent;
+        bytes_received += other.bytes_received;
+        for (std::size_t i = 0; i < query_phases_count; ++i) {
+            phases[i].merge(other.phases[i]);
+        }
+    }
+};
+
+namespace detail {
+
+/**
+ * Query counters which are updated by a single thread and may be read by any thread.
+ * The owner thread does not use read-modify-write operations.
+ */
+class atomic_query_counters {
+public:
+    void add(const query_sample& sample) noexcept {
+        increment(count_, 1);
+        increment(errors_, sample.failed);
+        increment(rows_, sample.rows);
+        increment(bytes_sent_, sample.bytes_sent);
+        increment(bytes_received_, sample.bytes_received);
+        for (std::size_t i = 0; i < query_phases_count; ++i) {
+            increment(buckets_[i][latency_histogram::bucket(sample.phases[i])], 1);
+            increment(sums_[i], static_cast<std::uint64_t>(sample.phases[i].count()));
+        }
+    }
+
+    void load(query_counters& out) const noexcept {
+        out.count += count_.load(std::memory_order_relaxed);
+        out.errors += errors_.load(std::memory_order_relaxed);
+        out.rows += rows_.load(std::memory_order_relaxed);
+        out.bytes_sent += bytes_sent_.load(std::memory_order_relaxed);
+        out.bytes_received += bytes_received_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < query_phases_count; ++i) {
+            auto& histogram = out.phases[i];
+            for (std::size_t j = 0; j < latency_histogram::buckets_count; ++j) {
+                histogram.counts()[j] += buckets_[i][j].load(std::memory_order_relaxed);
+            }
+            histogram.set_sum(histogram.sum() + time_traits::duration(
+                static_cast<time_traits::duration::rep>(sums_[i].load(std::memory_order_relaxed))));
+        }
+    }
+
+private:
+    using counter = std::atomic<std::uint64_t>;
+
+    static void increment(counter& c, std::uint64_t v) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    counter count_{0};
+    counter errors_{0};
+    counter rows_{0};
+    counter bytes_sent_{0};
+    counter bytes_received_{0};
+    std::array<std::array<counter, latency_histogram::buckets_count>, query_phases_count> buckets_{};
+    std::array<counter, query_phases_count> sums_{};
+};
+
+} // namespace detail
+
+/**
+ * @brief Registry of query statistics shared by connections
+ * @ingroup group-connection-types
+ *
+ * Samples are accumulated per query and per thread, each thread updates its own
+ * counters without locks and atomic read-modify-write operations. A lock is taken
+ * only when a thread records a query for the first time and by `snapshot()`, which
+ * sums the counters of all the threads.
+ *
+ * Queries are identified by their text. To limit the memory used with the queries
+ * which are built dynamically, the queries over `max_queries` per thread are
+ * accounted under the `other_queries` key.
+ *
+ * @thread_safety{Safe,Safe}
+ */
+class statistics_registry {
+public:
+    static constexpr std::string_view other_queries = "<other>";
+
+    explicit statistics_registry(std::size_t max_queries = 1024)
+    : id_(next_id()), max_queries_(max_queries) {}
+
+    statistics_registry(const statistics_registry&) = delete;
+    statistics_registry& operator= (const statistics_registry&) = delete;
+
+    /**
+     * Records the query sample into the counters of the current thread.
+     */
+    void record(std::string_view query, const query_sample& sample) {
+        auto& slot = thread_slot();
+        auto i = slot.queries.find(query);
+        if (i == slot.queries.end()) {
+            if (slot.queries.size() >= max_queries_) {
+                query = other_queries;
+                i = slot.queries.find(query);
+            }
+            if (i == slot.queries.end()) {
+                const std::lock_guard lock(slot.mutex);
+                i = slot.queries.emplace(std::string(query), std::make_unique<detail::atomic_query_counters>()).first;
+            }
+        }
+        i->second->add(sample);
+    }
+
+    /**
+     * Statistics per query summed over all the threads.
+     */
+    std::map<std::string, query_counters, std::less<>> snapshot() const {
+        std::map<std::string, query_counters, std::less<>> retval;
+        for_each_slot([&](const slot_type& slot) {
+            for (const auto& [query, counters] : slot.queries) {
+                counters->load(retval[query]);
+            }
+        });
+        return retval;
+    }
+
+    /**
+     * Statistics of all the queries summed over all the threads.
+     */
+    query_counters total() const {
+        query_counters retval;
+        for_each_slot([&](const slot_type& slot) {
+            for (const auto& entry : slot.queries) {
+                entry.second->load(retval);
+            }
+        });
+        return retval;
+    }
+
+private:
+    struct slot_type {
+        // Guards insertion of queries by the owner thread against reading by others
+        mutable std::mutex mutex;
+        std::map<std::string, std::unique_ptr<detail::atomic_query_counters>, std::less<>> queries;
+    };
+
+    static std::uint64_t next_id() noexcept {
+        static std::atomic<std::uint64_t> id{0};
+        return ++id;
+    }
+
+    slot_type& thread_slot() {
+        // Registries are identified by id since the address may be reused by a new registry
+        thread_local std::vector<std::pair<std::uint64_t, std::shared_ptr<slot_type>>> slots;
+        for (const auto& [id, slot] : slots) {
+            if (id == id_) {
+                return *slot;
+            }
+        }
+        auto slot = std::make_shared<slot_type>();
+        {
+            const std::lock_guard lock(mutex_);
+            slots_.push_back(slot);
+        }
+        slots.erase(std::remove_if(slots.begin(), slots.end(),
+            [](const auto& v) { return v.second.use_count() == 1;}), slots.end());
+        slots.emplace_back(id_, slot);
+        return *slot;
+    }
+
+    template <typename F>
+    void for_each_slot(F&& f) const {
+        const std::lock_guard lock(mutex_);
+        for (const auto& slot : slots_) {
+            const std::lock_guard slot_lock(slot->mutex);
+            f(*slot);
+        }
+    }
+
+    const std::uint64_t id_;
+    const std::size_t max_queries_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<slot_type>> slots_;
+};
+
+/**
+ * @brief Built-in statistics of connections
+ * @ingroup group-connection-types
+ *
+ * Model of the `Statistics` parameter of `bozo::connection_info` and `bozo::connection`.
+ * Requests, executions, cursors, pipelines and `COPY` operations made via a connection record
+ * the query count, rows and payload bytes count and latency of each `bozo::query_phase`, so it
+ * is possible to tell whether the latency comes from the connection pool, the network, the server
+ * or the result decoding. Samples are accumulated per connection and per query into the shared
+ * `bozo::statistics_registry`.
+ *
+ * Each connection gets its own copy of the object given to the connection source, so the
+ * per connection counters start from zero, while the registry is shared.
+ *
+ * ### Example
+ *
+@code{cpp}
+auto registry = std::make_shared<bozo::statistics_registry>();
+bozo::connection_info conn_info("host=localhost", bozo::empty_oid_map{}, bozo::query_statistics{registry});
+auto pool = bozo::make_connection_pool(conn_info, config);
+//...
+for (const auto& [query, counters] : registry->snapshot()) {
+    std::cout << query << ": " << counters.count << " queries, p99 server latency "
+              << counters[bozo::query_phase::server].percentile(0.99).count() << '\n';
+}
+@endcode
+ *
+ * @thread_safety{Safe,Unsafe}
+ */
+class query_statistics {
+public:
+    explicit query_statistics(std::shared_ptr<statistics_registry> registry = std::make_shared<statistics_registry>())
+    : registry_(std::move(registry)) {}
+
+    /**
+     * Records the sample of the query.
+     */
+    void update(std::string_view query, query_sample sample) noexcept {
+        sample[query_phase::queue_wait] += checkout_.queue_wait;
+        sample[query_phase::connect] += checkout_.connect;
+        checkout_ = {};
+        connection_.add(sample);
+        if (registry_) {
+            try {
+                registry_->record(query, sample);
+            } catch (const std::exception&) {
+                // Statistics should not break the request
+            }
+        }
+    }
+
+    /**
+     * Records the connection acquisition, it is attributed to the next query.
+     */
+    void update(checkout_key, const checkout_sample& sample) noexcept {
+        checkout_.queue_wait += sample.queue_wait;
+        checkout_.connect += sample.connect;
+    }
+
+    /**
+     * Statistics of the queries made via the connection.
+     */
+    const query_counters& connection_counters() const noexcept { return connection_;}
+
+    const std::shared_ptr<statistics_registry>& registry() const noexcept { return registry_;}
+
+private:
+    std::shared_ptr<statistics_registry> registry_;
+    query_counters connection_;
+    checkout_sample checkout_;
+};
+
+template <typename T, typename = std::void_t<>>
+struct is_query_statistics : std::false_type {};
+
+template <typename T>
+struct is_query_statistics<T, std::void_t<
+    decltype(std::declval<T&>().update(std::string_view{}, std::declval<const query_sample&>())),
+    decltype(std::declval<T&>().update(checkout_key{}, std::declval<const checkout_sample&>()))
+>> : std::true_type {};
+
+/**
+ * Indicates if the type collects the query statistics like `bozo::query_statistics` does.
+ */
+template <typename T>
+constexpr auto QueryStatistics = is_query_statistics<std::decay_t<T>>::value;
+
+} // namespace bozo
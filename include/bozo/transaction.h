@@ -111,6 +111,17 @@ public:
         return lowest_layer().statistics();
     }
 
+    /**
+     * Get a reference to the cache of statements prepared on the server for the
+     * underlying connection. Available if the lowest layer provides the cache.
+     *
+     * @note The object should be initialized for this call.
+     */
+    template <typename T = lowest_layer_type>
+    auto statement_cache() noexcept -> decltype(std::declval<T&>().statement_cache()) {
+        return lowest_layer().statement_cache();
+    }
+
     /**
      * Get the additional context object for an error that occurred during the last operation on the connection.
      *
@@ -346,6 +357,61 @@ decltype(auto) begin (ConnectionProvider&& provider, TimeConstraint time_constra
 template <typename ConnectionProvider, typename CompletionToken>
 decltype(auto) begin (ConnectionProvider&& provider, CompletionToken&& token);
 
+/**
+ * @brief Start new transaction with the first statement in a single round trip
+ *
+ * The function sends the `BEGIN` statement and the first statement of the transaction
+ * to a database within libpq pipeline mode with the one sync point, so the transaction
+ * is started without a dedicated round trip. The result of the statement is provided
+ * via the out parameter. The function can be called as any of Boost.Asio asynchronous
+ * function with #CompletionToken. The operation would be cancelled if time constrain
+ * is reached while performing.
+ *
+ * If the statement fails the handler is called with the error of the statement and
+ * the transaction is in the failed state on the database, so it should be rolled back
+ * via `bozo::rollback()` to reuse the connection. If `BEGIN` itself fails the statement
+ * is not executed.
+ *
+ * @note The function is available only if libpq supports pipeline mode (`LIBPQ_HAS_PIPELINING`).
+ * @note The function does not particitate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- `ConnectionProvider` to get connection from.
+ * @param query --- the first statement of the transaction.
+ * @param time_constraint --- operation `TimeConstraint`; this time constrain <b>includes</b> time for getting connection from provider.
+ * @param out --- output object like Iterator, #InsertIterator or `bozo::result` for the statement result.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ *
+ * @par Example
+ *
+@code
+bozo::rows_of<std::int64_t> id;
+auto transaction = bozo::begin(conn_info[io],
+    "INSERT INTO orders (user_id) VALUES ("_SQL + user_id + ") RETURNING id"_SQL, 500ms, bozo::into(id), yield);
+@endcode
+ * @ingroup group-transaction-functions
+ */
+template <typename ConnectionProvider, typename Query, typename TimeConstraint, typename Out, typename CompletionToken>
+decltype(auto) begin (ConnectionProvider&& provider, Query&& query, TimeConstraint time_constraint, Out out, CompletionToken&& token);
+
+/**
+ * @brief Start new transaction with the first statement in a single round trip
+ *
+ * This function is time constrain free shortcut to `bozo::begin()` function.
+ * Its call is equal to `bozo::begin(provider, query, bozo::none, out, token)` call.
+ *
+ * @note The function does not particitate in ADL since could be implemented via functional object.
+ *
+ * @param provider --- #ConnectionProvider to get connection from.
+ * @param query --- the first statement of the transaction.
+ * @param out --- output object for the statement result.
+ * @param token --- operation #CompletionToken.
+ * @return deduced from #CompletionToken.
+ * @ingroup group-transaction-functions
+ */
+template <typename ConnectionProvider, typename Query, typename Out, typename CompletionToken>
+decltype(auto) begin (ConnectionProvider&& provider, Query&& query, Out out, CompletionToken&& token);
+
 #endif
 //! @cond
 template <typename Initiator, typename Options = decltype(make_options())>
@@ -374,6 +440,29 @@ struct begin_op : base_async_operation <begin_op<Initiator, Options>, Initiator>
         );
     }
 
+#ifdef LIBPQ_HAS_PIPELINING
+    template <typename T, typename Query, typename TimeConstraint, typename Out, typename CompletionToken>
+    auto operator() (T&& provider, Query&& query, TimeConstraint t, Out out, CompletionToken&& token) const {
+        static_assert(ConnectionProvider<T>, "provider should be a ConnectionProvider");
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        return async_initiate<CompletionToken, handler_signature<transaction<connection_type<T>, Options>>>(
+            get_operation_initiator(*this), token,
+            std::forward<T>(provider), options_, detail::begin_statement_builder::build(options_),
+            std::forward<Query>(query), t, std::move(out));
+    }
+
+    template <typename T, typename Query, typename Out, typename CompletionToken>
+    auto operator() (T&& provider, Query&& query, Out out, CompletionToken&& token) const {
+        return (*this)(
+            std::forward<T>(provider),
+            std::forward<Query>(query),
+            none,
+            std::move(out),
+            std::forward<CompletionToken>(token)
+        );
+    }
+#endif
+
     template <typename OtherOptions>
     constexpr auto with_transaction_options(const OtherOptions& options) const {
         return begin_op<Initiator, OtherOptions>{get_operation_initiator(*this), options};
@@ -440,6 +529,63 @@ decltype(auto) commit (transaction<T, Options>&& transaction, TimeConstraint t,
 template <typename ConnectionProvider, typename CompletionToken>
 decltype(auto) commit (ConnectionProvider&& provider, CompletionToken&& token);
 
+/**
+ * @brief Commits a transaction with the last statement in a single round trip
+ *
+ * The function sends the last statement of the transaction and the `COMMIT` statement
+ * to a database within libpq pipeline mode with the one sync point, so the transaction
+ * is committed without a dedicated round trip. The result of the statement is provided
+ * via the out parameter. The function can be called as any of Boost.Asio asynchronous
+ * function with #CompletionToken. The operation would be cancelled if time constrain
+ * is reached while performing.
+ *
+ * If the statement fails `COMMIT` is not executed and the handler is called with the error
+ * of the statement. The transaction stays in the failed state on the database, so the connection
+ * is not idle and e.g. `bozo::connection_pool` does not reuse it.
+ *
+ * @note The function is available only if libpq supports pipeline mode (`LIBPQ_HAS_PIPELINING`).
+ * @note The function does not particitate in ADL since could be implemented via functional object.
+ * @note After commit the transaction object may not be used.
+ *
+ * @param transaction --- open transaction to commit.
+ * @param query --- the last statement of the transaction.
+ * @param time_constraint --- operation `TimeConstraint`.
+ * @param out --- output object like Iterator, #InsertIterator or `bozo::result` for the statement result.
+ * @param token --- operation `CompletionToken`.
+ * @return deduced from the `CompletionToken`.
+ *
+ * @par Example
+ *
+ * The transaction with a single write costs a single round trip:
+@code
+auto transaction = bozo::begin(conn_info[io], "UPDATE accounts SET amount = amount - 10 WHERE id = 1"_SQL,
+    bozo::none, yield);
+auto connection = bozo::commit(std::move(transaction), "UPDATE accounts SET amount = amount + 10 WHERE id = 2"_SQL,
+    bozo::none, yield);
+@endcode
+ * @ingroup group-transaction-functions
+ */
+template <typename T, typename Options, typename Query, typename TimeConstraint, typename Out, typename CompletionToken>
+decltype(auto) commit (transaction<T, Options>&& transaction, Query&& query, TimeConstraint t, Out out, CompletionToken&& token);
+
+/**
+ * @brief Commits a transaction with the last statement in a single round trip
+ *
+ * This function is time constrain free shortcut to `bozo::commit()` function.
+ * Its call is equal to `bozo::commit(std::move(transaction), query, bozo::none, out, token)` call.
+ *
+ * @note The function does not particitate in ADL since could be implemented via functional object.
+ *
+ * @param transaction --- open transaction to commit.
+ * @param query --- the last statement of the transaction.
+ * @param out --- output object for the statement result.
+ * @param token --- operation `CompletionToken`.
+ * @return deduced from the `CompletionToken`.
+ * @ingroup group-transaction-functions
+ */
+template <typename T, typename Options, typename Query, typename Out, typename CompletionToken>
+decltype(auto) commit (transaction<T, Options>&& transaction, Query&& query, Out out, CompletionToken&& token);
+
 #endif
 //! @cond
 struct commit_op {
@@ -460,6 +606,29 @@ struct commit_op {
             std::forward<CompletionToken>(token)
         );
     }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    template <typename T, typename Options, typename Query, typename TimeConstraint, typename Out, typename CompletionToken>
+    auto operator() (transaction<T, Options>&& transaction, Query&& query, TimeConstraint t,
+            Out out, CompletionToken&& token) const {
+        static_assert(bozo::TimeConstraint<TimeConstraint>, "should model TimeConstraint concept");
+        using namespace bozo::literals;
+        return async_initiate<CompletionToken, handler_signature<typename bozo::transaction<T, Options>::handle_type>>(
+            detail::initiate_async_end_transaction{}, token,
+            std::move(transaction), std::forward<Query>(query), "COMMIT"_SQL, t, std::move(out));
+    }
+
+    template <typename... Ts, typename Query, typename Out, typename CompletionToken>
+    auto operator() (transaction<Ts...>&& transaction, Query&& query, Out out, CompletionToken&& token) const {
+        return (*this)(
+            std::move(transaction),
+            std::forward<Query>(query),
+            none,
+            std::move(out),
+            std::forward<CompletionToken>(token)
+        );
+    }
+#endif
 };
 
 inline constexpr commit_op commit;
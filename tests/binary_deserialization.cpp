@@ -1,7 +1,9 @@
 #include "result_mock.h"
 
 #include <bozo/io/array.h>
+#include <bozo/io/copy.h>
 #include <bozo/io/recv.h>
+#include <bozo/row_stream.h>
 #include <bozo/ext/std.h>
 #include <bozo/pg/types.h>
 
@@ -213,6 +215,72 @@ TEST_F(recv, should_convert_TEXTARRAYOID_to_std_vector_of_std_string) {
     EXPECT_THAT(got, ElementsAre("test", "foo", "bar"));
 }
 
+TEST_F(recv, should_convert_INT8ARRAYOID_to_std_vector_of_int64_t) {
+    const char bytes[] = {
+        0x00, 0x00, 0x00, 0x01, // dimension count
+        0x00, 0x00, 0x00, 0x00, // data offset
+        0x00, 0x00, 0x00, 0x14, // Oid
+        0x00, 0x00, 0x00, 0x03, // dimension size
+        0x00, 0x00, 0x00, 0x01, // dimension index
+        0x00, 0x00, 0x00, 0x08, // 1st element size
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, // 1st element
+        0x00, 0x00, 0x00, 0x08, // 2nd element size
+        char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFE), // 2nd element
+        0x00, 0x00, 0x00, 0x08, // 3rd element size
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, // 3rd element
+    };
+    EXPECT_CALL(mock, field_type(_)).WillRepeatedly(Return(1016));
+    EXPECT_CALL(mock, get_value(_, _)).WillRepeatedly(Return(bytes));
+    EXPECT_CALL(mock, get_length(_, _)).WillRepeatedly(Return(sizeof bytes));
+    EXPECT_CALL(mock, get_isnull(_, _)).WillRepeatedly(Return(false));
+
+    std::vector<std::int64_t> got;
+    bozo::recv(value, oid_map, got);
+    EXPECT_THAT(got, ElementsAre(7, -2, 0x0102030405060708));
+}
+
+TEST_F(recv, should_convert_FLOAT8ARRAYOID_to_std_vector_of_double) {
+    const char bytes[] = {
+        0x00, 0x00, 0x00, 0x01, // dimension count
+        0x00, 0x00, 0x00, 0x00, // data offset
+        0x00, 0x00, 0x02, char(0xBD), // Oid
+        0x00, 0x00, 0x00, 0x02, // dimension size
+        0x00, 0x00, 0x00, 0x01, // dimension index
+        0x00, 0x00, 0x00, 0x08, // 1st element size
+        0x3F, char(0xF8), 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1st element
+        0x00, 0x00, 0x00, 0x08, // 2nd element size
+        char(0xC0), 0x09, 0x21, char(0xFB), 0x54, 0x44, 0x2D, 0x18, // 2nd element
+    };
+    EXPECT_CALL(mock, field_type(_)).WillRepeatedly(Return(1022));
+    EXPECT_CALL(mock, get_value(_, _)).WillRepeatedly(Return(bytes));
+    EXPECT_CALL(mock, get_length(_, _)).WillRepeatedly(Return(sizeof bytes));
+    EXPECT_CALL(mock, get_isnull(_, _)).WillRepeatedly(Return(false));
+
+    std::vector<double> got;
+    bozo::recv(value, oid_map, got);
+    EXPECT_THAT(got, ElementsAre(1.5, -3.141592653589793));
+}
+
+TEST_F(recv, should_throw_for_null_item_of_INT4ARRAYOID_if_item_type_is_not_nullable) {
+    const char bytes[] = {
+        0x00, 0x00, 0x00, 0x01, // dimension count
+        0x00, 0x00, 0x00, 0x01, // data offset
+        0x00, 0x00, 0x00, 0x17, // Oid
+        0x00, 0x00, 0x00, 0x02, // dimension size
+        0x00, 0x00, 0x00, 0x01, // dimension index
+        0x00, 0x00, 0x00, 0x04, // 1st element size
+        0x00, 0x00, 0x00, 0x07, // 1st element
+        char(0xFF), char(0xFF), char(0xFF), char(0xFF), // 2nd element is null
+    };
+    EXPECT_CALL(mock, field_type(_)).WillRepeatedly(Return(1007));
+    EXPECT_CALL(mock, get_value(_, _)).WillRepeatedly(Return(bytes));
+    EXPECT_CALL(mock, get_length(_, _)).WillRepeatedly(Return(sizeof bytes));
+    EXPECT_CALL(mock, get_isnull(_, _)).WillRepeatedly(Return(false));
+
+    std::vector<std::int32_t> got;
+    EXPECT_THROW(bozo::recv(value, oid_map, got), std::invalid_argument);
+}
+
 TEST_F(recv, should_convert_TEXTARRAYOID_with_matched_size_to_std_array_of_std_string) {
     const char bytes[] = {
         0x00, 0x00, 0x00, 0x01, // dimension count
@@ -729,6 +797,115 @@ TEST_F(recv_result, send_convert_INT4OID_to_vector_via_iterator) {
     EXPECT_THAT(got, ElementsAre(7, 7));
 }
 
+TEST_F(recv_result, should_resolve_columns_of_adapted_structure_and_check_oids_once_per_result) {
+    const char int32_bytes[] = { 0x00, 0x00, 0x00, 0x07 };
+    const char* string_bytes = "test";
+
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+
+    EXPECT_CALL(mock, field_number(Eq("digit"s))).WillOnce(Return(1));
+    EXPECT_CALL(mock, field_type(1)).WillOnce(Return(23));
+    EXPECT_CALL(mock, get_value(_, 1)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 1)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 1)).WillRepeatedly(Return(false));
+
+    EXPECT_CALL(mock, field_number(Eq("text"s))).WillOnce(Return(0));
+    EXPECT_CALL(mock, field_type(0)).WillOnce(Return(25));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return(string_bytes));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 0)).WillRepeatedly(Return(false));
+
+    std::vector<hana_adapted_test_result> got;
+    bozo::recv_result(res, oid_map, std::back_inserter(got));
+    EXPECT_EQ(got.size(), 3u);
+    EXPECT_EQ(got[2].digit, 7);
+    EXPECT_EQ(got[2].text, "test");
+}
+
+TEST_F(recv_result, should_check_oid_of_column_with_first_not_null_value) {
+    const char int32_bytes[] = { 0x00, 0x00, 0x00, 0x07 };
+
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(2));
+
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(25));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(0, 0)).WillRepeatedly(Return(true));
+    EXPECT_CALL(mock, get_isnull(1, 0)).WillRepeatedly(Return(false));
+
+    std::vector<std::optional<std::int32_t>> got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, std::back_inserter(got)), bozo::system_error);
+}
+
+TEST_F(recv_result, should_throw_range_error_if_column_corresponding_to_member_of_adapted_structure_does_not_found) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, field_number(_)).WillRepeatedly(Return(-1));
+
+    std::vector<fusion_adapted_test_result> got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, std::back_inserter(got)), std::range_error);
+}
+
+TEST_F(recv_result, should_not_resolve_columns_for_empty_result) {
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(0));
+
+    std::vector<hana_adapted_test_result> got;
+    bozo::recv_result(res, oid_map, std::back_inserter(got));
+    EXPECT_TRUE(got.empty());
+}
+
+struct row_stream : recv_result {
+    struct connection {
+        bozo::empty_oid_map oid_map_;
+        const bozo::empty_oid_map& oid_map() const noexcept { return oid_map_;}
+    } conn;
+};
+
+TEST_F(row_stream, should_pass_each_row_to_callback_and_resolve_columns_by_first_result_only) {
+    const char int32_bytes[] = { 0x00, 0x00, 0x00, 0x07 };
+    const char* string_bytes = "test";
+
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(1));
+
+    EXPECT_CALL(mock, field_number(Eq("digit"s))).WillOnce(Return(0));
+    EXPECT_CALL(mock, field_type(0)).WillOnce(Return(23));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 0)).WillRepeatedly(Return(false));
+
+    EXPECT_CALL(mock, field_number(Eq("text"s))).WillOnce(Return(1));
+    EXPECT_CALL(mock, field_type(1)).WillOnce(Return(25));
+    EXPECT_CALL(mock, get_value(_, 1)).WillRepeatedly(Return(string_bytes));
+    EXPECT_CALL(mock, get_length(_, 1)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 1)).WillRepeatedly(Return(false));
+
+    std::vector<fusion_adapted_test_result> got;
+    auto stream = bozo::for_each_row<fusion_adapted_test_result>([&](auto&& row) {
+        got.push_back(std::move(row));
+    });
+    stream(&mock, conn);
+    stream(&mock, conn);
+
+    EXPECT_EQ(got.size(), 2u);
+    EXPECT_EQ(got[1].digit, 7);
+    EXPECT_EQ(got[1].text, "test");
+}
+
+TEST_F(row_stream, should_skip_empty_result) {
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(0));
+
+    std::vector<fusion_adapted_test_result> got;
+    auto stream = bozo::for_each_row<fusion_adapted_test_result>([&](auto&& row) {
+        got.push_back(std::move(row));
+    });
+    stream(&mock, conn);
+
+    EXPECT_TRUE(got.empty());
+}
+
 TEST_F(recv_result, send_returns_result_then_result_requested) {
     bozo::basic_result<pg_result_mock*> got;
     bozo::recv_result(res, oid_map, got);
@@ -847,4 +1024,59 @@ INSTANTIATE_TEST_SUITE_P(convert_success_with_overflow, to_duration, Values(
     )
 ));
 
+struct copy_tuple_reader : Test {
+    bozo::detail::copy_tuple_reader reader;
+    std::vector<hana_adapted_test_result> rows;
+    const std::string header{"PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19};
+    const std::string trailer{"\377\377", 2};
+    const std::string tuple{"\0\2\0\0\0\3foo\0\0\0\4\0\0\0\7", 17};
+
+    void read(const std::string& data) {
+        reader.read<hana_adapted_test_result>(data.data(), data.size(), bozo::empty_oid_map{},
+            [&](hana_adapted_test_result&& row) { rows.push_back(std::move(row)); });
+    }
+};
+
+TEST_F(copy_tuple_reader, should_receive_tuples_by_messages_and_finish_on_trailer) {
+    read(header + tuple);
+    EXPECT_FALSE(reader.finished());
+    read(tuple);
+    read(trailer);
+    EXPECT_TRUE(reader.finished());
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1].text, "foo");
+    EXPECT_EQ(rows[1].digit, 7);
+}
+
+TEST_F(copy_tuple_reader, should_skip_header_extension) {
+    read(std::string("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\2xy", 21) + tuple + trailer);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].text, "foo");
+}
+
+TEST_F(copy_tuple_reader, should_receive_null_into_nullable_field) {
+    std::vector<std::tuple<std::optional<std::int32_t>>> out;
+    const std::string data = header + std::string("\0\1\377\377\377\377", 6) + trailer;
+    reader.read<std::tuple<std::optional<std::int32_t>>>(data.data(), data.size(), bozo::empty_oid_map{},
+        [&](auto&& row) { out.push_back(std::move(row)); });
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_FALSE(std::get<0>(out[0]));
+}
+
+TEST_F(copy_tuple_reader, should_throw_on_bad_signature) {
+    EXPECT_THROW(read(std::string("PGCOPY\n\377\r\n\1\0\0\0\0\0\0\0\0", 19) + tuple), std::invalid_argument);
+}
+
+TEST_F(copy_tuple_reader, should_throw_on_critical_flags) {
+    EXPECT_THROW(read(std::string("PGCOPY\n\377\r\n\0\0\1\0\0\0\0\0\0", 19) + tuple), std::invalid_argument);
+}
+
+TEST_F(copy_tuple_reader, should_throw_on_fields_count_mismatch) {
+    EXPECT_THROW(read(header + std::string("\0\1\0\0\0\3foo", 9)), std::range_error);
+}
+
+TEST_F(copy_tuple_reader, should_throw_on_truncated_tuple) {
+    EXPECT_THROW(read(header + tuple.substr(0, 10)), bozo::system_error);
+}
+
 } // namespace
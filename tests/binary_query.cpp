@@ -2,6 +2,7 @@
 #include <bozo/optional.h>
 
 #include <iterator>
+#include <optional>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -173,4 +174,67 @@ TEST_F(binary_query_values, for_std_reference_wrapper_value_should_be_equal_to_b
         ElementsAre('s', 't', 'r', 'i', 'n', 'g'));
 }
 
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    std::size_t* allocations;
+
+    counting_allocator(std::size_t& allocations) : allocations(&allocations) {}
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U>& other) : allocations(other.allocations) {}
+
+    T* allocate(std::size_t n) {
+        ++*allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        --*allocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator== (const counting_allocator<U>& rhs) const { return allocations == rhs.allocations;}
+
+    template <typename U>
+    bool operator!= (const counting_allocator<U>& rhs) const { return !(*this == rhs);}
+};
+
+struct binary_query_allocation : Test {};
+
+TEST_F(binary_query_allocation, should_place_query_data_into_single_memory_block) {
+    std::size_t allocations = 0;
+    {
+        const auto query = bozo::binary_query("", hana::make_tuple(std::int64_t(42), std::string("string"), 3.5),
+            bozo::empty_oid_map{}, counting_allocator<char>{allocations});
+        EXPECT_EQ(allocations, 1u);
+    }
+    EXPECT_EQ(allocations, 0u);
+}
+
+TEST_F(binary_query_allocation, should_share_data_between_copies) {
+    std::size_t allocations = 0;
+    std::optional<bozo::binary_query> copy;
+    {
+        const auto query = bozo::binary_query("", hana::make_tuple(std::string("string")),
+            bozo::empty_oid_map{}, counting_allocator<char>{allocations});
+        copy.emplace(query);
+        EXPECT_EQ(copy->values()[0], query.values()[0]);
+    }
+    EXPECT_EQ(allocations, 1u);
+    EXPECT_THAT(std::vector<char>(copy->values()[0], copy->values()[0] + 6),
+        ElementsAre('s', 't', 'r', 'i', 'n', 'g'));
+    copy.reset();
+    EXPECT_EQ(allocations, 0u);
+}
+
+TEST_F(binary_query_values, for_several_params_should_be_equal_to_binary_representations) {
+    const auto query = make_binary_query("", hana::make_tuple(std::int16_t(7), std::string("ab"), std::int32_t(-1)));
+    EXPECT_THAT(std::vector<char>(query.values()[0], query.values()[0] + 2), ElementsAre(0, 7));
+    EXPECT_THAT(std::vector<char>(query.values()[1], query.values()[1] + 2), ElementsAre('a', 'b'));
+    EXPECT_THAT(std::vector<char>(query.values()[2], query.values()[2] + 4), ElementsAre(-1, -1, -1, -1));
+}
+
 } // namespace
@@ -1,5 +1,6 @@
 #include <bozo/io/send.h>
 #include <bozo/io/array.h>
+#include <bozo/io/copy.h>
 #include <bozo/ext/std.h>
 #include <bozo/pg/types.h>
 
@@ -188,3 +189,44 @@ TEST_F(send, with_std_chrono_microseconds_should_store_as_days_and_microseconds)
 }
 
 } // namespace
+
+namespace {
+
+struct copy_row {
+    std::int32_t id;
+    std::optional<std::string> name;
+};
+
+} // namespace
+
+BOOST_HANA_ADAPT_STRUCT(copy_row, id, name);
+
+namespace {
+
+TEST(send_copy_tuple, should_write_fields_count_and_data_frames_of_fields) {
+    std::vector<char> buffer;
+    bozo::detail::send_copy_tuple(buffer, bozo::empty_oid_map{}, copy_row{7, std::string("ab")});
+    EXPECT_THAT(buffer, ElementsAre(
+        0, 2,
+        0, 0, 0, 4, 0, 0, 0, 7,
+        0, 0, 0, 2, 'a', 'b'
+    ));
+}
+
+TEST(send_copy_tuple, should_write_minus_one_size_for_null_field) {
+    std::vector<char> buffer;
+    bozo::detail::send_copy_tuple(buffer, bozo::empty_oid_map{}, copy_row{7, std::nullopt});
+    EXPECT_THAT(buffer, ElementsAre(
+        0, 2,
+        0, 0, 0, 4, 0, 0, 0, 7,
+        char(0xFF), char(0xFF), char(0xFF), char(0xFF)
+    ));
+}
+
+TEST(send_copy_tuple, should_append_tuple_of_std_tuple_to_buffer) {
+    std::vector<char> buffer{'x'};
+    bozo::detail::send_copy_tuple(buffer, bozo::empty_oid_map{}, std::make_tuple(std::int16_t(1)));
+    EXPECT_THAT(buffer, ElementsAre('x', 0, 1, 0, 0, 0, 2, 0, 1));
+}
+
+} // namespace
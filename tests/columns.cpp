@@ -0,0 +1,241 @@
+#include "result_mock.h"
+
+#include <bozo/columns.h>
+#include <bozo/ext/std.h>
+#include <bozo/pg/types.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+struct hana_adapted_test_columns {
+    BOOST_HANA_DEFINE_STRUCT(hana_adapted_test_columns,
+        (bozo::column<std::string>, text),
+        (bozo::column<std::int32_t>, digit)
+    );
+};
+
+namespace {
+
+using namespace testing;
+using namespace bozo::tests;
+using namespace std::literals;
+
+TEST(validity_bitmap, should_pack_bits_from_least_significant_one) {
+    bozo::validity_bitmap bitmap;
+    for (int i = 0; i != 10; ++i) {
+        bitmap.push_back(i % 3 != 0);
+    }
+    EXPECT_EQ(bitmap.size(), 10u);
+    EXPECT_EQ(bitmap.null_count(), 4u);
+    EXPECT_EQ(bitmap.data()[0], 0b10110110);
+    EXPECT_EQ(bitmap.data()[1], 0b00000001);
+    EXPECT_FALSE(bitmap[0]);
+    EXPECT_TRUE(bitmap[1]);
+    EXPECT_FALSE(bitmap[9]);
+}
+
+TEST(validity_bitmap, truncate_should_drop_bits_and_their_nulls) {
+    bozo::validity_bitmap bitmap;
+    for (int i = 0; i != 10; ++i) {
+        bitmap.push_back(i % 3 != 0);
+    }
+    bitmap.truncate(5);
+    EXPECT_EQ(bitmap.size(), 5u);
+    EXPECT_EQ(bitmap.null_count(), 2u);
+    EXPECT_EQ(bitmap.data()[0], 0b00010110);
+    bitmap.push_back(true);
+    EXPECT_EQ(bitmap.data()[0], 0b00110110);
+}
+
+struct recv_columns : Test {
+    bozo::empty_oid_map oid_map{};
+    StrictMock<pg_result_mock> mock{};
+    bozo::basic_result<pg_result_mock*> res{&mock};
+
+    const char int32_bytes[4] = { 0x00, 0x00, 0x00, 0x07 };
+
+    void expect_int32_column(int column) {
+        EXPECT_CALL(mock, field_type(column)).WillOnce(Return(23));
+        EXPECT_CALL(mock, get_value(_, column)).WillRepeatedly(Return(int32_bytes));
+        EXPECT_CALL(mock, get_length(_, column)).WillRepeatedly(Return(4));
+        EXPECT_CALL(mock, get_isnull(0, column)).WillRepeatedly(Return(false));
+        EXPECT_CALL(mock, get_isnull(1, column)).WillRepeatedly(Return(true));
+        EXPECT_CALL(mock, get_isnull(2, column)).WillRepeatedly(Return(false));
+    }
+
+    void expect_text_column(int column) {
+        EXPECT_CALL(mock, field_type(column)).WillOnce(Return(25));
+        EXPECT_CALL(mock, get_value(0, column)).WillRepeatedly(Return("foo"));
+        EXPECT_CALL(mock, get_length(0, column)).WillRepeatedly(Return(3));
+        EXPECT_CALL(mock, get_isnull(0, column)).WillRepeatedly(Return(false));
+        EXPECT_CALL(mock, get_value(1, column)).WillRepeatedly(Return(""));
+        EXPECT_CALL(mock, get_length(1, column)).WillRepeatedly(Return(0));
+        EXPECT_CALL(mock, get_isnull(1, column)).WillRepeatedly(Return(false));
+        EXPECT_CALL(mock, get_value(2, column)).WillRepeatedly(Return(""));
+        EXPECT_CALL(mock, get_length(2, column)).WillRepeatedly(Return(0));
+        EXPECT_CALL(mock, get_isnull(2, column)).WillRepeatedly(Return(true));
+    }
+};
+
+TEST_F(recv_columns, should_convert_result_into_columns_by_position) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    expect_int32_column(0);
+    expect_text_column(1);
+
+    bozo::columns_of<std::int32_t, std::string> got;
+    bozo::recv_result(res, oid_map, got);
+
+    const auto& digits = got[boost::hana::size_c<0>];
+    EXPECT_THAT(digits.values(), ElementsAre(7, 0, 7));
+    EXPECT_FALSE(digits.is_null(0));
+    EXPECT_TRUE(digits.is_null(1));
+    EXPECT_EQ(digits.validity().null_count(), 1u);
+
+    const auto& texts = got[boost::hana::size_c<1>];
+    EXPECT_EQ(texts.size(), 3u);
+    EXPECT_EQ(texts[0], "foo"sv);
+    EXPECT_EQ(texts[1], ""sv);
+    EXPECT_FALSE(texts.is_null(1));
+    EXPECT_TRUE(texts.is_null(2));
+    EXPECT_THAT(texts.offsets(), ElementsAre(0u, 3u, 3u, 3u));
+}
+
+TEST_F(recv_columns, should_convert_result_into_hana_adapted_structure_of_columns_by_name) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_number(Eq("text"s))).WillOnce(Return(0));
+    EXPECT_CALL(mock, field_number(Eq("digit"s))).WillOnce(Return(1));
+    expect_text_column(0);
+    expect_int32_column(1);
+
+    hana_adapted_test_columns got;
+    bozo::recv_result(res, oid_map, got);
+
+    EXPECT_THAT(got.digit.values(), ElementsAre(7, 0, 7));
+    EXPECT_EQ(got.text[0], "foo"sv);
+}
+
+TEST_F(recv_columns, should_append_values_of_each_result) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(23));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 0)).WillRepeatedly(Return(false));
+
+    bozo::columns_of<std::int32_t> got;
+    bozo::recv_result(res, oid_map, got);
+    bozo::recv_result(res, oid_map, got);
+
+    EXPECT_EQ(got[boost::hana::size_c<0>].size(), 6u);
+}
+
+TEST_F(recv_columns, should_keep_column_unchanged_if_value_could_not_be_received) {
+    const char short_bytes[2] = { 0x00, 0x07 };
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(23));
+    EXPECT_CALL(mock, get_isnull(_, 0)).WillRepeatedly(Return(false));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(4));
+
+    bozo::columns_of<std::int32_t> got;
+    bozo::recv_result(res, oid_map, got);
+
+    EXPECT_CALL(mock, get_value(2, 0)).WillRepeatedly(Return(short_bytes));
+    EXPECT_CALL(mock, get_length(2, 0)).WillRepeatedly(Return(2));
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), bozo::system_error);
+
+    const auto& digits = got[boost::hana::size_c<0>];
+    EXPECT_EQ(digits.size(), 3u);
+    EXPECT_EQ(digits.validity().size(), 3u);
+    EXPECT_THAT(digits.values(), ElementsAre(7, 7, 7));
+}
+
+TEST_F(recv_columns, should_keep_all_columns_unchanged_if_value_of_last_column_could_not_be_received) {
+    const char short_bytes[2] = { 0x00, 0x07 };
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(25));
+    EXPECT_CALL(mock, get_value(_, 0)).WillRepeatedly(Return("foo"));
+    EXPECT_CALL(mock, get_length(_, 0)).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, get_isnull(_, 0)).WillRepeatedly(Return(false));
+    EXPECT_CALL(mock, field_type(1)).WillRepeatedly(Return(23));
+    EXPECT_CALL(mock, get_value(_, 1)).WillRepeatedly(Return(int32_bytes));
+    EXPECT_CALL(mock, get_length(_, 1)).WillRepeatedly(Return(4));
+    EXPECT_CALL(mock, get_isnull(_, 1)).WillRepeatedly(Return(false));
+
+    bozo::columns_of<std::string, std::int32_t> got;
+    bozo::recv_result(res, oid_map, got);
+
+    EXPECT_CALL(mock, get_value(2, 1)).WillRepeatedly(Return(short_bytes));
+    EXPECT_CALL(mock, get_length(2, 1)).WillRepeatedly(Return(2));
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), bozo::system_error);
+
+    const auto& texts = got[boost::hana::size_c<0>];
+    EXPECT_EQ(texts.size(), 3u);
+    EXPECT_EQ(texts.validity().size(), 3u);
+    EXPECT_THAT(texts.offsets(), ElementsAre(0u, 3u, 6u, 9u));
+    EXPECT_EQ(got[boost::hana::size_c<1>].size(), 3u);
+}
+
+TEST_F(recv_columns, should_not_append_any_column_if_oid_of_last_column_does_not_match_the_type) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(23));
+    EXPECT_CALL(mock, field_type(1)).WillRepeatedly(Return(23));
+
+    bozo::columns_of<std::int32_t, std::string> got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), bozo::system_error);
+    EXPECT_TRUE(got[boost::hana::size_c<0>].empty());
+}
+
+TEST_F(recv_columns, should_not_append_any_member_if_column_for_last_member_does_not_found) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_number(Eq("text"s))).WillRepeatedly(Return(0));
+    EXPECT_CALL(mock, field_number(Eq("digit"s))).WillRepeatedly(Return(-1));
+
+    hana_adapted_test_columns got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), std::range_error);
+    EXPECT_TRUE(got.text.empty());
+}
+
+TEST_F(recv_columns, should_throw_system_error_if_column_oid_does_not_match_the_type) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_type(0)).WillRepeatedly(Return(25));
+
+    bozo::columns_of<std::int32_t> got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), bozo::system_error);
+}
+
+TEST_F(recv_columns, should_throw_range_error_if_number_of_columns_does_not_match) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+
+    bozo::columns_of<std::int32_t, std::string> got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), std::range_error);
+}
+
+TEST_F(recv_columns, should_throw_range_error_if_column_for_member_does_not_found) {
+    EXPECT_CALL(mock, nfields()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(3));
+    EXPECT_CALL(mock, field_number(_)).WillRepeatedly(Return(-1));
+
+    hana_adapted_test_columns got;
+    EXPECT_THROW(bozo::recv_result(res, oid_map, got), std::range_error);
+}
+
+TEST_F(recv_columns, should_leave_columns_empty_for_empty_result) {
+    EXPECT_CALL(mock, ntuples()).WillRepeatedly(Return(0));
+
+    bozo::columns_of<std::int32_t, std::string> got;
+    bozo::recv_result(res, oid_map, got);
+
+    EXPECT_TRUE(got[boost::hana::size_c<0>].empty());
+    EXPECT_TRUE(got[boost::hana::size_c<1>].empty());
+}
+
+} // namespace
@@ -18,6 +18,24 @@ TEST(connection_info, should_return_error_and_bad_connect_for_invalid_connection
     io.run();
 }
 
+TEST(connection_info, should_resolve_host_asynchronously_with_dns_cache_enabled) {
+    bozo::dns_cache::global().enable();
+    bozo::io_context io;
+    bozo::connection_info conn_info("host=localhost port=1");
+
+    bool called = false;
+    bozo::get_connection(conn_info[io], std::chrono::seconds(5), [&](bozo::error_code ec, auto conn){
+        called = true;
+        EXPECT_TRUE(ec);
+        EXPECT_TRUE(!bozo::is_null(conn));
+    });
+
+    io.run();
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(bozo::dns_cache::global().lookup("localhost"));
+    bozo::dns_cache::global().disable();
+}
+
 TEST(make_connection_info, should_not_throw) {
     EXPECT_NO_THROW(bozo::make_connection_info("conn info string"));
 }
@@ -2,6 +2,7 @@
 
 #include "test_asio.h"
 
+#include <bozo/detail/statement_cache.h>
 #include <bozo/impl/io.h>
 #include <bozo/impl/transaction.h>
 #include <bozo/time_traits.h>
@@ -11,8 +12,16 @@ namespace bozo::tests {
 struct pg_result {
     ExecStatusType status;
     const char* error;
+    int rows = 0;
+    std::size_t row_length = 0;
 };
 
+inline int pq_ntuples(const pg_result& res) noexcept { return res.rows;}
+
+inline int pq_nfields(const pg_result& res) noexcept { return res.rows ? 1 : 0;}
+
+inline std::size_t pq_get_length(const pg_result& res, int, int) noexcept { return res.row_length;}
+
 struct PGconn_mock {
     PGconn_mock() {
         using testing::_;
@@ -25,6 +34,18 @@ struct PGconn_mock {
         ON_CALL(*this, PQconsumeInput()).WillByDefault(::testing::Return(0));
         ON_CALL(*this, PQconnectPoll()).WillByDefault(::testing::Return(PGRES_POLLING_FAILED));
         ON_CALL(*this, PQsendQueryParams(_, _, _, _, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQsendPrepare(_, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQsendQueryPrepared(_, _, _, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQsetSingleRowMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQputCopyData(_, _)).WillByDefault(::testing::Return(-1));
+        ON_CALL(*this, PQputCopyEnd(_)).WillByDefault(::testing::Return(-1));
+        ON_CALL(*this, PQgetCopyData(_, _)).WillByDefault(::testing::Return(-2));
+        ON_CALL(*this, PQgetCancel()).WillByDefault(::testing::Return(nullptr));
+#ifdef LIBPQ_HAS_PIPELINING
+        ON_CALL(*this, PQenterPipelineMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQexitPipelineMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(*this, PQpipelineSync()).WillByDefault(::testing::Return(0));
+#endif
     };
 
     MOCK_METHOD0(PQsocket, int());
@@ -85,6 +106,73 @@ struct PGconn_mock {
         );
     }
 
+    MOCK_METHOD4(PQsendPrepare, int(const char*, const char*, int, const Oid*));
+    friend int PQsendPrepare(PGconn_mock* self,
+                      const char *stmtName,
+                      const char *query,
+                      int nParams,
+                      const Oid *paramTypes) {
+        return mock(self).PQsendPrepare(stmtName, query, nParams, paramTypes);
+    }
+
+    MOCK_METHOD6(PQsendQueryPrepared, int(
+                      const char*, int, const char* const*,
+                      const int*, const int*, int));
+    friend int PQsendQueryPrepared(PGconn_mock* self,
+                      const char *stmtName,
+                      int nParams,
+                      const char * const *paramValues,
+                      const int *paramLengths,
+                      const int *paramFormats,
+                      int resultFormat) {
+        return mock(self).PQsendQueryPrepared(
+            stmtName, nParams, paramValues,
+            paramLengths, paramFormats, resultFormat
+        );
+    }
+
+    MOCK_METHOD0(PQsetSingleRowMode, int());
+    friend int PQsetSingleRowMode(PGconn_mock* self) {
+        return mock(self).PQsetSingleRowMode();
+    }
+
+    MOCK_METHOD2(PQputCopyData, int(const char*, int));
+    friend int PQputCopyData(PGconn_mock* self, const char* buffer, int nbytes) {
+        return mock(self).PQputCopyData(buffer, nbytes);
+    }
+
+    MOCK_METHOD1(PQputCopyEnd, int(const char*));
+    friend int PQputCopyEnd(PGconn_mock* self, const char* errormsg) {
+        return mock(self).PQputCopyEnd(errormsg);
+    }
+
+    MOCK_METHOD2(PQgetCopyData, int(char**, int));
+    friend int PQgetCopyData(PGconn_mock* self, char** buffer, int async) {
+        return mock(self).PQgetCopyData(buffer, async);
+    }
+
+    MOCK_METHOD0(PQgetCancel, PGcancel*());
+    friend PGcancel* PQgetCancel(PGconn_mock* self) {
+        return mock(self).PQgetCancel();
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    MOCK_METHOD0(PQenterPipelineMode, int());
+    friend int PQenterPipelineMode(PGconn_mock* self) {
+        return mock(self).PQenterPipelineMode();
+    }
+
+    MOCK_METHOD0(PQexitPipelineMode, int());
+    friend int PQexitPipelineMode(PGconn_mock* self) {
+        return mock(self).PQexitPipelineMode();
+    }
+
+    MOCK_METHOD0(PQpipelineSync, int());
+    friend int PQpipelineSync(PGconn_mock* self) {
+        return mock(self).PQpipelineSync();
+    }
+#endif
+
     MOCK_METHOD0(PQgetResult, pg_result*());
     friend pg_result* PQgetResult(PGconn_mock* self) {
         return mock(self).PQgetResult();
@@ -107,6 +195,18 @@ private:
         ON_CALL(mock, PQconsumeInput()).WillByDefault(::testing::Return(0));
         ON_CALL(mock, PQconnectPoll()).WillByDefault(::testing::Return(PGRES_POLLING_FAILED));
         ON_CALL(mock, PQsendQueryParams(_, _, _, _, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQsendPrepare(_, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQsendQueryPrepared(_, _, _, _, _, _)).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQsetSingleRowMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQputCopyData(_, _)).WillByDefault(::testing::Return(-1));
+        ON_CALL(mock, PQputCopyEnd(_)).WillByDefault(::testing::Return(-1));
+        ON_CALL(mock, PQgetCopyData(_, _)).WillByDefault(::testing::Return(-2));
+        ON_CALL(mock, PQgetCancel()).WillByDefault(::testing::Return(nullptr));
+#ifdef LIBPQ_HAS_PIPELINING
+        ON_CALL(mock, PQenterPipelineMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQexitPipelineMode()).WillByDefault(::testing::Return(0));
+        ON_CALL(mock, PQpipelineSync()).WillByDefault(::testing::Return(0));
+#endif
         return mock;
     }
 };
@@ -146,6 +246,12 @@ struct cancel_handle_mock {
     friend auto dispatch_cancel(cancel_handle_mock* self) {
         return self->dispatch_cancel();
     }
+
+    template <typename Handler>
+    friend void async_dispatch_cancel(cancel_handle_mock* self, Handler&& handler) {
+        auto [ec, msg] = self->dispatch_cancel();
+        std::forward<Handler>(handler)(std::move(ec), std::move(msg));
+    }
 };
 
 struct connection_mock {
@@ -159,6 +265,7 @@ struct connection_mock {
     MOCK_METHOD0(assign, bozo::error_code());
     MOCK_METHOD0(async_request, void());
     MOCK_METHOD0(async_execute, void());
+    MOCK_METHOD0(async_pipeline, void());
     MOCK_METHOD0(request_oid_map, void());
     MOCK_METHOD0(get_cancel_handle, cancel_handle_mock*());
 };
@@ -211,6 +318,7 @@ struct connection {
     connection_mock* mock_ = nullptr;
     error_context_type error_context_;
     io_context* io_;
+    bozo::detail::statement_cache statement_cache_;
 
     connection(handle_type handle, OidMap oid_map, connection_mock* mock, error_context_type error_context_type, io_context* io)
     : handle_(std::move(handle)), oid_map_(oid_map), mock_(mock), error_context_(error_context_type), io_(io) {}
@@ -227,6 +335,8 @@ struct connection {
 
     const oid_map_type& oid_map() const noexcept { return oid_map_;}
 
+    bozo::detail::statement_cache& statement_cache() noexcept { return statement_cache_;}
+
     bool is_bad() const noexcept { return mock_->is_bad();}
 
     operator bool () const noexcept { return !is_bad();}
@@ -269,7 +379,7 @@ struct connection {
     }
 
     template <typename Handler>
-    friend void request_oid_map(std::shared_ptr<connection>&& provider, Handler&&) {
+    friend void request_oid_map(std::shared_ptr<connection>&& provider, Handler&&, time_traits::time_point) {
         provider->mock_->request_oid_map();
     }
 
@@ -279,6 +389,18 @@ struct connection {
         release_connection(std::move(transaction))->mock_->async_execute();
     }
 
+    template <typename Queries, typename Outs, typename Handler>
+    friend void async_pipeline(std::shared_ptr<connection>& provider, Queries&&,
+            const bozo::time_traits::duration&, Outs&&, Handler&&) {
+        provider->mock_->async_pipeline();
+    }
+
+    template <typename Queries, typename Options, typename Outs, typename Handler>
+    friend void async_pipeline(bozo::transaction<std::shared_ptr<connection>, Options>&& transaction, Queries&&,
+            const bozo::time_traits::duration&, Outs&&, Handler&&) {
+        release_connection(std::move(transaction))->mock_->async_pipeline();
+    }
+
     template <typename WaitHandler>
     void async_wait_write(WaitHandler&& h) {
         mock_->async_wait_write([h = std::forward<WaitHandler>(h)] (auto e) {
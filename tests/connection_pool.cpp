@@ -7,6 +7,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <optional>
+
 namespace {
 
 TEST(make_connection_pool, should_not_throw) {
@@ -30,6 +32,8 @@ struct pool_handle_mock {
         native_conn_handle safe_handle_;
         bozo::empty_oid_map oid_map_;
         error_context_type error_context_;
+        bozo::time_traits::time_point expires_at_ = bozo::time_traits::time_point::max();
+        bozo::time_traits::time_point idle_expires_at_ = bozo::time_traits::time_point::max();
 
         const native_conn_handle& safe_native_handle() const & {return safe_handle_;}
         native_conn_handle& safe_native_handle() & {return safe_handle_;}
@@ -47,6 +51,10 @@ struct pool_handle_mock {
         void set_error_context(error_context_type v) {
             error_context_ = std::move(v);
         }
+        bozo::time_traits::time_point expires_at() const noexcept { return expires_at_;}
+        void set_expires_at(bozo::time_traits::time_point v) noexcept { expires_at_ = v;}
+        bozo::time_traits::time_point idle_expires_at() const noexcept { return idle_expires_at_;}
+        void set_idle_expires_at(bozo::time_traits::time_point v) noexcept { idle_expires_at_ = v;}
     };
 
     MOCK_CONST_METHOD0(empty, bool());
@@ -205,6 +213,23 @@ INSTANTIATE_TEST_SUITE_P(
 
 } // namespace with_params
 
+TEST_F(pooled_connection, should_call_waste_on_destruction_if_query_is_active_and_context_is_stopped) {
+    io.stopped_ = true;
+    EXPECT_CALL(handle_mock, value()).WillRepeatedly(ReturnRef(value));
+    EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
+    EXPECT_CALL(conn_handle, PQsocket()).WillOnce(Return(42));
+    EXPECT_CALL(io.stream_service_, create()).WillRepeatedly(ReturnRef(socket));
+    EXPECT_CALL(socket, assign(42));
+    EXPECT_CALL(conn_handle, PQstatus()).WillRepeatedly(Return(CONNECTION_OK));
+    EXPECT_CALL(conn_handle, PQtransactionStatus()).WillRepeatedly(Return(PQTRANS_ACTIVE));
+    EXPECT_CALL(socket, release()).WillOnce(Return(42));
+    EXPECT_CALL(handle_mock, waste()).WillOnce(Return());
+
+    {
+        impl p(io.get_executor(), connection_pool::handle{&handle_mock}, std::chrono::seconds(1));
+    }
+}
+
 TEST_F(pooled_connection, should_not_call_waste_on_destruction_if_handle_is_not_empty_connection_is_good_and_idle) {
     EXPECT_CALL(handle_mock, value()).WillRepeatedly(ReturnRef(value));
     EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
@@ -235,6 +260,42 @@ TEST_F(pooled_connection, should_not_check_connection_status_and_call_waste_on_d
     }
 }
 
+TEST_F(pooled_connection, should_call_waste_on_destruction_if_connection_is_good_and_idle_but_expired) {
+    value.expires_at_ = bozo::time_traits::now() - std::chrono::seconds(1);
+    EXPECT_CALL(handle_mock, value()).WillRepeatedly(ReturnRef(value));
+    EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
+    EXPECT_CALL(conn_handle, PQsocket()).WillOnce(Return(42));
+    EXPECT_CALL(io.stream_service_, create()).WillRepeatedly(ReturnRef(socket));
+    EXPECT_CALL(socket, assign(42));
+    EXPECT_CALL(conn_handle, PQstatus()).WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(conn_handle, PQtransactionStatus()).WillOnce(Return(PQTRANS_IDLE));
+    EXPECT_CALL(socket, release()).WillOnce(Return(42));
+    EXPECT_CALL(handle_mock, waste()).WillOnce(Return());
+
+    {
+        impl p(io.get_executor(), connection_pool::handle{&handle_mock});
+    }
+}
+
+TEST_F(pooled_connection, should_set_idle_expiry_on_destruction_if_connection_returns_to_pool) {
+    EXPECT_CALL(handle_mock, value()).WillRepeatedly(ReturnRef(value));
+    EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
+    EXPECT_CALL(conn_handle, PQsocket()).WillOnce(Return(42));
+    EXPECT_CALL(io.stream_service_, create()).WillRepeatedly(ReturnRef(socket));
+    EXPECT_CALL(socket, assign(42));
+    EXPECT_CALL(conn_handle, PQstatus()).WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(conn_handle, PQtransactionStatus()).WillOnce(Return(PQTRANS_IDLE));
+    EXPECT_CALL(socket, release()).WillOnce(Return(42));
+
+    const auto now = bozo::time_traits::now();
+    {
+        impl p(io.get_executor(), connection_pool::handle{&handle_mock},
+            bozo::time_traits::duration::zero(), std::chrono::minutes(1));
+    }
+    EXPECT_GE(value.idle_expires_at_, now + std::chrono::minutes(1));
+    EXPECT_LE(value.idle_expires_at_, bozo::time_traits::now() + std::chrono::minutes(1));
+}
+
 struct pooled_connection_wrapper : Test {
     using pooled_connection_ptr = std::shared_ptr<bozo::pooled_connection<bozo::tests::connection_pool::handle, bozo::tests::executor>>;
     StrictMock<connection_source_mock> provider_mock;
@@ -335,6 +396,70 @@ TEST_F(pooled_connection_wrapper, should_call_async_get_connection_and_invoke_ha
     h({}, connection_pool::handle{&handle_mock});
 }
 
+TEST_F(pooled_connection_wrapper, should_call_async_get_connection_and_invoke_handler_if_passed_connection_is_expired) {
+    auto h = wrap_pooled_connection_handler();
+
+    rep.expires_at_ = bozo::time_traits::now() - std::chrono::seconds(1);
+    Sequence s;
+    EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
+    EXPECT_CALL(native_handle, PQstatus())
+        .InSequence(s)
+        .WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(provider_mock, async_get_connection(_))
+        .InSequence(s)
+        .WillOnce(InvokeArgument<0>(error_code{}, make_connection()));
+    EXPECT_CALL(handle_mock, reset(_)).InSequence(s).WillOnce(Invoke([&](auto){ rep.expires_at_ = bozo::time_traits::time_point::max();}));
+    EXPECT_CALL(io.stream_service_, create()).InSequence(s).WillOnce(ReturnRef(stream));
+    EXPECT_CALL(native_handle, PQsocket()).InSequence(s).WillOnce(Return(42));
+    EXPECT_CALL(stream, assign(42)).InSequence(s);
+
+    EXPECT_CALL(callback_mock, call(bozo::error_code{}, _))
+        .InSequence(s)
+        .WillOnce(Return());
+
+    EXPECT_CALL(stream, release()).InSequence(s);
+    EXPECT_CALL(native_handle, PQstatus())
+        .InSequence(s)
+        .WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(native_handle, PQtransactionStatus())
+        .InSequence(s)
+        .WillOnce(Return(PQTRANS_IDLE));
+
+    h({}, connection_pool::handle{&handle_mock});
+}
+
+TEST_F(pooled_connection_wrapper, should_call_async_get_connection_and_invoke_handler_if_passed_connection_is_idle_expired) {
+    auto h = wrap_pooled_connection_handler();
+
+    rep.idle_expires_at_ = bozo::time_traits::now() - std::chrono::seconds(1);
+    Sequence s;
+    EXPECT_CALL(handle_mock, empty()).WillRepeatedly(Return(false));
+    EXPECT_CALL(native_handle, PQstatus())
+        .InSequence(s)
+        .WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(provider_mock, async_get_connection(_))
+        .InSequence(s)
+        .WillOnce(InvokeArgument<0>(error_code{}, make_connection()));
+    EXPECT_CALL(handle_mock, reset(_)).InSequence(s).WillOnce(Invoke([&](auto){ rep.idle_expires_at_ = bozo::time_traits::time_point::max();}));
+    EXPECT_CALL(io.stream_service_, create()).InSequence(s).WillOnce(ReturnRef(stream));
+    EXPECT_CALL(native_handle, PQsocket()).InSequence(s).WillOnce(Return(42));
+    EXPECT_CALL(stream, assign(42)).InSequence(s);
+
+    EXPECT_CALL(callback_mock, call(bozo::error_code{}, _))
+        .InSequence(s)
+        .WillOnce(Return());
+
+    EXPECT_CALL(stream, release()).InSequence(s);
+    EXPECT_CALL(native_handle, PQstatus())
+        .InSequence(s)
+        .WillOnce(Return(CONNECTION_OK));
+    EXPECT_CALL(native_handle, PQtransactionStatus())
+        .InSequence(s)
+        .WillOnce(Return(PQTRANS_IDLE));
+
+    h({}, connection_pool::handle{&handle_mock});
+}
+
 TEST_F(pooled_connection_wrapper, should_call_async_get_connection_and_invoke_handler_if_handle_is_empty) {
     auto h = wrap_pooled_connection_handler();
 
@@ -411,3 +536,359 @@ TEST_F(pooled_connection_wrapper, should_invoke_callback_with_null_pointer_if_as
 }
 
 } // namespace
+
+namespace {
+
+using namespace testing;
+
+struct shard_stub {
+    struct stats_type {
+        std::size_t size = 0;
+        std::size_t available = 0;
+        std::size_t used = 0;
+        std::size_t queue_size = 0;
+    };
+
+    struct handle {
+        using value_type = int;
+
+        int value = 0;
+        bool empty_ = false;
+
+        bool empty() const { return empty_;}
+        int& operator * () { return value;}
+        const int& operator * () const { return value;}
+        void reset(int&& v) { value = v; empty_ = false;}
+        void waste() { empty_ = true;}
+        void recycle() { empty_ = true;}
+    };
+
+    std::size_t capacity;
+    std::size_t queue_capacity;
+    stats_type stats_;
+    std::size_t requests = 0;
+    bool empty_handles = false;
+
+    shard_stub(std::size_t capacity, std::size_t queue_capacity, bozo::time_traits::duration, bozo::time_traits::duration)
+    : capacity(capacity), queue_capacity(queue_capacity) {}
+
+    stats_type stats() const { return stats_;}
+
+    template <typename IoContext, typename Handler, typename Duration>
+    void get_auto_recycle(IoContext&, Handler&& handler, Duration) {
+        ++requests;
+        handler(bozo::error_code{}, handle{0, empty_handles});
+    }
+};
+
+using sharded_pool = bozo::detail::sharded_connection_pool<shard_stub>;
+using shard_handle = bozo::detail::shard_handle<shard_stub::handle>;
+
+constexpr auto ignore_handle = [] (bozo::error_code, shard_handle) {};
+
+struct sharded_connection_pool : Test {
+    bozo::time_traits::duration timeout = std::chrono::seconds(1);
+    bozo::io_context io1;
+    bozo::io_context io2;
+    bozo::io_context io3;
+
+    std::vector<std::size_t> requests(const sharded_pool& pool) const {
+        std::vector<std::size_t> retval;
+        for (std::size_t i = 0; i < pool.shards_count(); ++i) {
+            retval.push_back(pool.shard(i).requests);
+        }
+        return retval;
+    }
+};
+
+TEST_F(sharded_connection_pool, should_split_capacity_between_shards) {
+    sharded_pool pool(3, 10, 8, timeout, timeout);
+    ASSERT_EQ(pool.shards_count(), 3u);
+    EXPECT_EQ(pool.shard(0).capacity, 4u);
+    EXPECT_EQ(pool.shard(1).capacity, 3u);
+    EXPECT_EQ(pool.shard(2).capacity, 3u);
+    EXPECT_EQ(pool.shard(0).queue_capacity, 3u);
+    EXPECT_EQ(pool.shard(1).queue_capacity, 3u);
+    EXPECT_EQ(pool.shard(2).queue_capacity, 2u);
+}
+
+TEST_F(sharded_connection_pool, should_limit_shards_count_by_capacity) {
+    sharded_pool pool(8, 2, 0, timeout, timeout);
+    EXPECT_EQ(pool.shards_count(), 2u);
+    EXPECT_EQ(pool.shard(1).capacity, 1u);
+}
+
+TEST_F(sharded_connection_pool, should_use_single_shard_by_default) {
+    sharded_pool pool(1, 10, 8, timeout, timeout);
+    EXPECT_EQ(pool.shard_index(io1), 0u);
+    EXPECT_EQ(pool.shard_index(io2), 0u);
+    EXPECT_EQ(pool.shard(0).capacity, 10u);
+}
+
+TEST_F(sharded_connection_pool, should_bind_each_io_context_to_its_own_shard) {
+    sharded_pool pool(2, 10, 8, timeout, timeout);
+    EXPECT_EQ(pool.shard_index(io1), 0u);
+    EXPECT_EQ(pool.shard_index(io2), 1u);
+    EXPECT_EQ(pool.shard_index(io1), 0u);
+    EXPECT_EQ(pool.shard_index(io2), 1u);
+    EXPECT_LT(pool.shard_index(io3), 2u);
+}
+
+TEST_F(sharded_connection_pool, should_split_queue_capacity_exactly) {
+    sharded_pool pool(3, 10, 1, timeout, timeout);
+    EXPECT_EQ(pool.shard(0).queue_capacity, 1u);
+    EXPECT_EQ(pool.shard(1).queue_capacity, 0u);
+    EXPECT_EQ(pool.shard(2).queue_capacity, 0u);
+}
+
+TEST_F(sharded_connection_pool, should_get_connection_from_own_shard_if_it_has_idle_connection) {
+    sharded_pool pool(2, 10, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.load(0).acquire(true);
+    pool.load(0).release(true);
+    pool.load(1).acquire(true);
+    pool.load(1).release(true);
+    pool.get_auto_recycle(io1, ignore_handle, timeout);
+    EXPECT_THAT(requests(pool), ElementsAre(1u, 0u));
+}
+
+TEST_F(sharded_connection_pool, should_steal_connection_from_other_shard_if_own_shard_has_no_idle_connection) {
+    sharded_pool pool(3, 10, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.load(2).acquire(true);
+    pool.load(2).release(true);
+    pool.get_auto_recycle(io1, ignore_handle, timeout);
+    EXPECT_THAT(requests(pool), ElementsAre(0u, 0u, 1u));
+}
+
+TEST_F(sharded_connection_pool, should_get_connection_from_own_shard_if_no_shard_has_idle_connection) {
+    sharded_pool pool(3, 10, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.get_auto_recycle(io2, ignore_handle, timeout);
+    EXPECT_THAT(requests(pool), ElementsAre(0u, 1u, 0u));
+}
+
+TEST_F(sharded_connection_pool, should_open_connection_in_other_shard_if_own_shard_is_full) {
+    sharded_pool pool(2, 2, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.load(0).acquire(true);
+    pool.get_auto_recycle(io1, ignore_handle, timeout);
+    EXPECT_THAT(requests(pool), ElementsAre(0u, 1u));
+}
+
+TEST_F(sharded_connection_pool, should_wait_in_own_shard_if_all_shards_are_full) {
+    sharded_pool pool(2, 2, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.shard_index(io2);
+    pool.load(0).acquire(true);
+    pool.load(1).acquire(true);
+    pool.get_auto_recycle(io2, ignore_handle, timeout);
+    EXPECT_THAT(requests(pool), ElementsAre(0u, 1u));
+}
+
+TEST_F(sharded_connection_pool, should_track_shard_load_by_handle) {
+    sharded_pool pool(2, 10, 8, timeout, timeout);
+    std::optional<shard_handle> handle;
+    const auto keep_handle = [&] (bozo::error_code, shard_handle h) { handle.emplace(std::move(h));};
+
+    pool.get_auto_recycle(io1, keep_handle, timeout);
+    EXPECT_EQ(pool.load(0).used(), 1u);
+    EXPECT_EQ(pool.load(0).idle(), 0u);
+
+    handle.reset();
+    EXPECT_EQ(pool.load(0).used(), 0u);
+    EXPECT_EQ(pool.load(0).idle(), 1u);
+
+    pool.get_auto_recycle(io1, keep_handle, timeout);
+    EXPECT_EQ(pool.load(0).used(), 1u);
+    EXPECT_EQ(pool.load(0).idle(), 0u);
+
+    handle->waste();
+    EXPECT_EQ(pool.load(0).used(), 0u);
+    EXPECT_EQ(pool.load(0).idle(), 0u);
+    handle.reset();
+    EXPECT_EQ(pool.load(0).used(), 0u);
+}
+
+TEST_F(sharded_connection_pool, should_reset_idle_count_if_shard_provides_handle_without_connection) {
+    sharded_pool pool(2, 10, 8, timeout, timeout);
+    pool.shard_index(io1);
+    pool.load(0).acquire(true);
+    pool.load(0).acquire(true);
+    pool.load(0).release(true);
+    pool.load(0).release(true);
+    ASSERT_EQ(pool.load(0).idle(), 2u);
+
+    std::optional<shard_handle> handle;
+    pool.shard(0).empty_handles = true;
+    pool.get_auto_recycle(io1, [&] (bozo::error_code, shard_handle h) { handle.emplace(std::move(h));}, timeout);
+    EXPECT_EQ(pool.load(0).used(), 1u);
+    EXPECT_EQ(pool.load(0).idle(), 0u);
+}
+
+TEST_F(sharded_connection_pool, should_sum_stats_of_shards) {
+    sharded_pool pool(2, 10, 8, timeout, timeout);
+    pool.shard(0).stats_ = {3, 1, 2, 0};
+    pool.shard(1).stats_ = {4, 2, 2, 1};
+    const auto stats = pool.stats();
+    EXPECT_EQ(stats.size, 7u);
+    EXPECT_EQ(stats.available, 3u);
+    EXPECT_EQ(stats.used, 4u);
+    EXPECT_EQ(stats.queue_size, 1u);
+}
+
+TEST_F(sharded_connection_pool, should_provide_capacity_of_shards) {
+    sharded_pool pool(3, 10, 8, timeout, timeout);
+    EXPECT_EQ(pool.shard_capacity(0), 4u);
+    EXPECT_EQ(pool.shard_capacity(1), 3u);
+    EXPECT_EQ(pool.shard_capacity(2), 3u);
+}
+
+TEST(min_idle_top_up_count, should_return_zero_if_pool_has_enough_connections) {
+    EXPECT_EQ(bozo::detail::min_idle_top_up_count(shard_stub::stats_type{4, 0, 4, 0}, 4), 0u);
+    EXPECT_EQ(bozo::detail::min_idle_top_up_count(shard_stub::stats_type{5, 5, 0, 0}, 4), 0u);
+}
+
+TEST(min_idle_top_up_count, should_return_missing_connections_count_for_empty_pool) {
+    EXPECT_EQ(bozo::detail::min_idle_top_up_count(shard_stub::stats_type{}, 4), 4u);
+}
+
+TEST(min_idle_top_up_count, should_include_idle_connections_to_make_pool_open_new_ones) {
+    EXPECT_EQ(bozo::detail::min_idle_top_up_count(shard_stub::stats_type{3, 2, 1, 0}, 4), 3u);
+}
+
+TEST(get_connection_expiry, should_return_max_time_point_without_jitter) {
+    bozo::detail::pooled_connection_options options;
+    options.lifespan = std::chrono::hours(1);
+    EXPECT_EQ(bozo::detail::get_connection_expiry(options), bozo::time_traits::time_point::max());
+}
+
+TEST(get_connection_expiry, should_shorten_lifespan_by_jitter_part_at_most) {
+    bozo::detail::pooled_connection_options options;
+    options.lifespan = std::chrono::hours(1);
+    options.lifespan_jitter = 0.25;
+    const auto now = bozo::time_traits::now();
+    for (int i = 0; i < 100; ++i) {
+        const auto expiry = bozo::detail::get_connection_expiry(options, now);
+        EXPECT_LE(expiry, now + std::chrono::hours(1));
+        EXPECT_GE(expiry, now + std::chrono::minutes(45));
+    }
+}
+
+TEST(get_connection_idle_timeout, should_return_max_duration_without_jitter) {
+    bozo::detail::pooled_connection_options options;
+    options.idle_timeout = std::chrono::minutes(1);
+    EXPECT_EQ(bozo::detail::get_connection_idle_timeout(options), bozo::time_traits::duration::max());
+}
+
+TEST(get_connection_idle_timeout, should_shorten_idle_timeout_by_jitter_part_at_most) {
+    bozo::detail::pooled_connection_options options;
+    options.idle_timeout = std::chrono::minutes(1);
+    options.idle_timeout_jitter = 0.25;
+    for (int i = 0; i < 100; ++i) {
+        const auto idle_timeout = bozo::detail::get_connection_idle_timeout(options);
+        EXPECT_LE(idle_timeout, std::chrono::minutes(1));
+        EXPECT_GE(idle_timeout, std::chrono::seconds(45));
+    }
+}
+
+TEST(connection_idle_expired, should_compare_idle_expiry_with_current_time) {
+    pool_handle_mock::value_type rep{};
+    EXPECT_FALSE(bozo::detail::connection_idle_expired(rep));
+    bozo::detail::set_connection_idle_expiry(rep, bozo::time_traits::duration::max());
+    EXPECT_FALSE(bozo::detail::connection_idle_expired(rep));
+    bozo::detail::set_connection_idle_expiry(rep, std::chrono::hours(1));
+    EXPECT_FALSE(bozo::detail::connection_idle_expired(rep));
+    bozo::detail::set_connection_idle_expiry(rep, std::chrono::seconds(1), bozo::time_traits::now() - std::chrono::seconds(2));
+    EXPECT_TRUE(bozo::detail::connection_idle_expired(rep));
+}
+
+TEST(connection_expired, should_return_false_for_representation_without_expiry) {
+    struct rep {};
+    EXPECT_FALSE(bozo::detail::connection_expired(rep{}));
+}
+
+TEST(connection_expired, should_compare_expiry_with_current_time) {
+    pool_handle_mock::value_type rep{};
+    EXPECT_FALSE(bozo::detail::connection_expired(rep));
+    bozo::detail::set_connection_expiry(rep, bozo::time_traits::now() + std::chrono::hours(1));
+    EXPECT_FALSE(bozo::detail::connection_expired(rep));
+    bozo::detail::set_connection_expiry(rep, bozo::time_traits::now() - std::chrono::seconds(1));
+    EXPECT_TRUE(bozo::detail::connection_expired(rep));
+}
+
+struct top_up_handle {
+    std::shared_ptr<int> value;
+    bool empty() const { return !value;}
+};
+
+struct pool_top_up_state : Test {
+    boost::asio::io_context io;
+    std::optional<bozo::error_code> result;
+    std::shared_ptr<std::atomic<bool>> in_progress = std::make_shared<std::atomic<bool>>(true);
+
+    auto make_state(std::size_t pending) {
+        auto handler = [this](bozo::error_code ec) { result = ec; };
+        return bozo::detail::pool_top_up_state<top_up_handle, bozo::detail::stub_mutex,
+            boost::asio::io_context::executor_type, decltype(handler)>{
+                pending, in_progress, io.get_executor(), handler};
+    }
+};
+
+TEST_F(pool_top_up_state, should_hold_idle_connections_only_until_all_handles_are_got) {
+    auto state = make_state(3);
+    auto idle = std::make_shared<int>(1);
+    EXPECT_TRUE(state.add({}, top_up_handle{idle}).empty());
+    EXPECT_EQ(idle.use_count(), 2);
+    EXPECT_TRUE(state.add({}, top_up_handle{}).empty());
+    const auto handles = state.add({}, top_up_handle{});
+    EXPECT_EQ(handles.size(), 2u);
+    EXPECT_EQ(idle.use_count(), 1);
+    EXPECT_TRUE(in_progress->load());
+}
+
+TEST_F(pool_top_up_state, should_complete_once_new_connections_are_opened) {
+    auto state = make_state(2);
+    state.add({}, top_up_handle{});
+    state.add({}, top_up_handle{});
+    state.connected({});
+    EXPECT_TRUE(in_progress->load());
+    state.connected({});
+    EXPECT_FALSE(in_progress->load());
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(*result);
+}
+
+TEST_F(pool_top_up_state, should_complete_if_there_is_no_room_for_new_connections) {
+    auto state = make_state(1);
+    EXPECT_TRUE(state.add({}, top_up_handle{std::make_shared<int>(1)}).empty());
+    EXPECT_FALSE(in_progress->load());
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(*result);
+}
+
+TEST_F(pool_top_up_state, should_post_handler_with_first_error) {
+    auto state = make_state(3);
+    state.add(bozo::tests::error::error, top_up_handle{});
+    state.add({}, top_up_handle{std::make_shared<int>(1)});
+    EXPECT_EQ(state.add(boost::asio::error::timed_out, top_up_handle{}).size(), 2u);
+    state.connected(boost::asio::error::timed_out);
+    state.connected({});
+    EXPECT_FALSE(result);
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, bozo::error_code(bozo::tests::error::error));
+}
+
+TEST_F(pool_top_up_state, should_post_handler_without_error_on_complete) {
+    auto state = make_state(0);
+    state.complete();
+    EXPECT_FALSE(in_progress->load());
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(*result);
+}
+
+} // namespace
@@ -0,0 +1,91 @@
+#include <bozo/detail/bulk_endian.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace testing;
+
+template <typename T>
+std::vector<T> make_big_endian_sequence(std::size_t count) {
+    std::vector<T> retval;
+    for (std::size_t i = 0; i != count; ++i) {
+        const T v = static_cast<T>(0x0102030405060708ull * (i + 1));
+        retval.push_back(bozo::detail::byte_order_swap<T>(v, std::make_index_sequence<sizeof(T)>{}));
+    }
+    return retval;
+}
+
+template <typename T>
+std::vector<T> make_native_sequence(std::size_t count) {
+    std::vector<T> retval;
+    for (std::size_t i = 0; i != count; ++i) {
+        retval.push_back(static_cast<T>(0x0102030405060708ull * (i + 1)));
+    }
+    return retval;
+}
+
+template <typename T>
+void check_swap(bozo::detail::byte_order_swap_function swap) {
+    // Count is chosen to involve both the vectorized part and the tail
+    for (std::size_t count : {0, 1, 3, 17, 35}) {
+        auto values = make_big_endian_sequence<T>(count);
+        swap(reinterpret_cast<char*>(values.data()), values.size());
+        EXPECT_EQ(values, make_native_sequence<T>(count)) << "count " << count;
+    }
+}
+
+TEST(byte_order_swap_scalar, should_swap_bytes_of_each_item) {
+    check_swap<std::uint16_t>(bozo::detail::byte_order_swap_scalar<2>);
+    check_swap<std::uint32_t>(bozo::detail::byte_order_swap_scalar<4>);
+    check_swap<std::uint64_t>(bozo::detail::byte_order_swap_scalar<8>);
+}
+
+#ifdef BOZO_DETAIL_X86_SIMD
+
+TEST(byte_order_swap_ssse3, should_swap_bytes_of_each_item) {
+    if (!__builtin_cpu_supports("ssse3")) {
+        GTEST_SKIP() << "SSSE3 is not supported by the CPU";
+    }
+    check_swap<std::uint16_t>(bozo::detail::byte_order_swap_ssse3<2>);
+    check_swap<std::uint32_t>(bozo::detail::byte_order_swap_ssse3<4>);
+    check_swap<std::uint64_t>(bozo::detail::byte_order_swap_ssse3<8>);
+}
+
+TEST(byte_order_swap_avx2, should_swap_bytes_of_each_item) {
+    if (!__builtin_cpu_supports("avx2")) {
+        GTEST_SKIP() << "AVX2 is not supported by the CPU";
+    }
+    check_swap<std::uint16_t>(bozo::detail::byte_order_swap_avx2<2>);
+    check_swap<std::uint32_t>(bozo::detail::byte_order_swap_avx2<4>);
+    check_swap<std::uint64_t>(bozo::detail::byte_order_swap_avx2<8>);
+}
+
+#endif
+
+TEST(convert_from_big_endian, should_convert_signed_integers) {
+    std::vector<std::int32_t> values;
+    for (std::int32_t v : {-1, 7, -2, 0x01020304}) {
+        values.push_back(static_cast<std::int32_t>(bozo::detail::convert_to_big_endian(v)));
+    }
+    bozo::detail::convert_from_big_endian(values.data(), values.size());
+    EXPECT_THAT(values, ElementsAre(-1, 7, -2, 0x01020304));
+}
+
+TEST(convert_from_big_endian, should_convert_floating_point_numbers) {
+    std::vector<double> values = {1.5, -3.25};
+    for (auto& v : values) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof v);
+        bits = bozo::detail::convert_to_big_endian(bits);
+        std::memcpy(&v, &bits, sizeof v);
+    }
+    bozo::detail::convert_from_big_endian(values.data(), values.size());
+    EXPECT_THAT(values, ElementsAre(1.5, -3.25));
+}
+
+} // namespace
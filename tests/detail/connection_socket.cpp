@@ -0,0 +1,93 @@
+#include <bozo/detail/connection_socket.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using bozo::detail::connection_socket;
+
+struct connection_socket_test : testing::Test {
+    int fds[2] = {-1, -1};
+
+    connection_socket_test() {
+        EXPECT_EQ(::pipe(fds), 0);
+    }
+
+    ~connection_socket_test() {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    static bool is_open(int fd) {
+        return ::fcntl(fd, F_GETFD) != -1;
+    }
+};
+
+TEST_F(connection_socket_test, bind_should_assign_file_descriptor) {
+    boost::asio::io_context io;
+    connection_socket socket;
+    auto& stream = socket.bind(io, fds[0]);
+    EXPECT_EQ(stream.native_handle(), fds[0]);
+    EXPECT_TRUE(socket.is_bound());
+    EXPECT_EQ(socket.context(), &io);
+}
+
+TEST_F(connection_socket_test, bind_should_reuse_registration_for_same_io_context_and_file_descriptor) {
+    boost::asio::io_context io;
+    connection_socket socket;
+    auto& first = socket.bind(io, fds[0]);
+    auto& second = socket.bind(io, fds[0]);
+    EXPECT_EQ(&first, &second);
+}
+
+TEST_F(connection_socket_test, bind_should_rebind_for_another_io_context) {
+    boost::asio::io_context io1;
+    boost::asio::io_context io2;
+    connection_socket socket;
+    socket.bind(io1, fds[0]);
+    auto& stream = socket.bind(io2, fds[0]);
+    EXPECT_EQ(stream.native_handle(), fds[0]);
+    EXPECT_EQ(socket.context(), &io2);
+}
+
+TEST_F(connection_socket_test, bind_should_rebind_for_another_file_descriptor) {
+    boost::asio::io_context io;
+    connection_socket socket;
+    socket.bind(io, fds[0]);
+    EXPECT_EQ(socket.bind(io, fds[1]).native_handle(), fds[1]);
+}
+
+TEST_F(connection_socket_test, release_should_not_close_file_descriptor) {
+    boost::asio::io_context io;
+    {
+        connection_socket socket;
+        socket.bind(io, fds[0]);
+        socket.release();
+        EXPECT_FALSE(socket.is_bound());
+    }
+    EXPECT_TRUE(is_open(fds[0]));
+}
+
+TEST_F(connection_socket_test, destructor_should_not_close_file_descriptor_after_io_context_is_destroyed) {
+    connection_socket socket;
+    {
+        boost::asio::io_context io;
+        socket.bind(io, fds[0]);
+    }
+    socket.release();
+    EXPECT_TRUE(is_open(fds[0]));
+}
+
+TEST_F(connection_socket_test, move_should_transfer_registration) {
+    boost::asio::io_context io;
+    connection_socket socket;
+    auto& stream = socket.bind(io, fds[0]);
+    connection_socket other(std::move(socket));
+    EXPECT_FALSE(socket.is_bound());
+    EXPECT_EQ(&other.bind(io, fds[0]), &stream);
+}
+
+} // namespace
@@ -0,0 +1,111 @@
+#include <bozo/detail/query_arena.h>
+#include <bozo/io/binary_query.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+namespace hana = boost::hana;
+
+using namespace testing;
+using bozo::detail::query_arena;
+using bozo::detail::query_arena_allocator;
+
+TEST(query_arena, should_serve_allocation_from_heap_and_grow_block_on_rewind) {
+    query_arena arena;
+    auto p = arena.allocate(100, 8);
+    EXPECT_FALSE(arena.owns(p));
+    arena.deallocate(p, 100, 8);
+
+    p = arena.allocate(100, 8);
+    EXPECT_TRUE(arena.owns(p));
+    EXPECT_GE(arena.capacity(), 100u);
+    arena.deallocate(p, 100, 8);
+}
+
+TEST(query_arena, should_rewind_block_when_all_allocations_are_released) {
+    query_arena arena;
+    arena.deallocate(arena.allocate(64, 8), 64, 8);
+
+    auto p1 = arena.allocate(16, 8);
+    auto p2 = arena.allocate(16, 8);
+    EXPECT_NE(p1, p2);
+    arena.deallocate(p1, 16, 8);
+    arena.deallocate(p2, 16, 8);
+
+    auto p3 = arena.allocate(16, 8);
+    EXPECT_EQ(p3, p1);
+    arena.deallocate(p3, 16, 8);
+}
+
+TEST(query_arena, should_not_rewind_block_while_some_allocation_is_alive) {
+    query_arena arena;
+    arena.deallocate(arena.allocate(64, 8), 64, 8);
+
+    auto p1 = arena.allocate(16, 8);
+    auto p2 = arena.allocate(16, 8);
+    arena.deallocate(p1, 16, 8);
+
+    auto p3 = arena.allocate(16, 8);
+    EXPECT_NE(p3, p1);
+    EXPECT_NE(p3, p2);
+    arena.deallocate(p2, 16, 8);
+    arena.deallocate(p3, 16, 8);
+}
+
+TEST(query_arena, should_not_grow_block_beyond_max_block_size) {
+    query_arena arena;
+    const auto size = query_arena::max_block_size + 1;
+    arena.deallocate(arena.allocate(size, 8), size, 8);
+
+    auto p = arena.allocate(size, 8);
+    EXPECT_FALSE(arena.owns(p));
+    EXPECT_EQ(arena.capacity(), query_arena::max_block_size);
+    arena.deallocate(p, size, 8);
+}
+
+TEST(query_arena, should_align_allocations) {
+    query_arena arena;
+    arena.deallocate(arena.allocate(64, 8), 64, 8);
+
+    auto p1 = arena.allocate(1, 1);
+    auto p2 = arena.allocate(8, 8);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p2) % 8, 0u);
+    arena.deallocate(p1, 1, 1);
+    arena.deallocate(p2, 8, 8);
+}
+
+TEST(query_arena_allocator, should_be_usable_for_binary_query) {
+    auto arena = std::make_shared<query_arena>();
+    query_arena_allocator<char> alloc{arena};
+    const auto make_query = [&] {
+        return bozo::binary_query("", hana::make_tuple(std::string("string")), bozo::empty_oid_map{}, alloc);
+    };
+    const char* first = nullptr;
+    {
+        make_query();
+        const auto query = make_query();
+        first = query.values()[0];
+        EXPECT_TRUE(arena->owns(first));
+        EXPECT_EQ(std::string(first, 6), "string");
+    }
+    const auto query = make_query();
+    EXPECT_EQ(query.values()[0], first);
+}
+
+TEST(get_query_allocator, should_return_connection_arena_allocator_for_std_allocator) {
+    struct connection {
+        std::shared_ptr<bozo::detail::query_arena> arena = std::make_shared<bozo::detail::query_arena>();
+        const std::shared_ptr<bozo::detail::query_arena>& query_arena() { return arena;}
+    } conn;
+    const auto alloc = bozo::detail::get_query_allocator(conn, std::allocator<void>{});
+    EXPECT_EQ(alloc.arena(), conn.arena);
+}
+
+TEST(get_query_allocator, should_return_given_allocator_for_connection_without_arena) {
+    struct connection {} conn;
+    const auto alloc = bozo::detail::get_query_allocator(conn, std::allocator<void>{});
+    EXPECT_TRUE((std::is_same_v<decltype(alloc), const std::allocator<void>>));
+}
+
+} // namespace
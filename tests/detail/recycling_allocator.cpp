@@ -0,0 +1,88 @@
+#include <bozo/detail/recycling_allocator.h>
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bozo::detail::recycling_allocator;
+
+struct object {
+    char data[40];
+};
+
+TEST(recycling_allocator, should_reuse_deallocated_block) {
+    recycling_allocator<object> alloc;
+    auto p = alloc.allocate(1);
+    alloc.deallocate(p, 1);
+    EXPECT_EQ(alloc.allocate(1), p);
+    alloc.deallocate(p, 1);
+}
+
+TEST(recycling_allocator, should_not_cache_array_blocks) {
+    recycling_allocator<object> alloc;
+    const auto cached = alloc.cached();
+    auto p = alloc.allocate(2);
+    alloc.deallocate(p, 2);
+    EXPECT_EQ(alloc.cached(), cached);
+}
+
+TEST(recycling_allocator, should_not_cache_more_blocks_than_capacity) {
+    recycling_allocator<object> alloc;
+    std::vector<object*> blocks;
+    for (std::size_t i = 0; i < recycling_allocator<object>::cache_capacity + 2; ++i) {
+        blocks.push_back(alloc.allocate(1));
+    }
+    for (auto p : blocks) {
+        alloc.deallocate(p, 1);
+    }
+    EXPECT_EQ(alloc.cached(), recycling_allocator<object>::cache_capacity);
+}
+
+TEST(recycling_allocator, should_reuse_block_of_shared_object) {
+    recycling_allocator<object> alloc;
+    const object* p = std::allocate_shared<object>(alloc).get();
+    EXPECT_EQ(std::allocate_shared<object>(alloc).get(), p);
+}
+
+struct late_block {
+    object* block = nullptr;
+    std::size_t* cached = nullptr;
+
+    // Thread local destructors run in the reverse order, so the block
+    // is deallocated after the cache of the thread has been destroyed
+    ~late_block() {
+        if (block) {
+            recycling_allocator<object>{}.deallocate(block, 1);
+            *cached = recycling_allocator<object>::cached();
+        }
+    }
+};
+
+TEST(recycling_allocator, should_deallocate_block_to_heap_after_cache_of_thread_destroyed) {
+    std::size_t cached = recycling_allocator<object>::cache_capacity;
+    std::thread([&] {
+        thread_local late_block late;
+        recycling_allocator<object> alloc;
+        alloc.deallocate(alloc.allocate(1), 1);
+        late.block = alloc.allocate(1);
+        late.cached = &cached;
+    }).join();
+    EXPECT_EQ(cached, 0u);
+}
+
+TEST(get_recycling_allocator, should_replace_default_allocator) {
+    EXPECT_TRUE((std::is_same_v<decltype(bozo::detail::get_recycling_allocator(std::allocator<int>{})),
+        recycling_allocator<int>>));
+}
+
+TEST(get_recycling_allocator, should_keep_custom_allocator) {
+    using custom_allocator = std::pmr::polymorphic_allocator<int>;
+    EXPECT_TRUE((std::is_same_v<decltype(bozo::detail::get_recycling_allocator(custom_allocator{})),
+        custom_allocator>));
+}
+
+} // namespace
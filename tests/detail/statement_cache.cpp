@@ -0,0 +1,100 @@
+#include <bozo/detail/statement_cache.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace std::string_literals;
+
+auto make_query(const char* text) {
+    return bozo::binary_query(text, boost::hana::make_tuple(), bozo::empty_oid_map{});
+}
+
+auto make_query(const char* text, std::int64_t value) {
+    return bozo::binary_query(text, boost::hana::make_tuple(value), bozo::empty_oid_map{});
+}
+
+TEST(statement_cache, should_be_disabled_by_default) {
+    bozo::detail::statement_cache cache;
+    EXPECT_FALSE(cache.enabled());
+}
+
+TEST(statement_cache, should_not_insert_if_disabled) {
+    bozo::detail::statement_cache cache;
+    cache.insert(make_query("SELECT 1"), "name");
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.find(make_query("SELECT 1")), nullptr);
+}
+
+TEST(statement_cache, find_should_return_name_of_inserted_statement) {
+    bozo::detail::statement_cache cache{2};
+    cache.insert(make_query("SELECT 1"), "name");
+    const auto name = cache.find(make_query("SELECT 1"));
+    ASSERT_NE(name, nullptr);
+    EXPECT_EQ(*name, "name"s);
+}
+
+TEST(statement_cache, find_should_return_nullptr_for_statement_with_different_text) {
+    bozo::detail::statement_cache cache{2};
+    cache.insert(make_query("SELECT 1"), "name");
+    EXPECT_EQ(cache.find(make_query("SELECT 2")), nullptr);
+}
+
+TEST(statement_cache, find_should_return_nullptr_for_statement_with_different_parameters_types) {
+    bozo::detail::statement_cache cache{2};
+    cache.insert(make_query("SELECT $1"), "name");
+    EXPECT_EQ(cache.find(make_query("SELECT $1", 42)), nullptr);
+}
+
+TEST(statement_cache, insert_should_evict_least_recently_used_statement_if_full) {
+    bozo::detail::statement_cache cache{2};
+    cache.insert(make_query("SELECT 1"), "first");
+    cache.insert(make_query("SELECT 2"), "second");
+    cache.find(make_query("SELECT 1"));
+    cache.insert(make_query("SELECT 3"), "third");
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(make_query("SELECT 2")), nullptr);
+    EXPECT_NE(cache.find(make_query("SELECT 1")), nullptr);
+    EXPECT_THAT(cache.evicted(), ElementsAre("second"s));
+}
+
+TEST(statement_cache, set_capacity_should_evict_extra_statements) {
+    bozo::detail::statement_cache cache{2};
+    cache.insert(make_query("SELECT 1"), "first");
+    cache.insert(make_query("SELECT 2"), "second");
+    cache.set_capacity(1);
+
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_NE(cache.find(make_query("SELECT 2")), nullptr);
+    EXPECT_THAT(cache.evicted(), ElementsAre("first"s));
+}
+
+TEST(statement_cache, pop_evicted_should_return_and_remove_last_evicted_name) {
+    bozo::detail::statement_cache cache{1};
+    cache.insert(make_query("SELECT 1"), "first");
+    cache.insert(make_query("SELECT 2"), "second");
+
+    EXPECT_EQ(cache.pop_evicted(), "first"s);
+    EXPECT_TRUE(cache.evicted().empty());
+}
+
+TEST(statement_cache, clear_should_forget_statements_and_evicted_names) {
+    bozo::detail::statement_cache cache{1};
+    cache.insert(make_query("SELECT 1"), "first");
+    cache.insert(make_query("SELECT 2"), "second");
+    cache.clear();
+
+    EXPECT_TRUE(cache.empty());
+    EXPECT_TRUE(cache.evicted().empty());
+    EXPECT_EQ(cache.find(make_query("SELECT 2")), nullptr);
+}
+
+TEST(statement_cache, make_name_should_generate_unique_names) {
+    bozo::detail::statement_cache cache;
+    EXPECT_NE(cache.make_name(), cache.make_name());
+}
+
+} // namespace
@@ -0,0 +1,188 @@
+#include <bozo/asio.h>
+#include <bozo/error.h>
+#include <bozo/deadline_wheel.h>
+#include <bozo/detail/timer_wheel.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+#include <vector>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+struct timer_wheel : Test {
+    const bozo::time_traits::time_point start{};
+    bozo::detail::timer_wheel wheel{1ms, start};
+    std::vector<bozo::detail::timer_wheel_entry> entries = std::vector<bozo::detail::timer_wheel_entry>(4);
+
+    std::vector<std::size_t> advance(bozo::time_traits::duration to) {
+        std::vector<std::size_t> retval;
+        wheel.advance(start + to, [&] (auto& e) { retval.push_back(std::size_t(&e - entries.data()));});
+        return retval;
+    }
+};
+
+TEST_F(timer_wheel, insert_should_return_false_for_expired_deadline) {
+    advance(5ms);
+    EXPECT_FALSE(wheel.insert(entries[0], start + 5ms));
+    EXPECT_FALSE(entries[0].linked());
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST_F(timer_wheel, advance_should_expire_entries_when_deadline_passed) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 3ms));
+    ASSERT_TRUE(wheel.insert(entries[1], start + 10ms));
+    EXPECT_THAT(advance(2ms), IsEmpty());
+    EXPECT_THAT(advance(3ms), ElementsAre(0u));
+    EXPECT_FALSE(entries[0].linked());
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_THAT(advance(20ms), ElementsAre(1u));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST_F(timer_wheel, advance_should_round_deadline_up_to_granularity) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 2500us));
+    EXPECT_THAT(advance(2999us), IsEmpty());
+    EXPECT_THAT(advance(3ms), ElementsAre(0u));
+}
+
+TEST_F(timer_wheel, advance_should_expire_entries_of_second_level_and_overflow) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 300ms));
+    ASSERT_TRUE(wheel.insert(entries[1], start + 70s));
+    ASSERT_TRUE(wheel.insert(entries[2], start + 256ms));
+    EXPECT_THAT(advance(299ms), ElementsAre(2u));
+    EXPECT_THAT(advance(300ms), ElementsAre(0u));
+    EXPECT_THAT(advance(69999ms), IsEmpty());
+    EXPECT_THAT(advance(70s), ElementsAre(1u));
+}
+
+TEST_F(timer_wheel, remove_should_exclude_entry_from_expiration) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 3ms));
+    ASSERT_TRUE(wheel.insert(entries[1], start + 3ms));
+    wheel.remove(entries[0]);
+    EXPECT_FALSE(entries[0].linked());
+    EXPECT_THAT(advance(3ms), ElementsAre(1u));
+}
+
+TEST_F(timer_wheel, next_expiry_should_return_nearest_slot_time) {
+    EXPECT_EQ(wheel.next_expiry(), std::nullopt);
+    ASSERT_TRUE(wheel.insert(entries[0], start + 7ms));
+    ASSERT_TRUE(wheel.insert(entries[1], start + 4ms));
+    EXPECT_EQ(wheel.next_expiry(), start + 4ms);
+}
+
+TEST_F(timer_wheel, next_expiry_should_return_first_level_boundary_for_far_entries) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 1s));
+    EXPECT_EQ(wheel.next_expiry(), start + 256ms);
+}
+
+TEST_F(timer_wheel, clear_should_pass_all_entries_to_handler) {
+    ASSERT_TRUE(wheel.insert(entries[0], start + 1ms));
+    ASSERT_TRUE(wheel.insert(entries[1], start + 1s));
+    ASSERT_TRUE(wheel.insert(entries[2], start + 100s));
+    std::size_t count = 0;
+    wheel.clear([&] (auto& e) { EXPECT_FALSE(e.linked()); ++count;});
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(find_deadline_wheel, should_return_null_for_io_context_without_wheel) {
+    bozo::io_context io;
+    EXPECT_EQ(bozo::find_deadline_wheel(io.get_executor()), nullptr);
+}
+
+TEST(find_deadline_wheel, should_return_enabled_wheel) {
+    bozo::io_context io;
+    auto& wheel = bozo::enable_deadline_wheel(io);
+    EXPECT_EQ(bozo::find_deadline_wheel(io.get_executor()), &wheel);
+    EXPECT_EQ(&bozo::enable_deadline_wheel(io, 10ms), &wheel);
+    EXPECT_EQ(wheel.granularity(), 1ms);
+}
+
+TEST(enable_deadline_wheel, should_enable_single_wheel_if_called_concurrently) {
+    bozo::io_context io;
+    std::vector<std::future<bozo::deadline_wheel_service*>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.push_back(std::async(std::launch::async, [&] { return &bozo::enable_deadline_wheel(io);}));
+    }
+    const auto wheel = results.front().get();
+    for (auto i = std::next(results.begin()); i != results.end(); ++i) {
+        EXPECT_EQ(i->get(), wheel);
+    }
+    EXPECT_EQ(bozo::find_deadline_wheel(io.get_executor()), wheel);
+}
+
+TEST(operation_deadline_timer, should_use_steady_timer_without_wheel) {
+    bozo::io_context io;
+    bozo::detail::operation_deadline_timer<bozo::io_context::executor_type> timer(io.get_executor(), 1ms);
+    EXPECT_FALSE(timer.uses_deadline_wheel());
+}
+
+struct operation_deadline_timer_with_wheel : Test {
+    bozo::io_context io;
+    bozo::deadline_wheel_service& wheel = bozo::enable_deadline_wheel(io);
+    using timer_type = bozo::detail::operation_deadline_timer<bozo::io_context::executor_type>;
+};
+
+TEST_F(operation_deadline_timer_with_wheel, should_call_handler_without_error_on_expiry) {
+    timer_type timer(io.get_executor(), 1ms);
+    EXPECT_TRUE(timer.uses_deadline_wheel());
+    std::optional<bozo::error_code> result;
+    timer.async_wait([&] (bozo::error_code ec) { result = ec;});
+    EXPECT_EQ(wheel.size(), 1u);
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(*result);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST_F(operation_deadline_timer_with_wheel, should_call_handler_with_operation_aborted_on_cancel) {
+    timer_type timer(io.get_executor(), 1h);
+    std::optional<bozo::error_code> result;
+    timer.async_wait([&] (bozo::error_code ec) { result = ec;});
+    timer.cancel();
+    EXPECT_EQ(wheel.size(), 0u);
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, boost::asio::error::operation_aborted);
+}
+
+TEST_F(operation_deadline_timer_with_wheel, should_call_handler_with_operation_aborted_on_destruction) {
+    std::optional<bozo::error_code> result;
+    {
+        timer_type timer(io.get_executor(), 1h);
+        timer.async_wait([&] (bozo::error_code ec) { result = ec;});
+        auto moved = std::move(timer);
+    }
+    io.run();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, boost::asio::error::operation_aborted);
+}
+
+TEST_F(operation_deadline_timer_with_wheel, cancel_after_expiry_should_do_nothing) {
+    timer_type timer(io.get_executor(), bozo::time_traits::time_point{});
+    int calls = 0;
+    timer.async_wait([&] (bozo::error_code ec) { EXPECT_FALSE(ec); ++calls;});
+    timer.cancel();
+    io.run();
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(operation_deadline_timer, should_destroy_pending_handler_on_io_context_destruction) {
+    using timer_type = bozo::detail::operation_deadline_timer<bozo::io_context::executor_type>;
+    auto io = std::make_unique<bozo::io_context>();
+    bozo::enable_deadline_wheel(*io);
+    auto alive = std::make_shared<int>();
+    std::weak_ptr<int> weak = alive;
+    timer_type timer(io->get_executor(), 1h);
+    timer.async_wait([alive = std::move(alive)] (bozo::error_code) {});
+    boost::asio::post(*io, [timer = std::move(timer)] {});
+    io.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+} // namespace
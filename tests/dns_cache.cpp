@@ -0,0 +1,95 @@
+#include <bozo/dns_cache.h>
+#include <bozo/detail/conninfo.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+struct dns_cache : Test {
+    bozo::dns_cache cache;
+    const bozo::time_traits::time_point now {};
+
+    dns_cache() {
+        cache.enable(1min, 100ms);
+    }
+};
+
+TEST_F(dns_cache, lookup_should_return_nothing_for_missing_host) {
+    EXPECT_EQ(cache.lookup("host", now), std::nullopt);
+}
+
+TEST_F(dns_cache, lookup_should_return_updated_addresses_within_ttl) {
+    cache.update("host", {"10.0.0.1", "::1"}, now);
+    EXPECT_THAT(cache.lookup("host", now + 30s), Optional(ElementsAre("10.0.0.1", "::1")));
+    EXPECT_EQ(cache.lookup("other", now + 30s), std::nullopt);
+}
+
+TEST_F(dns_cache, lookup_should_return_nothing_for_expired_addresses) {
+    cache.update("host", {"10.0.0.1"}, now);
+    EXPECT_EQ(cache.lookup("host", now + 1min), std::nullopt);
+}
+
+TEST_F(dns_cache, update_should_not_store_empty_addresses) {
+    cache.update("host", {}, now);
+    EXPECT_EQ(cache.lookup("host", now), std::nullopt);
+}
+
+TEST_F(dns_cache, invalidate_should_drop_addresses_of_host) {
+    cache.update("host", {"10.0.0.1"}, now);
+    cache.update("other", {"10.0.0.2"}, now);
+    cache.invalidate("host");
+    EXPECT_EQ(cache.lookup("host", now), std::nullopt);
+    EXPECT_TRUE(cache.lookup("other", now));
+}
+
+TEST_F(dns_cache, disable_should_drop_addresses_and_ignore_updates) {
+    cache.update("host", {"10.0.0.1"}, now);
+    cache.disable();
+    cache.update("host", {"10.0.0.1"}, now);
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(cache.lookup("host", now), std::nullopt);
+}
+
+TEST_F(dns_cache, attempt_delay_should_return_enabled_value) {
+    EXPECT_EQ(cache.attempt_delay(), 100ms);
+}
+
+TEST(resolvable_host, should_return_host_name_of_key_value_and_uri_conninfo) {
+    EXPECT_EQ(bozo::detail::resolvable_host("host=db.example.com port=5432"), "db.example.com");
+    EXPECT_EQ(bozo::detail::resolvable_host("postgresql://user@db.example.com:5432/db"), "db.example.com");
+}
+
+TEST(resolvable_host, should_return_nothing_for_conninfo_resolved_without_getaddrinfo) {
+    EXPECT_EQ(bozo::detail::resolvable_host("dbname=db"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("host=127.0.0.1"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("host=::1"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("host=/var/run/postgresql"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("host=db.example.com hostaddr=10.0.0.1"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("host=db1.example.com,db2.example.com"), std::nullopt);
+    EXPECT_EQ(bozo::detail::resolvable_host("invalid connection info"), std::nullopt);
+}
+
+TEST(with_hostaddr, should_keep_parameters_and_add_hostaddr) {
+    const auto conninfo = bozo::detail::with_hostaddr("host=db.example.com password='it\\'s\\\\' dbname=db", "10.0.0.1");
+    const auto options = bozo::detail::parse_conninfo(conninfo);
+    ASSERT_TRUE(options);
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "host"), "db.example.com");
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "hostaddr"), "10.0.0.1");
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "dbname"), "db");
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "password"), "it's\\");
+}
+
+TEST(with_hostaddr, should_convert_uri_to_key_value_conninfo) {
+    const auto conninfo = bozo::detail::with_hostaddr("postgresql://user@db.example.com:6432/db", "::1");
+    const auto options = bozo::detail::parse_conninfo(conninfo);
+    ASSERT_TRUE(options);
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "hostaddr"), "::1");
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "port"), "6432");
+    EXPECT_STREQ(bozo::detail::get_conninfo_option(options, "user"), "user");
+}
+
+} // namespace
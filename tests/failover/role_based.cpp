@@ -17,7 +17,16 @@ using namespace std::chrono_literals;
 namespace hana = boost::hana;
 
 struct connection_mock {
+    connection_mock() = default;
+    explicit connection_mock(boost::asio::io_context& io) : io_(std::addressof(io)) {}
+
     MOCK_CONST_METHOD0(close_connection, void());
+    MOCK_METHOD0(cancel, void());
+
+    auto get_executor() const { return io_->get_executor();}
+
+    boost::asio::io_context* io_ = nullptr;
+
     friend void close_connection(connection_mock* self) {
         if(!self) {
             throw std::invalid_argument("self should not be null");
@@ -92,6 +101,11 @@ struct is_connection<::testing::StrictMock<connection_mock>*> : std::true_type {
 template <>
 struct is_nullable<::testing::StrictMock<connection_mock>*> : std::true_type {};
 
+template <>
+struct unwrap_connection_impl<connection_mock*> {
+    static connection_mock& apply(connection_mock* conn) noexcept { return *conn;}
+};
+
 } // namespace
 
 namespace {
@@ -379,4 +393,213 @@ TEST_F(role_based_try__get_context, should_return_whole_time_out_for_two_single_
     EXPECT_EQ(role_based_try.get_context()[hana::size_c<1>], 4s);
 }
 
+using pending_completions = std::vector<std::function<void(bozo::error_code)>>;
+
+// Completes as soon as a connection is obtained or, if pending completions are
+// given, once the completion stored for the connection is called.
+struct hedge_operation {
+    struct initiator {
+        pending_completions* pending_ = nullptr;
+
+        template <typename Handler, typename Provider, typename TimeConstraint, typename Query, typename Out>
+        void operator() (Handler&& h, Provider&& p, TimeConstraint t, Query, Out out) const {
+            auto handler = std::make_shared<std::decay_t<Handler>>(std::forward<Handler>(h));
+            p.async_get_connection(t, [handler, out, pending = pending_] (bozo::error_code ec, connection_mock* conn) mutable {
+                if (!ec) {
+                    *out++ = conn;
+                }
+                if (ec || !pending) {
+                    return (*handler)(ec, conn);
+                }
+                pending->push_back([handler, conn] (bozo::error_code ec) { (*handler)(ec, conn);});
+            });
+        }
+    };
+
+    pending_completions* pending_ = nullptr;
+
+    initiator get_initiator() const { return {pending_};}
+};
+
+// Query is neither default constructible nor assignable, so it can be passed as is only
+struct hedge_query {
+    const int id;
+
+    explicit hedge_query(int id) : id(id) {}
+};
+
+struct role_based__hedging : Test {
+    NiceMock<role_based_connection_source_mock> source;
+    boost::asio::io_context io;
+    NiceMock<connection_mock> first_conn{io};
+    NiceMock<connection_mock> second_conn{io};
+    NiceMock<connection_mock> third_conn{io};
+    std::vector<std::function<void(bozo::error_code, connection_mock*)>> issues;
+    pending_completions pending;
+    std::vector<connection_mock*> out;
+    std::vector<bozo::error_code> results;
+    const hedge_query query{42};
+
+    using opt = bozo::failover::role_based_options;
+
+    template <typename ...Roles>
+    void start(duration delay, hedge_operation op, Roles ...roles) {
+        EXPECT_CALL(source, call(_)).WillRepeatedly(Invoke([&] (auto h) { issues.push_back(std::move(h));}));
+        auto strategy = bozo::failover::role_based(roles...).set(opt::hedge_delay=delay);
+        auto initiator = bozo::construct_initiator(strategy, op);
+        initiator([&] (bozo::error_code ec, connection_mock*) { results.push_back(ec);},
+            bozo::failover::role_based_connection_provider{
+                role_based_connection_source<class dummy>{std::addressof(source)}, io},
+            bozo::none, std::cref(query), std::back_inserter(out));
+    }
+
+    void start(duration delay) {
+        start(delay, hedge_operation{}, test_role);
+    }
+};
+
+TEST_F(role_based__hedging, should_complete_without_second_issue_when_first_completed_before_delay) {
+    start(1h);
+    ASSERT_EQ(issues.size(), 1u);
+    issues[0](bozo::error_code{}, &first_conn);
+    io.run();
+    EXPECT_EQ(issues.size(), 1u);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_THAT(out, ElementsAre(&first_conn));
+}
+
+TEST_F(role_based__hedging, should_issue_operation_again_after_delay_and_complete_with_first_completed) {
+    start(0s);
+    io.run();
+    ASSERT_EQ(issues.size(), 2u);
+    issues[1](bozo::error_code{}, &second_conn);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_CALL(first_conn, cancel()).Times(0);
+    issues[0](bozo::error_code{}, &first_conn);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_THAT(out, ElementsAre(&second_conn));
+}
+
+TEST_F(role_based__hedging, should_cancel_connection_of_other_issue_via_its_executor) {
+    start(0s, hedge_operation{&pending}, test_role);
+    io.run();
+    ASSERT_EQ(issues.size(), 2u);
+    issues[0](bozo::error_code{}, &first_conn);
+    issues[1](bozo::error_code{}, &second_conn);
+    ASSERT_EQ(pending.size(), 2u);
+    EXPECT_CALL(first_conn, cancel()).Times(0);
+    pending[1](bozo::error_code{});
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    Mock::VerifyAndClearExpectations(&first_conn);
+
+    EXPECT_CALL(first_conn, cancel());
+    io.restart();
+    io.run();
+    pending[0](boost::asio::error::operation_aborted);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+}
+
+TEST_F(role_based__hedging, should_not_cancel_connection_of_finished_try) {
+    start(0s, hedge_operation{&pending}, test_role, test_role);
+    io.run();
+    ASSERT_EQ(issues.size(), 2u);
+    issues[0](bozo::error_code{}, &first_conn);
+    issues[1](bozo::error_code{}, &second_conn);
+    ASSERT_EQ(pending.size(), 2u);
+    pending[0](bozo::tests::error::error);
+    ASSERT_EQ(issues.size(), 3u);
+    pending[1](bozo::error_code{});
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_CALL(first_conn, cancel()).Times(0);
+    io.restart();
+    io.run();
+    issues[2](bozo::error_code{}, &third_conn);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_THAT(out, ElementsAre(&second_conn));
+}
+
+TEST_F(role_based__hedging, should_wait_for_other_issue_on_error) {
+    start(0s);
+    io.run();
+    ASSERT_EQ(issues.size(), 2u);
+    issues[0](bozo::tests::error::error, &first_conn);
+    EXPECT_THAT(results, IsEmpty());
+    issues[1](bozo::error_code{}, &second_conn);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}));
+    EXPECT_THAT(out, ElementsAre(&second_conn));
+}
+
+TEST_F(role_based__hedging, should_complete_with_error_when_both_issues_failed) {
+    start(0s);
+    io.run();
+    ASSERT_EQ(issues.size(), 2u);
+    issues[1](bozo::tests::error::error, &second_conn);
+    issues[0](bozo::tests::error::another_error, &first_conn);
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{bozo::tests::error::another_error}));
+    EXPECT_THAT(out, IsEmpty());
+}
+
+TEST(hedge_buffer, should_move_collected_values_to_back_inserter_on_commit) {
+    std::vector<int> out{1};
+    auto inserter = std::back_inserter(out);
+    bozo::failover::detail::hedge_buffer<decltype(inserter)> buffer;
+    auto it = buffer.get(inserter);
+    *it++ = 2;
+    *it++ = 3;
+    EXPECT_THAT(out, ElementsAre(1));
+    buffer.commit(inserter);
+    EXPECT_THAT(out, ElementsAre(1, 2, 3));
+}
+
+TEST(hedge_buffer, should_move_collected_values_to_forward_iterator_on_commit) {
+    std::vector<int> out{0, 0, 0};
+    auto it = out.begin();
+    bozo::failover::detail::hedge_buffer<decltype(it)> buffer;
+    auto buffer_it = buffer.get(it);
+    *buffer_it++ = 1;
+    *buffer_it++ = 2;
+    EXPECT_THAT(out, ElementsAre(0, 0, 0));
+    buffer.commit(it);
+    EXPECT_THAT(out, ElementsAre(1, 2, 0));
+}
+
+TEST(hedge_buffer, should_pass_collected_rows_to_row_stream_callback_on_commit) {
+    std::vector<int> out;
+    auto stream = bozo::for_each_row<int>([&] (int v) { out.push_back(v);});
+    bozo::failover::detail::hedge_buffer<decltype(stream)> buffer;
+    auto it = buffer.get(stream);
+    *it++ = 1;
+    *it++ = 2;
+    EXPECT_THAT(out, IsEmpty());
+    buffer.commit(stream);
+    EXPECT_THAT(out, ElementsAre(1, 2));
+}
+
+TEST(hedge_buffer, should_assign_collected_value_to_referenced_object_on_commit) {
+    std::string out;
+    auto ref = std::ref(out);
+    bozo::failover::detail::hedge_buffer<decltype(ref)> buffer;
+    buffer.get(ref).get() = "value";
+    EXPECT_EQ(out, "");
+    buffer.commit(ref);
+    EXPECT_EQ(out, "value");
+}
+
+TEST(hedge_buffers, should_pass_query_as_is_and_buffer_output_only) {
+    const hedge_query query{42};
+    std::string out;
+    auto query_ref = std::cref(query);
+    auto out_ref = std::ref(out);
+    typename bozo::failover::detail::hedge_buffers<decltype(query_ref), decltype(out_ref)>::type buffers;
+    EXPECT_EQ(&buffers[hana::size_c<0>].get(query_ref).get(), &query);
+    EXPECT_NE(&buffers[hana::size_c<1>].get(out_ref).get(), &out);
+}
+
+TEST(hedge_buffers, should_pass_single_query_as_is) {
+    std::string query = "SELECT 1";
+    auto query_ref = std::ref(query);
+    typename bozo::failover::detail::hedge_buffers<decltype(query_ref)>::type buffers;
+    EXPECT_EQ(&buffers[hana::size_c<0>].get(query_ref).get(), &query);
+}
+
 } // namespace
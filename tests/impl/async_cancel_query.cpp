@@ -0,0 +1,132 @@
+#include <connection_mock.h>
+#include <test_error.h>
+
+#include <bozo/impl/async_cancel_query.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::tests;
+
+using callback_mock = callback_gmock<connection_ptr<>>;
+
+using bozo::error_code;
+
+struct async_cancel_query_op : Test {
+    StrictMock<connection_gmock> connection{};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback{};
+    StrictMock<cancel_handle_mock> cancel_handle{};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+
+    async_cancel_query_op() {
+        EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+    }
+
+    auto make_operation(bozo::time_traits::time_point deadline = bozo::time_traits::time_point::max()) {
+        return bozo::impl::async_cancel_query_op{conn, deadline, wrap(callback)};
+    }
+
+    void expect_cancel(Sequence& s, error_code ec = {}, std::string msg = {}) {
+        EXPECT_CALL(connection, get_cancel_handle()).InSequence(s).WillOnce(Return(&cancel_handle));
+        EXPECT_CALL(cancel_handle, dispatch_cancel()).InSequence(s)
+            .WillOnce(Return(std::make_tuple(ec, std::move(msg))));
+    }
+};
+
+TEST_F(async_cancel_query_op, should_cancel_query_drain_results_and_call_handler) {
+    bozo::tests::pg_result canceled{PGRES_FATAL_ERROR, "57014"};
+
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&canceled));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+}
+
+TEST_F(async_cancel_query_op, should_wait_for_write_while_output_is_flushed) {
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_write(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+}
+
+TEST_F(async_cancel_query_op, should_call_handler_with_error_and_set_error_context_if_cancel_failed) {
+    Sequence s;
+    expect_cancel(s, bozo::error::pq_cancel_failed, "cancel error");
+    EXPECT_CALL(callback, call(error_code{bozo::error::pq_cancel_failed}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+
+    EXPECT_EQ(conn->error_context_, "cancel error");
+}
+
+TEST_F(async_cancel_query_op, should_call_handler_with_timed_out_if_deadline_is_reached) {
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(callback, call(error_code{boost::asio::error::timed_out}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation(bozo::time_traits::now() - std::chrono::seconds(1)).perform();
+}
+
+TEST_F(async_cancel_query_op, should_call_handler_with_error_if_wait_is_aborted) {
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s)
+        .WillOnce(InvokeArgument<0>(error_code{boost::asio::error::operation_aborted}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code{boost::asio::error::operation_aborted}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+}
+
+TEST_F(async_cancel_query_op, should_call_handler_with_error_if_consume_input_failed) {
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_consume_input_failed}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+}
+
+TEST_F(async_cancel_query_op, should_call_handler_with_result_status_unexpected_if_copy_is_in_progress) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+
+    Sequence s;
+    expect_cancel(s);
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&copy_out));
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _)).InSequence(s).WillOnce(Return());
+
+    make_operation().perform();
+}
+
+} // namespace
@@ -0,0 +1,287 @@
+#include <connection_mock.h>
+#include <test_error.h>
+
+#include <bozo/impl/async_copy_in.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::tests;
+
+using callback_mock = callback_gmock<connection_ptr<>>;
+
+using bozo::error_code;
+
+struct async_put_copy_data_op : Test {
+    StrictMock<connection_gmock> connection{};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback{};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+    std::string data;
+
+    auto make_operation_context() {
+        EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+        return bozo::impl::make_request_operation_context(conn, wrap(callback));
+    }
+
+    decltype(bozo::impl::make_request_operation_context(conn, wrap(callback))) ctx;
+
+    async_put_copy_data_op() : ctx(make_operation_context()) {}
+
+    bozo::binary_query query() const {
+        return bozo::binary_query("COPY t FROM STDIN (FORMAT binary)", boost::hana::make_tuple(), bozo::empty_oid_map{});
+    }
+
+    void expect_send_query(Sequence& s) {
+        EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+        EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    }
+
+    void expect_result(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(result));
+    }
+
+    auto save_data() {
+        return Invoke([&] (const char* buffer, int size) { data.append(buffer, size); return 1; });
+    }
+};
+
+const std::string copy_header("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19);
+const std::string copy_trailer("\377\377", 2);
+
+TEST_F(async_put_copy_data_op, should_put_rows_in_binary_copy_format_and_call_handler) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    const std::vector<std::tuple<std::int16_t>> rows = {{1}, {2}};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(save_data());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), rows);
+
+    EXPECT_EQ(data, copy_header
+        + std::string("\0\1\0\0\0\2\0\1", 8)
+        + std::string("\0\1\0\0\0\2\0\2", 8)
+        + copy_trailer);
+}
+
+TEST_F(async_put_copy_data_op, should_put_header_and_trailer_only_for_empty_rows) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(save_data());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+
+    EXPECT_EQ(data, copy_header + copy_trailer);
+}
+
+TEST_F(async_put_copy_data_op, should_put_rows_by_batches) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    const std::vector<std::tuple<std::string>> rows(3, std::tuple<std::string>(std::string(40000, 'a')));
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(save_data());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(save_data());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), rows);
+
+    EXPECT_EQ(data.size(), copy_header.size() + 3 * (2 + 4 + 40000) + copy_trailer.size());
+}
+
+TEST_F(async_put_copy_data_op, should_wait_for_write_if_copy_data_could_not_be_queued) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    const std::vector<std::tuple<std::int16_t>> rows = {{1}};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, async_wait_write(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(save_data());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_write(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), rows);
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_sql_state_error_if_query_failed) {
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "42P01"};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::undefined_table), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_result_status_unexpected_if_query_is_not_copy_in) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &tuples_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_pg_put_copy_data_failed_if_put_copy_data_failed) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(-1));
+    EXPECT_CALL(native_handle, PQputCopyEnd(NotNull())).InSequence(s).WillOnce(Return(-1));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_put_copy_data_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_end_copy_with_error_and_consume_results_if_put_copy_data_failed) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "57014"};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(-1));
+    EXPECT_CALL(native_handle, PQputCopyEnd(NotNull())).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_put_copy_data_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_pg_consume_input_failed_if_consume_input_failed_on_copy_result) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &command_ok);
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_consume_input_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_pg_put_copy_end_failed_if_put_copy_end_failed) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(-1));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_put_copy_end_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+TEST_F(async_put_copy_data_op, should_call_handler_with_sql_state_error_if_copy_failed) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "23505"};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    EXPECT_CALL(native_handle, PQputCopyData(_, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQputCopyEnd(nullptr)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::unique_violation), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_put_copy_data(ctx, query(), std::vector<std::tuple<std::int16_t>>{});
+}
+
+} // namespace
@@ -0,0 +1,220 @@
+#include <connection_mock.h>
+#include <test_error.h>
+
+#include <bozo/impl/async_copy_out.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::tests;
+
+using callback_mock = callback_gmock<connection_ptr<>>;
+
+using bozo::error_code;
+
+struct async_get_copy_data_op : Test {
+    StrictMock<connection_gmock> connection{};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback{};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+    std::vector<std::tuple<std::int16_t>> rows;
+
+    auto make_operation_context() {
+        EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+        return bozo::impl::make_request_operation_context(conn, wrap(callback));
+    }
+
+    decltype(bozo::impl::make_request_operation_context(conn, wrap(callback))) ctx;
+
+    async_get_copy_data_op() : ctx(make_operation_context()) {}
+
+    bozo::binary_query query() const {
+        return bozo::binary_query("COPY t TO STDOUT (FORMAT binary)", boost::hana::make_tuple(), bozo::empty_oid_map{});
+    }
+
+    void expect_send_query(Sequence& s) {
+        EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+        EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    }
+
+    void expect_result(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(result));
+    }
+
+    // The buffer is released via PQfreemem, so it is allocated via malloc like libpq does.
+    static auto copy_data(std::string value) {
+        return Invoke([value = std::move(value)] (char** buffer, int) {
+            *buffer = static_cast<char*>(std::malloc(value.size()));
+            std::memcpy(*buffer, value.data(), value.size());
+            return static_cast<int>(value.size());
+        });
+    }
+};
+
+const std::string copy_header("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19);
+const std::string copy_trailer("\377\377", 2);
+
+TEST_F(async_get_copy_data_op, should_get_rows_from_binary_copy_data_and_call_handler) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(copy_header + std::string("\0\1\0\0\0\2\0\1", 8)));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(std::string("\0\1\0\0\0\2\0\2", 8)));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(copy_data(copy_trailer));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(-1));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+
+    EXPECT_THAT(rows, ElementsAre(std::make_tuple(std::int16_t(1)), std::make_tuple(std::int16_t(2))));
+}
+
+TEST_F(async_get_copy_data_op, should_pass_rows_to_row_stream_callback) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(copy_header + std::string("\0\1\0\0\0\2\0\7", 8) + copy_trailer));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(-1));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), bozo::for_each_row<std::tuple<std::int16_t>>(
+        [&](std::tuple<std::int16_t>&& row) { rows.push_back(std::move(row)); }));
+
+    EXPECT_THAT(rows, ElementsAre(std::make_tuple(std::int16_t(7))));
+}
+
+TEST_F(async_get_copy_data_op, should_wait_for_read_if_copy_data_is_not_available) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(copy_header + std::string("\0\1\0\0\0\2\0\1", 8) + copy_trailer));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(-1));
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+
+    EXPECT_THAT(rows, ElementsAre(std::make_tuple(std::int16_t(1))));
+}
+
+TEST_F(async_get_copy_data_op, should_call_handler_with_sql_state_error_if_query_failed) {
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "42P01"};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::undefined_table), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+}
+
+TEST_F(async_get_copy_data_op, should_call_handler_with_result_status_unexpected_if_query_is_not_copy_out) {
+    bozo::tests::pg_result copy_in{PGRES_COPY_IN, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_in);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+}
+
+TEST_F(async_get_copy_data_op, should_call_handler_with_pg_get_copy_data_failed_if_get_copy_data_failed) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(-2));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_get_copy_data_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+}
+
+TEST_F(async_get_copy_data_op, should_call_handler_with_bad_result_process_if_copy_data_is_malformed) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(copy_header + std::string("\0\2\0\0\0\2\0\1\0\0\0\2\0\1", 14)));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::bad_result_process}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+
+    EXPECT_TRUE(rows.empty());
+}
+
+TEST_F(async_get_copy_data_op, should_call_handler_with_sql_state_error_if_copy_failed) {
+    bozo::tests::pg_result copy_out{PGRES_COPY_OUT, nullptr};
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "57014"};
+
+    Sequence s;
+
+    expect_send_query(s);
+    expect_result(s, &copy_out);
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s)
+        .WillOnce(copy_data(copy_header + std::string("\0\1\0\0\0\2\0\1", 8)));
+    EXPECT_CALL(native_handle, PQgetCopyData(_, 1)).InSequence(s).WillOnce(Return(-1));
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::query_canceled), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_copy_data(ctx, query(), std::back_inserter(rows));
+
+    EXPECT_THAT(rows, ElementsAre(std::make_tuple(std::int16_t(1))));
+}
+
+} // namespace
@@ -0,0 +1,230 @@
+#include <connection_mock.h>
+#include <test_error.h>
+
+#include <bozo/impl/async_cursor.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::tests;
+
+using callback_mock = callback_gmock<connection_ptr<>>;
+
+using bozo::error_code;
+
+struct async_cursor_op : Test {
+    StrictMock<connection_gmock> connection{};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback{};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+    std::vector<int> batches;
+
+    auto make_operation_context() {
+        EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+        return bozo::impl::make_request_operation_context(conn, wrap(callback));
+    }
+
+    decltype(bozo::impl::make_request_operation_context(conn, wrap(callback))) ctx;
+
+    async_cursor_op() : ctx(make_operation_context()) {}
+
+    bozo::binary_query query() const {
+        return bozo::binary_query("DECLARE c NO SCROLL CURSOR FOR SELECT 1", boost::hana::make_tuple(), bozo::empty_oid_map{});
+    }
+
+    auto processor() {
+        return [&] (bozo::tests::pg_result* res, auto&) { batches.push_back(res->rows); };
+    }
+
+    void expect_send_query(Sequence& s, const std::string& text) {
+        EXPECT_CALL(native_handle, PQsendQueryParams(StrEq(text), _, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+        EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    }
+
+    void expect_result(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(result));
+    }
+
+    void expect_declare(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+        expect_send_query(s, "DECLARE c NO SCROLL CURSOR FOR SELECT 1");
+        expect_result(s, result);
+        expect_result(s, nullptr);
+    }
+};
+
+TEST_F(async_cursor_op, should_fetch_batches_until_cursor_is_exhausted_then_close_cursor) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result full{PGRES_TUPLES_OK, nullptr, 2};
+    bozo::tests::pg_result last{PGRES_TUPLES_OK, nullptr, 1};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &full);
+    expect_result(s, nullptr);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &last);
+    expect_result(s, nullptr);
+    expect_send_query(s, "CLOSE c");
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{2, 100, 0});
+
+    EXPECT_THAT(batches, ElementsAre(2, 1));
+}
+
+TEST_F(async_cursor_op, should_decode_batch_after_next_fetch_is_sent) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result full{PGRES_TUPLES_OK, nullptr, 2};
+    bozo::tests::pg_result empty{PGRES_TUPLES_OK, nullptr, 0};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &full);
+    expect_result(s, nullptr);
+    EXPECT_CALL(native_handle, PQsendQueryParams(StrEq("FETCH 2 FROM c"), _, _, _, _, _, _)).InSequence(s)
+        .WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_write(_)).InSequence(s).WillOnce(Invoke([&] (auto handler) {
+        EXPECT_TRUE(batches.empty());
+        handler(error_code{});
+    }));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    expect_result(s, &empty);
+    expect_result(s, nullptr);
+    expect_send_query(s, "CLOSE c");
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{2, 100, 0});
+
+    EXPECT_THAT(batches, ElementsAre(2, 0));
+}
+
+TEST_F(async_cursor_op, should_adapt_fetch_size_to_batch_bytes) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result full{PGRES_TUPLES_OK, nullptr, 10, 10};
+    bozo::tests::pg_result last{PGRES_TUPLES_OK, nullptr, 3, 10};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 10 FROM c");
+    expect_result(s, &full);
+    expect_result(s, nullptr);
+    expect_send_query(s, "FETCH 100 FROM c");
+    expect_result(s, &last);
+    expect_result(s, nullptr);
+    expect_send_query(s, "CLOSE c");
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{10, 1000, 1000});
+
+    EXPECT_THAT(batches, ElementsAre(10, 3));
+}
+
+TEST_F(async_cursor_op, should_call_handler_with_sql_state_error_if_declare_failed) {
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "25P01"};
+
+    Sequence s;
+
+    expect_declare(s, &fatal_error);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::no_active_sql_transaction), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{2, 100, 0});
+
+    EXPECT_TRUE(batches.empty());
+}
+
+TEST_F(async_cursor_op, should_call_handler_with_sql_state_error_if_fetch_failed) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result full{PGRES_TUPLES_OK, nullptr, 2};
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "57014"};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &full);
+    expect_result(s, nullptr);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::query_canceled), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{2, 100, 0});
+
+    EXPECT_THAT(batches, ElementsAre(2));
+}
+
+TEST_F(async_cursor_op, should_call_handler_with_result_status_unexpected_if_fetch_returns_no_tuples) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &command_ok);
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(), processor(), bozo::cursor_config{2, 100, 0});
+}
+
+TEST_F(async_cursor_op, should_call_handler_with_bad_result_process_if_processor_throws) {
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result full{PGRES_TUPLES_OK, nullptr, 2};
+
+    Sequence s;
+
+    expect_declare(s, &command_ok);
+    expect_send_query(s, "FETCH 2 FROM c");
+    expect_result(s, &full);
+    expect_result(s, nullptr);
+    expect_send_query(s, "FETCH 2 FROM c");
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::bad_result_process}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_fetch_cursor(ctx, "c", query(),
+        [] (auto&&, auto&) { throw std::runtime_error("error"); }, bozo::cursor_config{2, 100, 0});
+}
+
+TEST(next_fetch_size, should_estimate_rows_by_batch_bytes_target) {
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 1000, 1000}, 10, 100), 100);
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 1000, 1000}, 100, 10000), 10);
+}
+
+TEST(next_fetch_size, should_clamp_rows_by_max_fetch_size_and_one) {
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 50, 1000}, 10, 100), 50);
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 50, 1000}, 10, 100000), 1);
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 50, 1000}, 10, 0), 50);
+}
+
+TEST(next_fetch_size, should_keep_rows_if_adaptation_is_disabled) {
+    EXPECT_EQ(bozo::impl::next_fetch_size(bozo::cursor_config{10, 50, 0}, 10, 100), 10);
+}
+
+} // namespace
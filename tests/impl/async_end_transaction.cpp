@@ -38,4 +38,19 @@ TEST_F(async_end_transaction, should_call_async_execute) {
     bozo::detail::async_end_transaction(std::move(transaction), empty_query {}, timeout, wrap(callback));
 }
 
+#ifdef LIBPQ_HAS_PIPELINING
+TEST_F(async_end_transaction, should_call_async_pipeline_for_commit_with_statement) {
+    EXPECT_CALL(handle, PQstatus()).WillRepeatedly(Return(CONNECTION_OK));
+
+    auto transaction = bozo::transaction(std::move(conn), options);
+
+    const InSequence s;
+
+    EXPECT_CALL(connection, async_pipeline()).WillOnce(Return());
+
+    bozo::detail::async_end_transaction(std::move(transaction), empty_query {}, empty_query {}, timeout,
+        bozo::none, wrap(callback));
+}
+#endif
+
 } // namespace
@@ -452,4 +452,104 @@ INSTANTIATE_TEST_SUITE_P(
     async_get_result_,
     Values(PGRES_COPY_OUT, PGRES_COPY_IN, PGRES_COPY_BOTH, PGRES_NONFATAL_ERROR));
 
+struct async_get_rows : Test {
+    fixture m;
+    StrictMock<process_mock> process;
+    process_wrapper process_f{process};
+
+    void expect_result(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(m.native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(m.native_handle, PQgetResult()).InSequence(s).WillOnce(Return(result));
+    }
+};
+
+TEST_F(async_get_rows, should_set_single_row_mode_and_process_each_result_until_no_result) {
+    bozo::tests::pg_result single_tuple{PGRES_SINGLE_TUPLE, nullptr};
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+
+    Sequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetSingleRowMode()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &single_tuple);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Return());
+    expect_result(s, &single_tuple);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Return());
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+    EXPECT_CALL(m.callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+}
+
+TEST_F(async_get_rows, should_wait_for_read_while_connection_is_busy) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+
+    Sequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetSingleRowMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(m.native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(m.connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(m.cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(m.native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+    EXPECT_CALL(m.callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+}
+
+TEST_F(async_get_rows, should_call_handler_with_error_if_single_row_mode_could_not_be_set) {
+    Sequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetSingleRowMode()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(m.connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(m.callback, call(error_code{bozo::error::pg_set_single_row_mode_failed}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+}
+
+TEST_F(async_get_rows, should_do_nothing_if_query_state_is_error) {
+    m.ctx->state = query_state::error;
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+    EXPECT_EQ(m.ctx->state, query_state::error);
+}
+
+TEST_F(async_get_rows, should_consume_results_and_call_handler_with_error_of_failed_query) {
+    bozo::tests::pg_result single_tuple{PGRES_SINGLE_TUPLE, nullptr};
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "42P01"};
+
+    Sequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetSingleRowMode()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &single_tuple);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Return());
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+    EXPECT_CALL(m.connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(m.callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::undefined_table), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+}
+
+TEST_F(async_get_rows, should_abandon_results_and_call_handler_with_error_if_process_throws) {
+    bozo::tests::pg_result single_tuple{PGRES_SINGLE_TUPLE, nullptr};
+
+    Sequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetSingleRowMode()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &single_tuple);
+    EXPECT_CALL(process, call()).InSequence(s).WillOnce(Invoke([]{ throw std::runtime_error("error");}));
+    EXPECT_CALL(m.connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(m.callback, call(error_code{bozo::error::bad_result_process}, _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_rows(m.ctx, process_f, 1);
+
+    EXPECT_EQ(m.conn->error_context_, "error");
+}
+
 } // namespace
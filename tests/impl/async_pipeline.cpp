@@ -0,0 +1,322 @@
+#include <connection_mock.h>
+#include <test_error.h>
+
+#include <bozo/impl/async_pipeline.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+namespace {
+
+namespace hana = boost::hana;
+
+using namespace testing;
+using namespace bozo::tests;
+
+using callback_mock = callback_gmock<connection_ptr<>>;
+
+using bozo::error_code;
+
+struct process_mock {
+    MOCK_METHOD1(call, void(int));
+};
+
+struct async_get_pipeline_results_op : Test {
+    StrictMock<connection_gmock> connection{};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback{};
+    StrictMock<process_mock> process{};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+
+    auto make_operation_context() {
+        EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+        return bozo::impl::make_request_operation_context(conn, wrap(callback));
+    }
+
+    decltype(bozo::impl::make_request_operation_context(conn, wrap(callback))) ctx;
+
+    async_get_pipeline_results_op() : ctx(make_operation_context()) {}
+
+    auto processors() {
+        return hana::make_tuple(
+            [&] (auto&&, auto&) { process.call(0); },
+            [&] (auto&&, auto&) { process.call(1); }
+        );
+    }
+
+    void expect_result(Sequence& s, bozo::tests::pg_result* result) {
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(result));
+    }
+};
+
+TEST_F(async_get_pipeline_results_op, should_process_results_in_order_of_queries_and_call_handler_after_sync) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result sync{PGRES_PIPELINE_SYNC, nullptr};
+
+    Sequence s;
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(0)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &command_ok);
+    EXPECT_CALL(process, call(1)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &sync);
+    EXPECT_CALL(native_handle, PQexitPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_consume_results_up_to_sync_and_call_handler_with_error_of_failed_query) {
+    bozo::tests::pg_result fatal_error{PGRES_FATAL_ERROR, "42P01"};
+    bozo::tests::pg_result aborted{PGRES_PIPELINE_ABORTED, nullptr};
+    bozo::tests::pg_result sync{PGRES_PIPELINE_SYNC, nullptr};
+
+    Sequence s;
+
+    expect_result(s, &fatal_error);
+    expect_result(s, nullptr);
+
+    expect_result(s, &aborted);
+    expect_result(s, nullptr);
+
+    expect_result(s, &sync);
+    EXPECT_CALL(native_handle, PQexitPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::undefined_table), _))
+        .InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_wait_for_read_while_connection_is_busy) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+    bozo::tests::pg_result sync{PGRES_PIPELINE_SYNC, nullptr};
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(1));
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(0)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(1)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &sync);
+    EXPECT_CALL(native_handle, PQexitPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(callback, call(error_code{}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_call_handler_with_result_status_unexpected_if_no_sync_result) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+
+    Sequence s;
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(0)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(1)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_close_connection_and_call_handler_with_error_if_consume_input_failed) {
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(error_code{}));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(native_handle, PQconsumeInput()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_consume_input_failed}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_close_connection_and_call_handler_with_error_if_wait_read_failed) {
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(connection, async_wait_read(_)).InSequence(s).WillOnce(InvokeArgument<0>(bozo::tests::error::error));
+    EXPECT_CALL(cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::tests::error::error}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_close_connection_and_call_handler_with_error_if_no_result_for_query) {
+    Sequence s;
+
+    expect_result(s, nullptr);
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::result_status_unexpected}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+TEST_F(async_get_pipeline_results_op, should_close_connection_and_call_handler_with_error_if_exit_pipeline_mode_failed) {
+    bozo::tests::pg_result tuples_ok{PGRES_TUPLES_OK, nullptr};
+    bozo::tests::pg_result sync{PGRES_PIPELINE_SYNC, nullptr};
+
+    Sequence s;
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(0)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &tuples_ok);
+    EXPECT_CALL(process, call(1)).InSequence(s).WillOnce(Return());
+    expect_result(s, nullptr);
+
+    expect_result(s, &sync);
+    EXPECT_CALL(native_handle, PQexitPipelineMode()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(callback, call(error_code{bozo::error::pg_exit_pipeline_mode_failed}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_get_pipeline_results(ctx, processors());
+}
+
+struct async_pipeline_op : Test {
+    StrictMock<connection_gmock> connection {};
+    StrictMock<PGconn_mock> native_handle{};
+    StrictMock<callback_mock> callback {};
+    StrictMock<executor_mock> strand {};
+    io_context io;
+    execution_context cb_io;
+    connection_ptr<> conn = make_connection(connection, io, native_handle);
+};
+
+TEST_F(async_pipeline_op, should_enter_pipeline_mode_and_send_queries_with_sync_and_get_results) {
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    bozo::tests::pg_result command_ok{PGRES_COMMAND_OK, nullptr};
+    bozo::tests::pg_result sync{PGRES_PIPELINE_SYNC, nullptr};
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQenterPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).Times(2).InSequence(s).WillRepeatedly(Return(1));
+    EXPECT_CALL(native_handle, PQpipelineSync()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&command_ok));
+        EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+        EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+    }
+
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&sync));
+    EXPECT_CALL(native_handle, PQexitPipelineMode()).InSequence(s).WillOnce(Return(1));
+
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_pipeline_op{
+        hana::make_tuple(empty_query{}, empty_query{}),
+        bozo::none,
+        hana::make_tuple(bozo::none, bozo::none),
+        wrap(callback)
+    }(error_code {}, conn);
+}
+
+TEST_F(async_pipeline_op, should_call_handler_with_error_if_enter_pipeline_mode_failed) {
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQenterPipelineMode()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {bozo::error::pg_enter_pipeline_mode_failed}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_pipeline_op{
+        std::make_tuple(empty_query{}),
+        bozo::none,
+        std::make_tuple(bozo::none),
+        wrap(callback)
+    }(error_code {}, conn);
+}
+
+TEST_F(async_pipeline_op, should_close_connection_and_call_handler_with_error_if_send_query_failed) {
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQenterPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {bozo::error::pg_send_query_params_failed}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_pipeline_op{
+        hana::make_tuple(empty_query{}, empty_query{}),
+        bozo::none,
+        hana::make_tuple(bozo::none, bozo::none),
+        wrap(callback)
+    }(error_code {}, conn);
+}
+
+TEST_F(async_pipeline_op, should_close_connection_and_call_handler_with_error_if_flush_failed) {
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQenterPipelineMode()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQpipelineSync()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(-1));
+    EXPECT_CALL(connection, close()).InSequence(s).WillOnce(Return(error_code{}));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {bozo::error::pg_flush_failed}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_pipeline_op{
+        std::make_tuple(empty_query{}),
+        bozo::none,
+        std::make_tuple(bozo::none),
+        wrap(callback)
+    }(error_code {}, conn);
+}
+
+} // namespace
+
+#endif
@@ -116,4 +116,168 @@ TEST_F(async_request_op, should_cancel_connection_io_on_timeout) {
     bozo::impl::async_request_op{empty_query {}, timeout, bozo::none, wrap(callback)}(error_code {}, conn);
 }
 
+TEST_F(async_request_op, should_prepare_statement_and_execute_it_if_statement_cache_is_enabled_and_has_no_statement) {
+    conn->statement_cache().set_capacity(1);
+
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    // Prepare statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendPrepare(StrEq("bozo_1"), _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    // Execute prepared statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryPrepared(StrEq("bozo_1"), _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    // Call client handler
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_request_op{empty_query {}, bozo::none, bozo::none, wrap(callback)}(error_code {}, conn);
+
+    EXPECT_EQ(conn->statement_cache().size(), 1u);
+}
+
+TEST_F(async_request_op, should_execute_cached_statement_if_statement_cache_has_statement) {
+    conn->statement_cache().set_capacity(1);
+    conn->statement_cache().insert(bozo::to_binary_query(empty_query {}, bozo::empty_oid_map_c), "cached");
+
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryPrepared(StrEq("cached"), _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_request_op{empty_query {}, bozo::none, bozo::none, wrap(callback)}(error_code {}, conn);
+}
+
+TEST_F(async_request_op, should_deallocate_evicted_statements_before_prepare) {
+    conn->statement_cache().set_capacity(1);
+    conn->statement_cache().insert(bozo::binary_query("SELECT 1", hana::make_tuple(), bozo::empty_oid_map{}), "old");
+    conn->statement_cache().set_capacity(0);
+    conn->statement_cache().set_capacity(1);
+
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    // Deallocate evicted statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryParams(StrEq("DEALLOCATE old"), 0, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    // Prepare statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendPrepare(_, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    // Execute prepared statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryPrepared(_, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_request_op{empty_query {}, bozo::none, bozo::none, wrap(callback)}(error_code {}, conn);
+
+    EXPECT_TRUE(conn->statement_cache().evicted().empty());
+}
+
+TEST_F(async_request_op, should_prepare_statement_if_server_has_no_evicted_statement_to_deallocate) {
+    conn->statement_cache().set_capacity(1);
+    conn->statement_cache().insert(bozo::binary_query("SELECT 1", hana::make_tuple(), bozo::empty_oid_map{}), "old");
+    conn->statement_cache().set_capacity(0);
+    conn->statement_cache().set_capacity(1);
+
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    // Deallocate evicted statement which is not known by the server
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryParams(StrEq("DEALLOCATE old"), 0, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    bozo::tests::pg_result result{PGRES_FATAL_ERROR, "26000"};
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&result));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+
+    // Prepare statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendPrepare(_, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    // Execute prepared statement
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryPrepared(_, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(error_code {}, _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_request_op{empty_query {}, bozo::none, bozo::none, wrap(callback)}(error_code {}, conn);
+
+    EXPECT_TRUE(conn->statement_cache().evicted().empty());
+    EXPECT_EQ(conn->statement_cache().size(), 1u);
+}
+
+TEST_F(async_request_op, should_clear_statement_cache_if_server_has_no_cached_statement) {
+    conn->statement_cache().set_capacity(1);
+    conn->statement_cache().insert(bozo::to_binary_query(empty_query {}, bozo::empty_oid_map_c), "cached");
+
+    EXPECT_CALL(io.strand_service_, get_executor()).WillOnce(ReturnRef(strand));
+    EXPECT_CALL(callback, get_executor()).WillRepeatedly(Return(cb_io.get_executor()));
+
+    Sequence s;
+
+    EXPECT_CALL(native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQsendQueryPrepared(StrEq("cached"), _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    bozo::tests::pg_result result{PGRES_FATAL_ERROR, "26000"};
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(&result));
+    EXPECT_CALL(native_handle, PQisBusy()).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(native_handle, PQgetResult()).InSequence(s).WillOnce(Return(nullptr));
+
+    EXPECT_CALL(connection, cancel()).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(cb_io.executor_, dispatch(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(callback, call(bozo::sqlstate::make_error_code(bozo::sqlstate::invalid_sql_statement_name), _)).InSequence(s).WillOnce(Return());
+
+    bozo::impl::async_request_op{empty_query {}, bozo::none, bozo::none, wrap(callback)}(error_code {}, conn);
+
+    EXPECT_TRUE(conn->statement_cache().empty());
+}
+
 } // namespace
@@ -0,0 +1,148 @@
+#include <test_error.h>
+
+#include <bozo/impl/async_resolve.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <functional>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+using bozo::error_code;
+
+struct connect_call;
+
+/**
+ * Connection of an attempt, the attempts are captured by the fixture instead
+ * of being connected.
+ */
+struct attempt_connection {
+    bozo::io_context* io;
+    std::vector<connect_call>* calls;
+    int cancelled = 0;
+    std::string error_context;
+
+    attempt_connection(bozo::io_context* io, std::vector<connect_call>* calls) : io(io), calls(calls) {}
+
+    auto get_executor() const { return io->get_executor();}
+
+    void set_error_context(std::string v) { error_context = std::move(v);}
+
+    void cancel() { ++cancelled;}
+};
+
+using attempt_connection_ptr = std::shared_ptr<attempt_connection>;
+
+struct connect_call {
+    std::string conninfo;
+    attempt_connection_ptr conn;
+    std::function<void(error_code)> handler;
+};
+
+// Found via ADL instead of bozo::impl::async_connect() since it is more specialized.
+template <typename Deadline, typename Handler>
+void async_connect(std::string conninfo, const Deadline&, attempt_connection_ptr&& conn, Handler&& handler) {
+    auto h = std::make_shared<std::decay_t<Handler>>(std::forward<Handler>(handler));
+    auto calls = conn->calls;
+    calls->push_back({std::move(conninfo), conn, [h, conn] (error_code ec) mutable { (*h)(ec, std::move(conn));}});
+}
+
+struct async_resolve_connect : Test {
+    bozo::io_context io;
+    std::vector<connect_call> calls;
+    std::vector<std::tuple<error_code, attempt_connection_ptr>> results;
+
+    async_resolve_connect() {
+        // Attempts are started from the handlers of the calls, so the calls must not be reallocated
+        calls.reserve(4);
+        bozo::dns_cache::global().enable(1min, 1ms);
+        bozo::dns_cache::global().update("db.example.com", {"10.0.0.1", "10.0.0.2"});
+    }
+
+    ~async_resolve_connect() {
+        bozo::dns_cache::global().disable();
+    }
+
+    void connect() {
+        bozo::impl::async_resolve_connect(io, "host=db.example.com", "db.example.com", bozo::none,
+            [this] { return std::make_shared<attempt_connection>(&io, &calls);},
+            [this] (error_code ec, attempt_connection_ptr conn) { results.emplace_back(ec, std::move(conn));});
+    }
+
+    static bool has_hostaddr(const connect_call& call, const std::string& address) {
+        return call.conninfo.find("hostaddr=" + address) != std::string::npos
+            || call.conninfo.find("hostaddr='" + address + "'") != std::string::npos;
+    }
+};
+
+TEST_F(async_resolve_connect, should_start_next_attempt_after_attempt_delay) {
+    connect();
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_TRUE(has_hostaddr(calls[0], "10.0.0.1"));
+
+    io.run_one();
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_TRUE(has_hostaddr(calls[1], "10.0.0.2"));
+    EXPECT_TRUE(results.empty());
+}
+
+TEST_F(async_resolve_connect, should_start_next_attempt_at_once_if_attempt_failed) {
+    connect();
+    ASSERT_EQ(calls.size(), 1u);
+    calls[0].handler(bozo::tests::error::error);
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_TRUE(has_hostaddr(calls[1], "10.0.0.2"));
+    EXPECT_TRUE(results.empty());
+}
+
+TEST_F(async_resolve_connect, should_pass_first_established_connection_to_handler_and_cancel_others) {
+    connect();
+    io.run_one();
+    ASSERT_EQ(calls.size(), 2u);
+
+    calls[1].handler(error_code{});
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(std::get<0>(results[0]), error_code{});
+    EXPECT_EQ(std::get<1>(results[0]), calls[1].conn);
+
+    io.restart();
+    io.run();
+    EXPECT_EQ(calls[0].conn->cancelled, 1);
+    EXPECT_EQ(calls[1].conn->cancelled, 0);
+
+    calls[0].handler(bozo::tests::error::error);
+    EXPECT_EQ(results.size(), 1u);
+    EXPECT_TRUE(bozo::dns_cache::global().lookup("db.example.com"));
+}
+
+TEST_F(async_resolve_connect, should_call_handler_with_error_and_invalidate_cached_addresses_if_all_attempts_failed) {
+    connect();
+    io.run_one();
+    ASSERT_EQ(calls.size(), 2u);
+
+    calls[0].handler(bozo::tests::error::error);
+    EXPECT_TRUE(results.empty());
+    calls[1].handler(bozo::tests::error::error);
+
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(std::get<0>(results[0]), bozo::tests::error::error);
+    EXPECT_EQ(bozo::dns_cache::global().lookup("db.example.com"), std::nullopt);
+}
+
+TEST_F(async_resolve_connect, should_invalidate_cached_address_if_single_attempt_failed) {
+    bozo::dns_cache::global().update("db.example.com", {"10.0.0.1"});
+    connect();
+    ASSERT_EQ(calls.size(), 1u);
+
+    calls[0].handler(bozo::tests::error::error);
+
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(std::get<0>(results[0]), bozo::tests::error::error);
+    EXPECT_EQ(bozo::dns_cache::global().lookup("db.example.com"), std::nullopt);
+}
+
+} // namespace
@@ -179,4 +179,66 @@ TEST_F(async_send_query_params_op, should_wait_for_write_in_strand) {
     bozo::impl::async_send_query_params_op(m.ctx, m.query)();
 }
 
+struct async_send_query_params_op_with_continuation : Test {
+    fixture m;
+    StrictMock<callback_gmock<bozo::impl::query_state>> continuation;
+
+    auto make_owned_context() {
+        return bozo::impl::request_operation_context<connection_ptr<>, decltype(wrap(m.callback))>{m.conn, wrap(m.callback)};
+    }
+
+    auto make_continuation() {
+        return [this] (auto&& ctx) { continuation.call(bozo::error_code{}, bozo::impl::get_query_state(ctx));};
+    }
+};
+
+TEST_F(async_send_query_params_op_with_continuation, should_pass_context_to_continuation_if_flush_output_returns_send_finish) {
+    const InSequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetnonblocking(1)).WillOnce(Return(0));
+    EXPECT_CALL(m.native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).WillOnce(Return(1));
+    EXPECT_CALL(m.native_handle, PQflush()).WillOnce(Return(0));
+    EXPECT_CALL(continuation, call(error_code{}, bozo::impl::query_state::send_finish)).WillOnce(Return());
+
+    bozo::impl::async_send_query_params_op(make_owned_context(), m.query, make_continuation()).perform();
+}
+
+TEST_F(async_send_query_params_op_with_continuation, should_pass_shared_context_to_continuation_while_wait_for_write) {
+    std::function<void(error_code)> on_write;
+
+    Sequence s;
+    EXPECT_CALL(m.native_handle, PQsetnonblocking(1)).InSequence(s).WillOnce(Return(0));
+    EXPECT_CALL(m.native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(m.native_handle, PQflush()).InSequence(s).WillOnce(Return(1));
+    EXPECT_CALL(m.connection, async_wait_write(_)).InSequence(s).WillOnce(SaveArg<0>(&on_write));
+    EXPECT_CALL(continuation, call(error_code{}, bozo::impl::query_state::send_in_progress)).InSequence(s).WillOnce(Return());
+    EXPECT_CALL(m.cb_io.executor_, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(m.native_handle, PQflush()).InSequence(s).WillOnce(Return(0));
+
+    std::shared_ptr<bozo::impl::request_operation_context<connection_ptr<>, decltype(wrap(m.callback))>> shared;
+    bozo::impl::async_send_query_params_op(make_owned_context(), m.query, [&] (auto ctx) {
+        if constexpr (std::is_same_v<decltype(ctx), decltype(shared)>) {
+            shared = ctx;
+        }
+        continuation.call(bozo::error_code{}, bozo::impl::get_query_state(ctx));
+    }).perform();
+
+    ASSERT_TRUE(on_write);
+    on_write(error_code{});
+    ASSERT_TRUE(shared);
+    EXPECT_EQ(bozo::impl::get_query_state(shared), bozo::impl::query_state::send_finish);
+}
+
+TEST_F(async_send_query_params_op_with_continuation, should_invoke_callback_with_error_and_not_continuation_if_flush_output_returns_error) {
+    const InSequence s;
+
+    EXPECT_CALL(m.native_handle, PQsetnonblocking(1)).WillOnce(Return(0));
+    EXPECT_CALL(m.native_handle, PQsendQueryParams(_, _, _, _, _, _, _)).WillOnce(Return(1));
+    EXPECT_CALL(m.native_handle, PQflush()).WillOnce(Return(-1));
+    EXPECT_CALL(m.connection, cancel()).WillOnce(Return());
+    EXPECT_CALL(m.callback, call(error_code{bozo::error::pg_flush_failed}, _)).WillOnce(Return());
+
+    bozo::impl::async_send_query_params_op(make_owned_context(), m.query, make_continuation()).perform();
+}
+
 } // namespace
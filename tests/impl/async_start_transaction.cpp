@@ -34,4 +34,14 @@ TEST_F(async_start_transaction, should_call_async_execute) {
     bozo::detail::async_start_transaction(conn, options, empty_query {}, timeout, wrap(callback));
 }
 
+#ifdef LIBPQ_HAS_PIPELINING
+TEST_F(async_start_transaction, should_call_async_pipeline_for_begin_with_statement) {
+    EXPECT_CALL(handle, PQstatus()).WillRepeatedly(Return(CONNECTION_OK));
+
+    EXPECT_CALL(connection, async_pipeline()).WillOnce(Return());
+
+    bozo::detail::async_start_transaction(conn, options, empty_query {}, empty_query {}, timeout, bozo::none, wrap(callback));
+}
+#endif
+
 } // namespace
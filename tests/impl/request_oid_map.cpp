@@ -11,6 +11,14 @@ namespace bozo::tests {
 struct custom_type1 {};
 struct custom_type2 {};
 
+struct native_handle_stub {
+    PGTransactionStatusType status = PQTRANS_IDLE;
+};
+
+inline PGTransactionStatusType PQtransactionStatus(const native_handle_stub* handle) {
+    return handle->status;
+}
+
 } // namespace bozo::tests
 
 BOZO_PG_DEFINE_CUSTOM_TYPE(bozo::tests::custom_type1, "custom_type1")
@@ -57,8 +65,13 @@ template <class OidMap = bozo::empty_oid_map>
 struct connection {
     OidMap oid_map_;
     std::string error_context_;
+    native_handle_stub handle_;
+    bool bad_ = false;
     using error_context = std::string;
 
+    const native_handle_stub* native_handle() const noexcept { return &handle_; }
+    bool is_bad() const noexcept { return bad_; }
+
     const error_context& get_error_context() const noexcept { return error_context_; }
     void set_error_context(error_context v = error_context{}) { error_context_ = std::move(v); }
 
@@ -87,4 +100,120 @@ TEST(request_oid_map_op, should_call_handler_with_oid_request_failed_error_when_
     operation(bozo::error_code {}, connection {});
 }
 
+TEST(get_oids, should_return_oids_of_oid_map_in_order_of_types) {
+    auto oid_map = bozo::register_types<custom_type1, custom_type2>();
+    bozo::set_type_oid<custom_type1>(oid_map, 11);
+    bozo::set_type_oid<custom_type2>(oid_map, 22);
+    EXPECT_THAT(bozo::impl::get_oids(oid_map), ElementsAre(11u, 22u));
+}
+
+struct oid_map_with_cache : Test {
+    using oid_map_type = decltype(bozo::register_types<custom_type1, custom_type2>());
+    StrictMock<callback_gmock<connection<oid_map_type>>> cb_mock {};
+    oid_map_type oid_map;
+    bozo::oid_map_cache cache;
+    const bozo::oid_map_cache::key_type key {typeid(oid_map_type), "host", "5432", "db", "user"};
+
+    oid_map_with_cache() {
+        cache.enable(std::chrono::minutes(1));
+    }
+};
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_set_oids_from_cache) {
+    cache.update(key, {11, 22});
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::hit);
+    EXPECT_EQ(bozo::type_oid<custom_type1>(oid_map), 11u);
+    EXPECT_EQ(bozo::type_oid<custom_type2>(oid_map), 22u);
+}
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_ask_to_update_missing_oids) {
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::update);
+}
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_return_pending_while_missing_oids_are_requested) {
+    bozo::impl::apply_cached_oid_map(oid_map, cache, key);
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::pending);
+}
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_ask_to_update_oids_not_fitting_map) {
+    cache.update(key, {11});
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::update);
+}
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_set_expired_oids_and_ask_to_refresh_them) {
+    cache.update(key, {11, 22}, bozo::time_traits::now() - std::chrono::minutes(2));
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::refresh);
+    EXPECT_EQ(bozo::type_oid<custom_type1>(oid_map), 11u);
+    EXPECT_EQ(bozo::type_oid<custom_type2>(oid_map), 22u);
+}
+
+TEST_F(oid_map_with_cache, apply_cached_oid_map_should_return_miss_for_disabled_cache) {
+    cache.disable();
+    EXPECT_EQ(bozo::impl::apply_cached_oid_map(oid_map, cache, key), bozo::impl::cached_oid_map::miss);
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_store_oids_on_success) {
+    connection<oid_map_type> conn;
+    bozo::set_type_oid<custom_type1>(conn.oid_map(), 11);
+    bozo::set_type_oid<custom_type2>(conn.oid_map(), 22);
+    EXPECT_CALL(cb_mock, call(bozo::error_code{}, _)).WillOnce(Return());
+
+    bozo::impl::cache_oid_map_handler{cache, key, wrap(cb_mock)}(bozo::error_code{}, conn);
+
+    EXPECT_THAT(cache.lookup(key).oids, Optional(ElementsAre(11u, 22u)));
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_not_store_oids_on_error) {
+    EXPECT_CALL(cb_mock, call(bozo::error_code{bozo::error::oid_request_failed}, _)).WillOnce(Return());
+
+    bozo::impl::cache_oid_map_handler{cache, key, wrap(cb_mock)}(
+        bozo::error::oid_request_failed, connection<oid_map_type>{});
+
+    EXPECT_FALSE(cache.lookup(key).oids);
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_release_pending_oids_and_notify_waiters_if_destroyed_without_call) {
+    EXPECT_TRUE(cache.lookup(key).refresh);
+    bool notified = false;
+    {
+        bozo::impl::cache_oid_map_handler handler{cache, key, wrap(cb_mock)};
+        cache.wait(key, [&] { notified = true;});
+        EXPECT_TRUE(cache.lookup(key).pending);
+    }
+
+    EXPECT_TRUE(notified);
+    EXPECT_TRUE(cache.lookup(key).refresh);
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_not_release_pending_oids_if_moved_from) {
+    EXPECT_TRUE(cache.lookup(key).refresh);
+    bozo::impl::cache_oid_map_handler handler{cache, key, wrap(cb_mock)};
+    {
+        auto moved = std::move(handler);
+        EXPECT_TRUE(cache.lookup(key).pending);
+    }
+    EXPECT_TRUE(cache.lookup(key).refresh);
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_keep_cached_oids_and_not_pass_error_if_refresh_failed) {
+    connection<oid_map_type> conn;
+    bozo::set_type_oid<custom_type1>(conn.oid_map(), 33);
+    EXPECT_CALL(cb_mock, call(bozo::error_code{}, _)).WillOnce(Invoke([] (auto, const auto& conn) {
+        EXPECT_EQ(bozo::type_oid<custom_type1>(conn.oid_map()), 11u);
+        EXPECT_EQ(bozo::type_oid<custom_type2>(conn.oid_map()), 22u);
+    }));
+
+    bozo::impl::cache_oid_map_handler{cache, key, wrap(cb_mock), std::make_optional(bozo::impl::oids_result{11, 22})}(
+        bozo::error::oid_request_failed, conn);
+}
+
+TEST_F(oid_map_with_cache, cache_oid_map_handler_should_pass_error_if_refresh_failed_and_connection_is_not_idle) {
+    connection<oid_map_type> conn;
+    conn.handle_.status = PQTRANS_ACTIVE;
+    EXPECT_CALL(cb_mock, call(bozo::error_code{boost::asio::error::timed_out}, _)).WillOnce(Return());
+
+    bozo::impl::cache_oid_map_handler{cache, key, wrap(cb_mock), std::make_optional(bozo::impl::oids_result{11, 22})}(
+        boost::asio::error::timed_out, conn);
+}
+
 } // namespace
@@ -38,11 +38,29 @@ struct connection_wrapper {
     }
 
     template <typename Handler>
-    friend void request_oid_map(connection_wrapper c, Handler&&) {
+    friend void request_oid_map(connection_wrapper c, Handler&&, bozo::time_traits::time_point) {
         c.mock_.request_oid_map();
     }
 };
 
+/**
+ * Connection waiting for OIDs pending in the cache.
+ */
+struct waiting_connection {
+    connection_mock* mock_;
+    bozo::io_context* io_;
+    std::string* error_context_;
+
+    auto get_executor() const { return io_->get_executor();}
+
+    void set_error_context(std::string v) { *error_context_ = std::move(v);}
+
+    template <typename Handler>
+    friend void request_oid_map(waiting_connection c, Handler&&, bozo::time_traits::time_point) {
+        c.mock_->request_oid_map();
+    }
+};
+
 struct request_oid_map_handler : Test {
     StrictMock<connection_mock> connection{};
 
@@ -85,4 +103,52 @@ TEST_F(request_oid_map_handler, should_not_request_for_oid_when_oid_map_is_empty
     bozo::impl::apply_oid_map_request<decltype(conn)>(wrap(callback))(error_code{}, std::move(conn));
 }
 
+struct wait_oid_map : Test {
+    StrictMock<connection_mock> connection{};
+    bozo::io_context io;
+    std::string error_context;
+    StrictMock<callback_gmock<waiting_connection>> callback;
+    bozo::oid_map_cache cache;
+    const bozo::oid_map_cache::key_type key {typeid(custom_type), "host", "5432", "db", "user"};
+
+    wait_oid_map() {
+        cache.enable();
+        // The first lookup makes the OIDs pending
+        cache.lookup(key);
+    }
+
+    void wait(bozo::time_traits::time_point deadline) {
+        bozo::impl::wait_oid_map(cache, key, waiting_connection{&connection, &io, &error_context},
+            wrap(callback, io.get_executor()), deadline);
+    }
+};
+
+TEST_F(wait_oid_map, should_request_oid_map_again_once_pending_oids_are_stored) {
+    wait(bozo::time_traits::now() + std::chrono::minutes(1));
+    cache.update(key, {11});
+
+    EXPECT_CALL(connection, request_oid_map()).WillOnce(Return());
+    io.run();
+}
+
+TEST_F(wait_oid_map, should_request_oid_map_again_once_pending_oids_request_failed) {
+    wait(bozo::time_traits::time_point::max());
+    cache.update_failed(key);
+
+    EXPECT_CALL(connection, request_oid_map()).WillOnce(Return());
+    io.run();
+}
+
+TEST_F(wait_oid_map, should_call_handler_with_timed_out_if_pending_oids_are_not_stored_before_deadline) {
+    wait(bozo::time_traits::now() - std::chrono::seconds(1));
+
+    EXPECT_CALL(callback, call(error_code{boost::asio::error::timed_out}, _)).WillOnce(Return());
+    io.run();
+    EXPECT_FALSE(error_context.empty());
+
+    cache.update(key, {11});
+    io.restart();
+    io.run();
+}
+
 } // namespace
@@ -1,5 +1,6 @@
 #include <bozo/connection_info.h>
 #include <bozo/connection_pool.h>
+#include <bozo/execute.h>
 #include <bozo/query_builder.h>
 #include <bozo/request.h>
 #include <bozo/shortcuts.h>
@@ -147,4 +148,89 @@ TEST(connection_pool_integration, should_serve_concurrent_requests) {
     EXPECT_THAT(results, Each(results.front()));
 }
 
+TEST(connection_pool_integration, should_reuse_connection_after_timed_out_request_with_cancel_timeout) {
+    using namespace bozo::literals;
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    bozo::connection_pool_config config;
+    config.capacity = 1;
+    config.queue_capacity = 1;
+    config.cancel_timeout = 5s;
+    bozo::connection_pool pool(conn_info, config, !bozo::thread_safe);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::rows_of<int> pid;
+        bozo::error_code ec;
+        bozo::request(pool[io], "SELECT pg_backend_pid()"_SQL, bozo::deadline(1s), bozo::into(pid), yield[ec]);
+        ASSERT_FALSE(ec) << ec.message();
+
+        bozo::execute(pool[io], "SELECT pg_sleep(10)"_SQL, bozo::deadline(100ms), yield[ec]);
+        EXPECT_EQ(ec, boost::asio::error::timed_out);
+
+        bozo::rows_of<int> next_pid;
+        bozo::request(pool[io], "SELECT pg_backend_pid()"_SQL, bozo::deadline(5s), bozo::into(next_pid), yield[ec]);
+        ASSERT_FALSE(ec) << ec.message();
+        ASSERT_EQ(pid.size(), 1u);
+        ASSERT_EQ(next_pid.size(), 1u);
+        EXPECT_EQ(std::get<0>(pid[0]), std::get<0>(next_pid[0]));
+    });
+
+    io.run();
+}
+
+TEST(connection_pool_integration, warm_up_should_open_min_idle_connections) {
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    bozo::connection_pool_config config;
+    config.capacity = 4;
+    config.min_idle = 3;
+    config.lifespan_jitter = 0.1;
+    config.idle_timeout_jitter = 0.1;
+    config.min_idle_check_interval = 100ms;
+    bozo::connection_pool pool(conn_info, config, !bozo::thread_safe);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec;
+        pool.warm_up(io, yield[ec]);
+        EXPECT_FALSE(ec) << ec.message();
+        EXPECT_EQ(pool.stats().size, 3u);
+        EXPECT_EQ(pool.stats().available, 3u);
+    });
+
+    io.run();
+}
+
+TEST(connection_pool_integration, request_should_be_accounted_in_query_statistics) {
+    using namespace bozo::literals;
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    const auto registry = std::make_shared<bozo::statistics_registry>();
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO, bozo::empty_oid_map{}, bozo::query_statistics{registry});
+    bozo::connection_pool_config config;
+    config.capacity = 1;
+    bozo::connection_pool pool(conn_info, config, !bozo::thread_safe);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::rows_of<int> result;
+        bozo::error_code ec;
+        bozo::request(pool[io], "SELECT 1"_SQL, bozo::deadline(1s), bozo::into(result), yield[ec]);
+        ASSERT_FALSE(ec) << ec.message();
+    });
+
+    io.run();
+
+    const auto snapshot = registry->snapshot();
+    ASSERT_EQ(snapshot.count("SELECT 1"), 1u);
+    const auto& counters = snapshot.at("SELECT 1");
+    EXPECT_EQ(counters.count, 1u);
+    EXPECT_EQ(counters.errors, 0u);
+    EXPECT_EQ(counters.rows, 1u);
+    EXPECT_EQ(counters[bozo::query_phase::connect].count(), 1u);
+}
+
 } // namespace
@@ -0,0 +1,145 @@
+#include <bozo/connection_info.h>
+#include <bozo/query_builder.h>
+#include <bozo/copy_in.h>
+#include <bozo/copy_out.h>
+#include <bozo/execute.h>
+#include <bozo/request.h>
+#include <bozo/shortcuts.h>
+
+#include <boost/asio/spawn.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#define ASSERT_REQUEST_OK(ec, conn)\
+    ASSERT_FALSE(ec) << ec.message() \
+        << "|" << bozo::error_message(conn) \
+        << "|" << bozo::get_error_context(conn) << std::endl
+
+namespace {
+
+using namespace testing;
+
+TEST(copy_in, should_insert_rows_into_table) {
+    using namespace bozo::literals;
+    namespace asio = boost::asio;
+
+    bozo::io_context io;
+    const bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec{};
+        auto conn = bozo::execute(conn_info[io],
+            "CREATE TEMPORARY TABLE copy_in_test (id bigint, name text)"_SQL, yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+
+        const std::vector<std::tuple<std::int64_t, std::optional<std::string>>> rows = {
+            {1, "one"}, {2, std::nullopt}, {3, "three"}
+        };
+        conn = bozo::copy_in(std::move(conn), "COPY copy_in_test (id, name) FROM STDIN (FORMAT binary)"_SQL,
+            rows, yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+
+        bozo::rows_of<std::int64_t, std::optional<std::string>> out;
+        conn = bozo::request(std::move(conn), "SELECT id, name FROM copy_in_test ORDER BY id"_SQL,
+            bozo::into(out), yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+        EXPECT_THAT(out, ElementsAreArray(rows));
+    });
+
+    io.run();
+}
+
+TEST(copy_in, should_return_error_for_rows_not_matching_table) {
+    using namespace bozo::literals;
+    namespace asio = boost::asio;
+
+    bozo::io_context io;
+    const bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec{};
+        auto conn = bozo::execute(conn_info[io],
+            "CREATE TEMPORARY TABLE copy_in_test (id bigint)"_SQL, yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+
+        const std::vector<std::tuple<std::int64_t, std::string>> rows = {{1, "one"}};
+        bozo::copy_in(std::move(conn), "COPY copy_in_test (id) FROM STDIN (FORMAT binary)"_SQL,
+            rows, yield[ec]);
+        EXPECT_EQ(ec, bozo::sqlstate::bad_copy_file_format);
+    });
+
+    io.run();
+}
+
+TEST(copy_out, should_get_rows_from_query) {
+    using namespace bozo::literals;
+    namespace asio = boost::asio;
+
+    bozo::io_context io;
+    const bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec{};
+        std::vector<std::tuple<std::int64_t, std::optional<std::string>>> rows;
+        auto conn = bozo::copy_out(conn_info[io],
+            "COPY (SELECT 1::bigint, 'one'::text UNION ALL SELECT 2, NULL) TO STDOUT (FORMAT binary)"_SQL,
+            std::back_inserter(rows), yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+        EXPECT_THAT(rows, ElementsAre(std::make_tuple(1, std::optional<std::string>("one")),
+            std::make_tuple(2, std::nullopt)));
+    });
+
+    io.run();
+}
+
+TEST(copy_out, should_pass_rows_to_callback) {
+    using namespace bozo::literals;
+    namespace asio = boost::asio;
+
+    bozo::io_context io;
+    const bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec{};
+        std::int64_t sum = 0;
+        auto conn = bozo::copy_out(conn_info[io],
+            "COPY (SELECT generate_series(1, 10000)::bigint) TO STDOUT (FORMAT binary)"_SQL,
+            bozo::for_each_row<std::tuple<std::int64_t>>([&](auto&& row) { sum += std::get<0>(row); }),
+            yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+        EXPECT_EQ(sum, 50005000);
+    });
+
+    io.run();
+}
+
+TEST(copy_out, should_be_accounted_in_query_statistics) {
+    using namespace bozo::literals;
+    namespace asio = boost::asio;
+
+    bozo::io_context io;
+    const auto registry = std::make_shared<bozo::statistics_registry>();
+    const bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO, bozo::empty_oid_map{}, bozo::query_statistics{registry});
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec{};
+        std::vector<std::tuple<std::int64_t>> rows;
+        auto conn = bozo::copy_out(conn_info[io],
+            "COPY (SELECT generate_series(1, 3)::bigint) TO STDOUT (FORMAT binary)"_SQL,
+            std::back_inserter(rows), yield[ec]);
+        ASSERT_REQUEST_OK(ec, conn);
+    });
+
+    io.run();
+
+    const auto snapshot = registry->snapshot();
+    const auto query = "COPY (SELECT generate_series(1, 3)::bigint) TO STDOUT (FORMAT binary)";
+    ASSERT_EQ(snapshot.count(query), 1u);
+    EXPECT_EQ(snapshot.at(query).count, 1u);
+    EXPECT_EQ(snapshot.at(query).errors, 0u);
+    EXPECT_EQ(snapshot.at(query).rows, 3u);
+    EXPECT_GT(snapshot.at(query).bytes_received, 0u);
+}
+
+} // namespace
@@ -1,14 +1,22 @@
+#include <bozo/awaitable.h>
 #include <bozo/connection_info.h>
 #include <bozo/connection_pool.h>
 #include <bozo/query_builder.h>
 #include <bozo/request.h>
+#include <bozo/result_cache.h>
 #include <bozo/execute.h>
+#include <bozo/lookup_batcher.h>
 #include <bozo/shortcuts.h>
+#include <bozo/single_flight.h>
 #include <bozo/pg/types/jsonb.h>
 #include <bozo/pg/types/ltree.h>
 
 #include <boost/asio/spawn.hpp>
 
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/co_spawn.hpp>
+#endif
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -635,4 +643,117 @@ TEST(request, should_send_and_receive_composite_with_ltree_field) {
     io.run();
 }
 
+TEST(lookup_batcher, should_return_rows_for_each_lookup_from_single_batch_query) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    using row = std::tuple<std::int64_t, std::int64_t>;
+    auto batcher = bozo::make_lookup_batcher<row>(io, conn_info[io], [] (std::vector<std::int64_t> ids) {
+        return "SELECT id, id * 10 FROM unnest("_SQL + std::move(ids) + "::bigint[]) AS id"_SQL;
+    });
+
+    std::vector<row> first, second;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(1, bozo::into(first), handler);
+    batcher(2, bozo::into(second), handler);
+
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(row{1, 10}));
+    EXPECT_THAT(second, ElementsAre(row{2, 20}));
+}
+
+TEST(single_flight, should_return_result_to_each_request_of_flight) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    bozo::single_flight<> flight(io);
+
+    bozo::rows_of<std::int32_t> first;
+    std::vector<std::tuple<std::int64_t>> second;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(42), bozo::into(first), handler);
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(42) + "::int8"_SQL, bozo::into(second), handler);
+
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(std::make_tuple(42)));
+    EXPECT_THAT(second, ElementsAre(std::make_tuple(42)));
+}
+
+TEST(result_cache, should_return_cached_result_for_second_request) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    bozo::result_cache<> cache(io);
+
+    bozo::rows_of<std::int32_t> first, second;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    cache("select_value", conn_info[io], "SELECT "_SQL + std::int32_t(42), bozo::into(first), handler);
+    io.run();
+    ASSERT_EQ(cache.size(), 1u);
+
+    io.restart();
+    bozo::connection_info invalid_conn_info("invalid connection info");
+    cache("select_value", invalid_conn_info[io], "SELECT "_SQL + std::int32_t(42), bozo::into(second), handler);
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(std::make_tuple(42)));
+    EXPECT_THAT(second, ElementsAre(std::make_tuple(42)));
+}
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+TEST(request, should_return_selected_value_with_use_awaitable) {
+    namespace asio = boost::asio;
+    using namespace bozo::literals;
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+    bozo::connection_pool pool(conn_info, bozo::connection_pool_config{}, !bozo::thread_safe);
+    bozo::rows_of<std::int32_t> result;
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto [ec, conn] = co_await bozo::request(pool[io], "SELECT 42"_SQL, 1s, bozo::into(result), bozo::use_awaitable);
+        EXPECT_FALSE(ec) << ec.message();
+        EXPECT_FALSE(bozo::is_null_recursive(conn));
+    }, [] (std::exception_ptr e) { EXPECT_FALSE(e); });
+
+    io.run();
+
+    EXPECT_THAT(result, ElementsAre(std::make_tuple(42)));
+}
+
+TEST(request, should_return_error_and_connection_with_use_awaitable) {
+    namespace asio = boost::asio;
+    using namespace bozo::literals;
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        bozo::result result;
+        auto [ec, conn] = co_await bozo::request(conn_info[io], "SELECT * FROM nonexistent_table"_SQL, 1s,
+            std::ref(result), bozo::use_awaitable);
+        EXPECT_EQ(ec, bozo::error_condition(bozo::sqlstate::undefined_table));
+        EXPECT_FALSE(bozo::is_null_recursive(conn));
+        EXPECT_THAT(std::string(bozo::error_message(conn)), HasSubstr("nonexistent_table"));
+    }, [] (std::exception_ptr e) { EXPECT_FALSE(e); });
+
+    io.run();
+}
+
+#endif
+
 } // namespace
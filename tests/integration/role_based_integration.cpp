@@ -96,4 +96,28 @@ TEST(role_based, should_return_error_for_invalid_connection_info_of_all_roles) {
     io.run();
 }
 
+TEST(role_based, should_return_rows_of_single_issue_for_hedged_request) {
+    using namespace bozo::literals;
+    using namespace std::chrono_literals;
+
+    bozo::io_context io;
+    auto conn_info = failover::make_role_based_connection_source(
+        failover::master=bozo::connection_info(BOZO_PG_TEST_CONNINFO),
+        failover::replica=bozo::connection_info(BOZO_PG_TEST_CONNINFO)
+    );
+    auto roles = failover::role_based(failover::replica, failover::master)
+                        .set(op::hedge_delay=bozo::time_traits::duration(0s));
+
+    std::vector<int> res;
+    std::optional<bozo::error_code> result;
+    bozo::request[roles](conn_info[io], "SELECT 1"_SQL + " + 1"_SQL, bozo::into(res),
+            [&] (bozo::error_code ec, auto) { result = ec;});
+
+    io.run();
+
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, bozo::error_code{});
+    EXPECT_THAT(res, ElementsAre(2));
+}
+
 } // namespace
@@ -1,7 +1,9 @@
 #include <bozo/connection_info.h>
+#include <bozo/cursor.h>
 #include <bozo/query_builder.h>
 #include <bozo/result.h>
 #include <bozo/request.h>
+#include <bozo/shortcuts.h>
 #include <bozo/transaction.h>
 
 #include <boost/asio/spawn.hpp>
@@ -196,4 +198,79 @@ TEST(transaction_integration, transaction_deferrability_options_should_not_gener
     io.run();
 }
 
+TEST(transaction_integration, begin_with_statement_and_commit_with_statement_then_rows_should_be_committed) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::result result;
+        auto connection = bozo::get_connection(conn_info[io], yield);
+        bozo::request(connection, "DROP TABLE IF EXISTS bozo_pipelined_transaction"_SQL, std::ref(result), yield);
+        bozo::request(connection, "CREATE TABLE bozo_pipelined_transaction (id INTEGER)"_SQL, std::ref(result), yield);
+
+        std::vector<std::tuple<std::int32_t>> first;
+        auto transaction = bozo::begin(std::move(connection),
+            "INSERT INTO bozo_pipelined_transaction VALUES (1) RETURNING id"_SQL, bozo::into(first), yield);
+        EXPECT_THAT(first, ElementsAre(std::make_tuple(1)));
+        EXPECT_EQ(bozo::get_transaction_status(transaction), bozo::transaction_status::transaction);
+
+        std::vector<std::tuple<std::int32_t>> last;
+        connection = bozo::commit(std::move(transaction),
+            "INSERT INTO bozo_pipelined_transaction VALUES (2) RETURNING id"_SQL, bozo::into(last), yield);
+        EXPECT_THAT(last, ElementsAre(std::make_tuple(2)));
+        EXPECT_EQ(bozo::get_transaction_status(connection), bozo::transaction_status::idle);
+
+        std::vector<std::tuple<std::int64_t>> count;
+        bozo::request(connection, "SELECT count(*) FROM bozo_pipelined_transaction"_SQL, bozo::into(count), yield);
+        EXPECT_THAT(count, ElementsAre(std::make_tuple(2)));
+        bozo::request(connection, "DROP TABLE bozo_pipelined_transaction"_SQL, std::ref(result), yield);
+    });
+
+    io.run();
+}
+
+TEST(transaction_integration, commit_with_failed_statement_should_not_commit_transaction) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        bozo::error_code ec;
+        auto transaction = bozo::begin(conn_info[io], "SELECT 1"_SQL, bozo::none, yield);
+        auto connection = bozo::commit(std::move(transaction), "SELECT * FROM bozo_missing_table"_SQL,
+            bozo::none, yield[ec]);
+        EXPECT_EQ(ec, bozo::error_condition(bozo::sqlstate::undefined_table));
+        EXPECT_EQ(bozo::get_transaction_status(connection), bozo::transaction_status::error);
+    });
+
+    io.run();
+}
+
+TEST(transaction_integration, cursor_should_fetch_all_rows_by_batches_within_transaction) {
+    using namespace bozo::literals;
+
+    bozo::io_context io;
+    bozo::connection_info conn_info(BOZO_PG_TEST_CONNINFO);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        std::vector<std::int32_t> rows;
+        auto transaction = bozo::begin(conn_info[io], yield);
+        transaction = bozo::cursor.with_config({3, 100, 64})(std::move(transaction),
+            "SELECT generate_series(1, "_SQL + std::int32_t(1000) + ")"_SQL,
+            bozo::for_each_row<std::tuple<std::int32_t>>([&] (auto&& row) { rows.push_back(std::get<0>(row));}),
+            yield);
+        EXPECT_EQ(bozo::get_transaction_status(transaction), bozo::transaction_status::transaction);
+        bozo::commit(std::move(transaction), yield);
+
+        ASSERT_EQ(rows.size(), 1000u);
+        EXPECT_EQ(rows.front(), 1);
+        EXPECT_EQ(rows.back(), 1000);
+    });
+
+    io.run();
+}
+
 } // namespace
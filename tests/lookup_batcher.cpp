@@ -0,0 +1,232 @@
+#include <bozo/lookup_batcher.h>
+
+#include "request_mock.h"
+#include "test_error.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+using row = std::tuple<std::int64_t, std::string>;
+
+using batch_call = bozo::tests::request_call<std::back_insert_iterator<std::vector<row>>, std::vector<std::int64_t>>;
+using operation_mock = bozo::tests::request_operation_mock<std::back_insert_iterator<std::vector<row>>, std::vector<std::int64_t>>;
+
+struct query_builder {
+    std::vector<std::int64_t> operator() (std::vector<std::int64_t> keys) const { return keys;}
+};
+
+struct throwing_query_builder {
+    bool* should_throw;
+
+    std::vector<std::int64_t> operator() (std::vector<std::int64_t> keys) const {
+        if (*should_throw) {
+            throw std::runtime_error("query builder failed");
+        }
+        return keys;
+    }
+};
+
+struct throwing_operation {
+    operation_mock op;
+    bool* should_throw;
+
+    template <typename Provider, typename Query, typename TimeConstraint, typename Out, typename Handler>
+    void operator() (Provider&& provider, Query&& query, TimeConstraint t, Out out, Handler handler) const {
+        if (*should_throw) {
+            throw std::runtime_error("operation failed");
+        }
+        op(std::forward<Provider>(provider), std::forward<Query>(query), t, std::move(out), std::move(handler));
+    }
+};
+
+struct time_constraint_capture {
+    std::vector<bozo::time_traits::duration>* timeouts;
+
+    template <typename Provider, typename Query, typename Out, typename Handler>
+    void operator() (Provider&&, Query&&, bozo::time_traits::duration t, Out, Handler) const {
+        timeouts->push_back(t);
+    }
+
+    template <typename Provider, typename Query, typename Out, typename Handler>
+    void operator() (Provider&&, Query&&, bozo::none_t, Out, Handler) const {
+        timeouts->push_back(bozo::time_traits::duration::zero());
+    }
+};
+
+struct throwing_key_of {
+    std::int64_t operator() (const row& r) const {
+        if (std::get<1>(r).empty()) {
+            throw std::runtime_error("bad key");
+        }
+        return std::get<0>(r);
+    }
+};
+
+struct lookup_batcher : Test {
+    bozo::io_context io;
+    std::vector<batch_call> calls;
+
+    auto make_batcher(const bozo::lookup_batcher_config& config) {
+        return bozo::make_lookup_batcher<row>(io, bozo::none, query_builder{}, config,
+            bozo::detail::first_column{}, operation_mock{std::addressof(calls)});
+    }
+};
+
+TEST_F(lookup_batcher, should_send_single_query_with_distinct_keys_of_lookups_within_window) {
+    auto batcher = make_batcher({});
+    std::vector<row> first, second, third;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(3, bozo::into(first), handler);
+    batcher(1, bozo::into(second), handler);
+    batcher(3, bozo::into(third), handler);
+    EXPECT_TRUE(calls.empty());
+
+    io.run_one();
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_THAT(calls[0].query, ElementsAre(1, 3));
+    EXPECT_TRUE(results.empty());
+}
+
+TEST_F(lookup_batcher, should_scatter_rows_to_lookups_by_key) {
+    auto batcher = make_batcher({});
+    std::vector<row> first, second, third, missing;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(3, bozo::into(first), handler);
+    batcher(1, bozo::into(second), handler);
+    batcher(3, bozo::into(third), handler);
+    batcher(2, bozo::into(missing), handler);
+    io.run_one();
+    ASSERT_EQ(calls.size(), 1u);
+
+    *calls[0].out++ = row{3, "c"};
+    *calls[0].out++ = row{1, "a"};
+    *calls[0].out++ = row{3, "cc"};
+    calls[0].handler(bozo::error_code{});
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}, bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(row{3, "c"}, row{3, "cc"}));
+    EXPECT_THAT(second, ElementsAre(row{1, "a"}));
+    EXPECT_THAT(third, ElementsAre(row{3, "c"}, row{3, "cc"}));
+    EXPECT_THAT(missing, IsEmpty());
+}
+
+TEST_F(lookup_batcher, should_send_query_immediately_when_max_batch_size_is_reached) {
+    auto batcher = make_batcher({1h, 2});
+    std::vector<row> out;
+    const auto handler = [] (bozo::error_code) {};
+    batcher(1, bozo::into(out), handler);
+    EXPECT_TRUE(calls.empty());
+    batcher(2, bozo::into(out), handler);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_THAT(calls[0].query, ElementsAre(1, 2));
+
+    batcher(3, bozo::into(out), handler);
+    EXPECT_EQ(calls.size(), 1u);
+}
+
+TEST_F(lookup_batcher, should_complete_all_lookups_of_batch_with_error_of_query) {
+    auto batcher = make_batcher({});
+    std::vector<row> first, second;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(1, bozo::into(first), handler);
+    batcher(2, bozo::into(second), handler);
+    io.run_one();
+    ASSERT_EQ(calls.size(), 1u);
+
+    *calls[0].out++ = row{1, "a"};
+    calls[0].handler(bozo::tests::error::error);
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::tests::error::error, bozo::tests::error::error));
+    EXPECT_THAT(first, IsEmpty());
+    EXPECT_THAT(second, IsEmpty());
+}
+
+TEST_F(lookup_batcher, should_collect_new_batch_after_previous_one_is_sent) {
+    auto batcher = make_batcher({});
+    std::vector<row> out;
+    const auto handler = [] (bozo::error_code) {};
+    batcher(1, bozo::into(out), handler);
+    io.run_one();
+    batcher(2, bozo::into(out), handler);
+    io.run_one();
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_THAT(calls[0].query, ElementsAre(1));
+    EXPECT_THAT(calls[1].query, ElementsAre(2));
+}
+
+TEST_F(lookup_batcher, should_complete_all_lookups_with_bad_batch_query_when_builder_throws_and_continue) {
+    bool should_throw = true;
+    auto batcher = bozo::make_lookup_batcher<row>(io, bozo::none, throwing_query_builder{&should_throw},
+        bozo::lookup_batcher_config{}, bozo::detail::first_column{}, operation_mock{std::addressof(calls)});
+    std::vector<row> out;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(1, bozo::into(out), handler);
+    batcher(2, bozo::into(out), handler);
+    EXPECT_NO_THROW(io.run());
+    EXPECT_THAT(results, ElementsAre(bozo::error::bad_batch_query, bozo::error::bad_batch_query));
+    EXPECT_TRUE(calls.empty());
+
+    should_throw = false;
+    io.restart();
+    batcher(3, bozo::into(out), handler);
+    io.run_one();
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_THAT(calls[0].query, ElementsAre(3));
+}
+
+TEST_F(lookup_batcher, should_complete_all_lookups_with_bad_batch_query_when_operation_throws_on_full_batch) {
+    bool should_throw = true;
+    auto batcher = bozo::make_lookup_batcher<row>(io, bozo::none, query_builder{},
+        bozo::lookup_batcher_config{1h, 2}, bozo::detail::first_column{},
+        throwing_operation{operation_mock{std::addressof(calls)}, &should_throw});
+    std::vector<row> out;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(1, bozo::into(out), handler);
+    EXPECT_NO_THROW(batcher(2, bozo::into(out), handler));
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::error::bad_batch_query, bozo::error::bad_batch_query));
+}
+
+TEST_F(lookup_batcher, should_complete_lookups_with_bad_result_process_when_key_of_row_throws) {
+    auto batcher = bozo::make_lookup_batcher<row>(io, bozo::none, query_builder{},
+        bozo::lookup_batcher_config{}, throwing_key_of{}, operation_mock{std::addressof(calls)});
+    std::vector<row> first, second;
+    std::vector<bozo::error_code> results;
+    const auto handler = [&] (bozo::error_code ec) { results.push_back(ec);};
+    batcher(1, bozo::into(first), handler);
+    batcher(2, bozo::into(second), handler);
+    io.run_one();
+    ASSERT_EQ(calls.size(), 1u);
+
+    *calls[0].out++ = row{1, "a"};
+    *calls[0].out++ = row{2, ""};
+    EXPECT_NO_THROW(calls[0].handler(bozo::error_code{}));
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error::bad_result_process, bozo::error::bad_result_process));
+}
+
+TEST_F(lookup_batcher, should_send_batch_query_with_default_timeout) {
+    std::vector<bozo::time_traits::duration> timeouts;
+    auto batcher = bozo::make_lookup_batcher<row>(io, bozo::none, query_builder{},
+        bozo::lookup_batcher_config{}, bozo::detail::first_column{}, time_constraint_capture{&timeouts});
+    std::vector<row> out;
+    batcher(1, bozo::into(out), [] (bozo::error_code) {});
+    io.run_one();
+    ASSERT_EQ(timeouts.size(), 1u);
+    EXPECT_GT(timeouts[0], bozo::time_traits::duration::zero());
+}
+
+} // namespace
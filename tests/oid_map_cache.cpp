@@ -0,0 +1,140 @@
+#include <bozo/oid_map_cache.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+struct oid_map_cache : Test {
+    bozo::oid_map_cache cache;
+    const bozo::oid_map_cache::key_type key {typeid(int), "host", "5432", "db", "user"};
+    const bozo::time_traits::time_point now {};
+
+    oid_map_cache() {
+        cache.enable(1min);
+    }
+};
+
+TEST_F(oid_map_cache, lookup_should_ask_to_refresh_missing_oids) {
+    const auto result = cache.lookup(key, now);
+    EXPECT_FALSE(result.oids);
+    EXPECT_TRUE(result.refresh);
+}
+
+TEST_F(oid_map_cache, lookup_should_return_updated_oids) {
+    cache.update(key, {11, 22}, now);
+    const auto result = cache.lookup(key, now + 30s);
+    EXPECT_THAT(result.oids, Optional(ElementsAre(11u, 22u)));
+    EXPECT_FALSE(result.refresh);
+}
+
+TEST_F(oid_map_cache, lookup_should_distinguish_oid_map_types_and_databases) {
+    cache.update(key, {11}, now);
+    auto other_type = key;
+    other_type.oid_map = typeid(long);
+    auto other_database = key;
+    other_database.database = "other";
+    EXPECT_FALSE(cache.lookup(other_type, now).oids);
+    EXPECT_FALSE(cache.lookup(other_database, now).oids);
+}
+
+TEST_F(oid_map_cache, lookup_should_ask_single_caller_to_refresh_expired_oids) {
+    cache.update(key, {11}, now);
+    const auto first = cache.lookup(key, now + 1min);
+    EXPECT_THAT(first.oids, Optional(ElementsAre(11u)));
+    EXPECT_TRUE(first.refresh);
+    const auto second = cache.lookup(key, now + 1min);
+    EXPECT_THAT(second.oids, Optional(ElementsAre(11u)));
+    EXPECT_FALSE(second.refresh);
+}
+
+TEST_F(oid_map_cache, lookup_should_ask_to_refresh_again_after_update_failed) {
+    cache.update(key, {11}, now);
+    cache.lookup(key, now + 1min);
+    cache.update_failed(key);
+    EXPECT_TRUE(cache.lookup(key, now + 1min).refresh);
+}
+
+TEST_F(oid_map_cache, lookup_should_tell_missing_oids_are_pending_while_they_are_requested) {
+    cache.lookup(key, now);
+    const auto result = cache.lookup(key, now);
+    EXPECT_FALSE(result.oids);
+    EXPECT_FALSE(result.refresh);
+    EXPECT_TRUE(result.pending);
+}
+
+TEST_F(oid_map_cache, wait_should_call_waiter_once_pending_oids_are_updated) {
+    cache.lookup(key, now);
+    int calls = 0;
+    cache.wait(key, [&] { ++calls;});
+    EXPECT_EQ(calls, 0);
+    cache.update(key, {11}, now);
+    EXPECT_EQ(calls, 1);
+    EXPECT_THAT(cache.lookup(key, now).oids, Optional(ElementsAre(11u)));
+}
+
+TEST_F(oid_map_cache, wait_should_call_waiter_right_away_if_oids_are_not_pending) {
+    cache.update(key, {11}, now);
+    int calls = 0;
+    cache.wait(key, [&] { ++calls;});
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(oid_map_cache, update_failed_should_call_waiters_and_ask_next_lookup_to_request_missing_oids) {
+    cache.lookup(key, now);
+    int calls = 0;
+    cache.wait(key, [&] { ++calls;});
+    cache.update_failed(key);
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(cache.lookup(key, now).refresh);
+}
+
+TEST_F(oid_map_cache, invalidate_should_call_waiters) {
+    cache.lookup(key, now);
+    int calls = 0;
+    cache.wait(key, [&] { ++calls;});
+    cache.invalidate();
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(oid_map_cache, update_should_reset_refresh_interval) {
+    cache.update(key, {11}, now);
+    cache.lookup(key, now + 1min);
+    cache.update(key, {12}, now + 1min);
+    const auto result = cache.lookup(key, now + 90s);
+    EXPECT_THAT(result.oids, Optional(ElementsAre(12u)));
+    EXPECT_FALSE(result.refresh);
+}
+
+TEST_F(oid_map_cache, invalidate_should_drop_oids_of_database_only) {
+    auto other = key;
+    other.host = "other";
+    cache.update(key, {11}, now);
+    cache.update(other, {12}, now);
+    cache.invalidate("host", "5432", "db");
+    EXPECT_FALSE(cache.lookup(key, now).oids);
+    EXPECT_TRUE(cache.lookup(other, now).oids);
+}
+
+TEST_F(oid_map_cache, invalidate_should_drop_all_oids) {
+    cache.update(key, {11}, now);
+    cache.invalidate();
+    EXPECT_FALSE(cache.lookup(key, now).oids);
+}
+
+TEST_F(oid_map_cache, should_not_cache_oids_when_disabled) {
+    cache.disable();
+    cache.update(key, {11}, now);
+    const auto result = cache.lookup(key, now);
+    EXPECT_FALSE(result.oids);
+    EXPECT_FALSE(result.refresh);
+}
+
+TEST(oid_map_cache_global, should_be_disabled_by_default) {
+    EXPECT_FALSE(bozo::oid_map_cache::global().enabled());
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <bozo/error.h>
+#include <bozo/result.h>
+#include <bozo/type_traits.h>
+
+#include <boost/endian/conversion.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bozo::tests {
+
+/**
+ * Connection passed to the handler of a captured request.
+ */
+struct fake_connection {
+    empty_oid_map oid_map() const { return {};}
+};
+
+/**
+ * Query of a captured request which is not checked by a test.
+ */
+struct ignored_query {
+    template <typename T>
+    ignored_query(T&&) noexcept {}
+};
+
+/**
+ * Request captured by `request_operation_mock`, a test fills the output
+ * and completes the request via the handler.
+ */
+template <typename Out, typename Query = ignored_query>
+struct request_call {
+    Query query;
+    Out out;
+    std::function<void(error_code)> handler;
+};
+
+/**
+ * Request operation which captures the requests instead of sending them.
+ */
+template <typename Out, typename Query = ignored_query>
+struct request_operation_mock {
+    std::vector<request_call<Out, Query>>* calls;
+
+    template <typename Provider, typename Q, typename TimeConstraint, typename Handler>
+    void operator() (Provider&&, Q&& query, TimeConstraint, Out out, Handler handler) const {
+        auto h = std::make_shared<Handler>(std::move(handler));
+        calls->push_back({Query(std::forward<Q>(query)), out, [h] (error_code ec) { (*h)(ec, fake_connection{});}});
+    }
+};
+
+/**
+ * Result with a single int4 column of the values in the binary format.
+ */
+inline result make_int4_result(std::initializer_list<std::int32_t> values) {
+    auto res = pg::make_safe(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK));
+    PGresAttDesc attr{};
+    attr.name = const_cast<char*>("value");
+    attr.typid = 23;
+    attr.format = 1;
+    attr.typlen = 4;
+    attr.atttypmod = -1;
+    PQsetResultAttrs(res.get(), 1, &attr);
+    int row = 0;
+    for (const auto v : values) {
+        const auto n = boost::endian::native_to_big(v);
+        PQsetvalue(res.get(), row++, 0, const_cast<char*>(reinterpret_cast<const char*>(&n)), sizeof(n));
+    }
+    return result(std::move(res));
+}
+
+} // namespace bozo::tests
@@ -0,0 +1,155 @@
+#include <bozo/result_cache.h>
+#include <bozo/connection_info.h>
+#include <bozo/query_builder.h>
+
+#include "request_mock.h"
+#include "test_error.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::literals;
+using namespace std::chrono_literals;
+
+using request_call = bozo::tests::request_call<std::reference_wrapper<bozo::result>>;
+using operation_mock = bozo::tests::request_operation_mock<std::reference_wrapper<bozo::result>>;
+using bozo::tests::make_int4_result;
+
+struct throwing_operation {
+    operation_mock op;
+    bool* should_throw;
+
+    template <typename Provider, typename Query, typename TimeConstraint, typename Out, typename Handler>
+    void operator() (Provider&& provider, Query&& query, TimeConstraint t, Out out, Handler handler) const {
+        if (*should_throw) {
+            throw std::runtime_error("operation failed");
+        }
+        op(std::forward<Provider>(provider), std::forward<Query>(query), t, std::move(out), std::move(handler));
+    }
+};
+
+struct result_cache : Test {
+    bozo::io_context io;
+    bozo::connection_info<> conn_info{""};
+    std::vector<request_call> calls;
+    std::vector<bozo::error_code> results;
+
+    auto make_cache(const bozo::result_cache_config& config) {
+        return bozo::result_cache<bozo::empty_oid_map, operation_mock>{io, config, operation_mock{std::addressof(calls)}};
+    }
+
+    auto handler() { return [this] (bozo::error_code ec) { results.push_back(ec);};}
+
+    template <typename Cache, typename Query>
+    void complete(Cache& cache, std::string_view name, Query query, std::int32_t value) {
+        std::vector<std::tuple<std::int32_t>> out;
+        const auto n = calls.size();
+        cache(name, conn_info[io], std::move(query), bozo::into(out), handler());
+        ASSERT_EQ(calls.size(), n + 1);
+        calls.back().out.get() = make_int4_result({value});
+        calls.back().handler(bozo::error_code{});
+    }
+};
+
+TEST_F(result_cache, should_complete_request_with_cached_result_without_operation) {
+    auto cache = make_cache({});
+    std::vector<std::tuple<std::int32_t>> first, second;
+    cache("query", conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(first), handler());
+    ASSERT_EQ(calls.size(), 1u);
+    calls[0].out.get() = make_int4_result({1, 2});
+    calls[0].handler(bozo::error_code{});
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache("query", conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(second), handler());
+    EXPECT_EQ(calls.size(), 1u);
+    EXPECT_TRUE(results.empty());
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(std::make_tuple(1), std::make_tuple(2)));
+    EXPECT_THAT(second, ElementsAre(std::make_tuple(1), std::make_tuple(2)));
+}
+
+TEST_F(result_cache, should_cache_results_by_name_and_query) {
+    auto cache = make_cache({});
+    complete(cache, "query", "SELECT "_SQL + std::int32_t(1), 1);
+    complete(cache, "query", "SELECT "_SQL + std::int32_t(2), 2);
+    complete(cache, "other", "SELECT "_SQL + std::int32_t(1), 3);
+    EXPECT_EQ(cache.size(), 3u);
+}
+
+TEST_F(result_cache, should_execute_query_for_expired_result) {
+    auto cache = make_cache({16, 0s});
+    complete(cache, "query", "SELECT 1"_SQL, 1);
+    complete(cache, "query", "SELECT 1"_SQL, 1);
+    EXPECT_EQ(calls.size(), 2u);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST_F(result_cache, should_evict_least_recently_used_result_when_capacity_is_reached) {
+    auto cache = make_cache({2, 1h});
+    complete(cache, "first", "SELECT 1"_SQL, 1);
+    complete(cache, "second", "SELECT 1"_SQL, 2);
+    std::vector<std::tuple<std::int32_t>> out;
+    cache("first", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    complete(cache, "third", "SELECT 1"_SQL, 3);
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache("first", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 3u);
+    cache("second", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 4u);
+}
+
+TEST_F(result_cache, invalidate_should_drop_results_of_query_with_name) {
+    auto cache = make_cache({});
+    complete(cache, "first", "SELECT "_SQL + std::int32_t(1), 1);
+    complete(cache, "first", "SELECT "_SQL + std::int32_t(2), 2);
+    complete(cache, "second", "SELECT 1"_SQL, 3);
+    cache.invalidate("first");
+    EXPECT_EQ(cache.size(), 1u);
+    cache.invalidate();
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(result_cache, should_not_cache_result_of_query_in_flight_while_invalidated) {
+    auto cache = make_cache({});
+    std::vector<std::tuple<std::int32_t>> out;
+    cache("query", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    cache.invalidate("query");
+    calls[0].out.get() = make_int4_result({1});
+    calls[0].handler(bozo::error_code{});
+    io.run();
+    EXPECT_THAT(out, ElementsAre(std::make_tuple(1)));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(result_cache, should_not_cache_failed_query) {
+    auto cache = make_cache({});
+    std::vector<std::tuple<std::int32_t>> out;
+    cache("query", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    calls[0].handler(bozo::tests::error::error);
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::tests::error::error));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(result_cache, should_complete_request_with_bad_cache_query_when_operation_throws) {
+    bool should_throw = true;
+    bozo::result_cache<bozo::empty_oid_map, throwing_operation> cache{io, {},
+        throwing_operation{operation_mock{std::addressof(calls)}, &should_throw}};
+    std::vector<std::tuple<std::int32_t>> out;
+    EXPECT_NO_THROW(cache("query", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler()));
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{bozo::error::bad_cache_query}));
+    EXPECT_EQ(cache.size(), 0u);
+
+    should_throw = false;
+    cache("query", conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 1u);
+}
+
+} // namespace
@@ -0,0 +1,160 @@
+#include <bozo/single_flight.h>
+#include <bozo/connection_info.h>
+#include <bozo/query_builder.h>
+
+#include "request_mock.h"
+#include "test_error.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace {
+
+using namespace testing;
+using namespace bozo::literals;
+
+using flight_call = bozo::tests::request_call<std::reference_wrapper<bozo::result>>;
+using operation_mock = bozo::tests::request_operation_mock<std::reference_wrapper<bozo::result>>;
+using bozo::tests::make_int4_result;
+
+struct throwing_operation {
+    operation_mock op;
+    bool* should_throw;
+
+    template <typename Provider, typename Query, typename TimeConstraint, typename Out, typename Handler>
+    void operator() (Provider&& provider, Query&& query, TimeConstraint t, Out out, Handler handler) const {
+        if (*should_throw) {
+            throw std::runtime_error("operation failed");
+        }
+        op(std::forward<Provider>(provider), std::forward<Query>(query), t, std::move(out), std::move(handler));
+    }
+};
+
+struct query_type_capture {
+    std::vector<bool>* binary_queries;
+
+    template <typename Provider, typename Query, typename TimeConstraint, typename Out, typename Handler>
+    void operator() (Provider&&, Query&&, TimeConstraint, Out, Handler) const {
+        binary_queries->push_back(std::is_same_v<std::decay_t<Query>, bozo::binary_query>);
+    }
+};
+
+struct single_flight : Test {
+    bozo::io_context io;
+    bozo::connection_info<> conn_info{""};
+    std::vector<flight_call> calls;
+    bozo::single_flight<bozo::empty_oid_map, operation_mock> flight{io, operation_mock{std::addressof(calls)}};
+    std::vector<bozo::error_code> results;
+
+    auto handler() { return [this] (bozo::error_code ec) { results.push_back(ec);};}
+};
+
+TEST_F(single_flight, should_send_identical_queries_in_flight_once) {
+    std::vector<std::tuple<std::int32_t>> first, second;
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(first), handler());
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(second), handler());
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(flight.size(), 1u);
+
+    calls[0].out.get() = make_int4_result({1, 2});
+    calls[0].handler(bozo::error_code{});
+    io.run();
+
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{}));
+    EXPECT_THAT(first, ElementsAre(std::make_tuple(1), std::make_tuple(2)));
+    EXPECT_THAT(second, ElementsAre(std::make_tuple(1), std::make_tuple(2)));
+    EXPECT_EQ(flight.size(), 0u);
+}
+
+TEST_F(single_flight, should_send_queries_with_different_parameters_separately) {
+    std::vector<std::tuple<std::int32_t>> out;
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(out), handler());
+    flight(conn_info[io], "SELECT "_SQL + std::int32_t(2), bozo::into(out), handler());
+    flight(conn_info[io], "SELECT "_SQL + std::int64_t(1), bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 3u);
+    EXPECT_EQ(flight.size(), 3u);
+}
+
+TEST_F(single_flight, should_send_query_again_after_flight_is_completed) {
+    std::vector<std::tuple<std::int32_t>> out;
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    ASSERT_EQ(calls.size(), 1u);
+    calls[0].handler(bozo::error_code{});
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 2u);
+}
+
+TEST_F(single_flight, should_complete_all_waiters_with_error_of_query) {
+    std::vector<std::tuple<std::int32_t>> out;
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    ASSERT_EQ(calls.size(), 1u);
+    calls[0].handler(bozo::tests::error::error);
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::tests::error::error, bozo::tests::error::error));
+    EXPECT_THAT(out, IsEmpty());
+}
+
+TEST_F(single_flight, should_complete_waiter_with_bad_result_process_for_mismatched_output) {
+    std::vector<std::tuple<std::int32_t>> good;
+    std::vector<std::tuple<std::string>> bad;
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(good), handler());
+    flight(conn_info[io], "SELECT 1"_SQL, bozo::into(bad), handler());
+    calls[0].out.get() = make_int4_result({1});
+    calls[0].handler(bozo::error_code{});
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{}, bozo::error_code{bozo::error::bad_result_process}));
+    EXPECT_THAT(good, ElementsAre(std::make_tuple(1)));
+}
+
+TEST_F(single_flight, should_share_result_with_shared_result_outputs) {
+    bozo::shared_result first, second;
+    flight(conn_info[io], "SELECT 1"_SQL, std::ref(first), handler());
+    flight(conn_info[io], "SELECT 1"_SQL, std::ref(second), handler());
+    calls[0].out.get() = make_int4_result({1});
+    calls[0].handler(bozo::error_code{});
+    io.run();
+    EXPECT_EQ(first.native_handle(), second.native_handle());
+    EXPECT_EQ(first.size(), 1);
+}
+
+TEST_F(single_flight, should_complete_all_waiters_with_bad_flight_query_and_forget_flight_when_operation_throws) {
+    bool should_throw = true;
+    bozo::single_flight<bozo::empty_oid_map, throwing_operation> throwing_flight{io,
+        throwing_operation{operation_mock{std::addressof(calls)}, &should_throw}};
+    std::vector<std::tuple<std::int32_t>> out;
+    EXPECT_NO_THROW(throwing_flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler()));
+    EXPECT_EQ(throwing_flight.size(), 0u);
+    io.run();
+    EXPECT_THAT(results, ElementsAre(bozo::error_code{bozo::error::bad_flight_query}));
+
+    should_throw = false;
+    throwing_flight(conn_info[io], "SELECT 1"_SQL, bozo::into(out), handler());
+    EXPECT_EQ(calls.size(), 1u);
+    EXPECT_EQ(throwing_flight.size(), 1u);
+}
+
+TEST_F(single_flight, should_send_query_serialized_for_key) {
+    std::vector<bool> binary_queries;
+    bozo::single_flight<bozo::empty_oid_map, query_type_capture> capturing_flight{io, query_type_capture{&binary_queries}};
+    std::vector<std::tuple<std::int32_t>> out;
+    capturing_flight(conn_info[io], "SELECT "_SQL + std::int32_t(1), bozo::into(out), handler());
+    EXPECT_THAT(binary_queries, ElementsAre(true));
+}
+
+TEST(make_query_key, should_return_equal_keys_for_equal_queries) {
+    const auto oid_map = bozo::empty_oid_map{};
+    EXPECT_EQ(bozo::detail::make_query_key("SELECT "_SQL + std::int32_t(1) + ", "_SQL + std::string("a"), oid_map),
+        bozo::detail::make_query_key("SELECT "_SQL + std::int32_t(1) + ", "_SQL + std::string("a"), oid_map));
+}
+
+TEST(make_query_key, should_return_different_keys_for_different_texts_or_parameters) {
+    const auto oid_map = bozo::empty_oid_map{};
+    const auto key = bozo::detail::make_query_key("SELECT "_SQL + std::int32_t(1), oid_map);
+    EXPECT_NE(key, bozo::detail::make_query_key("SELECT  "_SQL + std::int32_t(1), oid_map));
+    EXPECT_NE(key, bozo::detail::make_query_key("SELECT "_SQL + std::int32_t(2), oid_map));
+    EXPECT_NE(key, bozo::detail::make_query_key("SELECT "_SQL + std::int64_t(1), oid_map));
+    EXPECT_NE(key, bozo::detail::make_query_key("SELECT "_SQL + std::optional<std::int32_t>{}, oid_map));
+}
+
+} // namespace
@@ -0,0 +1,253 @@
+#include "connection_mock.h"
+
+#include <bozo/connection.h>
+#include <bozo/detail/request_statistics.h>
+#include <bozo/statistics.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+
+namespace {
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+bozo::query_sample make_sample(bozo::time_traits::duration server, std::size_t rows = 1, bool failed = false) {
+    bozo::query_sample retval;
+    retval[bozo::query_phase::server] = server;
+    retval.rows = rows;
+    retval.bytes_sent = 10;
+    retval.bytes_received = 20;
+    retval.failed = failed;
+    return retval;
+}
+
+TEST(latency_histogram, bucket_should_be_log2_of_microseconds) {
+    EXPECT_EQ(bozo::latency_histogram::bucket(0us), 0u);
+    EXPECT_EQ(bozo::latency_histogram::bucket(500ns), 0u);
+    EXPECT_EQ(bozo::latency_histogram::bucket(1us), 1u);
+    EXPECT_EQ(bozo::latency_histogram::bucket(3us), 2u);
+    EXPECT_EQ(bozo::latency_histogram::bucket(1024us), 11u);
+    EXPECT_EQ(bozo::latency_histogram::bucket(24h), bozo::latency_histogram::buckets_count - 1);
+}
+
+TEST(latency_histogram, percentile_should_return_upper_bound_of_bucket) {
+    bozo::latency_histogram histogram;
+    for (int i = 0; i < 99; ++i) {
+        histogram.add(3us);
+    }
+    histogram.add(1000us);
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.sum(), 99 * 3us + 1000us);
+    EXPECT_EQ(histogram.percentile(0.5), 4us);
+    EXPECT_EQ(histogram.percentile(0.99), 4us);
+    EXPECT_EQ(histogram.percentile(1.0), 1024us);
+}
+
+TEST(latency_histogram, percentile_should_return_zero_for_empty_histogram) {
+    EXPECT_EQ(bozo::latency_histogram{}.percentile(0.99), bozo::time_traits::duration{});
+}
+
+TEST(query_counters, add_should_accumulate_sample) {
+    bozo::query_counters counters;
+    counters.add(make_sample(5us, 2));
+    counters.add(make_sample(5us, 3, true));
+    EXPECT_EQ(counters.count, 2u);
+    EXPECT_EQ(counters.errors, 1u);
+    EXPECT_EQ(counters.rows, 5u);
+    EXPECT_EQ(counters.bytes_sent, 20u);
+    EXPECT_EQ(counters.bytes_received, 40u);
+    EXPECT_EQ(counters[bozo::query_phase::server].count(), 2u);
+    EXPECT_EQ(counters[bozo::query_phase::server].sum(), 10us);
+}
+
+TEST(statistics_registry, snapshot_should_return_counters_per_query) {
+    bozo::statistics_registry registry;
+    registry.record("SELECT 1", make_sample(5us));
+    registry.record("SELECT 1", make_sample(7us));
+    registry.record("SELECT 2", make_sample(9us));
+    const auto snapshot = registry.snapshot();
+    ASSERT_EQ(snapshot.size(), 2u);
+    EXPECT_EQ(snapshot.at("SELECT 1").count, 2u);
+    EXPECT_EQ(snapshot.at("SELECT 1")[bozo::query_phase::server].sum(), 12us);
+    EXPECT_EQ(snapshot.at("SELECT 2").count, 1u);
+    EXPECT_EQ(registry.total().count, 3u);
+}
+
+TEST(statistics_registry, snapshot_should_sum_counters_of_all_threads) {
+    bozo::statistics_registry registry;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 1000; ++j) {
+                registry.record("SELECT 1", make_sample(5us));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto snapshot = registry.snapshot();
+    EXPECT_EQ(snapshot.at("SELECT 1").count, 4000u);
+    EXPECT_EQ(snapshot.at("SELECT 1").rows, 4000u);
+}
+
+TEST(statistics_registry, record_should_account_queries_over_limit_as_other) {
+    bozo::statistics_registry registry(2);
+    registry.record("SELECT 1", make_sample(5us));
+    registry.record("SELECT 2", make_sample(5us));
+    registry.record("SELECT 3", make_sample(5us));
+    registry.record("SELECT 4", make_sample(5us));
+    const auto snapshot = registry.snapshot();
+    EXPECT_EQ(snapshot.size(), 3u);
+    EXPECT_EQ(snapshot.at(std::string(bozo::statistics_registry::other_queries)).count, 2u);
+}
+
+TEST(statistics_registry, should_not_mix_counters_of_different_registries) {
+    bozo::statistics_registry first;
+    bozo::statistics_registry second;
+    first.record("SELECT 1", make_sample(5us));
+    EXPECT_EQ(first.total().count, 1u);
+    EXPECT_EQ(second.total().count, 0u);
+}
+
+TEST(query_statistics, update_should_record_sample_per_connection_and_into_registry) {
+    auto registry = std::make_shared<bozo::statistics_registry>();
+    bozo::query_statistics statistics{registry};
+    statistics.update("SELECT 1", make_sample(5us));
+    EXPECT_EQ(statistics.connection_counters().count, 1u);
+    EXPECT_EQ(registry->snapshot().at("SELECT 1").count, 1u);
+}
+
+TEST(query_statistics, copies_should_share_registry_and_have_own_connection_counters) {
+    auto registry = std::make_shared<bozo::statistics_registry>();
+    const bozo::query_statistics prototype{registry};
+    auto first = prototype;
+    auto second = prototype;
+    first.update("SELECT 1", make_sample(5us));
+    second.update("SELECT 1", make_sample(5us));
+    EXPECT_EQ(first.connection_counters().count, 1u);
+    EXPECT_EQ(second.connection_counters().count, 1u);
+    EXPECT_EQ(prototype.connection_counters().count, 0u);
+    EXPECT_EQ(registry->total().count, 2u);
+}
+
+TEST(query_statistics, checkout_should_be_attributed_to_next_query_only) {
+    bozo::query_statistics statistics;
+    bozo::checkout_sample checkout;
+    checkout.queue_wait = 3us;
+    checkout.connect = 100us;
+    statistics.update(bozo::checkout_key{}, checkout);
+    statistics.update("SELECT 1", make_sample(5us));
+    statistics.update("SELECT 1", make_sample(5us));
+    const auto& counters = statistics.connection_counters();
+    EXPECT_EQ(counters[bozo::query_phase::queue_wait].sum(), 3us);
+    EXPECT_EQ(counters[bozo::query_phase::connect].sum(), 100us);
+    EXPECT_EQ(counters[bozo::query_phase::connect].counts()[0], 1u);
+}
+
+TEST(QueryStatistics, should_be_true_for_query_statistics_and_false_for_none) {
+    EXPECT_TRUE(bozo::QueryStatistics<bozo::query_statistics>);
+    EXPECT_FALSE(bozo::QueryStatistics<bozo::no_statistics>);
+}
+
+TEST(CollectsStatistics, should_be_true_for_connection_with_query_statistics_only) {
+    EXPECT_TRUE((bozo::detail::CollectsStatistics<bozo::connection<bozo::empty_oid_map, bozo::query_statistics>>));
+    EXPECT_FALSE((bozo::detail::CollectsStatistics<bozo::connection<bozo::empty_oid_map, bozo::no_statistics>>));
+    EXPECT_FALSE((bozo::detail::CollectsStatistics<bozo::tests::connection<>>));
+}
+
+TEST(request_statistics_disabled, should_be_empty) {
+    EXPECT_TRUE(std::is_empty_v<bozo::detail::request_statistics<false>>);
+}
+
+struct request_statistics : Test {
+    bozo::detail::request_statistics<true> statistics;
+    bozo::query_statistics connection_statistics;
+
+    struct connection {
+        bozo::query_statistics& statistics_;
+
+        template <typename Key, typename Value>
+        void update_statistics(const Key& key, Value&& v) noexcept {
+            statistics_.update(key, std::forward<Value>(v));
+        }
+    };
+};
+
+TEST_F(request_statistics, update_should_not_record_request_without_query) {
+    connection conn{connection_statistics};
+    statistics.update(conn, false);
+    EXPECT_EQ(connection_statistics.connection_counters().count, 0u);
+}
+
+TEST_F(request_statistics, update_should_record_request_by_query_text) {
+    statistics.set_query(bozo::binary_query("SELECT $1", boost::hana::make_tuple(std::int32_t(42)), bozo::empty_oid_map{}));
+    statistics.mark_sent();
+    statistics.mark_received();
+    connection conn{connection_statistics};
+    statistics.update(conn, true);
+    const auto snapshot = connection_statistics.registry()->snapshot();
+    ASSERT_EQ(snapshot.count("SELECT $1"), 1u);
+    EXPECT_EQ(snapshot.at("SELECT $1").count, 1u);
+    EXPECT_EQ(snapshot.at("SELECT $1").errors, 1u);
+    EXPECT_EQ(snapshot.at("SELECT $1").bytes_sent, std::strlen("SELECT $1") + sizeof(std::int32_t));
+}
+
+TEST_F(request_statistics, make_sample_should_account_rows_and_data_sent_after_query) {
+    statistics.set_query(bozo::binary_query("COPY t FROM STDIN", boost::hana::make_tuple(), bozo::empty_oid_map{}));
+    statistics.add_sent(100);
+    statistics.add_rows(2, 0);
+    statistics.add_rows(3, 50);
+    const auto sample = statistics.make_sample(false);
+    EXPECT_EQ(sample.bytes_sent, std::strlen("COPY t FROM STDIN") + 100);
+    EXPECT_EQ(sample.rows, 5u);
+    EXPECT_EQ(sample.bytes_received, 50u);
+}
+
+TEST_F(request_statistics, mark_sent_should_take_send_time_of_other_request) {
+    bozo::detail::request_statistics<true> other;
+    other.mark_sent();
+    statistics.mark_sent(other);
+    EXPECT_EQ(statistics.sent_, other.sent_);
+    bozo::detail::request_statistics<true> unsent;
+    statistics.mark_sent(unsent);
+    EXPECT_EQ(statistics.sent_, other.sent_);
+}
+
+TEST_F(request_statistics, mark_sent_should_use_current_time_if_other_request_is_not_sent) {
+    const auto now = bozo::time_traits::now();
+    statistics.mark_sent(bozo::detail::request_statistics<true>{});
+    EXPECT_GE(statistics.sent_, now);
+}
+
+TEST_F(request_statistics, make_sample_should_split_request_time_into_phases) {
+    std::this_thread::sleep_for(1ms);
+    statistics.mark_sent();
+    std::this_thread::sleep_for(1ms);
+    statistics.mark_first_byte();
+    std::this_thread::sleep_for(1ms);
+    statistics.mark_received();
+    statistics.decode([] { std::this_thread::sleep_for(1ms);});
+    const auto sample = statistics.make_sample(false);
+    EXPECT_GE(sample[bozo::query_phase::send], 1ms);
+    EXPECT_GE(sample[bozo::query_phase::server], 1ms);
+    EXPECT_GE(sample[bozo::query_phase::receive], 1ms);
+    EXPECT_GE(sample[bozo::query_phase::decode], 1ms);
+    EXPECT_EQ(sample[bozo::query_phase::connect], bozo::time_traits::duration{});
+    EXPECT_FALSE(sample.failed);
+}
+
+TEST_F(request_statistics, make_sample_should_exclude_decode_interleaved_with_receive) {
+    statistics.mark_sent();
+    statistics.mark_first_byte();
+    statistics.decode([] { std::this_thread::sleep_for(2ms);});
+    statistics.mark_received();
+    const auto sample = statistics.make_sample(false);
+    EXPECT_GE(sample[bozo::query_phase::decode], 2ms);
+    EXPECT_LT(sample[bozo::query_phase::receive], 2ms);
+}
+
+} // namespace
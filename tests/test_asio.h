@@ -157,7 +157,11 @@ struct execution_context : asio::execution_context {
     testing::StrictMock<steady_timer_service_mock> timer_service_;
     testing::StrictMock<stream_descriptor_service_mock> stream_service_;
 
+    bool stopped_ = false;
+
     executor_type get_executor() { return {executor_, *this}; }
+
+    bool stopped() const noexcept { return stopped_; }
 };
 
 using io_context = execution_context;